@@ -0,0 +1,56 @@
+function status = baslerAutoExposure(cameraIndex, varargin)
+% baslerAutoExposure.m - Keep the brightness of a continuous grab stable
+%
+%  Attaches an exposure controller to the continuous grab started with
+%  baslerStartGrabbing. It runs in the background thread which retrieves
+%  the frames: the mean brightness of every frame is measured from a
+%  histogram of a subsampled grid of pixels, and new values of
+%  ExposureTime (and Gain) are written right away, so the loop takes
+%  about as long as one frame. ExposureAuto and GainAuto are switched off.
+%
+%  The control law is a PI controller on the logarithm of exposure time
+%  times gain, where brightness is linear in both:
+%    e = log(Target / brightness)
+%    log(exposure * gain) = log(start) + Kp * e + Ki * sum(e)
+%  The exposure time is raised first, the gain only once the exposure
+%  reaches ExposureMax.
+%
+%  The optional struct settings holds any of these fields:
+%    - Target: mean brightness, 0 to 1 of full scale (default=0.45)
+%    - Kp, Ki: proportional and integral gain (default=0 and 0.8). Ki=1
+%      corrects a linear camera response in one update.
+%    - Tolerance: relative error which is not corrected (default=0.02)
+%    - Every: frames per update (default=2). The frame following a
+%      write is usually still exposed with the old value.
+%    - Subsample: pixel step of the histogram (default=4)
+%    - ExposureMin, ExposureMax: in us (default: the camera's limits)
+%    - GainMax: in dB, 0 leaves the gain alone (default=0)
+%  Calling it again replaces the controller and starts from the current
+%  values. 'off' or [] detaches it, the camera keeps the last values. The
+%  controller is removed when grabbing stops.
+%
+%  Unpacked mono, Bayer and RGB formats with 8 or 16 bit per sample are
+%  supported, all samples of a pixel count alike.
+%
+%  status contains the number of frames seen, measured and corrected,
+%  the last brightness (0 to 1), the written exposure time and gain and
+%  the time of the last update in s.
+%
+%  The optional parameter verbose (default=0) enables the output of
+%  internal information to the workspace.
+%
+%  Usage:
+%    status = baslerAutoExposure(cameraIndex)
+%    status = baslerAutoExposure(cameraIndex, settings)
+%    status = baslerAutoExposure(cameraIndex, 'off')
+%    status = baslerAutoExposure(cameraIndex, settings, verbose)
+%
+%  Examples:
+%    baslerStartGrabbing(0);
+%    baslerAutoExposure(0, struct('Target', 0.5, 'GainMax', 12));
+%    status = baslerAutoExposure(0)
+%
+
+status = baslerDriver('AutoExposure', cameraIndex, varargin{:});
+
+end
@@ -10,82 +10,19 @@ function cameraStruct = baslerCameraInfo(cameraIndex, varargin)
 %    - 2: Guru
 %  The default value is 0: Beginner
 %
+%  Integer parameters are returned as int64, float parameters as double,
+%  boolean parameters as logical and enumerations as strings.
+%
+%  The optional parameter verbose (default=0) prints the number of
+%  parameters and the time needed to read them.
+%
 %  Usage:
 %  cameraStruct = baslerCameraInfo(cameraIndex);
 %  cameraStruct = baslerCameraInfo(cameraIndex, visibility);
+%  cameraStruct = baslerCameraInfo(cameraIndex, visibility, verbose);
 %
 
-% Parse visibility input
-if nargin == 2
-    visibility = varargin{1};
-else
-    visibility = 0;
-end
-
-% Get raw data
-cameraCell = baslerGetRawCameraParams(cameraIndex);
-
-% Remove empty values
-emptyRows = cellfun( @isempty, cameraCell(:,2) );
-cameraCell = cameraCell(~emptyRows,:);
+% Read and filter all parameters in one call
+cameraStruct = baslerDriver('GetRawCameraParams', cameraIndex, varargin{:});
 
-% Remove parameters with ambiguous numbers
-nParamRows =                                                ...
-    cellfun(                                                ...
-        @(x) ~isempty( regexp(x,'N\d{1,4}','once')) ,       ...
-        cameraCell(:,1))                                    ...
-    |                                                       ...
-        cellfun(                                            ...
-        @(x) ~isempty( regexp(x,'\d{6,}','once')) ,         ...
-        cameraCell(:,1))                                    ...
-    ;
-cameraCell = cameraCell(~nParamRows,:);
-
-% Remove parameters with special keywords
-nParamConv = cellfun(                                       ...
-        @(x) ~isempty( strfind(x,'_ConvertTo')) ,           ...
-        cameraCell(:,1))                                    ...
-    |                                                       ...
-    cellfun(                                                ...
-        @(x) ~isempty( strfind(x,'_ConvertFrom')) ,         ...
-        cameraCell(:,1))                                    ...
-    |                                                       ...
-    cellfun(                                                ...
-        @(x) ~isempty( strfind(x,'Fao')) ,                  ...
-        cameraCell(:,1))                                    ...
-    |                                                       ...
-    cellfun(                                                ...
-        @(x) ~isempty( strfind(x,'_adrCalc')) ,             ...
-        cameraCell(:,1))                                    ...
-    |                                                       ...
-    cellfun(                                                ...
-        @(x) ~isempty( strfind(x,'_Reg')) ,                 ...
-        cameraCell(:,1))                                    ...
-    |                                                       ...
-    cellfun(                                                ...
-        @(x) ~isempty( strfind(x,'Status')) ,               ...
-        cameraCell(:,1))                                    ...
-    |                                                       ...
-    cellfun(                                                ...
-        @(x) ~isempty( strfind(x,'Status')) ,               ...
-        cameraCell(:,1))                                    ...
-    |                                                       ...
-    cellfun(                                                ...
-        @(x) ~isempty( strfind(x,'available')) ,            ...
-        cameraCell(:,1))                                    ...
-    |                                                       ...
-    cellfun(                                                ...
-        @(x) ~isempty( strfind(x,'Available')) ,            ...
-        cameraCell(:,1))                                    ...
-    ;
-cameraCell = cameraCell(~nParamConv,:);
-
-% Only correct visibility
-nVisRows = cellfun( @(x)x>visibility, cameraCell(:,3) );
-cameraCell = cameraCell(~nVisRows,:);
-
-% Remove visibility
-cameraCell = cameraCell(:,1:2);
-cameraStruct = cell2struct(cameraCell(:,2),cameraCell(:,1),1);
-
-end
\ No newline at end of file
+end
@@ -0,0 +1,20 @@
+function baslerCloseCamera(varargin)
+% baslerCloseCamera.m - Close an open Basler camera
+%
+%  Closes the camera specified by its index or its serial number, which
+%  makes it accessible for other applications again. Calling this
+%  function without a camera closes all open cameras.
+%
+%  The optional parameter verbose (default=0) enables the output of
+%  internal information to the workspace.
+%
+%  Usage:
+%    baslerCloseCamera()
+%    baslerCloseCamera(cameraIndex)
+%    baslerCloseCamera(serialNumber)
+%    baslerCloseCamera([], verbose)
+%
+
+baslerDriver('CloseCamera', varargin{:});
+
+end
@@ -0,0 +1,61 @@
+// baslerDriver.cpp - Entry point of the MATLAB Basler camera driver
+// Dispatches the command name given as first argument to the driver
+// function. Use the baslerXXX.m wrappers instead of calling it directly.
+
+#include "basler_helper/basler_driver.h"
+
+#include <map>
+#include <string>
+
+#include <matrix.h>
+#include <mex.h>
+
+
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    // Map command names to driver functions
+    static std::map<std::string,DriverFunction> commandMap;
+    if(commandMap.empty())
+    {
+        commandMap["FindCameras"] = baslerFindCameras;
+        commandMap["SetParameter"] = baslerSetParameter;
+        commandMap["GetParameter"] = baslerGetParameter;
+        commandMap["SetParameters"] = baslerSetParameters;
+        commandMap["GetParameters"] = baslerGetParameters;
+        commandMap["ParameterLatency"] = baslerParameterLatency;
+        commandMap["GetData"] = baslerGetData;
+        commandMap["GetMultiData"] = baslerGetMultiData;
+        commandMap["SaveData"] = baslerSaveData;
+        commandMap["GetRawCameraParams"] = baslerGetRawCameraParams;
+        commandMap["ReadRaw"] = baslerReadRaw;
+        commandMap["ReadTiff"] = baslerReadTiff;
+        commandMap["StartGrabbing"] = baslerStartGrabbing;
+        commandMap["StopGrabbing"] = baslerStopGrabbing;
+        commandMap["GetLatestData"] = baslerGetLatestData;
+        commandMap["AutoExposure"] = baslerAutoExposure;
+        commandMap["StartStream"] = baslerStartStream;
+        commandMap["ReadStream"] = baslerReadStream;
+        commandMap["StopStream"] = baslerStopStream;
+        commandMap["OpenCamera"] = baslerOpenCamera;
+        commandMap["CloseCamera"] = baslerCloseCamera;
+        commandMap["ListCameras"] = baslerListCameras;
+    }
+
+    // Parse command
+    if(nrhs < 1 || !mxIsChar(prhs[0]))
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "No command given. Use the baslerXXX functions instead of baslerDriver.");
+    }
+    const std::string s_command(mxArrayToString(prhs[0]));
+
+    std::map<std::string,DriverFunction>::const_iterator it = commandMap.find(s_command);
+    if(it == commandMap.end())
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "Unknown command \"%s\".", s_command.c_str());
+    }
+
+    // Call driver function without the command name
+    it->second(nlhs, plhs, nrhs-1, prhs+1);
+}
@@ -2,24 +2,22 @@
 // see baslerFindCameras.m for help
 
 #include <pylon/PylonIncludes.h>
+#include "basler_helper/basler_driver.h"
+#include "basler_helper/camera_session.h"
 
 #include <matrix.h>
 #include <mex.h>
 
-void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+void baslerFindCameras(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
 {       
     
-    // Initiatlize Pylon
-    Pylon::PylonAutoInitTerm auto_init_term;
-
     try
     {
+        // Get all attached devices, this also updates the camera indices
+        const Pylon::DeviceInfoList_t& devices = BaslerHelper::get_devices(true);
+        
         // Get the transport layer factory.
         Pylon::CTlFactory& tlFactory = Pylon::CTlFactory::GetInstance();
-        
-        // Get all attached devices
-        Pylon::DeviceInfoList_t devices;
-        tlFactory.EnumerateDevices(devices);
 
         
         // Create an array of instant cameras for the found devices
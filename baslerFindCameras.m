@@ -1,3 +1,4 @@
+function available_cams = baslerFindCameras()
 % baslerFindCameras.m - Find all connected Basler cameras
 %
 %  Returns a cell array containing the index (first column) and name 
@@ -5,4 +6,8 @@
 %
 %  Usage:
 %  available_cams = baslerFindCameras();
-%
\ No newline at end of file
+%
+
+available_cams = baslerDriver('FindCameras');
+
+end
@@ -2,33 +2,204 @@
 // see baslerGetData.m for help
 
 #include <pylon/PylonIncludes.h>
+#include "basler_helper/basler_driver.h"
+#include "basler_helper/camera_session.h"
 #include "basler_helper/basler_set_get.h"
 #include "basler_helper/capture_images.h"
+#include "basler_helper/direct_capture.h"
+#include "basler_helper/frame_source.h"
+#include "basler_helper/frame_metadata.h"
+#include "basler_helper/debayer_image.h"
+#include "basler_helper/crop_image.h"
+#include "basler_helper/frame_reduce.h"
+#include "basler_helper/trigger_capture.h"
+#include "basler_helper/grab_options.h"
+#include "basler_helper/telemetry.h"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include <matrix.h>
 #include <mex.h>
 
+
+namespace {
+
+    //---------------------------------------------------------------------
+    // Read the windows, factor and mode of the crop struct
+    void parse_crop(const mxArray* mxa_crop, BaslerHelper::CropSettings& crop)
+    {
+        const mxArray* mxa_roi = mxIsStruct(mxa_crop) ? mxGetField(mxa_crop, 0, "ROI") : NULL;
+        if(mxa_roi == NULL || !mxIsDouble(mxa_roi) || mxGetN(mxa_roi) != 4 || mxGetM(mxa_roi) < 1)
+        {
+            mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                    "Crop needs a field ROI with one row [xOffset, yOffset, width, height] per window.");
+        }
+        const double* p_roi = mxGetPr(mxa_roi);
+        const size_t i_num_of_windows = mxGetM(mxa_roi);
+        for(size_t k = 0; k < i_num_of_windows; k++)
+        {
+            for(size_t c = 0; c < 4; c++)
+            {
+                if(p_roi[c * i_num_of_windows + k] < 0)
+                {
+                    mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                            "The offsets and sizes of the windows cannot be negative.");
+                }
+            }
+            BaslerHelper::CropWindow window;
+            window.i_x = (size_t)p_roi[k];
+            window.i_y = (size_t)p_roi[i_num_of_windows + k];
+            window.i_width = (size_t)p_roi[2 * i_num_of_windows + k];
+            window.i_height = (size_t)p_roi[3 * i_num_of_windows + k];
+            crop.windows.push_back(window);
+        }
+
+        const mxArray* mxa_factor = mxGetField(mxa_crop, 0, "Factor");
+        if(mxa_factor != NULL && mxGetNumberOfElements(mxa_factor) >= 1)
+        {
+            const double d_factor = mxGetScalar(mxa_factor);
+            if(d_factor < 1 || d_factor != (double)(unsigned int)d_factor)
+            {
+                mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                        "The factor has to be a positive integer.");
+            }
+            crop.i_factor = (unsigned int)d_factor;
+        }
+
+        const mxArray* mxa_mode = mxGetField(mxa_crop, 0, "Mode");
+        if(mxa_mode != NULL && !mxIsEmpty(mxa_mode))
+        {
+            const std::string s_mode = mxArrayToString(mxa_mode);
+            if(s_mode == "decimate")
+            {
+                crop.bm_mode = BaslerHelper::Binning_Decimate;
+            }
+            else if(s_mode == "sum")
+            {
+                crop.bm_mode = BaslerHelper::Binning_Sum;
+            }
+            else if(s_mode == "average")
+            {
+                crop.bm_mode = BaslerHelper::Binning_Average;
+            }
+            else
+            {
+                mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                        "Unknown mode, use 'decimate', 'sum' or 'average'.");
+            }
+        }
+    }
     
-void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
-{       
-    // Parse parameters
-    if(nrhs < 1)
+    //---------------------------------------------------------------------
+    // Read the mode and dark frame of the reduce string or struct
+    BaslerHelper::ReduceMode parse_reduce(const mxArray* mxa_reduce, const mxArray*& mxa_dark)
     {
+        const mxArray* mxa_mode = mxa_reduce;
+        mxa_dark = NULL;
+        if(mxIsStruct(mxa_reduce))
+        {
+            mxa_mode = mxGetField(mxa_reduce, 0, "Mode");
+            mxa_dark = mxGetField(mxa_reduce, 0, "DarkFrame");
+            if(mxa_dark != NULL && mxIsEmpty(mxa_dark))
+            {
+                mxa_dark = NULL;
+            }
+            if(mxa_dark != NULL && (!mxIsDouble(mxa_dark) || mxIsComplex(mxa_dark)))
+            {
+                mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                        "DarkFrame must be a real double array.");
+            }
+        }
+        if(mxa_mode == NULL || !mxIsChar(mxa_mode))
+        {
+            mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                    "Reduce needs a mode, 'mean', 'var', 'sum', 'max' or 'min'.");
+        }
+        
+        const std::string s_mode = mxArrayToString(mxa_mode);
+        if(s_mode == "mean")
+        {
+            return BaslerHelper::Reduce_Mean;
+        }
+        else if(s_mode == "var")
+        {
+            return BaslerHelper::Reduce_Var;
+        }
+        else if(s_mode == "sum")
+        {
+            return BaslerHelper::Reduce_Sum;
+        }
+        else if(s_mode == "max")
+        {
+            return BaslerHelper::Reduce_Max;
+        }
+        else if(s_mode == "min")
+        {
+            return BaslerHelper::Reduce_Min;
+        }
         mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
-                "Not enough arguments. Use help baslerGetParameter for further information."); 
+                "Unknown reduce mode, use 'mean', 'var', 'sum', 'max' or 'min'.");
+        return BaslerHelper::Reduce_None;
     }
-    else if(nrhs > 4)
+    
+    //---------------------------------------------------------------------
+    // Capture the frames into an accumulator and write its result into
+    // mxa_output
+    template <typename T>
+    int capture_reduced(BaslerHelper::FrameSource* p_source,
+                        const int i_num_of_frames,
+                        mxArray* mxa_output,
+                        const Pylon::EPixelType ept_output_type,
+                        const int i_num_of_workers,
+                        const bool b_verbose,
+                        BaslerHelper::FrameMetadata* p_metadata,
+                        const BaslerHelper::ColorConversion cc_method,
+                        const BaslerHelper::ReduceMode rm_mode,
+                        const mxArray* mxa_dark,
+                        const BaslerHelper::TriggerSettings* p_trigger,
+                        BaslerHelper::LatencyHistogram* p_latency,
+                        BaslerHelper::Telemetry* p_telemetry,
+                        BaslerHelper::GrabThread* p_grab_thread)
     {
-        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
-                "Too many arguments. Use help baslerGetParameter for further information."); 
+        BaslerHelper::FrameAccumulator<T> accumulator(rm_mode, (size_t)p_source->height(), (size_t)p_source->width(),
+                Pylon::SamplesPerPixel(ept_output_type));
+        
+        // Every worker accumulates into its own copy of the frame
+        const int i_reduce_workers = std::min(i_num_of_workers, BaslerHelper::MAX_REDUCE_WORKERS);
+        if(b_verbose && i_reduce_workers < i_num_of_workers)
+        {
+            mexPrintf("Reducing with %d conversion thread(s) \n", i_reduce_workers);
+        }
+        const int i_dropped = BaslerHelper::capture_images<T>(p_source, i_num_of_frames, (T*)NULL, ept_output_type,
+                i_reduce_workers, b_verbose, p_metadata, cc_method, NULL, &accumulator, p_trigger, p_latency,
+                p_telemetry, p_grab_thread);
+        if(b_verbose)
+        {
+            mexPrintf("Reduced %llu frame(s)\n", accumulator.frames());
+        }
+        accumulator.result(mxGetPr(mxa_output), mxa_dark != NULL ? mxGetPr(mxa_dark) : NULL);
+        return i_dropped;
     }
+}
+
     
-    // Get camera number
-    const int i_cam_number = (int)mxGetScalar(prhs[0]);
+void baslerGetData(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{       
+    // Parse parameters
+    if(nrhs < 1)
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "Not enough arguments. Use help baslerGetData for further information."); 
+    }
     
     // Get verbose parameter
     bool b_verbose = 0;
-    if(nrhs == 4)
+    if(nrhs >= 4 && mxGetNumberOfElements(prhs[3]) >= 1)
     {
         b_verbose = (int)mxGetScalar(prhs[3]) != 0;
     }
@@ -42,11 +213,126 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
             i_num_of_frames = (int)mxGetScalar(prhs[1]);
         }
     }
+    if(i_num_of_frames < 1)
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "nFrames has to be at least 1.");
+    }
     if(b_verbose)
     {
         mexPrintf("Capturing %d frame(s) \n",i_num_of_frames);
     }
     
+    // Get options, a struct or name/value pairs after nWorkers
+    const char* s_capture_names[] = {"Transposed", "Demosaic", "Crop", "Reduce", "Trigger"};
+    const mxArray* mxa_options = BaslerHelper::options_to_struct(std::max(0, nrhs - 5), prhs + std::min(nrhs, 5),
+            std::vector<std::string>(s_capture_names, s_capture_names + 5));
+    const mxArray* mxa_transposed = (mxa_options != NULL) ? mxGetField(mxa_options, 0, "Transposed") : NULL;
+    const mxArray* mxa_demosaic = (mxa_options != NULL) ? mxGetField(mxa_options, 0, "Demosaic") : NULL;
+    const mxArray* mxa_crop = (mxa_options != NULL) ? mxGetField(mxa_options, 0, "Crop") : NULL;
+    const mxArray* mxa_reduce = (mxa_options != NULL) ? mxGetField(mxa_options, 0, "Reduce") : NULL;
+    const mxArray* mxa_trigger = (mxa_options != NULL) ? mxGetField(mxa_options, 0, "Trigger") : NULL;
+    
+    // Get transposed output, frames are returned as width x height
+    bool b_transposed = false;
+    if(mxa_transposed != NULL && mxGetNumberOfElements(mxa_transposed) >= 1)
+    {
+        b_transposed = (int)mxGetScalar(mxa_transposed) != 0;
+    }
+    if(b_transposed && nrhs >= 5 && mxGetNumberOfElements(prhs[4]) >= 1)
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "Transposed output is not converted, nWorkers cannot be given.");
+    }
+    
+    // Get number of conversion threads, default: one per core but the one
+    // retrieving the frames
+    int i_num_of_workers = (int)std::thread::hardware_concurrency() - 1;
+    if(nrhs >= 5 && mxGetNumberOfElements(prhs[4]) >= 1)
+    {
+        i_num_of_workers = (int)mxGetScalar(prhs[4]);
+    }
+    i_num_of_workers = std::max(0, std::min(i_num_of_workers, std::min(i_num_of_frames, 16)));
+    if(i_num_of_frames < 2 || b_transposed)
+    {
+        i_num_of_workers = 0;
+    }
+    if(b_verbose)
+    {
+        mexPrintf("Using %d conversion thread(s) \n",i_num_of_workers);
+    }
+    
+    // Get color conversion of Bayer and mono frames, default: Pylon's
+    // converter for RGB, native unpacking, see default_conversion
+    BaslerHelper::ColorConversion cc_method = BaslerHelper::ColorConversion_Pylon;
+    const bool b_demosaic_given = mxa_demosaic != NULL && !mxIsEmpty(mxa_demosaic);
+    if(b_demosaic_given)
+    {
+        if(!mxIsChar(mxa_demosaic))
+        {
+            mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                    "Demosaic must be 'bilinear', 'gradient' or 'pylon'.");
+        }
+        const std::string s_demosaic = mxArrayToString(mxa_demosaic);
+        if(s_demosaic == "bilinear")
+        {
+            cc_method = BaslerHelper::ColorConversion_Bilinear;
+        }
+        else if(s_demosaic == "gradient")
+        {
+            cc_method = BaslerHelper::ColorConversion_GradientCorrected;
+        }
+        else if(s_demosaic == "pylon")
+        {
+            cc_method = BaslerHelper::ColorConversion_Pylon;
+        }
+        else
+        {
+            mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                    "Unknown demosaic method, use 'bilinear', 'gradient' or 'pylon'.");
+        }
+    }
+    
+    // Get windows to copy instead of the whole frame
+    BaslerHelper::CropSettings crop;
+    if(mxa_crop != NULL && !mxIsEmpty(mxa_crop))
+    {
+        parse_crop(mxa_crop, crop);
+        if(b_transposed)
+        {
+            mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                    "Transposed output cannot be cropped.");
+        }
+    }
+    
+    // Get reduction of the frames, instead of returning all of them
+    BaslerHelper::ReduceMode rm_mode = BaslerHelper::Reduce_None;
+    const mxArray* mxa_dark = NULL;
+    if(mxa_reduce != NULL && !mxIsEmpty(mxa_reduce))
+    {
+        rm_mode = parse_reduce(mxa_reduce, mxa_dark);
+        if(b_transposed || !crop.windows.empty())
+        {
+            mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                    "Reduced frames cannot be transposed or cropped.");
+        }
+    }
+    
+    // Get trigger and timeout policy, default: free-running with a
+    // timeout of 5 s
+    BaslerHelper::TriggerSettings trigger;
+    if(mxa_trigger != NULL && !mxIsEmpty(mxa_trigger))
+    {
+        BaslerHelper::parse_trigger(mxa_trigger, trigger);
+    }
+    
+    // Get grab engine and grab thread options
+    BaslerHelper::GrabOptions grab_options;
+    if(mxa_options != NULL)
+    {
+        BaslerHelper::parse_grab_options(mxa_options, grab_options);
+    }
+    
     // Get output type
     Pylon::EPixelType ept_output_type = Pylon::PixelType_Undefined;
     if(nrhs >= 3)
@@ -62,78 +348,247 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
     }
 
     
-    // Initiatlize Pylon
-    Pylon::PylonAutoInitTerm auto_init_term;
-    
     try
     {
-        // Get the transport layer factory.
-        Pylon::CTlFactory& tlFactory = Pylon::CTlFactory::GetInstance();
-        
-        // Get all attached devices
-        Pylon::DeviceInfoList_t devices;
-        int i_num_of_cameras = tlFactory.EnumerateDevices(devices);
-        if ( i_num_of_cameras == 0 )
-        {
-            throw RUNTIME_EXCEPTION( "No camera found.");
-        }
+        // Get camera, or a synthetic source
+        std::unique_ptr<BaslerHelper::FrameSource> p_source = BaslerHelper::create_source(prhs[0], b_verbose);
         
-        // Check if camera exists
-        if (i_cam_number > i_num_of_cameras-1 )
+        // Tune the grab engine, and the thread which retrieves the frames
+        if(p_source->camera() != NULL)
         {
-            throw RUNTIME_EXCEPTION("No camera with this index exists.");
-        }
-        
-        // Create camera object
-        Pylon::CInstantCamera camera(tlFactory.CreateDevice(devices[i_cam_number]));
-        
-        // Open Camera
-        camera.Open();
-        if(b_verbose)
-        {
-            mexPrintf("Using camera \"%s\"\n", camera.GetDeviceInfo().GetModelName().c_str());
+            BaslerHelper::apply_grab_options(p_source->camera(), grab_options, b_verbose);
         }
+        BaslerHelper::GrabThread grab_thread(grab_options);
         
         // Get width and height 
-        const unsigned long long i_width = BaslerHelper::get_int(&camera,"Width",b_verbose);
-        const unsigned long long i_height = BaslerHelper::get_int(&camera,"Height",b_verbose);
+        const unsigned long long i_width = p_source->width();
+        const unsigned long long i_height = p_source->height();
         unsigned long long i_numel = i_height * i_width;
         
         // Get dimensions of output array
         if(ept_output_type == Pylon::PixelType_Undefined)
         {
-            std::string s_pixel_type = BaslerHelper::get_string(&camera,"PixelFormat",b_verbose);
-            ept_output_type = Pylon::CPixelTypeMapper().GetPylonPixelTypeByName(s_pixel_type.c_str());
+            ept_output_type = p_source->pixel_type();
+        }
+        if(!b_demosaic_given)
+        {
+            cc_method = BaslerHelper::default_conversion(p_source->pixel_type(), ept_output_type);
         }
         
         const size_t i_dimensions[] = { i_height, 
                                         i_width,
                                         Pylon::SamplesPerPixel(ept_output_type), 
                                         i_num_of_frames};
+        if(b_verbose && BaslerHelper::can_convert_native(p_source->pixel_type(), ept_output_type) &&
+                cc_method != BaslerHelper::ColorConversion_Pylon)
+        {
+            mexPrintf("Converting to %s natively\n", cc_method == BaslerHelper::ColorConversion_Bilinear ?
+                    "RGB (bilinear)" : "RGB (gradient-corrected)");
+        }
+        const std::chrono::steady_clock::time_point tp_start = std::chrono::steady_clock::now();
+                                        
+        // Collect the metadata of the frames only if it is returned
+        BaslerHelper::FrameMetadata metadata;
+        BaslerHelper::FrameMetadata* p_metadata = (nlhs >= 2) ? &metadata : NULL;
+        
+        // Measure the latencies only if they are returned or shown
+        BaslerHelper::LatencyHistogram latency;
+        BaslerHelper::LatencyHistogram* p_latency = (nlhs >= 3 || b_verbose) ? &latency : NULL;
+        
+        // Time the stages if asked for or returned
+        BaslerHelper::Telemetry telemetry(!grab_options.s_trace_file.empty());
+        BaslerHelper::Telemetry* p_telemetry = (nlhs >= 5 || grab_options.b_telemetry) ? &telemetry : NULL;
                                         
         // Create output array and create pointer
         mxArray* mxa_output;
-        if(Pylon::BitDepth(ept_output_type) <= 8)
+        std::vector<mxArray*> mxa_windows;
+        int i_dropped = 0;
+        if(b_transposed)
+        {
+            // Let the camera write into the output array, no copy at all
+            if(p_source->camera() == NULL)
+            {
+                throw RUNTIME_EXCEPTION("Transposed output needs a camera.");
+            }
+            if(!BaslerHelper::can_capture_direct(p_source.get(), ept_output_type))
+            {
+                throw RUNTIME_EXCEPTION("Transposed output needs an unpacked mono output type equal to PixelFormat and no chunk data.");
+            }
+            const size_t i_transposed_dimensions[] = { i_width, i_height, (size_t)i_num_of_frames };
+            mxa_output = mxCreateNumericArray(3, i_transposed_dimensions,
+                    Pylon::BitDepth(ept_output_type) <= 8 ? mxUINT8_CLASS : mxUINT16_CLASS, mxREAL);
+            i_dropped = BaslerHelper::capture_images_direct(p_source.get(), i_num_of_frames, mxa_output, b_verbose,
+                    p_metadata, &trigger, p_latency, &grab_thread);
+        }
+        else if(rm_mode != BaslerHelper::Reduce_None)
+        {
+            // Accumulate the frames, only the result is allocated
+            mxa_output = mxCreateNumericArray(3, i_dimensions, mxDOUBLE_CLASS, mxREAL);
+            if(mxa_dark != NULL && mxGetNumberOfElements(mxa_dark) != mxGetNumberOfElements(mxa_output))
+            {
+                throw RUNTIME_EXCEPTION("DarkFrame must have %llux%llux%d elements.", i_height, i_width,
+                        (int)i_dimensions[2]);
+            }
+            if(Pylon::BitDepth(ept_output_type) <= 8)
+            {
+                i_dropped = capture_reduced<uint8_t>(p_source.get(), i_num_of_frames, mxa_output, ept_output_type,
+                        i_num_of_workers, b_verbose, p_metadata, cc_method, rm_mode, mxa_dark, &trigger, p_latency, p_telemetry, &grab_thread);
+            }
+            else if(Pylon::BitDepth(ept_output_type) <= 16)
+            {
+                i_dropped = capture_reduced<uint16_t>(p_source.get(), i_num_of_frames, mxa_output, ept_output_type,
+                        i_num_of_workers, b_verbose, p_metadata, cc_method, rm_mode, mxa_dark, &trigger, p_latency, p_telemetry, &grab_thread);
+            }
+            else
+            {
+                throw RUNTIME_EXCEPTION("Frames of more than 16 bit cannot be reduced.");
+            }
+        }
+        else if(!crop.windows.empty())
+        {
+            // Copy only the windows, into one array each. Sums are double.
+            const mxClassID mx_class = Pylon::BitDepth(ept_output_type) <= 8 ? mxUINT8_CLASS :
+                    (Pylon::BitDepth(ept_output_type) <= 16 ? mxUINT16_CLASS : mxDOUBLE_CLASS);
+            for(size_t k = 0; k < crop.windows.size(); k++)
+            {
+                const BaslerHelper::CropWindow& window = crop.windows[k];
+                if(window.i_x + window.i_width > i_width || window.i_y + window.i_height > i_height)
+                {
+                    throw RUNTIME_EXCEPTION("Window %d exceeds the frame of %llux%llu pixels.", (int)k + 1, i_width, i_height);
+                }
+                if(crop.output_width(k) == 0 || crop.output_height(k) == 0)
+                {
+                    throw RUNTIME_EXCEPTION("Window %d is smaller than the factor.", (int)k + 1);
+                }
+                
+                // Singleton dimensions are left out, like squeeze does
+                const size_t i_window_dimensions[] = { crop.output_height(k),
+                                                       crop.output_width(k),
+                                                       i_dimensions[2],
+                                                       i_dimensions[3]};
+                std::vector<size_t> i_squeezed;
+                for(size_t d = 0; d < 4; d++)
+                {
+                    if(i_window_dimensions[d] != 1)
+                    {
+                        i_squeezed.push_back(i_window_dimensions[d]);
+                    }
+                }
+                i_squeezed.resize(std::max<size_t>(i_squeezed.size(), 2), 1);
+                mxa_windows.push_back(mxCreateNumericArray(i_squeezed.size(), &i_squeezed[0],
+                        crop.bm_mode == BaslerHelper::Binning_Sum ? mxDOUBLE_CLASS : mx_class, mxREAL));
+                crop.outputs.push_back(mxGetData(mxa_windows.back()));
+            }
+            if(Pylon::BitDepth(ept_output_type) <= 8)
+            {
+                i_dropped = BaslerHelper::capture_images<uint8_t>(p_source.get(), i_num_of_frames, (uint8_t*)NULL, ept_output_type, i_num_of_workers, b_verbose, p_metadata, cc_method, &crop, NULL, &trigger, p_latency, p_telemetry, &grab_thread);
+            }
+            else if(Pylon::BitDepth(ept_output_type) <= 16)
+            {
+                i_dropped = BaslerHelper::capture_images<uint16_t>(p_source.get(), i_num_of_frames, (uint16_t*)NULL, ept_output_type, i_num_of_workers, b_verbose, p_metadata, cc_method, &crop, NULL, &trigger, p_latency, p_telemetry, &grab_thread);
+            }
+            else
+            {
+                i_dropped = BaslerHelper::capture_images<double>(p_source.get(), i_num_of_frames, (double*)NULL, ept_output_type, i_num_of_workers, b_verbose, p_metadata, cc_method, &crop, NULL, &trigger, p_latency, p_telemetry, &grab_thread);
+            }
+            
+            // A single window is returned as array, several as cell array
+            if(mxa_windows.size() == 1)
+            {
+                mxa_output = mxa_windows[0];
+            }
+            else
+            {
+                mxa_output = mxCreateCellMatrix(1, mxa_windows.size());
+                for(size_t k = 0; k < mxa_windows.size(); k++)
+                {
+                    mxSetCell(mxa_output, k, mxa_windows[k]);
+                }
+            }
+        }
+        else if(Pylon::BitDepth(ept_output_type) <= 8)
         {
             mxa_output = mxCreateNumericArray(4, i_dimensions, mxUINT8_CLASS, mxREAL);
-            BaslerHelper::capture_images<uint8_t>(&camera, i_num_of_frames, mxa_output, ept_output_type, b_verbose);
+            i_dropped = BaslerHelper::capture_images<uint8_t>(p_source.get(), i_num_of_frames, mxa_output, ept_output_type, i_num_of_workers, b_verbose, p_metadata, cc_method, &trigger, p_latency, p_telemetry, &grab_thread);
         }
         else if(Pylon::BitDepth(ept_output_type) <= 16)
         {
             mxa_output = mxCreateNumericArray(4, i_dimensions, mxUINT16_CLASS, mxREAL);
-            BaslerHelper::capture_images<uint16_t>(&camera, i_num_of_frames, mxa_output, ept_output_type, b_verbose);
+            i_dropped = BaslerHelper::capture_images<uint16_t>(p_source.get(), i_num_of_frames, mxa_output, ept_output_type, i_num_of_workers, b_verbose, p_metadata, cc_method, &trigger, p_latency, p_telemetry, &grab_thread);
         }
         else
         {
            mxa_output = mxCreateNumericArray(4, i_dimensions, mxDOUBLE_CLASS, mxREAL);
-           BaslerHelper::capture_images<double>(&camera, i_num_of_frames, mxa_output, ept_output_type, b_verbose);
+           i_dropped = BaslerHelper::capture_images<double>(p_source.get(), i_num_of_frames, mxa_output, ept_output_type, i_num_of_workers, b_verbose, p_metadata, cc_method, &trigger, p_latency, p_telemetry, &grab_thread);
+        }
+        
+        grab_thread.report(b_verbose);
+        if(b_verbose)
+        {
+            const double d_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - tp_start).count();
+            double d_megabytes = (double)(mxGetNumberOfElements(mxa_output) * mxGetElementSize(mxa_output)) / 1e6;
+            if(mxa_windows.size() > 1)
+            {
+                d_megabytes = 0;
+                for(size_t k = 0; k < mxa_windows.size(); k++)
+                {
+                    d_megabytes += (double)(mxGetNumberOfElements(mxa_windows[k]) * mxGetElementSize(mxa_windows[k])) / 1e6;
+                }
+            }
+            mexPrintf("Captured %.1f MB in %.3f s (%.1f MB/s)\n", d_megabytes, d_seconds, d_megabytes / d_seconds);
+            if(p_latency != NULL)
+            {
+                mexPrintf("Latency from %s to stored frame: median %.3f ms, p90 %.3f ms, p99 %.3f ms, max %.3f ms\n",
+                        trigger.software() ? "trigger" : "arrival", 1000 * latency.percentile(50),
+                        1000 * latency.percentile(90), 1000 * latency.percentile(99), 1000 * latency.percentile(100));
+            }
+        }
+        
+        // Telemetry of the stages, to find the bottleneck
+        if(p_telemetry != NULL && b_verbose)
+        {
+            mexPrintf("Time per frame and stage:\n");
+            telemetry.print();
+        }
+        if(!grab_options.s_trace_file.empty())
+        {
+            telemetry.write_trace(grab_options.s_trace_file);
+        }
+        
+        // Statistics of the stream grabber, to tune the grab options
+        const BaslerHelper::StreamStatistics stream_statistics = BaslerHelper::read_stream_statistics(p_source->camera());
+        if(b_verbose && p_source->camera() != NULL)
+        {
+            mexPrintf("Stream grabber: %g buffers, %g failed, %g underruns, %g resend requests\n",
+                    stream_statistics.d_total_buffers, stream_statistics.d_failed_buffers,
+                    stream_statistics.d_buffer_underruns, stream_statistics.d_resend_requests);
+        }
+        
+        // Report lost frames
+        if(i_dropped > 0)
+        {
+            mexWarnMsgIdAndTxt("baslerDriver:Warning:FramesDropped",
+                    "%d frame(s) were dropped during capture.", i_dropped);
         }
-
-        // Close camera
-        camera.Close();
         
         // Remove singleton dimensions
         mexCallMATLAB(1,plhs,1,&mxa_output,"squeeze");
+        if(p_metadata != NULL)
+        {
+            plhs[1] = BaslerHelper::metadata_to_struct(metadata);
+        }
+        if(nlhs >= 3)
+        {
+            plhs[2] = BaslerHelper::latency_to_struct(latency);
+        }
+        if(nlhs >= 4)
+        {
+            plhs[3] = BaslerHelper::stream_statistics_to_struct(stream_statistics);
+        }
+        if(nlhs >= 5)
+        {
+            plhs[4] = telemetry.to_struct();
+        }
     }
     catch (GenICam::GenericException &e)
     {
@@ -1,3 +1,4 @@
+function varargout = baslerGetData(cameraIndex, varargin)
 % baslerGetData.m - Capture any number of frames from a Basler camera
 %
 %  Captures and returns a number of frames from the selected Basler camera.
@@ -17,10 +18,155 @@
 %  The optional parameter verbose (default=0) enables the output of
 %  internal information to the workspace.
 %
+%  The frames are retrieved from the camera in one thread and converted
+%  in nWorkers further threads. The default is one thread per CPU core
+%  but one, nWorkers = 0 converts the frames in the retrieving thread.
+%  A warning is issued if frames were dropped during capture.
+%
+%  Further settings of the capture are given in options, a struct or
+%  name/value pairs after nWorkers, e.g.
+%    frames = baslerGetData(cameraIndex, 100, 'Mono8', 0, [], 'Transposed', 1);
+%  Unknown names are an error. The options are:
+%
+%  With Transposed = 1, the frames are returned as width x height x
+%  nFrames and the camera writes them directly into the returned array,
+%  without any copy or Pylon grab buffers. This needs an unpacked mono
+%  outputType (e.g. Mono8 or Mono16) equal to PixelFormat and no chunk
+%  data. Use permute(frames, [2 1 3]) to get height x width frames, or
+%  process the transposed frames directly. The frames are not converted,
+%  so nWorkers cannot be given; Trigger and its timeout apply as usual.
+%
+%  Bayer frames (8, 10 and 12 bit, unpacked) and mono frames are
+%  converted to RGB8packed/RGB8planar/BGR8packed or, from more than 8
+%  bits, RGB16packed/RGB16planar by native kernels, which write straight
+%  into the returned array, if Demosaic selects them: 'bilinear' or
+%  'gradient' (gradient-corrected, sharper edges, slower). With 'pylon',
+%  the Pylon converter is always used, e.g. to compare the speed with
+%  verbose = 1 on a synthetic source. Without Demosaic, Bayer and mono
+%  frames are converted to RGB by the Pylon converter and packed frames
+%  are unpacked natively. Other formats use the Pylon converter.
+%
+%  Packed 10 and 12 bit formats (Mono10p, Mono12p, Mono10packed,
+%  Mono12packed, Bayer 10p, 12p and 12Packed) are unpacked natively in
+%  the same pass as the copy. Without outputType, or with the unpacked
+%  format (e.g. Mono12 for Mono12p), the values are returned as they are;
+%  with Mono16 or RGB16, they are shifted to the most significant bits.
+%
+%  With Crop, only windows of the frames are copied, e.g. to feed several
+%  analysis windows from one full-sensor capture without reprogramming the
+%  sensor ROI. Crop is a struct with the fields
+%    - ROI: one row [xOffset, yOffset, width, height] per window, in
+%      pixels of the frame like baslerSetROI
+%    - Factor (default=1): each Factor x Factor block of a window becomes
+%      one pixel
+%    - Mode (default='decimate'): 'decimate' keeps the top left pixel of
+%      each block, 'average' the rounded mean (same class as the frames)
+%      and 'sum' the sum (double)
+%  A single window is returned as array, several as a 1 x nWindows cell
+%  array. Note that the blocks of Bayer frames mix the colors. Bayer
+%  frames are converted by the Pylon converter when cropped, e.g.
+%    crop = struct('ROI', [0 0 320 240; 320 240 320 240], ...
+%                  'Factor', 2, 'Mode', 'average');
+%    windows = baslerGetData(cameraIndex, 10, [], 0, [], 'Crop', crop);
+%
+%  With Reduce, the frames are not returned but reduced as they arrive,
+%  so the memory does not grow with nFrames. Reduce is 'mean', 'var'
+%  (sample variance, like var(frames, 0, 4)), 'sum', 'max' or 'min', or a
+%  struct with the fields Mode and DarkFrame. The DarkFrame (double,
+%  height x width x samples) is subtracted from every frame; it does not
+%  change the variance. The result is a height x width x samples double
+%  array. Besides the result, the frames are summed up in one accumulator
+%  and one more for each conversion thread. At most 2 conversion threads
+%  are used, nWorkers above 2 are reduced to 2. An accumulator takes 12
+%  bytes per sample for 'mean' and 'sum', 20 for 'var' and the size of a
+%  sample for 'max' and 'min'. 'var' of 2448 x 2048 Mono12 frames thus
+%  needs up to 3 x 100 MB plus 40 MB for the result, whatever nFrames
+%  is. E.g.
+%    background = baslerGetData(cameraIndex, 500, [], 0, [], 'Reduce', 'mean');
+%    peak = baslerGetData(cameraIndex, 500, [], 0, [], 'Reduce', ...
+%                         struct('Mode', 'max', 'DarkFrame', background));
+%
+%  With Trigger, the camera is armed once for a frame trigger before the
+%  capture and restored afterwards. Trigger is a struct with the fields
+%    - Source: TriggerSource, e.g. 'Software' or 'Line1'. With
+%      'Software', every frame is triggered by the driver as soon as the
+%      camera is ready for it. Empty runs free.
+%    - Activation: TriggerActivation, e.g. 'RisingEdge', empty keeps the
+%      camera's setting
+%    - Timeout (default=5): seconds to wait for each frame
+%    - OnTimeout (default='error'): 'error' aborts, 'skip' counts the
+%      frame as dropped and waits for the next one, 'stop' returns the
+%      frames captured so far (the rest count as dropped)
+%  A synthetic source supports the software trigger only, e.g.
+%    trig = struct('Source', 'Software', 'Timeout', 0.5, 'OnTimeout', 'skip');
+%    frames = baslerGetData(src, 100, [], 0, [], 'Trigger', trig);
+%
+%  The optional output latency holds the latency of every frame from its
+%  software trigger (or, without one, from its arrival) until it is
+%  stored in the returned array, in s, and its median, p90, p99 and max.
+%  verbose = 1 prints them. nWorkers = 0 gives the lowest latency, as the
+%  frames are stored by the thread retrieving them.
+%
+%  The following options tune the grab engine for throughput. The
+%  settings stay on the camera:
+%    - MaxNumBuffer: number of Pylon grab buffers
+%    - PacketSize, InterPacketDelay: GevSCPSPacketSize and GevSCPD of
+%      GigE cameras
+%    - MaxTransferSize, NumMaxQueuedUrbs: transfer settings of the USB
+%      stream grabber
+%    - EnginePriority: priority of Pylon's grab engine thread
+%    - GrabThreadCpu, GrabThreadPriority: retrieve the frames in a
+%      dedicated thread, pinned to a CPU and run at a real-time priority
+%      (1 to 99). Matlab's own thread is left as it is. On Linux, the
+%      priority needs CAP_SYS_NICE or an rtprio limit, else a warning is
+%      issued.
+%  The optional output statistics holds the counters of the stream
+%  grabber after the capture: totalBuffers, failedBuffers,
+%  bufferUnderruns, missedFrames, resendRequests and resendPackets (NaN
+%  where the transport layer does not provide them), e.g.
+%    opts = struct('MaxNumBuffer', 64, 'PacketSize', 8192, 'GrabThreadCpu', 2);
+%
+%  The optional output telemetry times every stage of the capture:
+%  retrieve (waiting for a frame), wait (for a full queue), convert, copy
+%  (transpose, crop or accumulate), compress and save (both only in
+%  baslerSaveData), each with count, total, p50, p99 and max in s, and
+%  queueDepth, droppedFrames and incompleteFrames.
+%  The options Telemetry = 1 prints it with verbose = 1, TraceFile writes
+%  every stage of every thread as Chrome trace-event JSON, to be opened in
+%  chrome://tracing or Perfetto. The first 65536 stages of every thread
+%  are kept, a warning tells if later ones were dropped, e.g.
+%    opts = struct('TraceFile', 'capture.json');
+%
+%  The optional output metadata holds one nFrames x 1 array per field:
+%  timestamps, imageNumbers, blockIds and skippedImages of the grab
+%  results, exposureTimes and frameCounters from the chunk data (NaN and
+%  -1 if chunk mode is off) and succeeded. Use it to detect dropped
+%  frames (gaps in blockIds) and to align frames with other sensors.
+%
+%  Instead of a camera, cameraIndex can be a struct describing a
+%  synthetic source with the fields Width, Height, PixelFormat and the
+%  optional FrameRate (default=0, as fast as possible) and DropEvery
+%  (default=0, every DropEvery-th frame is lost). It generates a moving
+%  test pattern, so the capture can be tested and profiled without a
+%  camera, e.g.
+%    src = struct('Width',640,'Height',480,'PixelFormat','Mono8', ...
+%                 'FrameRate',100,'DropEvery',50);
+%
 %  Usage:
 %    baslerGetData(cameraIndex)
 %    baslerGetData(cameraIndex, nFrames)
 %    baslerGetData(cameraIndex, [], outputType)
 %    baslerGetData(cameraIndex, [], [], verbose)
 %    baslerGetData(cameraIndex, nFrames, outputType, verbose)
+%    baslerGetData(cameraIndex, nFrames, outputType, verbose, nWorkers)
+%    baslerGetData(cameraIndex, nFrames, outputType, verbose, nWorkers, options)
+%    baslerGetData(cameraIndex, nFrames, outputType, verbose, nWorkers, 'Name', value, ...)
+%    [frames, metadata] = baslerGetData(...)
+%    [frames, metadata, latency] = baslerGetData(...)
+%    [frames, metadata, latency, statistics] = baslerGetData(...)
+%    [frames, metadata, latency, statistics, telemetry] = baslerGetData(...)
 %
+
+[varargout{1:max(1,nargout)}] = baslerDriver('GetData', cameraIndex, varargin{:});
+
+end
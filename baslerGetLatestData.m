@@ -0,0 +1,31 @@
+function [frames, info] = baslerGetLatestData(cameraIndex, varargin)
+% baslerGetLatestData.m - Get the newest frames of a continuous grab
+%
+%  Returns the nFrames (default=1) newest frames grabbed since
+%  baslerStartGrabbing, oldest first. The call does not wait for new
+%  frames: fewer frames are returned if the ring buffer does not hold
+%  enough, and an empty array if no frame has arrived yet. The same
+%  frame is returned again if no newer one has arrived in between.
+%
+%  The outputType specifies the desired output type, which the frames
+%  are converted to. When omiting the parameter, the camera's pixel
+%  format is used. See baslerGetData for possible values.
+%
+%  The optional output info contains the image numbers and timestamps of
+%  the returned frames and the number of frames grabbed and dropped since
+%  the start.
+%
+%  The optional parameter verbose (default=0) enables the output of
+%  internal information to the workspace.
+%
+%  Usage:
+%    baslerGetLatestData(cameraIndex)
+%    baslerGetLatestData(cameraIndex, nFrames)
+%    baslerGetLatestData(cameraIndex, nFrames, outputType)
+%    baslerGetLatestData(cameraIndex, nFrames, outputType, verbose)
+%    [frames, info] = baslerGetLatestData(...)
+%
+
+[frames, info] = baslerDriver('GetLatestData', cameraIndex, varargin{:});
+
+end
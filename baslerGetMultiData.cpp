@@ -0,0 +1,440 @@
+// baslerGetMultiData.cpp - Capture frames from several Basler cameras at once
+// see baslerGetMultiData.m for help
+
+#include <pylon/PylonIncludes.h>
+#include "basler_helper/basler_driver.h"
+#include "basler_helper/capture_images.h"
+#include "basler_helper/frame_source.h"
+#include "basler_helper/frame_metadata.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <matrix.h>
+#include <mex.h>
+
+
+namespace {
+
+    //---------------------------------------------------------------------
+    // Whether the camera's clock is synchronized by PTP (IEEE 1588)
+    bool ptp_enabled(BaslerHelper::FrameSource* source)
+    {
+        if(source->camera() == NULL)
+        {
+            return false;
+        }
+        GenApi::INodeMap& nodemap = source->camera()->GetNodeMap();
+        const char* s_names[] = {"PtpEnable", "GevIEEE1588"};
+        for(size_t i = 0; i < 2; i++)
+        {
+            GenApi::CBooleanPtr p_enable = nodemap.GetNode(s_names[i]);
+            if(p_enable.IsValid() && GenApi::IsReadable(p_enable))
+            {
+                return p_enable->GetValue();
+            }
+        }
+        return false;
+    }
+
+    //---------------------------------------------------------------------
+    // Latch the current timestamp of the camera's clock, false if it has
+    // no latch. Synthetic sources share the host clock and latch 0.
+    bool latch_timestamp(BaslerHelper::FrameSource* source, int64_t& i_timestamp)
+    {
+        i_timestamp = 0;
+        if(source->camera() == NULL)
+        {
+            return true;
+        }
+        GenApi::INodeMap& nodemap = source->camera()->GetNodeMap();
+        const char* s_names[][2] = {{"TimestampLatch", "TimestampLatchValue"},
+                                    {"GevTimestampControlLatch", "GevTimestampValue"}};
+        for(size_t i = 0; i < 2; i++)
+        {
+            GenApi::CCommandPtr p_latch = nodemap.GetNode(s_names[i][0]);
+            GenApi::CIntegerPtr p_value = nodemap.GetNode(s_names[i][1]);
+            if(p_latch.IsValid() && p_value.IsValid() && GenApi::IsWritable(p_latch))
+            {
+                p_latch->Execute();
+                i_timestamp = p_value->GetValue();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //---------------------------------------------------------------------
+    // For every frame of the reference, the frame of the other camera with
+    // the nearest timestamp. The timestamps of each camera are taken
+    // relative to its offset. Both are sorted by time, failed frames are
+    // only used if there is no other. The result is non-decreasing.
+    std::vector<size_t> match_timestamps(const BaslerHelper::FrameMetadata& reference,
+                                         const int64_t i_reference_offset,
+                                         const BaslerHelper::FrameMetadata& other,
+                                         const int64_t i_other_offset)
+    {
+        std::vector<size_t> i_order(reference.size(), 0);
+        std::vector<size_t> i_valid;
+        for(size_t j = 0; j < other.size(); j++)
+        {
+            if(other.b_succeeded[j])
+            {
+                i_valid.push_back(j);
+            }
+        }
+        if(i_valid.empty())
+        {
+            for(size_t i = 0; i < i_order.size(); i++)
+            {
+                i_order[i] = std::min(i, other.size() - 1);
+            }
+            return i_order;
+        }
+
+        size_t k = 0;
+        for(size_t i = 0; i < reference.size(); i++)
+        {
+            const int64_t i_time = (int64_t)reference.i_timestamps[i] - i_reference_offset;
+            while(k + 1 < i_valid.size()
+                  && (int64_t)other.i_timestamps[i_valid[k + 1]] - i_other_offset <= i_time)
+            {
+                k++;
+            }
+            size_t j = i_valid[k];
+            if(k + 1 < i_valid.size())
+            {
+                const int64_t i_before = (int64_t)other.i_timestamps[j] - i_other_offset;
+                const int64_t i_after = (int64_t)other.i_timestamps[i_valid[k + 1]] - i_other_offset;
+                if(std::llabs(i_after - i_time) < std::llabs(i_time - i_before))
+                {
+                    j = i_valid[k + 1];
+                }
+            }
+            i_order[i] = j;
+        }
+        return i_order;
+    }
+
+    //---------------------------------------------------------------------
+    // Rearrange the frames of one camera in place, frame i becomes frame
+    // i_order[i]. i_order has to be non-decreasing: frames moving to the
+    // front are copied first, then those moving back in reverse, so that
+    // no frame is overwritten before it is read.
+    void reorder_frames(uint8_t* p_frames, const size_t i_frame_bytes, const std::vector<size_t>& i_order)
+    {
+        for(size_t i = 0; i < i_order.size(); i++)
+        {
+            if(i_order[i] > i)
+            {
+                memcpy(p_frames + i * i_frame_bytes, p_frames + i_order[i] * i_frame_bytes, i_frame_bytes);
+            }
+        }
+        for(size_t i = i_order.size(); i-- > 0; )
+        {
+            if(i_order[i] < i)
+            {
+                memcpy(p_frames + i * i_frame_bytes, p_frames + i_order[i] * i_frame_bytes, i_frame_bytes);
+            }
+        }
+    }
+}
+
+
+void baslerGetMultiData(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    // Parse parameters
+    if(nrhs < 1)
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "Not enough arguments. Use help baslerGetMultiData for further information.");
+    }
+    else if(nrhs > 6)
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "Too many arguments. Use help baslerGetMultiData for further information.");
+    }
+
+    // Get verbose parameter
+    bool b_verbose = 0;
+    if(nrhs >= 4 && mxGetNumberOfElements(prhs[3]) >= 1)
+    {
+        b_verbose = (int)mxGetScalar(prhs[3]) != 0;
+    }
+
+    // Get cameras, a vector of indices or a cell of indices, serial numbers
+    // or synthetic sources
+    std::vector<mxArray*> mxa_cameras;
+    if(mxIsCell(prhs[0]))
+    {
+        for(size_t i = 0; i < mxGetNumberOfElements(prhs[0]); i++)
+        {
+            if(mxGetCell(prhs[0], i) == NULL)
+            {
+                mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                        "Empty camera in the list of cameras.");
+            }
+            mxa_cameras.push_back(mxDuplicateArray(mxGetCell(prhs[0], i)));
+        }
+    }
+    else if(mxIsDouble(prhs[0]))
+    {
+        for(size_t i = 0; i < mxGetNumberOfElements(prhs[0]); i++)
+        {
+            mxa_cameras.push_back(mxCreateDoubleScalar(mxGetPr(prhs[0])[i]));
+        }
+    }
+    if(mxa_cameras.empty())
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "Cameras have to be a vector of indices or a cell.");
+    }
+    const int i_num_of_cameras = (int)mxa_cameras.size();
+
+    // Get number of frames
+    int i_num_of_frames = 1;
+    if(nrhs >= 2 && mxGetNumberOfElements(prhs[1]) >= 1)
+    {
+        i_num_of_frames = (int)mxGetScalar(prhs[1]);
+    }
+    if(i_num_of_frames < 1)
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "nFrames has to be at least 1.");
+    }
+    if(b_verbose)
+    {
+        mexPrintf("Capturing %d frame(s) from %d camera(s)\n", i_num_of_frames, i_num_of_cameras);
+    }
+
+    // Get output type
+    Pylon::EPixelType ept_output_type = Pylon::PixelType_Undefined;
+    if(nrhs >= 3 && !(mxGetM(prhs[2]) == 0 && mxGetN(prhs[2]) == 0))
+    {
+        ept_output_type = Pylon::CPixelTypeMapper().GetPylonPixelTypeByName(mxArrayToString(prhs[2]));
+        if(b_verbose)
+        {
+            mexPrintf("Using output data type \"%s\"\n",mxArrayToString(prhs[2]));
+        }
+    }
+
+    // Get matching of the frames, by order (hardware trigger) or timestamp
+    bool b_match_timestamps = false;
+    if(nrhs >= 5 && !(mxGetM(prhs[4]) == 0 && mxGetN(prhs[4]) == 0))
+    {
+        const std::string s_match_by(mxArrayToString(prhs[4]));
+        if(s_match_by == "timestamp")
+        {
+            b_match_timestamps = true;
+        }
+        else if(s_match_by != "trigger")
+        {
+            mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                    "Unknown matching \"%s\", use 'trigger' or 'timestamp'.", s_match_by.c_str());
+        }
+    }
+
+    // Get number of conversion threads, default: one per core but the ones
+    // retrieving the frames
+    int i_num_of_workers = (int)std::thread::hardware_concurrency() - i_num_of_cameras;
+    if(nrhs >= 6 && mxGetNumberOfElements(prhs[5]) >= 1)
+    {
+        i_num_of_workers = (int)mxGetScalar(prhs[5]);
+    }
+    i_num_of_workers = std::max(0, std::min(i_num_of_workers, 16 * i_num_of_cameras));
+    if(i_num_of_frames < 2)
+    {
+        i_num_of_workers = 0;
+    }
+    if(b_verbose)
+    {
+        mexPrintf("Using %d conversion thread(s) \n",i_num_of_workers);
+    }
+
+    try
+    {
+        // Get cameras, or synthetic sources. All need the same format.
+        std::vector<std::unique_ptr<BaslerHelper::FrameSource> > p_sources;
+        std::vector<BaslerHelper::FrameSource*> sources;
+        for(int i = 0; i < i_num_of_cameras; i++)
+        {
+            p_sources.push_back(BaslerHelper::create_source(mxa_cameras[i], b_verbose));
+            mxDestroyArray(mxa_cameras[i]);
+            sources.push_back(p_sources.back().get());
+            for(int j = 0; j < i; j++)
+            {
+                if(sources[i]->camera() != NULL && sources[i]->camera() == sources[j]->camera())
+                {
+                    throw RUNTIME_EXCEPTION("Camera %d is selected twice.", i + 1);
+                }
+            }
+        }
+        const unsigned long long i_width = sources[0]->width();
+        const unsigned long long i_height = sources[0]->height();
+        const Pylon::EPixelType ept_camera_type = sources[0]->pixel_type();
+        for(int i = 1; i < i_num_of_cameras; i++)
+        {
+            if(sources[i]->width() != i_width || sources[i]->height() != i_height)
+            {
+                throw RUNTIME_EXCEPTION("Camera %d has another image size than camera 1.", i + 1);
+            }
+            if(ept_output_type == Pylon::PixelType_Undefined && sources[i]->pixel_type() != ept_camera_type)
+            {
+                throw RUNTIME_EXCEPTION("Camera %d has another pixel format than camera 1, select an outputType.", i + 1);
+            }
+        }
+        if(ept_output_type == Pylon::PixelType_Undefined)
+        {
+            ept_output_type = ept_camera_type;
+        }
+
+        // Without PTP, the clocks of the cameras run from their own start.
+        // Latch all of them right before the capture, their timestamps are
+        // then compared relative to the latched values.
+        std::vector<int64_t> i_offsets(i_num_of_cameras, 0);
+        bool b_synchronized = true;
+        for(int i = 0; i < i_num_of_cameras; i++)
+        {
+            b_synchronized = b_synchronized && ptp_enabled(sources[i]);
+        }
+        if(!b_synchronized)
+        {
+            for(int i = 0; i < i_num_of_cameras; i++)
+            {
+                if(!latch_timestamp(sources[i], i_offsets[i]) && b_match_timestamps)
+                {
+                    throw RUNTIME_EXCEPTION("Camera %d can neither latch its timestamp nor has PTP enabled, "
+                            "its frames cannot be matched by timestamp.", i + 1);
+                }
+            }
+        }
+        if(b_verbose)
+        {
+            mexPrintf("Comparing timestamps %s\n", b_synchronized ? "of PTP synchronized clocks"
+                                                                  : "relative to the latched clocks");
+        }
+
+        // Create output array and capture from all cameras at once
+        const size_t i_dimensions[] = { i_height,
+                                        i_width,
+                                        Pylon::SamplesPerPixel(ept_output_type),
+                                        (size_t)i_num_of_frames,
+                                        (size_t)i_num_of_cameras};
+        const std::chrono::steady_clock::time_point tp_start = std::chrono::steady_clock::now();
+        mxArray* mxa_output;
+        std::vector<int> i_dropped;
+        std::vector<BaslerHelper::FrameMetadata> metadata;
+        if(Pylon::BitDepth(ept_output_type) <= 8)
+        {
+            mxa_output = mxCreateNumericArray(5, i_dimensions, mxUINT8_CLASS, mxREAL);
+            i_dropped = BaslerHelper::capture_images_multi<uint8_t>(sources, i_num_of_frames, mxa_output,
+                    ept_output_type, i_num_of_workers, b_verbose, metadata);
+        }
+        else if(Pylon::BitDepth(ept_output_type) <= 16)
+        {
+            mxa_output = mxCreateNumericArray(5, i_dimensions, mxUINT16_CLASS, mxREAL);
+            i_dropped = BaslerHelper::capture_images_multi<uint16_t>(sources, i_num_of_frames, mxa_output,
+                    ept_output_type, i_num_of_workers, b_verbose, metadata);
+        }
+        else
+        {
+            mxa_output = mxCreateNumericArray(5, i_dimensions, mxDOUBLE_CLASS, mxREAL);
+            i_dropped = BaslerHelper::capture_images_multi<double>(sources, i_num_of_frames, mxa_output,
+                    ept_output_type, i_num_of_workers, b_verbose, metadata);
+        }
+        const double d_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - tp_start).count();
+        const double d_megabytes = (double)(mxGetNumberOfElements(mxa_output) * mxGetElementSize(mxa_output)) / 1e6;
+
+        // Align the frames of all cameras to those of the first one
+        if(b_match_timestamps)
+        {
+            const size_t i_frame_bytes = mxGetNumberOfElements(mxa_output) * mxGetElementSize(mxa_output)
+                    / (i_num_of_frames * i_num_of_cameras);
+            uint8_t* p_output = static_cast<uint8_t*> (mxGetData(mxa_output));
+            for(int i = 1; i < i_num_of_cameras; i++)
+            {
+                const std::vector<size_t> i_order = match_timestamps(metadata[0], i_offsets[0],
+                                                                     metadata[i], i_offsets[i]);
+                reorder_frames(p_output + i * i_num_of_frames * i_frame_bytes, i_frame_bytes, i_order);
+                metadata[i] = metadata[i].select(i_order);
+            }
+        }
+
+        // Skew of every frame: latest minus earliest timestamp
+        mxArray* mxa_skew = mxCreateNumericMatrix(i_num_of_frames, 1, mxUINT64_CLASS, mxREAL);
+        uint64_t* p_skew = static_cast<uint64_t*> (mxGetData(mxa_skew));
+        uint64_t i_max_skew = 0;
+        for(int i_frame = 0; i_frame < i_num_of_frames; i_frame++)
+        {
+            int64_t i_first = 0, i_last = 0;
+            bool b_any = false;
+            for(int i = 0; i < i_num_of_cameras; i++)
+            {
+                if(!metadata[i].b_succeeded[i_frame])
+                {
+                    continue;
+                }
+                const int64_t i_time = (int64_t)metadata[i].i_timestamps[i_frame] - i_offsets[i];
+                i_first = b_any ? std::min(i_first, i_time) : i_time;
+                i_last = b_any ? std::max(i_last, i_time) : i_time;
+                b_any = true;
+            }
+            p_skew[i_frame] = (uint64_t)(i_last - i_first);
+            i_max_skew = std::max(i_max_skew, p_skew[i_frame]);
+        }
+
+        if(b_verbose)
+        {
+            mexPrintf("Captured %.1f MB in %.3f s (%.1f MB/s), maximum skew %llu ticks\n",
+                    d_megabytes, d_seconds, d_megabytes / d_seconds, (unsigned long long)i_max_skew);
+        }
+
+        // Report lost frames
+        int i_total_dropped = 0;
+        for(int i = 0; i < i_num_of_cameras; i++)
+        {
+            i_total_dropped += i_dropped[i];
+        }
+        if(i_total_dropped > 0)
+        {
+            mexWarnMsgIdAndTxt("baslerDriver:Warning:FramesDropped",
+                    "%d frame(s) were dropped during capture.", i_total_dropped);
+        }
+
+        plhs[0] = mxa_output;
+        if(nlhs >= 2)
+        {
+            const char* s_fields[] = {"skew", "maxSkew", "framesDropped", "megabytesPerSecond", "metadata"};
+            plhs[1] = mxCreateStructMatrix(1, 1, 5, s_fields);
+            mxSetField(plhs[1], 0, "skew", mxa_skew);
+            mxSetField(plhs[1], 0, "maxSkew", mxCreateDoubleScalar((double)i_max_skew));
+            mxArray* mxa_dropped = mxCreateDoubleMatrix(1, i_num_of_cameras, mxREAL);
+            mxArray* mxa_metadata = mxCreateCellMatrix(1, i_num_of_cameras);
+            for(int i = 0; i < i_num_of_cameras; i++)
+            {
+                mxGetPr(mxa_dropped)[i] = i_dropped[i];
+                mxSetCell(mxa_metadata, i, BaslerHelper::metadata_to_struct(metadata[i]));
+            }
+            mxSetField(plhs[1], 0, "framesDropped", mxa_dropped);
+            mxSetField(plhs[1], 0, "megabytesPerSecond", mxCreateDoubleScalar(d_megabytes / d_seconds));
+            mxSetField(plhs[1], 0, "metadata", mxa_metadata);
+        }
+        else
+        {
+            mxDestroyArray(mxa_skew);
+        }
+    }
+    catch (GenICam::GenericException &e)
+    {
+        // Error handling.
+        mexErrMsgIdAndTxt("baslerDriver:Error:CameraError",e.GetDescription());
+    }
+
+    return;
+}
@@ -0,0 +1,53 @@
+function [frames, info] = baslerGetMultiData(cameraIndices, varargin)
+% baslerGetMultiData.m - Capture frames from several Basler cameras at once
+%
+%  Captures nFrames (default=1) frames from all selected cameras at the
+%  same time, each camera in its own grab thread. cameraIndices is a
+%  vector of camera indices, or a cell of indices, serial numbers or
+%  synthetic sources (see baslerGetData). All cameras need the same image
+%  size. The frames are returned as height x width x samples x nFrames x
+%  nCameras. See baslerGetData for the possible values of outputType; by
+%  default the pixel format of the cameras is used, which then has to be
+%  the same for all of them.
+%
+%  matchBy selects how the frames of the cameras are assembled:
+%    - 'trigger'   (default) the n-th frame of every camera belongs
+%                  together, as for cameras on a common hardware trigger
+%    - 'timestamp' every frame of the first camera gets the frame of each
+%                  other camera with the nearest timestamp. If PTP (IEEE
+%                  1588) is enabled on all cameras, their timestamps are
+%                  compared directly. Otherwise the clock of every camera
+%                  is latched right before the capture and the timestamps
+%                  are compared relative to the latched values, which is
+%                  accurate to the time between the latches.
+%
+%  The optional output info contains:
+%    - skew                latest minus earliest timestamp of every frame
+%                          in timestamp ticks of the cameras, compared
+%                          like the timestamps of matchBy 'timestamp'
+%    - maxSkew             maximum of skew
+%    - framesDropped       number of dropped frames of every camera
+%    - megabytesPerSecond  aggregate bandwidth of all cameras
+%    - metadata            per-frame metadata of every camera, see
+%                          baslerGetData
+%
+%  The frames are converted by nWorkers threads, which are shared out
+%  among the cameras. The default is one thread per CPU core but one per
+%  camera.
+%
+%  The optional parameter verbose (default=0) enables the output of
+%  internal information to the workspace.
+%
+%  Usage:
+%    baslerGetMultiData(cameraIndices)
+%    baslerGetMultiData(cameraIndices, nFrames)
+%    baslerGetMultiData(cameraIndices, nFrames, outputType)
+%    baslerGetMultiData(cameraIndices, nFrames, outputType, verbose)
+%    baslerGetMultiData(cameraIndices, nFrames, outputType, verbose, matchBy)
+%    baslerGetMultiData(cameraIndices, nFrames, outputType, verbose, matchBy, nWorkers)
+%    [frames, info] = baslerGetMultiData(...)
+%
+
+[frames, info] = baslerDriver('GetMultiData', cameraIndices, varargin{:});
+
+end
@@ -2,7 +2,9 @@
 // see baslerSetParameter.m for help
 
 #include <pylon/PylonIncludes.h>
-#include "basler_helper/basler_set_get.h"
+#include "basler_helper/basler_driver.h"
+#include "basler_helper/camera_session.h"
+#include "basler_helper/node_cache.h"
 
 #include <matrix.h>
 #include <mex.h>
@@ -17,7 +19,7 @@ enum class ParamType {
     String
 };
     
-void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+void baslerGetParameter(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
 {       
     // Parse parameters
     if(nrhs < 3)
@@ -31,7 +33,6 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
                 "Too many arguments. Use help baslerGetParameter for further information."); 
     }
     
-    const int i_cam_number = (int)mxGetScalar(prhs[0]);
     const std::string s_param_name(mxArrayToString(prhs[1]));
     const std::string s_param_type(mxArrayToString(prhs[2]));
     
@@ -50,36 +51,14 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
 
     }
     
-    // Initiatlize Pylon
-    Pylon::PylonAutoInitTerm auto_init_term;
-    
     try
     {
-        // Get the transport layer factory.
-        Pylon::CTlFactory& tlFactory = Pylon::CTlFactory::GetInstance();
-        
-        // Get all attached devices
-        Pylon::DeviceInfoList_t devices;
-        int i_num_of_cameras = tlFactory.EnumerateDevices(devices);
-        if ( i_num_of_cameras == 0 )
-        {
-            throw RUNTIME_EXCEPTION( "No camera found.");
-        }
-        
-        // Check if camera exists
-        if (i_cam_number > i_num_of_cameras-1 )
-        {
-            throw RUNTIME_EXCEPTION("No camera with this index exists.");
-        }
-        
-        // Create camera object
-        Pylon::CInstantCamera camera(tlFactory.CreateDevice(devices[i_cam_number]));
-        
-        // Open Camera
-        camera.Open();
+        // Get camera, it stays open between calls, as do its node handles
+        BaslerHelper::CameraSession* p_session = BaslerHelper::get_session(prhs[0], b_verbose);
+        BaslerHelper::NodeCache& nodes = *p_session->nodes();
         if(b_verbose)
         {
-            mexPrintf("Using camera \"%s\"\n", camera.GetDeviceInfo().GetModelName().c_str());
+            mexPrintf("Using camera \"%s\"\n", p_session->camera()->GetDeviceInfo().GetModelName().c_str());
         }
         
         // Find type of parameter
@@ -87,32 +66,24 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
         {
             case ParamType::Float:
             {
-                double d_param_value = BaslerHelper::get_float(
-                        &camera,s_param_name.c_str(),b_verbose);
-                plhs[0] = mxCreateDoubleScalar(d_param_value);
+                plhs[0] = mxCreateDoubleScalar(nodes.get_float(s_param_name, b_verbose));
                 break;
-        }
+            }
             case ParamType::Int:
             {
-                int i_param_value = BaslerHelper::get_int(
-                        &camera,s_param_name.c_str(),b_verbose);
                 plhs[0] = mxCreateNumericMatrix(1,1,mxINT64_CLASS,mxREAL);
                 int64_t* p_output = (int64_t*) mxGetData(plhs[0]);
-                p_output[0] = i_param_value;
+                p_output[0] = nodes.get_int(s_param_name, b_verbose);
                 break;
             }
             case ParamType::Bool:
             {
-                bool b_param_value = BaslerHelper::get_bool(
-                        &camera,s_param_name.c_str(),b_verbose);
-                plhs[0] = mxCreateLogicalScalar(b_param_value);
+                plhs[0] = mxCreateLogicalScalar(nodes.get_bool(s_param_name, b_verbose));
                 break;
             }
             case ParamType::String:
             {
-                std::string s_param_value = BaslerHelper::get_string(
-                        &camera,s_param_name.c_str(),b_verbose);
-                plhs[0] = mxCreateString(s_param_value.c_str());
+                plhs[0] = mxCreateString(nodes.get_string(s_param_name, b_verbose).c_str());
                 break;
             }
             default:
@@ -123,9 +94,6 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
             }
         }
         
-        // Close camera
-        camera.Close();
-        
     }
     catch (GenICam::GenericException &e)
     {
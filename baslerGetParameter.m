@@ -1,3 +1,4 @@
+function parameterValue = baslerGetParameter(cameraIndex, varargin)
 % baslerGetParameter.m - Get value of any Basler camera parameter
 %
 %  Gets the parameter specified in 'parameterName' from the camera. The
@@ -19,3 +20,7 @@
 %    baslerGetParameter(0,'Width','Int');
 %    baslerGetParameter(0,'Width','Int', 1);
 %
+
+parameterValue = baslerDriver('GetParameter', cameraIndex, varargin{:});
+
+end
@@ -0,0 +1,28 @@
+function varargout = baslerGetParameters(cameraIndex, varargin)
+% baslerGetParameters.m - Get many Basler camera parameters at once
+%
+%  Returns a struct with one field per parameter in parameterNames. The
+%  data type follows the camera parameter: int64 for integers, double for
+%  floats, logical for booleans and strings for all others. Parameters
+%  which cannot be read are returned as [].
+%
+%  The optional output status is a struct array with the fields name,
+%  success and message for each parameter. Without it, a warning lists
+%  all failed parameters. The optional output time is the wall time of
+%  the call in seconds.
+%
+%  The optional parameter verbose (default=0) enables the output of
+%  internal information to the workspace.
+%
+%  Usage:
+%    values = baslerGetParameters(cameraIndex, parameterNames)
+%    values = baslerGetParameters(cameraIndex, parameterNames, verbose)
+%    [values, status, time] = baslerGetParameters(...)
+%
+%  Examples:
+%    values = baslerGetParameters(0, {'Width','Height','PixelFormat'});
+%
+
+[varargout{1:max(nargout,1)}] = baslerDriver('GetParameters', cameraIndex, varargin{:});
+
+end
@@ -0,0 +1,387 @@
+// baslerGrabbing.cpp - Continuous acquisition in the background
+// see baslerStartGrabbing.m, baslerStopGrabbing.m, baslerGetLatestData.m and baslerAutoExposure.m for help
+
+#include <pylon/PylonIncludes.h>
+#include "basler_helper/basler_driver.h"
+#include "basler_helper/camera_session.h"
+#include "basler_helper/continuous_grab.h"
+#include "basler_helper/exposure_control.h"
+#include "basler_helper/transpose_image.h"
+#include "basler_helper/debayer_image.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <matrix.h>
+#include <mex.h>
+
+
+namespace {
+
+    typedef std::vector<std::shared_ptr<const BaslerHelper::RingFrame> > RingFrames;
+
+    //---------------------------------------------------------------------
+    // Convert the ring buffer frames, if needed, and copy them into the
+    // Matlab array
+    template <typename T>
+    void copy_ring_frames(  const RingFrames& frames,
+                            mxArray* mxa_output,
+                            Pylon::EPixelType ept_output_type)
+    {
+        const unsigned int i_samples_p_pixel = Pylon::SamplesPerPixel(ept_output_type);
+        Pylon::CPylonImage im_target_image;
+        Pylon::CImageFormatConverter py_converter;
+        py_converter.OutputPixelFormat = ept_output_type;
+
+        T* p_output = static_cast<T*> (mxGetData(mxa_output));
+        for(size_t i_c_frame = 0; i_c_frame < frames.size(); i_c_frame++)
+        {
+            const Pylon::CPylonImage& im_frame = frames[i_c_frame]->image;
+            const unsigned long long i_height = im_frame.GetHeight();
+            const unsigned long long i_width = im_frame.GetWidth();
+
+            const T* p_image_buffer;
+            if(BaslerHelper::can_convert_native(im_frame.GetPixelType(), ept_output_type))
+            {
+                BaslerHelper::convert_native(im_frame.GetBuffer(), im_frame.GetPixelType(),
+                        p_output + i_c_frame * i_height * i_width * i_samples_p_pixel, ept_output_type,
+                        i_height, i_width, BaslerHelper::ColorConversion_Bilinear);
+                continue;
+            }
+            else if(im_frame.GetPixelType() != ept_output_type &&
+                    Pylon::CImageFormatConverter::IsSupportedOutputFormat(ept_output_type))
+            {
+                py_converter.Convert(im_target_image, im_frame);
+                p_image_buffer = static_cast<const T*> (im_target_image.GetBuffer());
+            }
+            else
+            {
+                p_image_buffer = static_cast<const T*> (im_frame.GetBuffer());
+            }
+
+            BaslerHelper::transpose_image(p_image_buffer,
+                    p_output + i_c_frame * i_height * i_width * i_samples_p_pixel,
+                    i_height, i_width, i_samples_p_pixel);
+        }
+    }
+}
+
+
+//-------------------------------------------------------------------------
+// Start grabbing into a ring buffer in the background
+void baslerStartGrabbing(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    // Parse parameters
+    if(nrhs < 1)
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "Not enough arguments. Use help baslerStartGrabbing for further information.");
+    }
+    else if(nrhs > 4)
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "Too many arguments. Use help baslerStartGrabbing for further information.");
+    }
+
+    // Get verbose parameter
+    bool b_verbose = 0;
+    if(nrhs >= 4 && mxGetNumberOfElements(prhs[3]) >= 1)
+    {
+        b_verbose = (int)mxGetScalar(prhs[3]) != 0;
+    }
+
+    // Get ring buffer size
+    int i_buffer_size = 16;
+    if(nrhs >= 2 && mxGetNumberOfElements(prhs[1]) >= 1)
+    {
+        i_buffer_size = (int)mxGetScalar(prhs[1]);
+    }
+    if(i_buffer_size < 1)
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "The buffer size has to be at least 1.");
+    }
+
+    // Get grab strategy
+    Pylon::EGrabStrategy egs_strategy = Pylon::GrabStrategy_LatestImageOnly;
+    if(nrhs >= 3 && !mxIsEmpty(prhs[2]))
+    {
+        const std::string s_strategy = mxArrayToString(prhs[2]);
+        if(s_strategy == "UpcomingImage")
+        {
+            egs_strategy = Pylon::GrabStrategy_UpcomingImage;
+        }
+        else if(s_strategy != "LatestImageOnly")
+        {
+            mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                    "Unknown grab strategy \"%s\".", s_strategy.c_str());
+        }
+    }
+
+    try
+    {
+        BaslerHelper::CameraSession* p_session = BaslerHelper::get_session(prhs[0], b_verbose);
+        p_session->start_continuous(i_buffer_size, egs_strategy);
+        if(b_verbose)
+        {
+            mexPrintf("Grabbing into a ring buffer of %d frame(s)\n", i_buffer_size);
+        }
+    }
+    catch (GenICam::GenericException &e)
+    {
+        // Error handling.
+        mexErrMsgIdAndTxt("baslerDriver:Error:CameraError",e.GetDescription());
+    }
+}
+
+//-------------------------------------------------------------------------
+// Stop grabbing in the background
+void baslerStopGrabbing(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    // Parse parameters
+    if(nrhs < 1)
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "Not enough arguments. Use help baslerStopGrabbing for further information.");
+    }
+    else if(nrhs > 2)
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "Too many arguments. Use help baslerStopGrabbing for further information.");
+    }
+
+    // Get verbose parameter
+    bool b_verbose = 0;
+    if(nrhs == 2 && mxGetNumberOfElements(prhs[1]) >= 1)
+    {
+        b_verbose = (int)mxGetScalar(prhs[1]) != 0;
+    }
+
+    try
+    {
+        BaslerHelper::CameraSession* p_session = BaslerHelper::get_session(prhs[0], b_verbose);
+        if(b_verbose && p_session->continuous() != NULL)
+        {
+            mexPrintf("Stopped grabbing after %llu frame(s), %llu dropped\n",
+                    p_session->continuous()->frames_grabbed(),
+                    p_session->continuous()->frames_dropped());
+        }
+        p_session->stop_continuous();
+    }
+    catch (GenICam::GenericException &e)
+    {
+        // Error handling.
+        mexErrMsgIdAndTxt("baslerDriver:Error:CameraError",e.GetDescription());
+    }
+}
+
+//-------------------------------------------------------------------------
+// Return the newest frames of the ring buffer without waiting
+void baslerGetLatestData(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    // Parse parameters
+    if(nrhs < 1)
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "Not enough arguments. Use help baslerGetLatestData for further information.");
+    }
+    else if(nrhs > 4)
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "Too many arguments. Use help baslerGetLatestData for further information.");
+    }
+
+    // Get verbose parameter
+    bool b_verbose = 0;
+    if(nrhs >= 4 && mxGetNumberOfElements(prhs[3]) >= 1)
+    {
+        b_verbose = (int)mxGetScalar(prhs[3]) != 0;
+    }
+
+    // Get number of frames
+    int i_num_of_frames = 1;
+    if(nrhs >= 2 && mxGetNumberOfElements(prhs[1]) >= 1)
+    {
+        i_num_of_frames = (int)mxGetScalar(prhs[1]);
+    }
+    if(i_num_of_frames < 1)
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "The number of frames has to be at least 1.");
+    }
+
+    // Get output type
+    Pylon::EPixelType ept_output_type = Pylon::PixelType_Undefined;
+    if(nrhs >= 3)
+    {
+        if(!(mxGetM(prhs[2]) == 0 && mxGetN(prhs[2]) == 0))
+        {
+            ept_output_type = Pylon::CPixelTypeMapper().GetPylonPixelTypeByName(mxArrayToString(prhs[2]));
+        }
+    }
+
+    try
+    {
+        BaslerHelper::CameraSession* p_session = BaslerHelper::get_session(prhs[0], b_verbose);
+        BaslerHelper::ContinuousGrab* p_continuous = p_session->continuous();
+        if(p_continuous == NULL)
+        {
+            throw RUNTIME_EXCEPTION("Camera is not grabbing, call baslerStartGrabbing first.");
+        }
+
+        // Take the frames out of the ring buffer's reach
+        RingFrames frames = p_continuous->latest(i_num_of_frames);
+        if(b_verbose)
+        {
+            mexPrintf("Got %d of %d frame(s)\n", (int)frames.size(), i_num_of_frames);
+        }
+
+        // Create output array, empty if no frame has arrived yet
+        mxArray* mxa_output;
+        if(frames.empty())
+        {
+            mxa_output = mxCreateNumericMatrix(0, 0, mxUINT8_CLASS, mxREAL);
+        }
+        else
+        {
+            if(ept_output_type == Pylon::PixelType_Undefined)
+            {
+                ept_output_type = frames.back()->image.GetPixelType();
+            }
+            const size_t i_dimensions[] = { frames.back()->image.GetHeight(),
+                                            frames.back()->image.GetWidth(),
+                                            Pylon::SamplesPerPixel(ept_output_type),
+                                            frames.size()};
+            if(Pylon::BitDepth(ept_output_type) <= 8)
+            {
+                mxa_output = mxCreateNumericArray(4, i_dimensions, mxUINT8_CLASS, mxREAL);
+                copy_ring_frames<uint8_t>(frames, mxa_output, ept_output_type);
+            }
+            else if(Pylon::BitDepth(ept_output_type) <= 16)
+            {
+                mxa_output = mxCreateNumericArray(4, i_dimensions, mxUINT16_CLASS, mxREAL);
+                copy_ring_frames<uint16_t>(frames, mxa_output, ept_output_type);
+            }
+            else
+            {
+                mxa_output = mxCreateNumericArray(4, i_dimensions, mxDOUBLE_CLASS, mxREAL);
+                copy_ring_frames<double>(frames, mxa_output, ept_output_type);
+            }
+        }
+
+        // Return frame information
+        if(nlhs >= 2)
+        {
+            mxArray* mxa_image_numbers = mxCreateDoubleMatrix(frames.size(), 1, mxREAL);
+            mxArray* mxa_timestamps = mxCreateNumericMatrix(frames.size(), 1, mxUINT64_CLASS, mxREAL);
+            double* p_image_numbers = mxGetPr(mxa_image_numbers);
+            uint64_t* p_timestamps = (uint64_t*)mxGetData(mxa_timestamps);
+            for(size_t i = 0; i < frames.size(); i++)
+            {
+                p_image_numbers[i] = (double)frames[i]->i_image_number;
+                p_timestamps[i] = frames[i]->i_timestamp;
+            }
+
+            const char* s_fields[] = {"imageNumbers", "timestamps", "framesGrabbed", "framesDropped"};
+            plhs[1] = mxCreateStructMatrix(1, 1, 4, s_fields);
+            mxSetField(plhs[1], 0, "imageNumbers", mxa_image_numbers);
+            mxSetField(plhs[1], 0, "timestamps", mxa_timestamps);
+            mxSetField(plhs[1], 0, "framesGrabbed", mxCreateDoubleScalar((double)p_continuous->frames_grabbed()));
+            mxSetField(plhs[1], 0, "framesDropped", mxCreateDoubleScalar((double)p_continuous->frames_dropped()));
+        }
+
+        // Remove singleton dimensions
+        mexCallMATLAB(1,plhs,1,&mxa_output,"squeeze");
+    }
+    catch (GenICam::GenericException &e)
+    {
+        // Error handling.
+        mexErrMsgIdAndTxt("baslerDriver:Error:CameraError",e.GetDescription());
+    }
+}
+
+//-------------------------------------------------------------------------
+// Attach, replace or detach the exposure controller of a continuous grab
+void baslerAutoExposure(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    // Parse parameters
+    if(nrhs < 1)
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "Not enough arguments. Use help baslerAutoExposure for further information.");
+    }
+    else if(nrhs > 3)
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "Too many arguments. Use help baslerAutoExposure for further information.");
+    }
+
+    // Get verbose parameter
+    bool b_verbose = 0;
+    if(nrhs >= 3 && mxGetNumberOfElements(prhs[2]) >= 1)
+    {
+        b_verbose = (int)mxGetScalar(prhs[2]) != 0;
+    }
+
+    // Get settings, 'off' or [] detaches the controller
+    const bool b_change = nrhs >= 2;
+    const bool b_attach = b_change && mxIsStruct(prhs[1]);
+    BaslerHelper::ExposureSettings settings;
+    if(b_attach)
+    {
+        BaslerHelper::parse_exposure_settings(prhs[1], settings);
+    }
+    else if(b_change && !mxIsEmpty(prhs[1]) && !(mxIsChar(prhs[1]) && std::string(mxArrayToString(prhs[1])) == "off"))
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "settings must be a struct or 'off', see help baslerAutoExposure.");
+    }
+
+    try
+    {
+        BaslerHelper::CameraSession* p_session = BaslerHelper::get_session(prhs[0], b_verbose);
+        BaslerHelper::ContinuousGrab* p_continuous = p_session->continuous();
+        if(p_continuous == NULL)
+        {
+            throw RUNTIME_EXCEPTION("Camera is not grabbing, call baslerStartGrabbing first.");
+        }
+
+        // The controller gets its node handles in this thread
+        if(b_attach)
+        {
+            const Pylon::EPixelType ept_pixel_type = p_session->format()->get(b_verbose).ept_pixel_type;
+            std::unique_ptr<BaslerHelper::ExposureController> p_controller(
+                    new BaslerHelper::ExposureController(*p_session->nodes(), settings, ept_pixel_type, b_verbose));
+            p_continuous->set_exposure_controller(std::move(p_controller));
+        }
+        else if(b_change)
+        {
+            p_continuous->set_exposure_controller(std::unique_ptr<BaslerHelper::ExposureController>());
+            if(b_verbose)
+            {
+                mexPrintf("Auto exposure off\n");
+            }
+        }
+
+        // Return status of the controller
+        BaslerHelper::ExposureStatus status;
+        const bool b_enabled = p_continuous->exposure_status(status);
+        const char* s_fields[] = {"enabled", "frames", "updates", "writes", "brightness",
+                                  "exposureTime", "gain", "updateSeconds"};
+        plhs[0] = mxCreateStructMatrix(1, 1, 8, s_fields);
+        mxSetField(plhs[0], 0, "enabled", mxCreateLogicalScalar(b_enabled));
+        mxSetField(plhs[0], 0, "frames", mxCreateDoubleScalar((double)status.i_frames));
+        mxSetField(plhs[0], 0, "updates", mxCreateDoubleScalar((double)status.i_updates));
+        mxSetField(plhs[0], 0, "writes", mxCreateDoubleScalar((double)status.i_writes));
+        mxSetField(plhs[0], 0, "brightness", mxCreateDoubleScalar(status.d_brightness));
+        mxSetField(plhs[0], 0, "exposureTime", mxCreateDoubleScalar(status.d_exposure));
+        mxSetField(plhs[0], 0, "gain", mxCreateDoubleScalar(status.d_gain));
+        mxSetField(plhs[0], 0, "updateSeconds", mxCreateDoubleScalar(status.d_update_seconds));
+    }
+    catch (GenICam::GenericException &e)
+    {
+        // Error handling.
+        mexErrMsgIdAndTxt("baslerDriver:Error:CameraError",e.GetDescription());
+    }
+}
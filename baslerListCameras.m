@@ -0,0 +1,13 @@
+function open_cams = baslerListCameras()
+% baslerListCameras.m - List all open Basler cameras
+%
+%  Returns a cell array containing the serial number (first column) and
+%  name (second column) of all cameras currently held open by the driver.
+%
+%  Usage:
+%  open_cams = baslerListCameras();
+%
+
+open_cams = baslerDriver('ListCameras');
+
+end
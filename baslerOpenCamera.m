@@ -0,0 +1,33 @@
+function serialNumber = baslerOpenCamera(camera, varargin)
+% baslerOpenCamera.m - Open a Basler camera and keep it open
+%
+%  Opens the camera specified by its index (see baslerFindCameras) or by
+%  its serial number and returns the serial number. The camera stays open
+%  until baslerCloseCamera is called or the driver is cleared, so that
+%  subsequent calls of the driver functions do not have to initialize
+%  Pylon and open the camera again.
+%  All driver functions open the camera on their first call anyway,
+%  baslerOpenCamera only allows to do so in advance.
+%
+%  The optional parameter readPolicy sets where baslerGetParameter reads
+%  values from, it is kept until the camera is closed:
+%    - 'Cached': values known to GenApi are returned without asking the
+%      camera (default)
+%    - 'Polled': values which the camera changes itself (e.g. ExposureTime
+%      during ExposureAuto) are refreshed once their polling time elapsed
+%    - 'Device': every value is read from the camera
+%
+%  The optional parameter verbose (default=0) enables the output of
+%  internal information to the workspace.
+%
+%  Usage:
+%    baslerOpenCamera(cameraIndex)
+%    baslerOpenCamera(serialNumber)
+%    baslerOpenCamera(cameraIndex, verbose)
+%    baslerOpenCamera(cameraIndex, readPolicy)
+%    baslerOpenCamera(cameraIndex, readPolicy, verbose)
+%
+
+serialNumber = baslerDriver('OpenCamera', camera, varargin{:});
+
+end
@@ -0,0 +1,36 @@
+function results = baslerParameterLatency(cameraIndex, varargin)
+% baslerParameterLatency.m - Measure the latency of parameter accesses
+%
+%  Reads every parameter in parameterNames repetitions times (default
+%  1000) and returns the latency of each access. The accesses are timed
+%  three ways: reading with a lookup of the node by name on every call,
+%  reading through the node handle kept by the camera session (as
+%  baslerGetParameter and baslerSetParameter do) with the read policy set
+%  by baslerOpenCamera, and writing the current value back through the
+%  handle. Writable parameters keep their value.
+%
+%  Use the Pylon camera emulator (environment variable PYLON_CAMEMU=1)
+%  to measure the driver's overhead without a transport layer, or a real
+%  camera with the policy 'Device' to include the control channel.
+%
+%  The result is a struct array with the fields name, lookupGet, cachedGet
+%  and cachedSet per parameter. Each holds the latencies (in s) and their
+%  median, p90, p99 and max. cachedSet is [] for read-only parameters.
+%
+%  The optional parameter verbose (default=0) enables the output of
+%  internal information to the workspace.
+%
+%  Usage:
+%    results = baslerParameterLatency(cameraIndex, parameterNames)
+%    results = baslerParameterLatency(cameraIndex, parameterNames, repetitions)
+%    results = baslerParameterLatency(cameraIndex, parameterNames, repetitions, verbose)
+%
+%  Examples:
+%    baslerOpenCamera(0, 'Device');
+%    results = baslerParameterLatency(0, {'ExposureTime','Gain'}, 5000);
+%    [results.cachedGet].median
+%
+
+results = baslerDriver('ParameterLatency', cameraIndex, varargin{:});
+
+end
@@ -0,0 +1,455 @@
+// baslerParameters.cpp - Set or get many Basler camera parameters at once
+// see baslerSetParameters.m, baslerGetParameters.m and baslerParameterLatency.m for help
+
+#include <pylon/PylonIncludes.h>
+#include "basler_helper/basler_driver.h"
+#include "basler_helper/camera_session.h"
+#include "basler_helper/basler_set_get.h"
+#include "basler_helper/node_cache.h"
+#include "basler_helper/latency_histogram.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <matrix.h>
+#include <mex.h>
+
+
+namespace {
+
+    //---------------------------------------------------------------------
+    // Copy a Matlab string and free the copy made by mxArrayToString
+    std::string to_string(const mxArray* mxa_string)
+    {
+        char* s_chars = mxArrayToString(mxa_string);
+        const std::string s_string(s_chars != NULL ? s_chars : "");
+        mxFree(s_chars);
+        return s_string;
+    }
+
+    //---------------------------------------------------------------------
+    // Names of a string or a cell of strings, s_function names the help
+    std::vector<std::string> parameter_names(const mxArray* mxa_names, const char* s_function)
+    {
+        std::vector<std::string> s_param_names;
+        if(mxIsChar(mxa_names))
+        {
+            s_param_names.push_back(to_string(mxa_names));
+        }
+        else if(mxIsCell(mxa_names))
+        {
+            for(size_t i = 0; i < mxGetNumberOfElements(mxa_names); i++)
+            {
+                const mxArray* mxa_name = mxGetCell(mxa_names, i);
+                if(mxa_name == NULL || !mxIsChar(mxa_name))
+                {
+                    mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                            "Parameter names have to be strings. Use help %s for further information.", s_function);
+                }
+                s_param_names.push_back(to_string(mxa_name));
+            }
+        }
+        else
+        {
+            mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                    "Parameter names have to be a cell of strings. Use help %s for further information.", s_function);
+        }
+        return s_param_names;
+    }
+
+    //---------------------------------------------------------------------
+    // Read a Matlab value, its class gives the type of the value
+    BaslerHelper::ParameterValue to_parameter_value(const mxArray* mxa_value)
+    {
+        BaslerHelper::ParameterValue value;
+        if(mxIsChar(mxa_value))
+        {
+            value.e_type = GenApi::intfIString;
+            value.s_value = to_string(mxa_value);
+        }
+        else if(mxIsLogical(mxa_value) && mxGetNumberOfElements(mxa_value) >= 1)
+        {
+            value.e_type = GenApi::intfIBoolean;
+            value.d_value = mxGetLogicals(mxa_value)[0] ? 1 : 0;
+        }
+        else if((mxIsDouble(mxa_value) || mxIsSingle(mxa_value)) && mxGetNumberOfElements(mxa_value) >= 1)
+        {
+            value.e_type = GenApi::intfIFloat;
+            value.d_value = mxGetScalar(mxa_value);
+        }
+        else if(mxIsNumeric(mxa_value) && mxGetNumberOfElements(mxa_value) >= 1)
+        {
+            value.e_type = GenApi::intfIInteger;
+            value.d_value = mxGetScalar(mxa_value);
+            value.i_value = (mxIsClass(mxa_value, "int64") || mxIsClass(mxa_value, "uint64"))
+                    ? *(const int64_t*)mxGetData(mxa_value) : (int64_t)value.d_value;
+        }
+        else
+        {
+            mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                    "Cannot detect type of parameter value. Use help baslerSetParameters for further information.");
+        }
+        return value;
+    }
+
+    //---------------------------------------------------------------------
+    // Struct array with name, success and message of every parameter
+    mxArray* status_to_struct(const std::vector<BaslerHelper::ParameterStatus>& status)
+    {
+        const char* s_fields[] = {"name", "success", "message"};
+        mxArray* mxa_status = mxCreateStructMatrix(status.size(), 1, 3, s_fields);
+        for(size_t i = 0; i < status.size(); i++)
+        {
+            mxSetField(mxa_status, i, "name", mxCreateString(status[i].s_name.c_str()));
+            mxSetField(mxa_status, i, "success", mxCreateLogicalScalar(status[i].b_success));
+            mxSetField(mxa_status, i, "message", mxCreateString(status[i].s_message.c_str()));
+        }
+        return mxa_status;
+    }
+
+    //---------------------------------------------------------------------
+    // Warn about all failed parameters
+    void warn_failed(const std::vector<BaslerHelper::ParameterStatus>& status)
+    {
+        std::string s_failed;
+        for(size_t i = 0; i < status.size(); i++)
+        {
+            if(!status[i].b_success)
+            {
+                s_failed += "\n  " + status[i].s_name + ": " + status[i].s_message;
+            }
+        }
+        if(!s_failed.empty())
+        {
+            mexWarnMsgIdAndTxt("baslerDriver:Warning:ParameterFailed",
+                    "Some parameters failed:%s", s_failed.c_str());
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Write a value read from the same node back, by its type
+    void write_value(GenApi::INode* p_node, const BaslerHelper::ParameterValue& value)
+    {
+        switch(value.e_type)
+        {
+            case GenApi::intfIInteger: GenApi::CIntegerPtr(p_node)->SetValue(value.i_value); break;
+            case GenApi::intfIFloat: GenApi::CFloatPtr(p_node)->SetValue(value.d_value); break;
+            case GenApi::intfIBoolean: GenApi::CBooleanPtr(p_node)->SetValue(value.d_value != 0); break;
+            default: GenApi::CValuePtr(p_node)->FromString(value.s_value.c_str()); break;
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Time i_repetitions calls of an access, in s each
+    template <typename Access>
+    BaslerHelper::LatencyHistogram time_access(const size_t i_repetitions, Access access)
+    {
+        BaslerHelper::LatencyHistogram latency;
+        latency.resize(i_repetitions);
+        for(size_t i = 0; i < i_repetitions; i++)
+        {
+            latency.tp_starts[i] = std::chrono::steady_clock::now();
+            access();
+            latency.stop(i);
+        }
+        return latency;
+    }
+}
+
+
+//-------------------------------------------------------------------------
+// Set all parameters of a struct or a cell of name/value pairs
+void baslerSetParameters(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    // Parse parameters
+    if(nrhs < 2)
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "Not enough arguments. Use help baslerSetParameters for further information.");
+    }
+    else if(nrhs > 3)
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "Too many arguments. Use help baslerSetParameters for further information.");
+    }
+
+    // Get verbose parameter
+    bool b_verbose = 0;
+    if(nrhs == 3 && mxGetNumberOfElements(prhs[2]) >= 1)
+    {
+        b_verbose = (int)mxGetScalar(prhs[2]) != 0;
+    }
+
+    // Get names and values
+    std::vector<std::string> s_param_names;
+    std::vector<BaslerHelper::ParameterValue> new_values;
+    if(mxIsStruct(prhs[1]) && mxGetNumberOfElements(prhs[1]) == 1)
+    {
+        for(int i = 0; i < mxGetNumberOfFields(prhs[1]); i++)
+        {
+            s_param_names.push_back(mxGetFieldNameByNumber(prhs[1], i));
+            new_values.push_back(to_parameter_value(mxGetFieldByNumber(prhs[1], 0, i)));
+        }
+    }
+    else if(mxIsCell(prhs[1]) && mxGetNumberOfElements(prhs[1]) % 2 == 0)
+    {
+        // Name/value pairs, either as n x 2 cell or as one row
+        const size_t i_pairs = mxGetNumberOfElements(prhs[1]) / 2;
+        const bool b_columns = (mxGetN(prhs[1]) == 2 && mxGetM(prhs[1]) == i_pairs);
+        for(size_t i = 0; i < i_pairs; i++)
+        {
+            const mxArray* mxa_name = mxGetCell(prhs[1], b_columns ? i : 2*i);
+            const mxArray* mxa_value = mxGetCell(prhs[1], b_columns ? i + i_pairs : 2*i + 1);
+            if(mxa_name == NULL || !mxIsChar(mxa_name) || mxa_value == NULL)
+            {
+                mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                        "Parameter names have to be strings. Use help baslerSetParameters for further information.");
+            }
+            s_param_names.push_back(to_string(mxa_name));
+            new_values.push_back(to_parameter_value(mxa_value));
+        }
+    }
+    else
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "Parameters have to be a struct or a cell of name/value pairs. Use help baslerSetParameters for further information.");
+    }
+
+    try
+    {
+        const std::chrono::steady_clock::time_point tp_start = std::chrono::steady_clock::now();
+
+        // Get camera, it stays open between calls
+        Pylon::CInstantCamera& camera = *BaslerHelper::get_session(prhs[0], b_verbose)->camera();
+        std::vector<BaslerHelper::ParameterStatus> status =
+                BaslerHelper::set_parameters(&camera, s_param_names, new_values, b_verbose);
+
+        const double d_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - tp_start).count();
+        if(b_verbose)
+        {
+            mexPrintf("Set %d parameter(s) in %.3f s\n", (int)status.size(), d_seconds);
+        }
+
+        // Return status, else report failures
+        if(nlhs >= 1)
+        {
+            plhs[0] = status_to_struct(status);
+        }
+        else
+        {
+            warn_failed(status);
+        }
+        if(nlhs >= 2)
+        {
+            plhs[1] = mxCreateDoubleScalar(d_seconds);
+        }
+    }
+    catch (GenICam::GenericException &e)
+    {
+        // Error handling.
+        mexErrMsgIdAndTxt("baslerDriver:Error:CameraError",e.GetDescription());
+    }
+}
+
+//-------------------------------------------------------------------------
+// Get all parameters of a cell of names
+void baslerGetParameters(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    // Parse parameters
+    if(nrhs < 2)
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "Not enough arguments. Use help baslerGetParameters for further information.");
+    }
+    else if(nrhs > 3)
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "Too many arguments. Use help baslerGetParameters for further information.");
+    }
+
+    // Get verbose parameter
+    bool b_verbose = 0;
+    if(nrhs == 3 && mxGetNumberOfElements(prhs[2]) >= 1)
+    {
+        b_verbose = (int)mxGetScalar(prhs[2]) != 0;
+    }
+
+    // Get names
+    const std::vector<std::string> s_param_names = parameter_names(prhs[1], "baslerGetParameters");
+
+    try
+    {
+        const std::chrono::steady_clock::time_point tp_start = std::chrono::steady_clock::now();
+
+        // Get camera, it stays open between calls
+        Pylon::CInstantCamera& camera = *BaslerHelper::get_session(prhs[0], b_verbose)->camera();
+        std::vector<BaslerHelper::ParameterValue> values;
+        std::vector<BaslerHelper::ParameterStatus> status =
+                BaslerHelper::get_parameters(&camera, s_param_names, values, b_verbose);
+
+        const double d_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - tp_start).count();
+
+        // Struct with one field per parameter, empty if it failed
+        std::vector<const char*> s_fields(s_param_names.size());
+        for(size_t i = 0; i < s_param_names.size(); i++)
+        {
+            s_fields[i] = s_param_names[i].c_str();
+        }
+        plhs[0] = mxCreateStructMatrix(1, 1, (int)s_fields.size(), s_fields.empty() ? NULL : &s_fields[0]);
+        for(size_t i = 0; i < values.size(); i++)
+        {
+            mxArray* mxa_value;
+            if(!status[i].b_success)
+            {
+                mxa_value = mxCreateDoubleMatrix(0, 0, mxREAL);
+            }
+            else if(values[i].e_type == GenApi::intfIInteger)
+            {
+                mxa_value = mxCreateNumericMatrix(1, 1, mxINT64_CLASS, mxREAL);
+                *(int64_t*)mxGetData(mxa_value) = values[i].i_value;
+            }
+            else if(values[i].e_type == GenApi::intfIFloat)
+            {
+                mxa_value = mxCreateDoubleScalar(values[i].d_value);
+            }
+            else if(values[i].e_type == GenApi::intfIBoolean)
+            {
+                mxa_value = mxCreateLogicalScalar(values[i].d_value != 0);
+            }
+            else
+            {
+                mxa_value = mxCreateString(values[i].s_value.c_str());
+            }
+            mxSetField(plhs[0], 0, s_fields[i], mxa_value);
+        }
+
+        // Return status, else report failures
+        if(nlhs >= 2)
+        {
+            plhs[1] = status_to_struct(status);
+        }
+        else
+        {
+            warn_failed(status);
+        }
+        if(nlhs >= 3)
+        {
+            plhs[2] = mxCreateDoubleScalar(d_seconds);
+        }
+    }
+    catch (GenICam::GenericException &e)
+    {
+        // Error handling.
+        mexErrMsgIdAndTxt("baslerDriver:Error:CameraError",e.GetDescription());
+    }
+}
+
+//-------------------------------------------------------------------------
+// Measure get and set latency of parameters, with and without node lookup
+void baslerParameterLatency(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    // Parse parameters
+    if(nrhs < 2)
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "Not enough arguments. Use help baslerParameterLatency for further information.");
+    }
+    else if(nrhs > 4)
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "Too many arguments. Use help baslerParameterLatency for further information.");
+    }
+
+    // Get names
+    const std::vector<std::string> s_param_names = parameter_names(prhs[1], "baslerParameterLatency");
+
+    // Get number of repetitions
+    size_t i_repetitions = 1000;
+    if(nrhs >= 3 && !mxIsEmpty(prhs[2]))
+    {
+        const double d_repetitions = mxGetScalar(prhs[2]);
+        if(d_repetitions < 1)
+        {
+            mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                    "The number of repetitions has to be positive. Use help baslerParameterLatency for further information.");
+        }
+        i_repetitions = (size_t)d_repetitions;
+    }
+
+    // Get verbose parameter
+    bool b_verbose = 0;
+    if(nrhs == 4 && mxGetNumberOfElements(prhs[3]) >= 1)
+    {
+        b_verbose = (int)mxGetScalar(prhs[3]) != 0;
+    }
+
+    try
+    {
+        // Get camera and its node handles
+        BaslerHelper::CameraSession* p_session = BaslerHelper::get_session(prhs[0], b_verbose);
+        GenApi::INodeMap& nodemap = p_session->camera()->GetNodeMap();
+        BaslerHelper::NodeCache& nodes = *p_session->nodes();
+        if(b_verbose)
+        {
+            mexPrintf("Timing %d access(es) per parameter, read policy %s\n", (int)i_repetitions,
+                    BaslerHelper::read_policy_name(nodes.read_policy()));
+        }
+
+        const char* s_fields[] = {"name", "lookupGet", "cachedGet", "cachedSet"};
+        plhs[0] = mxCreateStructMatrix(s_param_names.size(), 1, 4, s_fields);
+        for(size_t i = 0; i < s_param_names.size(); i++)
+        {
+            const std::string& s_name = s_param_names[i];
+            GenApi::INode* p_node = nodes.node(s_name);
+            if(!IsReadable(p_node))
+            {
+                throw RUNTIME_EXCEPTION("Parameter \"%s\" not readable.", s_name.c_str());
+            }
+
+            // Read as the single parameter functions did, looking the
+            // node up by name each time
+            const BaslerHelper::LatencyHistogram lookup_get = time_access(i_repetitions, [&]()
+            {
+                BaslerHelper::get_value(nodemap.GetNode(s_name.c_str()));
+            });
+
+            // Read through the cached handle, following the read policy
+            const BaslerHelper::LatencyHistogram cached_get = time_access(i_repetitions, [&]()
+            {
+                nodes.prepare_read(p_node);
+                BaslerHelper::get_value(p_node);
+            });
+
+            // Write the current value back, the camera keeps its setting
+            mxArray* mxa_set;
+            if(IsWritable(p_node))
+            {
+                const BaslerHelper::ParameterValue value = BaslerHelper::get_value(p_node);
+                mxa_set = BaslerHelper::latency_to_struct(time_access(i_repetitions, [&]()
+                {
+                    write_value(p_node, value);
+                }));
+            }
+            else
+            {
+                mxa_set = mxCreateDoubleMatrix(0, 0, mxREAL);
+            }
+
+            mxSetField(plhs[0], i, "name", mxCreateString(s_name.c_str()));
+            mxSetField(plhs[0], i, "lookupGet", BaslerHelper::latency_to_struct(lookup_get));
+            mxSetField(plhs[0], i, "cachedGet", BaslerHelper::latency_to_struct(cached_get));
+            mxSetField(plhs[0], i, "cachedSet", mxa_set);
+            if(b_verbose)
+            {
+                mexPrintf("%s: get %.2f us by name, %.2f us cached (median)\n", s_name.c_str(),
+                        lookup_get.percentile(50) * 1e6, cached_get.percentile(50) * 1e6);
+            }
+        }
+    }
+    catch (GenICam::GenericException &e)
+    {
+        // Error handling.
+        mexErrMsgIdAndTxt("baslerDriver:Error:CameraError",e.GetDescription());
+    }
+}
@@ -3,7 +3,9 @@ function baslerPreview( cameraIndex  )
 % camera
 %
 %  Creates a new Video preview window that displays live video data from 
-%  the selected Basler camera
+%  the selected Basler camera. The camera grabs continuously in the
+%  background while the window is open, the preview shows the newest
+%  frame whenever the figure is redrawn.
 %
 %  Usage:
 %  baslerPreview(cameraIndex)
@@ -15,17 +17,30 @@ set(fig,'NumberTitle','off')
 set(fig,'Name','Basler Preview Window');
 set(fig,'Visible','on');
 
+% Grab in the background, stop when leaving this function
+baslerStartGrabbing(cameraIndex, 2);
+cleanup = onCleanup(@() baslerStopGrabbing(cameraIndex));
+
 % Get preview data until window is closed
+img = [];
+lastImage = -1;
 while ishandle(fig)
     
-    % Get video and preview
-    imagesc(baslerGetData(cameraIndex,1,'RGB8packed'));
-    axis off;
-    pause(0.1);
+    % Show newest frame, if there is one
+    [frame, info] = baslerGetLatestData(cameraIndex, 1, 'RGB8packed');
+    if ~isempty(frame) && info.imageNumbers(end) ~= lastImage
+        lastImage = info.imageNumbers(end);
+        if isempty(img) || ~ishandle(img)
+            img = imagesc(frame);
+            axis off;
+        else
+            set(img, 'CData', frame);
+        end
+    end
+    drawnow limitrate;
+    pause(0.01);
     
 end
 
 
 end
-
-
@@ -0,0 +1,33 @@
+function metadata = baslerReadMetadata(fileName)
+% baslerReadMetadata.m - Read the frame metadata written by baslerSaveData
+%
+%  Reads a .bmeta file written by baslerSaveData next to the saved frames
+%  and returns the same struct as the metadata output of baslerGetData:
+%  one nFrames x 1 array per field, in the order the frames were saved.
+%
+%  Usage:
+%    metadata = baslerReadMetadata(fileName)
+%
+
+fid = fopen(fileName, 'r', 'ieee-le');
+if fid < 0
+    error('baslerDriver:Error:FileError', 'Cannot open file %s.', fileName);
+end
+cleanup = onCleanup(@() fclose(fid));
+
+magic = fread(fid, [1 8], '*char');
+if ~strcmp(magic, 'BSLMETA1')
+    error('baslerDriver:Error:FileError', '%s is no frame metadata file.', fileName);
+end
+n = double(fread(fid, 1, '*uint64'));
+
+% Columns in file order
+metadata.timestamps    = fread(fid, [n 1], '*uint64');
+metadata.imageNumbers  = fread(fid, [n 1], '*int64');
+metadata.blockIds      = fread(fid, [n 1], '*uint64');
+metadata.skippedImages = fread(fid, [n 1], '*int64');
+metadata.exposureTimes = fread(fid, [n 1], 'double');
+metadata.frameCounters = fread(fid, [n 1], '*int64');
+metadata.succeeded     = logical(fread(fid, [n 1], 'uint8'));
+
+end
@@ -0,0 +1,402 @@
+// baslerReadRaw.cpp - Read frames from a raw or compressed stream file written by baslerSaveData
+// see baslerReadRaw.m for help
+
+#include <pylon/PylonIncludes.h>
+#include "basler_helper/basler_driver.h"
+#include "basler_helper/raw_stream.h"
+#include "basler_helper/compressed_stream.h"
+#include "basler_helper/transpose_image.h"
+#include "basler_helper/unpack_image.h"
+
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <matrix.h>
+#include <mex.h>
+
+
+namespace {
+
+    //---------------------------------------------------------------------
+    // Copy the selected frames into the Matlab array
+    template <typename T>
+    void read_frames(   const char* p_data,
+                        const BaslerHelper::RawStreamHeader& header,
+                        const std::vector<uint64_t>& i_frames,
+                        mxArray* mxa_output)
+    {
+        const unsigned int i_bands = Pylon::SamplesPerPixel((Pylon::EPixelType)header.i_pixel_type);
+        const size_t i_numel = (size_t)header.i_width * header.i_height * i_bands;
+        T* p_output = (T*)mxGetData(mxa_output);
+        for(size_t i_c_frame = 0; i_c_frame < i_frames.size(); i_c_frame++)
+        {
+            const T* p_frame = (const T*)(p_data + header.i_data_offset + i_frames[i_c_frame] * header.i_frame_stride);
+            BaslerHelper::transpose_image(p_frame, p_output + i_c_frame * i_numel,
+                    header.i_height, header.i_width, i_bands);
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Unpack the selected frames of a packed format into the Matlab array
+    void unpack_frames( const char* p_data,
+                        const BaslerHelper::RawStreamHeader& header,
+                        const std::vector<uint64_t>& i_frames,
+                        mxArray* mxa_output)
+    {
+        const size_t i_numel = (size_t)header.i_width * header.i_height;
+        uint16_t* p_output = (uint16_t*)mxGetData(mxa_output);
+        for(size_t i_c_frame = 0; i_c_frame < i_frames.size(); i_c_frame++)
+        {
+            BaslerHelper::unpack_image(p_data + header.i_data_offset + i_frames[i_c_frame] * header.i_frame_stride,
+                    (Pylon::EPixelType)header.i_pixel_type, p_output + i_c_frame * i_numel,
+                    header.i_height, header.i_width, 0);
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Decompress the selected frames into the Matlab array, the frames are
+    // decoded in parallel
+    template <typename T>
+    void decode_frames( const char* p_data,
+                        const BaslerHelper::CompressedStreamHeader& header,
+                        const BaslerHelper::CompressedStreamIndexEntry* p_index,
+                        const std::vector<uint64_t>& i_frames,
+                        mxArray* mxa_output)
+    {
+        const unsigned int i_bands = header.i_samples_per_row / header.i_width;
+        const size_t i_numel = (size_t)header.i_width * header.i_height * i_bands;
+        T* p_output = (T*)mxGetData(mxa_output);
+
+        const size_t i_num_of_threads = std::max<size_t>(1,
+                std::min<size_t>(std::thread::hardware_concurrency(), i_frames.size()));
+        std::atomic<size_t> i_next_frame(0);
+        std::vector<std::exception_ptr> errors(i_num_of_threads);
+        std::vector<std::thread> threads;
+        for(size_t i_thread = 0; i_thread < i_num_of_threads; i_thread++)
+        {
+            threads.push_back(std::thread([&, i_thread]()
+            {
+                try
+                {
+                    std::vector<T> frame((size_t)(header.i_frame_bytes / sizeof(T)));
+                    for(size_t i_c_frame = i_next_frame++; i_c_frame < i_frames.size(); i_c_frame = i_next_frame++)
+                    {
+                        const BaslerHelper::CompressedStreamIndexEntry& entry = p_index[i_frames[i_c_frame]];
+                        BaslerHelper::decode_frame(header, (const uint8_t*)p_data + entry.i_offset, entry.i_size, &frame[0]);
+                        BaslerHelper::transpose_image(&frame[0], p_output + i_c_frame * i_numel,
+                                header.i_height, header.i_width, i_bands);
+                    }
+                }
+                catch (...)
+                {
+                    errors[i_thread] = std::current_exception();
+                }
+            }));
+        }
+        for(size_t i = 0; i < threads.size(); i++)
+        {
+            threads[i].join();
+        }
+        for(size_t i = 0; i < errors.size(); i++)
+        {
+            if(errors[i])
+            {
+                std::rethrow_exception(errors[i]);
+            }
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Frames to read, 1-based, default all
+    std::vector<uint64_t> frame_numbers(int nrhs, const mxArray *prhs[], const uint64_t i_frame_count)
+    {
+        std::vector<uint64_t> i_frames;
+        if(nrhs >= 2 && !mxIsEmpty(prhs[1]))
+        {
+            if(!mxIsDouble(prhs[1]))
+            {
+                throw RUNTIME_EXCEPTION("The frame numbers have to be doubles.");
+            }
+            const double* p_numbers = mxGetPr(prhs[1]);
+            for(size_t i = 0; i < mxGetNumberOfElements(prhs[1]); i++)
+            {
+                if(p_numbers[i] < 1 || p_numbers[i] > (double)i_frame_count || p_numbers[i] != (double)(uint64_t)p_numbers[i])
+                {
+                    throw RUNTIME_EXCEPTION("Frame number %g is out of range, the file holds %llu frame(s).",
+                            p_numbers[i], (unsigned long long)i_frame_count);
+                }
+                i_frames.push_back((uint64_t)p_numbers[i] - 1);
+            }
+        }
+        else
+        {
+            for(uint64_t i = 0; i < i_frame_count; i++)
+            {
+                i_frames.push_back(i);
+            }
+        }
+        return i_frames;
+    }
+
+    //---------------------------------------------------------------------
+    // Info struct with the index entries of the selected frames
+    template <typename IndexEntry>
+    mxArray* frame_info(const char* s_pixel_format,
+                        const uint64_t i_frame_count,
+                        const IndexEntry* p_index,
+                        const std::vector<uint64_t>& i_frames)
+    {
+        mxArray* mxa_timestamps = mxCreateNumericMatrix(i_frames.size(), 1, mxUINT64_CLASS, mxREAL);
+        mxArray* mxa_image_numbers = mxCreateNumericMatrix(i_frames.size(), 1, mxINT64_CLASS, mxREAL);
+        uint64_t* p_timestamps = (uint64_t*)mxGetData(mxa_timestamps);
+        int64_t* p_image_numbers = (int64_t*)mxGetData(mxa_image_numbers);
+        for(size_t i = 0; i < i_frames.size(); i++)
+        {
+            p_timestamps[i] = p_index[i_frames[i]].i_timestamp;
+            p_image_numbers[i] = p_index[i_frames[i]].i_image_number;
+        }
+
+        const char* s_fields[] = {"pixelFormat", "frameCount", "timestamps", "imageNumbers"};
+        mxArray* mxa_info = mxCreateStructMatrix(1, 1, 4, s_fields);
+        mxSetField(mxa_info, 0, "pixelFormat", mxCreateString(s_pixel_format));
+        mxSetField(mxa_info, 0, "frameCount", mxCreateDoubleScalar((double)i_frame_count));
+        mxSetField(mxa_info, 0, "timestamps", mxa_timestamps);
+        mxSetField(mxa_info, 0, "imageNumbers", mxa_image_numbers);
+        return mxa_info;
+    }
+
+    //---------------------------------------------------------------------
+    // Read a compressed stream file
+    mxArray* read_compressed(   const char* p_data,
+                                const size_t i_file_size,
+                                const std::string& s_filename,
+                                int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[],
+                                const bool b_verbose)
+    {
+        BaslerHelper::CompressedStreamHeader header;
+        memcpy(&header, p_data, sizeof(header));
+        if(header.i_version != BaslerHelper::COMPRESSED_STREAM_VERSION)
+        {
+            throw RUNTIME_EXCEPTION("Compressed stream version %u is not supported.", header.i_version);
+        }
+        // Divide instead of multiplying the frame count, so that a damaged
+        // header cannot overflow the checks. Every decoded frame has to
+        // fill exactly one slice of the output array.
+        if(header.i_index_offset < header.i_header_size || header.i_index_offset > i_file_size
+                || header.i_frame_count > (i_file_size - header.i_index_offset) / sizeof(BaslerHelper::CompressedStreamIndexEntry)
+                || header.i_width == 0 || header.i_height == 0 || header.i_samples_per_row == 0
+                || header.i_samples_per_row % header.i_width != 0 || header.i_block_rows == 0
+                || (header.i_bits_per_sample != 8 && header.i_bits_per_sample != 16)
+                || header.i_frame_bytes != (uint64_t)header.i_height * header.i_samples_per_row * (header.i_bits_per_sample / 8))
+        {
+            throw RUNTIME_EXCEPTION("Compressed stream file %s is truncated or damaged.", s_filename.c_str());
+        }
+        const BaslerHelper::CompressedStreamIndexEntry* p_index =
+                (const BaslerHelper::CompressedStreamIndexEntry*)(p_data + header.i_index_offset);
+        if(b_verbose)
+        {
+            mexPrintf("%s: %llu compressed frame(s) of %ux%u %s\n", s_filename.c_str(),
+                    (unsigned long long)header.i_frame_count, header.i_width, header.i_height, header.s_pixel_format);
+        }
+
+        const std::vector<uint64_t> i_frames = frame_numbers(nrhs, prhs, header.i_frame_count);
+        for(size_t i = 0; i < i_frames.size(); i++)
+        {
+            const BaslerHelper::CompressedStreamIndexEntry& entry = p_index[i_frames[i]];
+            if(entry.i_size == 0 || entry.i_offset < header.i_header_size || entry.i_offset > header.i_index_offset
+                    || entry.i_size > header.i_index_offset - entry.i_offset)
+            {
+                throw RUNTIME_EXCEPTION("Frame %llu is missing in %s.", (unsigned long long)i_frames[i] + 1, s_filename.c_str());
+            }
+        }
+
+        // Create output array and decompress frames
+        const size_t i_dimensions[] = { header.i_height,
+                                        header.i_width,
+                                        header.i_samples_per_row / header.i_width,
+                                        i_frames.size()};
+        mxArray* mxa_output;
+        if(header.i_bits_per_sample == 8)
+        {
+            mxa_output = mxCreateNumericArray(4, i_dimensions, mxUINT8_CLASS, mxREAL);
+            decode_frames<uint8_t>(p_data, header, p_index, i_frames, mxa_output);
+        }
+        else
+        {
+            mxa_output = mxCreateNumericArray(4, i_dimensions, mxUINT16_CLASS, mxREAL);
+            decode_frames<uint16_t>(p_data, header, p_index, i_frames, mxa_output);
+        }
+
+        if(nlhs >= 2)
+        {
+            plhs[1] = frame_info(header.s_pixel_format, header.i_frame_count, p_index, i_frames);
+        }
+        return mxa_output;
+    }
+}
+
+
+void baslerReadRaw(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    // Parse parameters
+    if(nrhs < 1)
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "Not enough arguments. Use help baslerReadRaw for further information.");
+    }
+    else if(nrhs > 3)
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "Too many arguments. Use help baslerReadRaw for further information.");
+    }
+    if(!mxIsChar(prhs[0]))
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "The file name has to be a string.");
+    }
+    const std::string s_filename = mxArrayToString(prhs[0]);
+
+    // Get verbose parameter
+    bool b_verbose = 0;
+    if(nrhs >= 3 && mxGetNumberOfElements(prhs[2]) >= 1)
+    {
+        b_verbose = (int)mxGetScalar(prhs[2]) != 0;
+    }
+
+    try
+    {
+        // An empty file cannot be mapped, one shorter than a header is no
+        // stream file
+        const uintmax_t i_disk_size = boost::filesystem::file_size(s_filename);
+        if(i_disk_size < std::min(sizeof(BaslerHelper::RawStreamHeader), sizeof(BaslerHelper::CompressedStreamHeader)))
+        {
+            throw RUNTIME_EXCEPTION("%s is not a raw stream file.", s_filename.c_str());
+        }
+
+        // Map the whole file, the pages are loaded on access
+        boost::interprocess::file_mapping bif_file(s_filename.c_str(), boost::interprocess::read_only);
+        boost::interprocess::mapped_region bir_region(bif_file, boost::interprocess::read_only);
+        const char* p_data = static_cast<const char*>(bir_region.get_address());
+        const size_t i_file_size = bir_region.get_size();
+
+        // Check header
+        BaslerHelper::RawStreamHeader header;
+        if(i_file_size >= sizeof(BaslerHelper::CompressedStreamHeader)
+                && memcmp(p_data, BaslerHelper::COMPRESSED_STREAM_MAGIC, sizeof(BaslerHelper::COMPRESSED_STREAM_MAGIC)) == 0)
+        {
+            mxArray* mxa_output = read_compressed(p_data, i_file_size, s_filename, nlhs, plhs, nrhs, prhs, b_verbose);
+            mexCallMATLAB(1,plhs,1,&mxa_output,"squeeze");
+            return;
+        }
+        if(i_file_size < sizeof(header))
+        {
+            throw RUNTIME_EXCEPTION("%s is not a raw stream file.", s_filename.c_str());
+        }
+        memcpy(&header, p_data, sizeof(header));
+        if(memcmp(header.s_magic, BaslerHelper::RAW_STREAM_MAGIC, sizeof(header.s_magic)) != 0)
+        {
+            throw RUNTIME_EXCEPTION("%s is not a raw stream file.", s_filename.c_str());
+        }
+        if(header.i_version != BaslerHelper::RAW_STREAM_VERSION)
+        {
+            throw RUNTIME_EXCEPTION("Raw stream version %u is not supported.", header.i_version);
+        }
+        // Divide instead of multiplying the frame count, so that a damaged
+        // header cannot overflow the checks
+        if(header.i_index_offset < sizeof(header) || header.i_data_offset < header.i_index_offset
+                || header.i_data_offset > i_file_size
+                || header.i_frame_count > (header.i_data_offset - header.i_index_offset) / sizeof(BaslerHelper::RawStreamIndexEntry)
+                || (header.i_frame_count > 0 && (header.i_frame_stride == 0
+                    || header.i_frame_count > (i_file_size - header.i_data_offset) / header.i_frame_stride)))
+        {
+            throw RUNTIME_EXCEPTION("Raw stream file %s is truncated.", s_filename.c_str());
+        }
+        if(b_verbose)
+        {
+            mexPrintf("%s: %llu frame(s) of %ux%u %s\n", s_filename.c_str(),
+                    (unsigned long long)header.i_frame_count, header.i_width, header.i_height, header.s_pixel_format);
+        }
+
+        // Only formats with whole bytes per sample can be copied, packed
+        // 10 and 12 bit formats are unpacked
+        const Pylon::EPixelType ept_pixel_type = (Pylon::EPixelType)header.i_pixel_type;
+        const unsigned int i_bands = Pylon::SamplesPerPixel(ept_pixel_type);
+        const unsigned int i_sample_bits = header.i_bits_per_pixel / i_bands;
+        Pylon::EPixelType ept_unpacked_type;
+        const bool b_packed = BaslerHelper::unpacked_format(ept_pixel_type, ept_unpacked_type);
+        if(!b_packed && (header.i_bits_per_pixel % i_bands != 0 || (i_sample_bits != 8 && i_sample_bits != 16)))
+        {
+            throw RUNTIME_EXCEPTION("Pixel format %s cannot be read, save with another output type.",
+                    header.s_pixel_format);
+        }
+
+        // Every frame has to hold all of its pixels
+        const uint64_t i_pixel_bits = (uint64_t)header.i_width * header.i_height * header.i_bits_per_pixel;
+        if(header.i_bits_per_pixel != Pylon::BitPerPixel(ept_pixel_type) || header.i_width == 0
+                || header.i_height == 0 || i_pixel_bits / header.i_width / header.i_height != header.i_bits_per_pixel
+                || header.i_frame_stride < (i_pixel_bits + 7) / 8)
+        {
+            throw RUNTIME_EXCEPTION("Raw stream file %s has a damaged header.", s_filename.c_str());
+        }
+
+        // Get frames to read
+        const std::vector<uint64_t> i_frames = frame_numbers(nrhs, prhs, header.i_frame_count);
+
+        // Create output array and copy frames
+        const size_t i_dimensions[] = { header.i_height,
+                                        header.i_width,
+                                        i_bands,
+                                        i_frames.size()};
+        mxArray* mxa_output;
+        if(b_packed)
+        {
+            mxa_output = mxCreateNumericArray(4, i_dimensions, mxUINT16_CLASS, mxREAL);
+            unpack_frames(p_data, header, i_frames, mxa_output);
+        }
+        else if(i_sample_bits == 8)
+        {
+            mxa_output = mxCreateNumericArray(4, i_dimensions, mxUINT8_CLASS, mxREAL);
+            read_frames<uint8_t>(p_data, header, i_frames, mxa_output);
+        }
+        else
+        {
+            mxa_output = mxCreateNumericArray(4, i_dimensions, mxUINT16_CLASS, mxREAL);
+            read_frames<uint16_t>(p_data, header, i_frames, mxa_output);
+        }
+
+        // Return frame index
+        if(nlhs >= 2)
+        {
+            plhs[1] = frame_info(header.s_pixel_format, header.i_frame_count,
+                    (const BaslerHelper::RawStreamIndexEntry*)(p_data + header.i_index_offset), i_frames);
+        }
+
+        // Remove singleton dimensions
+        mexCallMATLAB(1,plhs,1,&mxa_output,"squeeze");
+    }
+    catch (boost::interprocess::interprocess_exception &e)
+    {
+        mexErrMsgIdAndTxt("baslerDriver:Error:FileError", e.what());
+    }
+    catch (boost::filesystem::filesystem_error &e)
+    {
+        mexErrMsgIdAndTxt("baslerDriver:Error:FileError", e.what());
+    }
+    catch (GenICam::GenericException &e)
+    {
+        // Error handling.
+        mexErrMsgIdAndTxt("baslerDriver:Error:FileError",e.GetDescription());
+    }
+
+    return;
+}
+
@@ -0,0 +1,31 @@
+function [frames, info] = baslerReadRaw(fileName, varargin)
+% baslerReadRaw.m - Read frames from a raw or compressed stream file
+%
+%  Reads frames from a raw stream file written by baslerSaveData with a
+%  savePath ending in .braw, or a compressed stream file (.bcmp). The file
+%  is memory mapped, so only the selected frames are loaded from disk.
+%  Compressed frames are decompressed in parallel. frameNumbers selects
+%  the frames (1-based), the default is all frames.
+%
+%  The optional output info contains the pixel format, the number of
+%  frames in the file and the camera timestamps and image numbers of the
+%  returned frames.
+%
+%  Packed 10 and 12 bit formats (Mono10p, Mono12p, Mono10packed,
+%  Mono12packed and the packed Bayer formats) are unpacked to uint16
+%  with the original values. Compressed streams store them unpacked, the
+%  pixel format in info is the unpacked one (e.g. Mono12 for Mono12p).
+%
+%  The optional parameter verbose (default=0) enables the output of
+%  internal information to the workspace.
+%
+%  Usage:
+%    baslerReadRaw(fileName)
+%    baslerReadRaw(fileName, frameNumbers)
+%    baslerReadRaw(fileName, frameNumbers, verbose)
+%    [frames, info] = baslerReadRaw(...)
+%
+
+[frames, info] = baslerDriver('ReadRaw', fileName, varargin{:});
+
+end
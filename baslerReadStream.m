@@ -0,0 +1,35 @@
+function [frames, metadata, info] = baslerReadStream(cameraIndex, varargin)
+% baslerReadStream.m - Read the next chunk of a stream
+%
+%  Returns the next chunk of frames streamed since baslerStartStream, as
+%  height x width x frames for mono and height x width x samples x frames
+%  for color output types. Waits up to timeout seconds (default=5) for a
+%  full chunk; the last chunk of a stream may hold fewer frames. An
+%  empty array is returned if no chunk is ready in time or the stream has
+%  ended.
+%
+%  The outputType specifies the desired output type, which the frames
+%  are converted to. When omiting the parameter, the camera's pixel
+%  format is used. See baslerGetData for possible values.
+%
+%  The optional output metadata holds the per-frame metadata of the
+%  chunk, see baslerGetData. The optional output info contains:
+%    - ended          true if all frames were grabbed and read
+%    - framesGrabbed  frames grabbed since the start
+%    - framesDropped  frames lost since the start
+%    - stalls         how often grabbing had to wait for a free chunk
+%
+%  The optional parameter verbose (default=0) enables the output of
+%  internal information to the workspace.
+%
+%  Usage:
+%    baslerReadStream(cameraIndex)
+%    baslerReadStream(cameraIndex, outputType)
+%    baslerReadStream(cameraIndex, outputType, timeout)
+%    baslerReadStream(cameraIndex, outputType, timeout, verbose)
+%    [frames, metadata, info] = baslerReadStream(...)
+%
+
+[frames, metadata, info] = baslerDriver('ReadStream', cameraIndex, varargin{:});
+
+end
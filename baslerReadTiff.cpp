@@ -0,0 +1,357 @@
+// baslerReadTiff.cpp - Read the TIFF frames of a directory written by baslerSaveData
+// see baslerReadTiff.m for help
+
+#include <pylon/PylonIncludes.h>
+#include "basler_helper/basler_driver.h"
+#include "basler_helper/tiff_reader.h"
+#include "basler_helper/transpose_image.h"
+#include "basler_helper/crop_image.h"
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <exception>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <matrix.h>
+#include <mex.h>
+
+
+namespace {
+
+    //---------------------------------------------------------------------
+    // A TIFF file of the directory
+    struct TiffEntry
+    {
+        std::string s_path;
+        std::string s_name;
+        double d_number;        // Trailing number of the name, NaN if none
+
+        bool operator<(const TiffEntry& other) const
+        {
+            if(std::isnan(d_number) != std::isnan(other.d_number))
+            {
+                return !std::isnan(d_number);
+            }
+            if(!std::isnan(d_number) && d_number != other.d_number)
+            {
+                return d_number < other.d_number;
+            }
+            return s_name < other.s_name;
+        }
+    };
+
+    //---------------------------------------------------------------------
+    // TIFF files of a directory, ordered by the number at the end of their
+    // name (the image number of frame_%04d.tif)
+    std::vector<TiffEntry> list_tiffs(const boost::filesystem::path& bfp_directory)
+    {
+        std::vector<TiffEntry> entries;
+        for(boost::filesystem::directory_iterator it(bfp_directory), end; it != end; ++it)
+        {
+            const std::string s_extension = it->path().extension().string();
+            if(!boost::filesystem::is_regular_file(it->status()) || (s_extension != ".tif" && s_extension != ".tiff"))
+            {
+                continue;
+            }
+            TiffEntry entry;
+            entry.s_path = it->path().string();
+            entry.s_name = it->path().filename().string();
+            const std::string s_stem = it->path().stem().string();
+            const size_t i_digits = s_stem.find_last_not_of("0123456789") + 1;
+            entry.d_number = i_digits < s_stem.size() ? atof(s_stem.c_str() + i_digits) :
+                    std::numeric_limits<double>::quiet_NaN();
+            entries.push_back(entry);
+        }
+        std::sort(entries.begin(), entries.end());
+        return entries;
+    }
+
+    //---------------------------------------------------------------------
+    // Read a whole file
+    void read_file(const std::string& s_path, std::vector<uint8_t>& data)
+    {
+        FILE* p_file = fopen(s_path.c_str(), "rb");
+        if(p_file == NULL)
+        {
+            throw RUNTIME_EXCEPTION("Cannot open file %s.", s_path.c_str());
+        }
+        bool b_ok = fseek(p_file, 0, SEEK_END) == 0;
+        const long i_size = b_ok ? ftell(p_file) : -1;
+        b_ok = i_size >= 0 && fseek(p_file, 0, SEEK_SET) == 0;
+        if(b_ok)
+        {
+            data.resize((size_t)i_size);
+            b_ok = i_size == 0 || fread(&data[0], 1, (size_t)i_size, p_file) == (size_t)i_size;
+        }
+        fclose(p_file);
+        if(!b_ok)
+        {
+            throw RUNTIME_EXCEPTION("Cannot read file %s.", s_path.c_str());
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Read the selected files in parallel, each thread reads a file,
+    // checks that it matches the first one and copies the window into the
+    // frame of the output
+    template <typename T>
+    void read_tiffs(const std::vector<TiffEntry>& entries,
+                    const std::vector<size_t>& i_files,
+                    const BaslerHelper::TiffLayout& first,
+                    const BaslerHelper::CropWindow& window,
+                    const bool b_cropped,
+                    mxArray* mxa_output)
+    {
+        const size_t i_numel = window.i_width * window.i_height * first.i_bands;
+        T* p_output = (T*)mxGetData(mxa_output);
+
+        const size_t i_num_of_threads = std::max<size_t>(1,
+                std::min<size_t>(std::thread::hardware_concurrency(), i_files.size()));
+        std::atomic<size_t> i_next_frame(0);
+        std::vector<std::exception_ptr> errors(i_num_of_threads);
+        std::vector<std::thread> threads;
+        for(size_t i_thread = 0; i_thread < i_num_of_threads; i_thread++)
+        {
+            threads.push_back(std::thread([&, i_thread]()
+            {
+                try
+                {
+                    std::vector<uint8_t> data;
+                    std::vector<uint8_t> scratch;
+                    BaslerHelper::TiffLayout layout;
+                    for(size_t i_c_frame = i_next_frame++; i_c_frame < i_files.size(); i_c_frame = i_next_frame++)
+                    {
+                        const TiffEntry& entry = entries[i_files[i_c_frame]];
+                        read_file(entry.s_path, data);
+                        BaslerHelper::parse_tiff(data.empty() ? NULL : &data[0], data.size(), entry.s_name, layout);
+                        if(layout.i_width != first.i_width || layout.i_height != first.i_height
+                                || layout.i_bands != first.i_bands || layout.i_bits != first.i_bits)
+                        {
+                            throw RUNTIME_EXCEPTION("%s differs in size or format from the first frame.", entry.s_name.c_str());
+                        }
+                        const T* p_pixels = (const T*)BaslerHelper::tiff_pixels(&data[0], data.size(), layout, scratch);
+                        if(b_cropped)
+                        {
+                            BaslerHelper::crop_window(p_pixels, layout.i_width, layout.i_bands, window, 1,
+                                    BaslerHelper::Binning_Decimate, p_output + i_c_frame * i_numel);
+                        }
+                        else
+                        {
+                            BaslerHelper::transpose_image(p_pixels, p_output + i_c_frame * i_numel,
+                                    layout.i_height, layout.i_width, layout.i_bands);
+                        }
+                    }
+                }
+                catch (...)
+                {
+                    errors[i_thread] = std::current_exception();
+                }
+            }));
+        }
+        for(size_t i = 0; i < threads.size(); i++)
+        {
+            threads[i].join();
+        }
+        for(size_t i = 0; i < errors.size(); i++)
+        {
+            if(errors[i])
+            {
+                std::rethrow_exception(errors[i]);
+            }
+        }
+    }
+}
+
+
+void baslerReadTiff(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    // Parse parameters
+    if(nrhs < 1)
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "Not enough arguments. Use help baslerReadTiff for further information.");
+    }
+    else if(nrhs > 5)
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "Too many arguments. Use help baslerReadTiff for further information.");
+    }
+    if(!mxIsChar(prhs[0]))
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "The directory has to be a string.");
+    }
+    const std::string s_directory = mxArrayToString(prhs[0]);
+
+    // Get range of frames, 1-based and inclusive
+    double d_first = 1;
+    double d_last = std::numeric_limits<double>::infinity();
+    if(nrhs >= 2 && !mxIsEmpty(prhs[1]))
+    {
+        if(!mxIsDouble(prhs[1]) || mxGetNumberOfElements(prhs[1]) > 2)
+        {
+            mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                    "The range has to be [first last] or first.");
+        }
+        d_first = mxGetPr(prhs[1])[0];
+        if(mxGetNumberOfElements(prhs[1]) == 2)
+        {
+            d_last = mxGetPr(prhs[1])[1];
+        }
+        if(d_first < 1 || d_last < d_first || d_first != std::floor(d_first))
+        {
+            mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                    "The range has to start at 1 or later and must not end before it starts.");
+        }
+    }
+
+    // Get stride
+    size_t i_stride = 1;
+    if(nrhs >= 3 && !mxIsEmpty(prhs[2]))
+    {
+        const double d_stride = mxGetScalar(prhs[2]);
+        if(d_stride < 1 || d_stride != std::floor(d_stride))
+        {
+            mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                    "The stride has to be a positive integer.");
+        }
+        i_stride = (size_t)d_stride;
+    }
+
+    // Get ROI
+    bool b_cropped = false;
+    BaslerHelper::CropWindow window;
+    if(nrhs >= 4 && !mxIsEmpty(prhs[3]))
+    {
+        if(!mxIsDouble(prhs[3]) || mxGetNumberOfElements(prhs[3]) != 4)
+        {
+            mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                    "The ROI has to be [xOffset, yOffset, width, height].");
+        }
+        const double* p_roi = mxGetPr(prhs[3]);
+        for(size_t c = 0; c < 4; c++)
+        {
+            if(p_roi[c] < 0 || p_roi[c] != std::floor(p_roi[c]) || (c >= 2 && p_roi[c] == 0))
+            {
+                mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                        "The offsets of the ROI cannot be negative, its size has to be positive.");
+            }
+        }
+        window.i_x = (size_t)p_roi[0];
+        window.i_y = (size_t)p_roi[1];
+        window.i_width = (size_t)p_roi[2];
+        window.i_height = (size_t)p_roi[3];
+        b_cropped = true;
+    }
+
+    // Get verbose parameter
+    bool b_verbose = 0;
+    if(nrhs >= 5 && mxGetNumberOfElements(prhs[4]) >= 1)
+    {
+        b_verbose = (int)mxGetScalar(prhs[4]) != 0;
+    }
+
+    try
+    {
+        // Find and select frames
+        const std::vector<TiffEntry> entries = list_tiffs(s_directory);
+        if(entries.empty())
+        {
+            throw RUNTIME_EXCEPTION("There are no TIFF files in %s.", s_directory.c_str());
+        }
+        if(d_first > (double)entries.size())
+        {
+            throw RUNTIME_EXCEPTION("The range starts after the last frame, the directory holds %d frame(s).",
+                    (int)entries.size());
+        }
+        std::vector<size_t> i_files;
+        for(size_t i = (size_t)d_first - 1; i < entries.size() && (double)i < d_last; i += i_stride)
+        {
+            i_files.push_back(i);
+        }
+
+        // The first selected frame defines size and format
+        BaslerHelper::TiffLayout first;
+        {
+            std::vector<uint8_t> data;
+            read_file(entries[i_files[0]].s_path, data);
+            BaslerHelper::parse_tiff(data.empty() ? NULL : &data[0], data.size(), entries[i_files[0]].s_name, first);
+        }
+        if(b_cropped)
+        {
+            if(window.i_x + window.i_width > first.i_width || window.i_y + window.i_height > first.i_height)
+            {
+                throw RUNTIME_EXCEPTION("The ROI exceeds the frames of %ux%u pixels.", first.i_width, first.i_height);
+            }
+        }
+        else
+        {
+            window.i_x = 0;
+            window.i_y = 0;
+            window.i_width = first.i_width;
+            window.i_height = first.i_height;
+        }
+        if(b_verbose)
+        {
+            mexPrintf("Reading %d of %d frame(s) of %ux%u pixels, %u x %u bit\n", (int)i_files.size(), (int)entries.size(),
+                    first.i_width, first.i_height, first.i_bands, first.i_bits);
+        }
+
+        // Create output array and read frames
+        const size_t i_dimensions[] = { window.i_height,
+                                        window.i_width,
+                                        first.i_bands,
+                                        i_files.size()};
+        mxArray* mxa_output;
+        if(first.i_bits == 8)
+        {
+            mxa_output = mxCreateNumericArray(4, i_dimensions, mxUINT8_CLASS, mxREAL);
+            read_tiffs<uint8_t>(entries, i_files, first, window, b_cropped, mxa_output);
+        }
+        else
+        {
+            mxa_output = mxCreateNumericArray(4, i_dimensions, mxUINT16_CLASS, mxREAL);
+            read_tiffs<uint16_t>(entries, i_files, first, window, b_cropped, mxa_output);
+        }
+
+        // Return file names and image numbers
+        if(nlhs >= 2)
+        {
+            mxArray* mxa_names = mxCreateCellMatrix(i_files.size(), 1);
+            mxArray* mxa_numbers = mxCreateDoubleMatrix(i_files.size(), 1, mxREAL);
+            double* p_numbers = mxGetPr(mxa_numbers);
+            for(size_t i = 0; i < i_files.size(); i++)
+            {
+                mxSetCell(mxa_names, i, mxCreateString(entries[i_files[i]].s_name.c_str()));
+                p_numbers[i] = entries[i_files[i]].d_number;
+            }
+
+            const char* s_fields[] = {"frameCount", "fileNames", "imageNumbers"};
+            plhs[1] = mxCreateStructMatrix(1, 1, 3, s_fields);
+            mxSetField(plhs[1], 0, "frameCount", mxCreateDoubleScalar((double)entries.size()));
+            mxSetField(plhs[1], 0, "fileNames", mxa_names);
+            mxSetField(plhs[1], 0, "imageNumbers", mxa_numbers);
+        }
+
+        // Remove singleton dimensions
+        mexCallMATLAB(1,plhs,1,&mxa_output,"squeeze");
+    }
+    catch (boost::filesystem::filesystem_error &e)
+    {
+        mexErrMsgIdAndTxt("baslerDriver:Error:FileError", e.what());
+    }
+    catch (GenICam::GenericException &e)
+    {
+        // Error handling.
+        mexErrMsgIdAndTxt("baslerDriver:Error:FileError",e.GetDescription());
+    }
+
+    return;
+}
@@ -0,0 +1,36 @@
+function [frames, info] = baslerReadTiff(directory, varargin)
+% baslerReadTiff.m - Read the TIFF frames of a directory
+%
+%  Reads the frames which baslerSaveData saved as .tiff files into a
+%  directory. The files are ordered by the image number at the end of
+%  their names. range selects the frames as [first last] (1-based,
+%  inclusive) or first, the default is all frames. Every stride-th frame
+%  of the range is read (default=1). roi crops the frames to
+%  [xOffset, yOffset, width, height] (0-based offsets), the default are
+%  the whole frames.
+%
+%  The files are read and converted in parallel, all frames need the
+%  same size and format. Only uncompressed 8 and 16 bit TIFF files are
+%  supported, the frames are returned as uint8 or uint16 with the
+%  dimensions height x width x bands x frames, singleton dimensions are
+%  removed.
+%
+%  The optional output info contains the number of TIFF files in the
+%  directory and the file names and image numbers of the returned frames.
+%  The image number is NaN if a file name does not end in a number.
+%
+%  The optional parameter verbose (default=0) enables the output of
+%  internal information to the workspace.
+%
+%  Usage:
+%    baslerReadTiff(directory)
+%    baslerReadTiff(directory, range)
+%    baslerReadTiff(directory, range, stride)
+%    baslerReadTiff(directory, range, stride, roi)
+%    baslerReadTiff(directory, range, stride, roi, verbose)
+%    [frames, info] = baslerReadTiff(...)
+%
+
+[frames, info] = baslerDriver('ReadTiff', directory, varargin{:});
+
+end
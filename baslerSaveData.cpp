@@ -2,45 +2,72 @@
 // see baslerSaveData.m for help
 
 #include <pylon/PylonIncludes.h>
+#include "basler_helper/basler_driver.h"
+#include "basler_helper/camera_session.h"
 #include "basler_helper/basler_set_get.h"
 #include "basler_helper/capture_images.h"
+#include "basler_helper/frame_source.h"
+#include "basler_helper/frame_metadata.h"
+#include "basler_helper/grab_options.h"
+#include "basler_helper/telemetry.h"
+#include "basler_helper/trigger_capture.h"
 
 #include <boost/filesystem.hpp>
 #include <boost/format.hpp>
 
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
 #include <matrix.h>
 #include <mex.h>
 
     
-void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+void baslerSaveData(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
 {       
     const std::string s_filename = "frame_%04d.tif";
+    const std::string s_raw_extension = ".braw";
+    const std::string s_compressed_extension = ".bcmp";
+    const std::string s_metadata_filename = "frames.bmeta";
+    const std::string s_metadata_extension = ".bmeta";
     
     // Parse parameters
-    if(nrhs < 1)
-    {
-        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
-                "Not enough arguments. Use help baslerGetParameter for further information."); 
-    }
-    else if(nrhs > 5)
+    if(nrhs < 2)
     {
         mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
-                "Too many arguments. Use help baslerGetParameter for further information."); 
+                "Not enough arguments. Use help baslerSaveData for further information."); 
     }
     
-    // Get camera number
-    const int i_cam_number = (int)mxGetScalar(prhs[0]);
-    
     // Get verbose parameter
     bool b_verbose = 0;
-    if(nrhs == 5)
+    if(nrhs >= 5 && mxGetNumberOfElements(prhs[4]) >= 1)
+    {
+        b_verbose = (int)mxGetScalar(prhs[4]) != 0;
+    }
+    
+    // Get grab engine and grab thread options, and the trigger and timeout
+    // policy, default: free-running with a timeout of 5 s. The options are
+    // a struct or name/value pairs after nWriters.
+    BaslerHelper::GrabOptions grab_options;
+    BaslerHelper::TriggerSettings trigger;
+    const mxArray* mxa_options = BaslerHelper::options_to_struct(std::max(0, nrhs - 6), prhs + std::min(nrhs, 6),
+            std::vector<std::string>(1, "Trigger"));
+    if(mxa_options != NULL)
     {
-        b_verbose = (int)mxGetScalar(prhs[3]) != 0;
+        BaslerHelper::parse_grab_options(mxa_options, grab_options);
+        const mxArray* mxa_trigger = mxGetField(mxa_options, 0, "Trigger");
+        if(mxa_trigger != NULL && !mxIsEmpty(mxa_trigger))
+        {
+            BaslerHelper::parse_trigger(mxa_trigger, trigger);
+        }
     }
     
     // Get save path
     std::string s_save_path = mxArrayToString(prhs[1]);
     boost::filesystem::path bfp_save_path;
+    boost::filesystem::path bfp_metadata_path;
+    BaslerHelper::SaveFormat sf_format = BaslerHelper::SaveFormat_Tiff;
     if(b_verbose)
     {
         mexPrintf("Saving to \"%s\"\n",mxArrayToString(prhs[1]));
@@ -48,8 +75,26 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
     try
     {
         bfp_save_path = s_save_path;
-        boost::filesystem::create_directory(bfp_save_path);
-        bfp_save_path /= s_filename;
+        if(bfp_save_path.extension() == s_raw_extension)
+        {
+            // All frames into one raw stream file
+            sf_format = BaslerHelper::SaveFormat_RawStream;
+            bfp_metadata_path = bfp_save_path;
+            bfp_metadata_path.replace_extension(s_metadata_extension);
+        }
+        else if(bfp_save_path.extension() == s_compressed_extension)
+        {
+            // All frames compressed into one file
+            sf_format = BaslerHelper::SaveFormat_Compressed;
+            bfp_metadata_path = bfp_save_path;
+            bfp_metadata_path.replace_extension(s_metadata_extension);
+        }
+        else
+        {
+            boost::filesystem::create_directory(bfp_save_path);
+            bfp_metadata_path = bfp_save_path / s_metadata_filename;
+            bfp_save_path /= s_filename;
+        }
     }
     catch(boost::filesystem::filesystem_error &e)
     {
@@ -65,11 +110,23 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
             i_num_of_frames = (int)mxGetScalar(prhs[2]);
         }
     }
+    if(i_num_of_frames < 1)
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "nFrames has to be at least 1.");
+    }
     if(b_verbose)
     {
         mexPrintf("Capturing %d frame(s) \n",i_num_of_frames);
     }
     
+    // Get number of writer threads
+    int i_num_of_writers = 2;
+    if(nrhs >= 6 && mxGetNumberOfElements(prhs[5]) >= 1)
+    {
+        i_num_of_writers = std::max(1, std::min((int)mxGetScalar(prhs[5]), 16));
+    }
+    
     // Get output type
     Pylon::EPixelType ept_output_type = Pylon::PixelType_Undefined;
     if(nrhs >= 4)
@@ -85,51 +142,98 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
     }
 
     
-    // Initiatlize Pylon
-    Pylon::PylonAutoInitTerm auto_init_term;
-    
     try
     {
-        // Get the transport layer factory.
-        Pylon::CTlFactory& tlFactory = Pylon::CTlFactory::GetInstance();
+        // Get camera, or a synthetic source
+        std::unique_ptr<BaslerHelper::FrameSource> p_source = BaslerHelper::create_source(prhs[0], b_verbose);
         
-        // Get all attached devices
-        Pylon::DeviceInfoList_t devices;
-        int i_num_of_cameras = tlFactory.EnumerateDevices(devices);
-        if ( i_num_of_cameras == 0 )
+        // Tune the grab engine, and the thread which retrieves the frames
+        if(p_source->camera() != NULL)
         {
-            throw RUNTIME_EXCEPTION( "No camera found.");
+            BaslerHelper::apply_grab_options(p_source->camera(), grab_options, b_verbose);
         }
-        
-        // Check if camera exists
-        if (i_cam_number > i_num_of_cameras-1 )
+        BaslerHelper::GrabThread grab_thread(grab_options);
+           
+        // Find pixel type if needed
+        if(ept_output_type == Pylon::PixelType_Undefined)
         {
-            throw RUNTIME_EXCEPTION("No camera with this index exists.");
+            ept_output_type = p_source->pixel_type();
         }
         
-        // Create camera object
-        Pylon::CInstantCamera camera(tlFactory.CreateDevice(devices[i_cam_number]));
-        
-        // Open Camera
-        camera.Open();
+        // Capture and save images, then their metadata next to them
+        BaslerHelper::FrameMetadata metadata;
+        BaslerHelper::Telemetry telemetry(!grab_options.s_trace_file.empty());
+        BaslerHelper::SaveStatistics stats = BaslerHelper::save_images(p_source.get(), 
+                bfp_save_path, i_num_of_frames, ept_output_type, i_num_of_writers, sf_format, b_verbose, &metadata,
+                &trigger, grab_options.b_telemetry ? &telemetry : NULL, &grab_thread);
+        grab_thread.report(b_verbose);
+        BaslerHelper::write_metadata(bfp_metadata_path.string(), metadata);
         if(b_verbose)
         {
-            mexPrintf("Using camera \"%s\"\n", camera.GetDeviceInfo().GetModelName().c_str());
+            mexPrintf("Saved %d frame(s), %d grab(s) waited for a free buffer\n",
+                    stats.i_saved, stats.i_stalls);
+            if(sf_format == BaslerHelper::SaveFormat_Compressed && stats.i_compressed_bytes > 0)
+            {
+                mexPrintf("Compressed %.1f MB to %.1f MB (ratio %.2f), %.0f MB/s per writer thread\n",
+                        stats.i_raw_bytes / 1e6, stats.i_compressed_bytes / 1e6,
+                        (double)stats.i_raw_bytes / (double)stats.i_compressed_bytes,
+                        stats.i_raw_bytes / 1e6 / std::max(stats.d_compress_seconds, 1e-9));
+            }
+            if(grab_options.b_telemetry)
+            {
+                mexPrintf("Time per frame and stage:\n");
+                telemetry.print();
+            }
         }
-           
-        // Find pixel type if needed
-        if(ept_output_type == Pylon::PixelType_Undefined)
+        if(!grab_options.s_trace_file.empty())
         {
-            std::string s_pixel_type = BaslerHelper::get_string(&camera,"PixelFormat",b_verbose);
-            ept_output_type = Pylon::CPixelTypeMapper().GetPylonPixelTypeByName(s_pixel_type.c_str());
+            telemetry.write_trace(grab_options.s_trace_file);
         }
         
-        // Capture and save images                                
-        BaslerHelper::save_images(&camera, bfp_save_path, i_num_of_frames, ept_output_type, b_verbose);
-       
-        // Close camera
-        camera.Close();
+        // Report lost frames
+        if(stats.i_dropped > 0)
+        {
+            mexWarnMsgIdAndTxt("baslerDriver:Warning:FramesDropped",
+                    "%d frame(s) were dropped during capture.", stats.i_dropped);
+        }
         
+        // Return statistics
+        if(nlhs >= 1)
+        {
+            const char* s_fields[] = {"framesSaved", "framesDropped", "bufferStalls", 
+                                      "maxQueueDepth", "bufferPoolSize", "streamGrabber", "telemetry",
+                                      "compression"};
+            plhs[0] = mxCreateStructMatrix(1, 1, 8, s_fields);
+            mxSetField(plhs[0], 0, "framesSaved", mxCreateDoubleScalar(stats.i_saved));
+            mxSetField(plhs[0], 0, "framesDropped", mxCreateDoubleScalar(stats.i_dropped));
+            mxSetField(plhs[0], 0, "bufferStalls", mxCreateDoubleScalar(stats.i_stalls));
+            mxSetField(plhs[0], 0, "maxQueueDepth", mxCreateDoubleScalar(stats.i_max_queue_depth));
+            mxSetField(plhs[0], 0, "bufferPoolSize", mxCreateDoubleScalar(stats.i_pool_size));
+            mxSetField(plhs[0], 0, "streamGrabber", BaslerHelper::stream_statistics_to_struct(
+                    BaslerHelper::read_stream_statistics(p_source->camera())));
+            if(grab_options.b_telemetry)
+            {
+                mxSetField(plhs[0], 0, "telemetry", telemetry.to_struct());
+            }
+            if(sf_format == BaslerHelper::SaveFormat_Compressed)
+            {
+                const char* s_compression_fields[] = {"rawBytes", "compressedBytes", "ratio", "seconds", "mbPerSecondPerCore"};
+                mxArray* mxa_compression = mxCreateStructMatrix(1, 1, 5, s_compression_fields);
+                mxSetField(mxa_compression, 0, "rawBytes", mxCreateDoubleScalar((double)stats.i_raw_bytes));
+                mxSetField(mxa_compression, 0, "compressedBytes", mxCreateDoubleScalar((double)stats.i_compressed_bytes));
+                mxSetField(mxa_compression, 0, "ratio", mxCreateDoubleScalar(stats.i_compressed_bytes > 0 ?
+                        (double)stats.i_raw_bytes / (double)stats.i_compressed_bytes : 0.0));
+                mxSetField(mxa_compression, 0, "seconds", mxCreateDoubleScalar(stats.d_compress_seconds));
+                mxSetField(mxa_compression, 0, "mbPerSecondPerCore", mxCreateDoubleScalar(stats.d_compress_seconds > 0 ?
+                        stats.i_raw_bytes / 1e6 / stats.d_compress_seconds : 0.0));
+                mxSetField(plhs[0], 0, "compression", mxa_compression);
+            }
+        }
+        if(nlhs >= 2)
+        {
+            plhs[1] = BaslerHelper::metadata_to_struct(metadata);
+        }
+       
     }
     catch (GenICam::GenericException &e)
     {
@@ -1,8 +1,16 @@
+function varargout = baslerSaveData(cameraIndex, varargin)
 % baslerSaveData.m - Capture and save a number of frames from Basler a camera
 %
 %  Captures and saves a number of frames from the selected Basler camera.
-%  The save path has to be specified in savePath. Currently the only output
-%  format is a number of .tiff files.
+%  The save path has to be specified in savePath. By default, savePath is
+%  a directory and each frame is saved as a .tiff file, which is read back
+%  with baslerReadTiff. If savePath ends
+%  in .braw, all frames are written unconverted or in outputType into a
+%  single raw stream file, bypassing the file cache where possible. If
+%  savePath ends in .bcmp, the frames are losslessly compressed by the
+%  writer threads into a single file, which is typically 2 to 3 times
+%  smaller for camera images; use more nWriters if the compression cannot
+%  keep up. Both files are read with baslerReadRaw.
 %  The default number of frames is 1. The outputType specifies the
 %  desired output type, which the captured frames are converted to. When
 %  omiting the parameter, the type from PixelFormat is used. Possible
@@ -19,10 +27,56 @@
 %  The optional parameter verbose (default=0) enables the output of
 %  internal information to the workspace.
 %
+%  The frames are written to disk by nWriters (default=2) background
+%  threads, so that slow disks do not throttle the acquisition. The
+%  optional output stats reports the number of saved and dropped frames
+%  and how often the acquisition had to wait for a free frame buffer.
+%  A warning is issued if frames were dropped during capture. The field
+%  streamGrabber of stats holds the counters of the stream grabber, see
+%  baslerGetData. For .bcmp files, the field compression holds the bytes
+%  before and after compression (rawBytes, compressedBytes), their ratio,
+%  the compression time of all writers (seconds) and the resulting
+%  throughput of one writer (mbPerSecondPerCore).
+%
+%  options, a struct or name/value pairs, tunes the grab engine and the
+%  grab thread, with the same fields as in baslerGetData (MaxNumBuffer,
+%  PacketSize, InterPacketDelay, MaxTransferSize, NumMaxQueuedUrbs,
+%  EnginePriority, GrabThreadCpu, GrabThreadPriority, Telemetry and
+%  TraceFile). With Telemetry or
+%  TraceFile, the field telemetry of stats times the stages of the
+%  capture, see baslerGetData. The field Trigger arms a frame trigger and
+%  sets the timeout for each frame, with the fields Source, Activation,
+%  Timeout and OnTimeout of trigger in baslerGetData. Without it, the
+%  camera runs free and a frame not arriving within 5 s is an error, e.g.
+%    opts = struct('Trigger', struct('Source', 'Line1', 'Timeout', 60));
+%
+%  The metadata of the saved frames (see baslerGetData) is written to
+%  frames.bmeta in the TIFF directory, or next to the raw stream file
+%  with the extension .bmeta. Read it with baslerReadMetadata, or get it
+%  from the optional output metadata.
+%
+%  Instead of a camera, cameraIndex can be a struct describing a
+%  synthetic source with the fields Width, Height, PixelFormat and the
+%  optional FrameRate (default=0, as fast as possible) and DropEvery
+%  (default=0, every DropEvery-th frame is lost). It generates a moving
+%  test pattern, so the capture can be tested and profiled without a
+%  camera, e.g.
+%    src = struct('Width',640,'Height',480,'PixelFormat','Mono8', ...
+%                 'FrameRate',100,'DropEvery',50);
+%
 %  Usage:
 %    baslerSaveData(cameraIndex, savePath)
 %    baslerSaveData(cameraIndex, savePath, nFrames)
 %    baslerSaveData(cameraIndex, savePath, [], outputType)
 %    baslerSaveData(cameraIndex, savePath, [], [], verbose)
 %    baslerSaveData(cameraIndex, savePath, nFrames, outputType, verbose)
+%    baslerSaveData(cameraIndex, savePath, nFrames, outputType, verbose, nWriters)
+%    baslerSaveData(cameraIndex, savePath, nFrames, outputType, verbose, nWriters, options)
+%    baslerSaveData(cameraIndex, savePath, nFrames, outputType, verbose, nWriters, 'Name', value, ...)
+%    stats = baslerSaveData(...)
+%    [stats, metadata] = baslerSaveData(...)
 %
+
+[varargout{1:nargout}] = baslerDriver('SaveData', cameraIndex, varargin{:});
+
+end
@@ -0,0 +1,108 @@
+// baslerSession.cpp - Open, close and list persistent camera sessions
+// see baslerOpenCamera.m, baslerCloseCamera.m and baslerListCameras.m for help
+
+#include <pylon/PylonIncludes.h>
+#include "basler_helper/basler_driver.h"
+#include "basler_helper/camera_session.h"
+
+#include <string>
+
+#include <matrix.h>
+#include <mex.h>
+
+
+//-------------------------------------------------------------------------
+// Open camera and keep it open until baslerCloseCamera is called
+void baslerOpenCamera(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    // Parse parameters
+    if(nrhs < 1)
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "Not enough arguments. Use help baslerOpenCamera for further information.");
+    }
+    else if(nrhs > 3)
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "Too many arguments. Use help baslerOpenCamera for further information.");
+    }
+
+    // Get read policy, if given
+    const bool b_policy_given = (nrhs >= 2 && mxIsChar(prhs[1]));
+    const std::string s_read_policy = b_policy_given ? mxArrayToString(prhs[1]) : "";
+
+    // Get verbose parameter
+    bool b_verbose = 0;
+    const int i_verbose_index = b_policy_given ? 2 : 1;
+    if(nrhs > i_verbose_index && mxGetNumberOfElements(prhs[i_verbose_index]) >= 1)
+    {
+        b_verbose = (int)mxGetScalar(prhs[i_verbose_index]) != 0;
+    }
+
+    try
+    {
+        BaslerHelper::CameraSession* p_session = BaslerHelper::get_session(prhs[0], b_verbose);
+
+        // Where parameter values are read from, kept until changed
+        if(b_policy_given)
+        {
+            p_session->nodes()->set_read_policy(BaslerHelper::parse_read_policy(s_read_policy));
+            if(b_verbose)
+            {
+                mexPrintf("Reading parameters with policy %s\n",
+                        BaslerHelper::read_policy_name(p_session->nodes()->read_policy()));
+            }
+        }
+
+        // Return serial number
+        plhs[0] = mxCreateString(p_session->serial_number().c_str());
+    }
+    catch (GenICam::GenericException &e)
+    {
+        // Error handling.
+        mexErrMsgIdAndTxt("baslerDriver:Error:CameraError",e.GetDescription());
+    }
+}
+
+//-------------------------------------------------------------------------
+// Close one camera, or all cameras if none is given
+void baslerCloseCamera(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    // Parse parameters
+    if(nrhs > 2)
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "Too many arguments. Use help baslerCloseCamera for further information.");
+    }
+
+    // Get verbose parameter
+    bool b_verbose = 0;
+    if(nrhs == 2)
+    {
+        b_verbose = (int)mxGetScalar(prhs[1]) != 0;
+    }
+
+    try
+    {
+        if(nrhs == 0 || mxIsEmpty(prhs[0]))
+        {
+            BaslerHelper::close_all_sessions(b_verbose);
+        }
+        else
+        {
+            BaslerHelper::close_session(prhs[0], b_verbose);
+        }
+    }
+    catch (GenICam::GenericException &e)
+    {
+        // Error handling.
+        mexErrMsgIdAndTxt("baslerDriver:Error:CameraError",e.GetDescription());
+    }
+}
+
+//-------------------------------------------------------------------------
+// List all open cameras
+void baslerListCameras(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    plhs[0] = BaslerHelper::list_sessions();
+}
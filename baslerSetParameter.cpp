@@ -2,12 +2,14 @@
 // see baslerSetParameter.m for help
 
 #include <pylon/PylonIncludes.h>
-#include "basler_helper/basler_set_get.h"
+#include "basler_helper/basler_driver.h"
+#include "basler_helper/camera_session.h"
+#include "basler_helper/node_cache.h"
 
 #include <matrix.h>
 #include <mex.h>
 
-void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+void baslerSetParameter(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
 {       
     // Parse parameters
     if(nrhs < 3)
@@ -21,7 +23,6 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
                 "Too many arguments. Use help baslerSetParameter for further information."); 
     }
     
-    const int i_cam_number = (int)mxGetScalar(prhs[0]);
     const std::string s_param_name(mxArrayToString(prhs[1]));
     bool b_verbose = 0;
     
@@ -31,36 +32,14 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
 
     }
     
-    // Initiatlize Pylon
-    Pylon::PylonAutoInitTerm auto_init_term;
-    
     try
     {
-        // Get the transport layer factory.
-        Pylon::CTlFactory& tlFactory = Pylon::CTlFactory::GetInstance();
-        
-        // Get all attached devices
-        Pylon::DeviceInfoList_t devices;
-        int i_num_of_cameras = tlFactory.EnumerateDevices(devices);
-        if ( i_num_of_cameras == 0 )
-        {
-            throw RUNTIME_EXCEPTION( "No camera found.");
-        }
-        
-        // Check if camera exists
-        if (i_cam_number > i_num_of_cameras-1 )
-        {
-            throw RUNTIME_EXCEPTION("No camera with this index exists.");
-        }
-        
-        // Create camera object
-        Pylon::CInstantCamera camera(tlFactory.CreateDevice(devices[i_cam_number]));
-        
-        // Open Camera
-        camera.Open();
+        // Get camera, it stays open between calls, as do its node handles
+        BaslerHelper::CameraSession* p_session = BaslerHelper::get_session(prhs[0], b_verbose);
+        BaslerHelper::NodeCache& nodes = *p_session->nodes();
         if(b_verbose)
         {
-            mexPrintf("Using camera \"%s\"\n", camera.GetDeviceInfo().GetModelName().c_str());
+            mexPrintf("Using camera \"%s\"\n", p_session->camera()->GetDeviceInfo().GetModelName().c_str());
         }
         
         // Find type of parameter
@@ -68,29 +47,20 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
         {
             if(mxIsDouble(prhs[2]) ||mxIsSingle(prhs[2]))   // Float types
             {
-                const double d_param_value = (const double)mxGetScalar(prhs[2]);
-                BaslerHelper::set_parameter(&camera, 
-                        s_param_name.c_str(), &d_param_value , b_verbose);
+                nodes.set_float(s_param_name, mxGetScalar(prhs[2]), b_verbose);
             }
             else                                            // Integers
             {
-                const int i_param_value = (const int)mxGetScalar(prhs[2]);
-                BaslerHelper::set_parameter(&camera, 
-                        s_param_name.c_str(), &i_param_value , b_verbose);
+                nodes.set_int(s_param_name, (int64_t)mxGetScalar(prhs[2]), b_verbose);
             }
         }
         else if(mxIsLogical(prhs[2]))                   // Boolean
         {
-            const bool b_param_value = (const bool)mxGetLogicals(prhs[2]);
-            BaslerHelper::set_parameter(&camera, 
-                    s_param_name.c_str(), &b_param_value , b_verbose);
+            nodes.set_bool(s_param_name, mxGetLogicals(prhs[2])[0], b_verbose);
         }
         else if(mxIsChar(prhs[2]))                      // Strings
         {
-            const char* s_param_value = mxArrayToString(prhs[2]);
-            BaslerHelper::set_parameter(&camera, 
-                    s_param_name.c_str(), s_param_value , b_verbose);
-
+            nodes.set_string(s_param_name, mxArrayToString(prhs[2]), b_verbose);
         }
         else                                            // else: fail!
         {
@@ -98,9 +68,6 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
                     "Cannot detect type of parameter value."); 
         }
         
-        // Close camera
-        camera.Close();
-        
     }
     catch (GenICam::GenericException &e)
     {
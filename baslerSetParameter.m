@@ -1,3 +1,4 @@
+function baslerSetParameter(cameraIndex, varargin)
 % baslerSetParameter.m - Set any Basler camera parameter
 %
 %  Sets the parameter specified in 'parameterName' to the value
@@ -16,4 +17,9 @@
 %    baslerSetParameter(0,'ExposureTime',double(10000));
 %    baslerSetParameter(0,'AcquisitionFrameRateEnable',logical(1));
 %    baslerSetParameter(0,'PixelFormat','Mono8');
-%    baslerSetParameter(..., 1);
\ No newline at end of file
+%    baslerSetParameter(..., 1);
+%
+
+baslerDriver('SetParameter', cameraIndex, varargin{:});
+
+end
@@ -0,0 +1,37 @@
+function varargout = baslerSetParameters(cameraIndex, varargin)
+% baslerSetParameters.m - Set many Basler camera parameters at once
+%
+%  Sets all parameters given as struct (field name = parameter name) or
+%  as cell of name/value pairs in one call. The data type of each value
+%  is converted to the type of the camera parameter, e.g. a double can be
+%  used for integer parameters and a string for enumerations.
+%
+%  The parameters are applied in an order which respects dependencies:
+%  first the ones changing the sensor format (PixelFormat, Binning...,
+%  Decimation...), then the ROI size (Width, Height), then the ROI offset
+%  (OffsetX, OffsetY), then all others in the given order. Given offsets
+%  are zeroed before the size is set, others are moved to zero only if
+%  the ROI would not fit otherwise and put back afterwards. A failing
+%  parameter does not stop the others.
+%
+%  The optional output status is a struct array with the fields name,
+%  success and message for each parameter. Without outputs, a warning
+%  lists all failed parameters. The optional output time is the wall time
+%  of the call in seconds.
+%
+%  The optional parameter verbose (default=0) enables the output of
+%  internal information to the workspace.
+%
+%  Usage:
+%    baslerSetParameters(cameraIndex, parameters)
+%    baslerSetParameters(cameraIndex, parameters, verbose)
+%    [status, time] = baslerSetParameters(...)
+%
+%  Examples:
+%    baslerSetParameters(0, struct('ExposureTime', 10000, 'Gain', 2));
+%    baslerSetParameters(0, {'PixelFormat','Mono12'; 'Width',1024});
+%
+
+[varargout{1:nargout}] = baslerDriver('SetParameters', cameraIndex, varargin{:});
+
+end
@@ -17,8 +17,9 @@ function baslerSetROI( cameraIndex, varargin )
 % Parse input arguments
 if nargin == 1
     regionOfInterest = uint16(zeros(1,4));
-    regionOfInterest(3) = baslerGetParameter(cameraIndex,'WidthMax','Int');
-    regionOfInterest(4) = baslerGetParameter(cameraIndex,'HeightMax','Int');
+    maxSize = baslerGetParameters(cameraIndex,{'WidthMax','HeightMax'});
+    regionOfInterest(3) = maxSize.WidthMax;
+    regionOfInterest(4) = maxSize.HeightMax;
 elseif nargin == 2
     regionOfInterest = varargin{1};
 elseif nargin == 5
@@ -31,15 +32,17 @@ end
 % Convert ROI to integer
 regionOfInterest = uint16(regionOfInterest);
 
-% Reset Offset first
-baslerSetParameter(cameraIndex,'OffsetX', uint16(0));
-baslerSetParameter(cameraIndex,'OffsetY', uint16(0));
-
-% Then set ROI
-baslerSetParameter(cameraIndex,'Width', regionOfInterest(3));
-baslerSetParameter(cameraIndex,'Height', regionOfInterest(4));
-baslerSetParameter(cameraIndex,'OffsetX', regionOfInterest(1));
-baslerSetParameter(cameraIndex,'OffsetY', regionOfInterest(2));
+% Set ROI in one call, the offsets are moved out of the way as needed
+roi = struct('OffsetX', regionOfInterest(1), ...
+             'OffsetY', regionOfInterest(2), ...
+             'Width',   regionOfInterest(3), ...
+             'Height',  regionOfInterest(4));
+status = baslerSetParameters(cameraIndex, roi);
+if ~all([status.success])
+    failed = status(~[status.success]);
+    error('baslerDriver:Error:CameraError', 'Cannot set %s: %s', ...
+          failed(1).name, failed(1).message);
+end
 
 
 end
@@ -0,0 +1,33 @@
+function baslerStartGrabbing(cameraIndex, varargin)
+% baslerStartGrabbing.m - Start grabbing continuously in the background
+%
+%  Starts grabbing frames from the selected Basler camera in a background
+%  thread, which keeps the newest frames in a ring buffer of bufferSize
+%  (default=16) frames. The frames are fetched with baslerGetLatestData
+%  at any rate without stopping the acquisition. Grabbing continues until
+%  baslerStopGrabbing, baslerGetData, baslerSaveData or baslerCloseCamera
+%  is called.
+%
+%  The strategy sets the Pylon grab strategy:
+%    - LatestImageOnly (default): the ring buffer receives every frame
+%      the background thread can keep up with
+%    - UpcomingImage: a frame is only acquired when the previous one has
+%      been retrieved
+%
+%  Parameters which cannot be changed during acquisition, e.g. Width or
+%  PixelFormat, have to be set before grabbing is started. Exposure and
+%  gain can be controlled from the frames with baslerAutoExposure.
+%
+%  The optional parameter verbose (default=0) enables the output of
+%  internal information to the workspace.
+%
+%  Usage:
+%    baslerStartGrabbing(cameraIndex)
+%    baslerStartGrabbing(cameraIndex, bufferSize)
+%    baslerStartGrabbing(cameraIndex, bufferSize, strategy)
+%    baslerStartGrabbing(cameraIndex, bufferSize, strategy, verbose)
+%
+
+baslerDriver('StartGrabbing', cameraIndex, varargin{:});
+
+end
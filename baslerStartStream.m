@@ -0,0 +1,29 @@
+function baslerStartStream(cameraIndex, varargin)
+% baslerStartStream.m - Start streaming frames in chunks
+%
+%  Starts grabbing nFrames frames (default=Inf, until baslerStopStream)
+%  in the background and collects them in chunks of chunkSize (default=
+%  100) frames. Read the chunks with baslerReadStream. The chunks come
+%  from a pool of nChunks (default=4) chunks, which are reused, so the
+%  memory needed is bounded by nChunks x chunkSize frames whatever the
+%  number of frames. If all chunks are full, grabbing waits for
+%  baslerReadStream and the camera may drop frames. Frames which failed
+%  count towards nFrames as dropped, so fewer than nFrames frames may be
+%  read.
+%
+%  A running continuous grab (baslerStartGrabbing) is stopped.
+%
+%  The optional parameter verbose (default=0) enables the output of
+%  internal information to the workspace.
+%
+%  Usage:
+%    baslerStartStream(cameraIndex)
+%    baslerStartStream(cameraIndex, chunkSize)
+%    baslerStartStream(cameraIndex, chunkSize, nFrames)
+%    baslerStartStream(cameraIndex, chunkSize, nFrames, nChunks)
+%    baslerStartStream(cameraIndex, chunkSize, nFrames, nChunks, verbose)
+%
+
+baslerDriver('StartStream', cameraIndex, varargin{:});
+
+end
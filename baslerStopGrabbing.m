@@ -0,0 +1,17 @@
+function baslerStopGrabbing(cameraIndex, varargin)
+% baslerStopGrabbing.m - Stop grabbing continuously in the background
+%
+%  Stops the acquisition started with baslerStartGrabbing. The camera
+%  stays open.
+%
+%  The optional parameter verbose (default=0) enables the output of
+%  internal information to the workspace.
+%
+%  Usage:
+%    baslerStopGrabbing(cameraIndex)
+%    baslerStopGrabbing(cameraIndex, verbose)
+%
+
+baslerDriver('StopGrabbing', cameraIndex, varargin{:});
+
+end
@@ -0,0 +1,17 @@
+function baslerStopStream(cameraIndex, varargin)
+% baslerStopStream.m - Stop streaming frames in chunks
+%
+%  Stops a stream started by baslerStartStream. Chunks not read yet are
+%  discarded. A warning is issued if frames were dropped.
+%
+%  The optional parameter verbose (default=0) enables the output of
+%  internal information to the workspace.
+%
+%  Usage:
+%    baslerStopStream(cameraIndex)
+%    baslerStopStream(cameraIndex, verbose)
+%
+
+baslerDriver('StopStream', cameraIndex, varargin{:});
+
+end
@@ -0,0 +1,300 @@
+// baslerStream.cpp - Streaming acquisition in chunks of frames
+// see baslerStartStream.m, baslerReadStream.m and baslerStopStream.m for help
+
+#include <pylon/PylonIncludes.h>
+#include "basler_helper/basler_driver.h"
+#include "basler_helper/camera_session.h"
+#include "basler_helper/chunk_stream.h"
+#include "basler_helper/capture_images.h"
+#include "basler_helper/frame_metadata.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <matrix.h>
+#include <mex.h>
+
+
+namespace {
+
+    //---------------------------------------------------------------------
+    // Convert the frames of a chunk, if needed, and copy them into the
+    // Matlab array
+    template <typename T>
+    void copy_chunk(const BaslerHelper::StreamChunk& chunk,
+                    mxArray* mxa_output,
+                    Pylon::EPixelType ept_output_type)
+    {
+        const unsigned int i_samples_p_pixel = Pylon::SamplesPerPixel(ept_output_type);
+        const bool b_convert_image = (chunk.images[0].GetPixelType() != ept_output_type) &&
+                Pylon::CImageFormatConverter::IsSupportedOutputFormat(ept_output_type);
+        Pylon::CPylonImage im_target_image;
+        Pylon::CImageFormatConverter py_converter;
+        if(b_convert_image)
+        {
+            py_converter.OutputPixelFormat = ept_output_type;
+        }
+        const BaslerHelper::ColorConversion cc_native = BaslerHelper::native_conversion(
+                chunk.images[0].GetPixelType(), ept_output_type,
+                BaslerHelper::default_conversion(chunk.images[0].GetPixelType(), ept_output_type));
+
+        T* p_output = static_cast<T*> (mxGetData(mxa_output));
+        const unsigned long long i_height = chunk.images[0].GetHeight();
+        const unsigned long long i_width = chunk.images[0].GetWidth();
+        for(size_t i_c_frame = 0; i_c_frame < chunk.i_count; i_c_frame++)
+        {
+            BaslerHelper::copy_frame<T>(chunk.images[i_c_frame], b_convert_image ? &py_converter : NULL,
+                    im_target_image, p_output + i_c_frame * i_height * i_width * i_samples_p_pixel,
+                    i_height, i_width, i_samples_p_pixel, cc_native, ept_output_type);
+        }
+    }
+}
+
+
+//-------------------------------------------------------------------------
+// Start streaming in chunks in the background
+void baslerStartStream(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    // Parse parameters
+    if(nrhs < 1)
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "Not enough arguments. Use help baslerStartStream for further information.");
+    }
+    else if(nrhs > 5)
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "Too many arguments. Use help baslerStartStream for further information.");
+    }
+
+    // Get verbose parameter
+    bool b_verbose = 0;
+    if(nrhs >= 5 && mxGetNumberOfElements(prhs[4]) >= 1)
+    {
+        b_verbose = (int)mxGetScalar(prhs[4]) != 0;
+    }
+
+    // Get chunk size
+    int i_chunk_frames = 100;
+    if(nrhs >= 2 && mxGetNumberOfElements(prhs[1]) >= 1)
+    {
+        i_chunk_frames = (int)mxGetScalar(prhs[1]);
+    }
+    if(i_chunk_frames < 1)
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "The chunk size has to be at least 1.");
+    }
+
+    // Get number of frames, default: until stopped
+    unsigned long long i_num_of_frames = 0;
+    if(nrhs >= 3 && mxGetNumberOfElements(prhs[2]) >= 1 && !mxIsInf(mxGetScalar(prhs[2])))
+    {
+        i_num_of_frames = (unsigned long long)std::max(0.0, mxGetScalar(prhs[2]));
+    }
+
+    // Get number of chunks in the pool
+    int i_num_of_chunks = 4;
+    if(nrhs >= 4 && mxGetNumberOfElements(prhs[3]) >= 1)
+    {
+        i_num_of_chunks = (int)mxGetScalar(prhs[3]);
+    }
+    if(i_num_of_chunks < 2)
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "The pool needs at least 2 chunks.");
+    }
+
+    try
+    {
+        BaslerHelper::CameraSession* p_session = BaslerHelper::get_session(prhs[0], b_verbose);
+        p_session->start_stream(i_chunk_frames, i_num_of_chunks, i_num_of_frames);
+        if(b_verbose)
+        {
+            mexPrintf("Streaming in chunks of %d frame(s) with a pool of %d chunks\n",
+                    i_chunk_frames, i_num_of_chunks);
+        }
+    }
+    catch (GenICam::GenericException &e)
+    {
+        // Error handling.
+        mexErrMsgIdAndTxt("baslerDriver:Error:CameraError",e.GetDescription());
+    }
+}
+
+//-------------------------------------------------------------------------
+// Return the next chunk of frames
+void baslerReadStream(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    // Parse parameters
+    if(nrhs < 1)
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "Not enough arguments. Use help baslerReadStream for further information.");
+    }
+    else if(nrhs > 4)
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "Too many arguments. Use help baslerReadStream for further information.");
+    }
+
+    // Get verbose parameter
+    bool b_verbose = 0;
+    if(nrhs >= 4 && mxGetNumberOfElements(prhs[3]) >= 1)
+    {
+        b_verbose = (int)mxGetScalar(prhs[3]) != 0;
+    }
+
+    // Get output type
+    Pylon::EPixelType ept_output_type = Pylon::PixelType_Undefined;
+    if(nrhs >= 2 && !(mxGetM(prhs[1]) == 0 && mxGetN(prhs[1]) == 0))
+    {
+        ept_output_type = Pylon::CPixelTypeMapper().GetPylonPixelTypeByName(mxArrayToString(prhs[1]));
+    }
+
+    // Get timeout in seconds
+    double d_timeout = 5;
+    if(nrhs >= 3 && mxGetNumberOfElements(prhs[2]) >= 1)
+    {
+        d_timeout = std::max(0.0, mxGetScalar(prhs[2]));
+    }
+
+    try
+    {
+        BaslerHelper::CameraSession* p_session = BaslerHelper::get_session(prhs[0], b_verbose);
+        BaslerHelper::ChunkStream* p_stream = p_session->stream();
+        if(p_stream == NULL)
+        {
+            throw RUNTIME_EXCEPTION("Camera is not streaming, call baslerStartStream first.");
+        }
+
+        // Create output array, empty if no chunk is ready. Mono frames are
+        // height x width x frames without a copy by squeeze.
+        BaslerHelper::StreamChunk* p_chunk = p_stream->next((unsigned int)(d_timeout * 1000));
+        mxArray* mxa_output;
+        mxArray* mxa_metadata;
+        if(p_chunk == NULL)
+        {
+            mxa_output = mxCreateNumericMatrix(0, 0, mxUINT8_CLASS, mxREAL);
+            mxa_metadata = BaslerHelper::metadata_to_struct(BaslerHelper::FrameMetadata());
+        }
+        else
+        {
+            // Hand the chunk back also if the copy fails
+            struct ReleaseChunk
+            {
+                ~ReleaseChunk() { p_stream->release(p_chunk); }
+                BaslerHelper::ChunkStream* p_stream;
+                BaslerHelper::StreamChunk* p_chunk;
+            } release = { p_stream, p_chunk };
+
+            if(ept_output_type == Pylon::PixelType_Undefined)
+            {
+                ept_output_type = p_chunk->images[0].GetPixelType();
+            }
+            const size_t i_samples_p_pixel = Pylon::SamplesPerPixel(ept_output_type);
+            const size_t i_dimensions[] = { p_chunk->images[0].GetHeight(),
+                                            p_chunk->images[0].GetWidth(),
+                                            i_samples_p_pixel,
+                                            p_chunk->i_count};
+            const size_t i_mono_dimensions[] = { i_dimensions[0], i_dimensions[1], i_dimensions[3] };
+            const mwSize i_num_of_dims = i_samples_p_pixel == 1 ? 3 : 4;
+            const size_t* p_dimensions = i_samples_p_pixel == 1 ? i_mono_dimensions : i_dimensions;
+            if(Pylon::BitDepth(ept_output_type) <= 8)
+            {
+                mxa_output = mxCreateNumericArray(i_num_of_dims, p_dimensions, mxUINT8_CLASS, mxREAL);
+                copy_chunk<uint8_t>(*p_chunk, mxa_output, ept_output_type);
+            }
+            else if(Pylon::BitDepth(ept_output_type) <= 16)
+            {
+                mxa_output = mxCreateNumericArray(i_num_of_dims, p_dimensions, mxUINT16_CLASS, mxREAL);
+                copy_chunk<uint16_t>(*p_chunk, mxa_output, ept_output_type);
+            }
+            else
+            {
+                mxa_output = mxCreateNumericArray(i_num_of_dims, p_dimensions, mxDOUBLE_CLASS, mxREAL);
+                copy_chunk<double>(*p_chunk, mxa_output, ept_output_type);
+            }
+            mxa_metadata = BaslerHelper::metadata_to_struct(p_chunk->metadata);
+            if(b_verbose)
+            {
+                mexPrintf("Read chunk of %d frame(s)\n", (int)p_chunk->i_count);
+            }
+        }
+
+        plhs[0] = mxa_output;
+        if(nlhs >= 2)
+        {
+            plhs[1] = mxa_metadata;
+        }
+        else
+        {
+            mxDestroyArray(mxa_metadata);
+        }
+
+        // Return stream state
+        if(nlhs >= 3)
+        {
+            const char* s_fields[] = {"ended", "framesGrabbed", "framesDropped", "stalls"};
+            plhs[2] = mxCreateStructMatrix(1, 1, 4, s_fields);
+            mxSetField(plhs[2], 0, "ended", mxCreateLogicalScalar(p_stream->ended()));
+            mxSetField(plhs[2], 0, "framesGrabbed", mxCreateDoubleScalar((double)p_stream->frames_grabbed()));
+            mxSetField(plhs[2], 0, "framesDropped", mxCreateDoubleScalar((double)p_stream->frames_dropped()));
+            mxSetField(plhs[2], 0, "stalls", mxCreateDoubleScalar((double)p_stream->stalls()));
+        }
+    }
+    catch (GenICam::GenericException &e)
+    {
+        // Error handling.
+        mexErrMsgIdAndTxt("baslerDriver:Error:CameraError",e.GetDescription());
+    }
+}
+
+//-------------------------------------------------------------------------
+// Stop streaming
+void baslerStopStream(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    // Parse parameters
+    if(nrhs < 1)
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "Not enough arguments. Use help baslerStopStream for further information.");
+    }
+    else if(nrhs > 2)
+    {
+        mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                "Too many arguments. Use help baslerStopStream for further information.");
+    }
+
+    // Get verbose parameter
+    bool b_verbose = 0;
+    if(nrhs >= 2 && mxGetNumberOfElements(prhs[1]) >= 1)
+    {
+        b_verbose = (int)mxGetScalar(prhs[1]) != 0;
+    }
+
+    try
+    {
+        BaslerHelper::CameraSession* p_session = BaslerHelper::get_session(prhs[0], b_verbose);
+        BaslerHelper::ChunkStream* p_stream = p_session->stream();
+        if(p_stream != NULL)
+        {
+            if(b_verbose)
+            {
+                mexPrintf("Stopped stream after %llu frame(s), %llu dropped\n",
+                        p_stream->frames_grabbed(), p_stream->frames_dropped());
+            }
+            if(p_stream->frames_dropped() > 0)
+            {
+                mexWarnMsgIdAndTxt("baslerDriver:Warning:FramesDropped",
+                        "%llu frame(s) were dropped during capture.", p_stream->frames_dropped());
+            }
+        }
+        p_session->stop_continuous();
+    }
+    catch (GenICam::GenericException &e)
+    {
+        // Error handling.
+        mexErrMsgIdAndTxt("baslerDriver:Error:CameraError",e.GetDescription());
+    }
+}
@@ -0,0 +1,46 @@
+function info = baslerStreamData(cameraIndex, callback, varargin)
+% baslerStreamData.m - Stream frames in chunks to a callback function
+%
+%  Grabs nFrames frames (default=Inf) from the selected Basler camera and
+%  calls callback(frames, metadata) with every chunk of chunkSize
+%  (default=100) frames, see baslerReadStream. Only nChunks (default=4)
+%  chunks are held in memory, whatever the number of frames, so long
+%  recordings do not need to fit into memory. The stream is stopped when
+%  all frames are passed, on an error or on Ctrl-C.
+%
+%  The outputType specifies the desired output type, see baslerGetData.
+%
+%  The optional output info is the stream state after the last chunk,
+%  see baslerReadStream.
+%
+%  The optional parameter verbose (default=0) enables the output of
+%  internal information to the workspace.
+%
+%  Usage:
+%    baslerStreamData(cameraIndex, callback)
+%    baslerStreamData(cameraIndex, callback, chunkSize)
+%    baslerStreamData(cameraIndex, callback, chunkSize, nFrames)
+%    baslerStreamData(cameraIndex, callback, chunkSize, nFrames, outputType)
+%    baslerStreamData(cameraIndex, callback, chunkSize, nFrames, outputType, nChunks)
+%    baslerStreamData(cameraIndex, callback, chunkSize, nFrames, outputType, nChunks, verbose)
+%    info = baslerStreamData(...)
+%
+
+args = [varargin, cell(1, 5 - numel(varargin))];
+[chunkSize, nFrames, outputType, nChunks, verbose] = args{:};
+if isempty(verbose)
+    verbose = 0;
+end
+
+baslerDriver('StartStream', cameraIndex, chunkSize, nFrames, nChunks, verbose);
+cleanup = onCleanup(@() baslerDriver('StopStream', cameraIndex, verbose));
+
+info = struct('ended', false);
+while ~info.ended
+    [frames, metadata, info] = baslerDriver('ReadStream', cameraIndex, outputType, 5, verbose);
+    if ~isempty(frames)
+        callback(frames, metadata);
+    end
+end
+
+end
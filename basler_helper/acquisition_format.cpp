@@ -0,0 +1,77 @@
+// acquisition_format.cpp - Cached acquisition format of a camera
+// 17.10.2026 / agent
+
+
+#include "acquisition_format.h"
+#include "basler_set_get.h"
+#include <string>
+
+
+namespace {
+
+    // Nodes of the format, a change of any invalidates the cache
+    const char* s_format_nodes[] = {"Width", "Height", "PixelFormat", "PayloadSize"};
+}
+
+
+namespace BaslerHelper {
+
+    //---------------------------------------------------------------------
+    // Register for changes of the format nodes
+    AcquisitionFormatCache::AcquisitionFormatCache(Pylon::CInstantCamera* camera)
+        : m_camera(camera), m_b_valid(false)
+    {
+        GenApi::INodeMap& nodemap = m_camera->GetNodeMap();
+        for(size_t i = 0; i < sizeof(s_format_nodes) / sizeof(s_format_nodes[0]); i++)
+        {
+            GenApi::INode* p_node = nodemap.GetNode(s_format_nodes[i]);
+            if(p_node != NULL)
+            {
+                m_callbacks.push_back(GenApi::Register(p_node, *this, &AcquisitionFormatCache::node_changed));
+            }
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Remove the callbacks before the node map goes away with the camera
+    AcquisitionFormatCache::~AcquisitionFormatCache()
+    {
+        for(size_t i = 0; i < m_callbacks.size(); i++)
+        {
+            GenApi::Deregister(m_callbacks[i]);
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Read the format if a node changed since the last read. The cache is
+    // marked valid before reading, so a change during the read is not lost.
+    const AcquisitionFormat& AcquisitionFormatCache::get(const bool b_verbose)
+    {
+        if(!m_b_valid.exchange(true))
+        {
+            try
+            {
+                m_format.i_width = BaslerHelper::get_int(m_camera, "Width", b_verbose);
+                m_format.i_height = BaslerHelper::get_int(m_camera, "Height", b_verbose);
+                const std::string s_pixel_type = BaslerHelper::get_string(m_camera, "PixelFormat", b_verbose);
+                m_format.ept_pixel_type = Pylon::CPixelTypeMapper().GetPylonPixelTypeByName(s_pixel_type.c_str());
+                GenApi::CIntegerPtr p_payload_size = m_camera->GetNodeMap().GetNode("PayloadSize");
+                m_format.i_payload_size = GenApi::IsReadable(p_payload_size) ? p_payload_size->GetValue() : 0;
+            }
+            catch (...)
+            {
+                m_b_valid = false;
+                throw;
+            }
+        }
+        return m_format;
+    }
+
+    //---------------------------------------------------------------------
+    // Called by GenApi when a format node or one it depends on changes
+    void AcquisitionFormatCache::node_changed(GenApi::INode* /*p_node*/)
+    {
+        m_b_valid = false;
+    }
+
+}
@@ -0,0 +1,62 @@
+// acquisition_format.h - Cached acquisition format of a camera
+// 17.10.2026 / agent
+//
+// Every capture needs Width, Height, PixelFormat and PayloadSize, and
+// every read of a node can be a round trip over the control channel. The
+// cache reads them once per camera session and keeps them until GenApi
+// reports a change of one of the nodes, or of a node they depend on (e.g.
+// BinningHorizontal), through a node callback. Writes by set_parameter go
+// through the same node map and invalidate the cache as well.
+
+#ifndef __ACQUISITIONFORMAT_H_INCLUDED__
+#define __ACQUISITIONFORMAT_H_INCLUDED__
+
+#include <atomic>
+#include <vector>
+#include <pylon/PylonIncludes.h>
+
+
+namespace BaslerHelper {
+
+    //---------------------------------------------------------------------
+    // Format of the frames a camera delivers
+    struct AcquisitionFormat
+    {
+        AcquisitionFormat() : i_width(0), i_height(0), ept_pixel_type(Pylon::PixelType_Undefined), i_payload_size(0) {}
+        unsigned long long i_width;
+        unsigned long long i_height;
+        Pylon::EPixelType ept_pixel_type;
+        unsigned long long i_payload_size;  // 0 if the camera has no PayloadSize
+    };
+
+    //---------------------------------------------------------------------
+    // Acquisition format of an open camera, read again only after a change
+    class AcquisitionFormatCache
+    {
+    public:
+        // The camera has to be open and has to stay open as long as the cache
+        AcquisitionFormatCache(Pylon::CInstantCamera* camera);
+        ~AcquisitionFormatCache();
+
+        // Current format, read from the camera if it is not valid
+        const AcquisitionFormat& get(const bool b_verbose);
+
+        // Read the format again at the next call of get
+        void invalidate() { m_b_valid = false; }
+
+    private:
+        AcquisitionFormatCache(const AcquisitionFormatCache&);
+        AcquisitionFormatCache& operator=(const AcquisitionFormatCache&);
+
+        // Node callback
+        void node_changed(GenApi::INode* p_node);
+
+        Pylon::CInstantCamera* m_camera;
+        AcquisitionFormat m_format;
+        std::atomic<bool> m_b_valid;
+        std::vector<GenApi::CallbackHandleType> m_callbacks;
+    };
+
+}
+
+#endif
@@ -0,0 +1,69 @@
+// basler_driver.h - Functions of the MATLAB Basler camera driver
+// 17.10.2026 / agent
+//
+// All functions are compiled into the single MEX file baslerDriver, so
+// that they share the Pylon instance and the open camera sessions. Each
+// function gets the MEX arguments without the leading command name.
+
+#ifndef __BASLERDRIVER_H_INCLUDED__
+#define __BASLERDRIVER_H_INCLUDED__
+
+#include <matrix.h>
+
+
+// Signature of all driver functions
+typedef void (*DriverFunction)(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+
+// see baslerFindCameras.m
+void baslerFindCameras(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+
+// see baslerSetParameter.m
+void baslerSetParameter(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+
+// see baslerGetParameter.m
+void baslerGetParameter(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+
+// see baslerSetParameters.m and baslerGetParameters.m
+void baslerSetParameters(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+void baslerGetParameters(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+
+// see baslerParameterLatency.m
+void baslerParameterLatency(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+
+// see baslerGetData.m
+void baslerGetData(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+
+// see baslerGetMultiData.m
+void baslerGetMultiData(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+
+// see baslerSaveData.m
+void baslerSaveData(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+
+// see baslerCameraInfo.m
+void baslerGetRawCameraParams(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+
+// see baslerReadRaw.m
+void baslerReadRaw(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+
+// see baslerReadTiff.m
+void baslerReadTiff(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+
+// see baslerStartGrabbing.m, baslerStopGrabbing.m and baslerGetLatestData.m
+void baslerStartGrabbing(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+void baslerStopGrabbing(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+void baslerGetLatestData(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+
+// see baslerAutoExposure.m
+void baslerAutoExposure(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+
+// see baslerStartStream.m, baslerReadStream.m and baslerStopStream.m
+void baslerStartStream(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+void baslerReadStream(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+void baslerStopStream(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+
+// see baslerOpenCamera.m, baslerCloseCamera.m and baslerListCameras.m
+void baslerOpenCamera(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+void baslerCloseCamera(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+void baslerListCameras(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+
+#endif
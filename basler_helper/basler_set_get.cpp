@@ -3,10 +3,144 @@
 
 
 #include "basler_set_get.h"
+#include <algorithm>
+#include <cmath>
 #include <mex.h>
 #include <pylon/PylonIncludes.h>
 
 
+namespace {
+
+    //---------------------------------------------------------------------
+    // Value as integer, rounded if given as float
+    int64_t as_int(const BaslerHelper::ParameterValue& value)
+    {
+        return value.e_type == GenApi::intfIInteger ? value.i_value : (int64_t)floor(value.d_value + 0.5);
+    }
+
+    //---------------------------------------------------------------------
+    // Value as float
+    double as_float(const BaslerHelper::ParameterValue& value)
+    {
+        return value.e_type == GenApi::intfIInteger ? (double)value.i_value : value.d_value;
+    }
+
+    //---------------------------------------------------------------------
+    // Set one node, converting the value to the node's type
+    void set_node(GenApi::INodeMap& nodemap, const std::string& s_param_name, const BaslerHelper::ParameterValue& value)
+    {
+        GenApi::INode* p_node = nodemap.GetNode(s_param_name.c_str());
+        if(p_node == NULL)
+        {
+            throw RUNTIME_EXCEPTION("Parameter does not exist.");
+        }
+        if(!IsWritable(p_node))
+        {
+            throw RUNTIME_EXCEPTION("Parameter not writable.");
+        }
+
+        const bool b_is_string = (value.e_type == GenApi::intfIString);
+        switch(p_node->GetPrincipalInterfaceType())
+        {
+            case GenApi::intfIInteger:
+            {
+                GenApi::CIntegerPtr p_parameter(p_node);
+                if(b_is_string) p_parameter->FromString(value.s_value.c_str());
+                else            p_parameter->SetValue(as_int(value));
+                break;
+            }
+            case GenApi::intfIFloat:
+            {
+                GenApi::CFloatPtr p_parameter(p_node);
+                if(b_is_string) p_parameter->FromString(value.s_value.c_str());
+                else            p_parameter->SetValue(as_float(value));
+                break;
+            }
+            case GenApi::intfIBoolean:
+            {
+                GenApi::CBooleanPtr p_parameter(p_node);
+                if(b_is_string) p_parameter->FromString(value.s_value.c_str());
+                else            p_parameter->SetValue(as_float(value) != 0);
+                break;
+            }
+            case GenApi::intfIEnumeration:
+            {
+                GenApi::CEnumerationPtr p_parameter(p_node);
+                if(b_is_string) p_parameter->FromString(value.s_value.c_str());
+                else            p_parameter->SetIntValue(as_int(value));
+                break;
+            }
+            case GenApi::intfIString:
+            {
+                GenApi::CStringPtr p_parameter(p_node);
+                if(!b_is_string)
+                {
+                    throw RUNTIME_EXCEPTION("Parameter needs a string.");
+                }
+                p_parameter->SetValue(value.s_value.c_str());
+                break;
+            }
+            case GenApi::intfICommand:
+            {
+                GenApi::CCommandPtr p_parameter(p_node);
+                p_parameter->Execute();
+                break;
+            }
+            default:
+                throw RUNTIME_EXCEPTION("Parameter type not supported.");
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Order of the parameters: 0 changes the sensor format, 1 is the size
+    // of the ROI, 2 its offset, 3 all others
+    int parameter_stage(const std::string& s_param_name)
+    {
+        if(s_param_name == "PixelFormat" || s_param_name.compare(0, 7, "Binning") == 0
+                || s_param_name.compare(0, 10, "Decimation") == 0)
+        {
+            return 0;
+        }
+        if(s_param_name == "Width" || s_param_name == "Height")
+        {
+            return 1;
+        }
+        if(s_param_name == "OffsetX" || s_param_name == "OffsetY")
+        {
+            return 2;
+        }
+        return 3;
+    }
+
+    //---------------------------------------------------------------------
+    // Move an offset to zero if the new size does not fit with it, or
+    // always if b_always is set. Returns true if the offset was moved.
+    bool clear_offset(GenApi::INodeMap& nodemap, const char* s_size_name, const char* s_offset_name,
+                      const int64_t i_new_size, const bool b_always)
+    {
+        GenApi::CIntegerPtr p_size = nodemap.GetNode(s_size_name);
+        GenApi::CIntegerPtr p_offset = nodemap.GetNode(s_offset_name);
+        if(!p_size.IsValid() || !p_offset.IsValid() || !IsWritable(p_offset)
+                || (!b_always && i_new_size <= p_size->GetMax()))
+        {
+            return false;
+        }
+        p_offset->SetValue(p_offset->GetMin());
+        return true;
+    }
+
+    //---------------------------------------------------------------------
+    // Put a moved offset back, as close as the new size allows
+    void restore_offset(GenApi::INodeMap& nodemap, const char* s_offset_name, const int64_t i_old_offset)
+    {
+        GenApi::CIntegerPtr p_offset = nodemap.GetNode(s_offset_name);
+        const int64_t i_inc = std::max<int64_t>(p_offset->GetInc(), 1);
+        const int64_t i_offset = std::min(i_old_offset, p_offset->GetMax());
+        p_offset->SetValue(i_offset - (i_offset - p_offset->GetMin()) % i_inc);
+    }
+}
+
+
 namespace BaslerHelper {
     //---------------------------------------------------------------------
     // Set float parameter
@@ -141,8 +275,168 @@ namespace BaslerHelper {
         }
         
         return p_parameter->GetValue();
-    } 
-    
-    
+    }
+
+    //---------------------------------------------------------------------
+    // Read a node by its principal interface type
+    ParameterValue get_value(GenApi::INode* p_node)
+    {
+        ParameterValue value;
+        value.e_type = p_node->GetPrincipalInterfaceType();
+        switch(value.e_type)
+        {
+            case GenApi::intfIInteger:
+                value.i_value = GenApi::CIntegerPtr(p_node)->GetValue();
+                value.d_value = (double)value.i_value;
+                break;
+            case GenApi::intfIFloat:
+                value.d_value = GenApi::CFloatPtr(p_node)->GetValue();
+                break;
+            case GenApi::intfIBoolean:
+                value.d_value = GenApi::CBooleanPtr(p_node)->GetValue() ? 1 : 0;
+                break;
+            default:
+                value.s_value = GenApi::CValuePtr(p_node)->ToString().c_str();
+                break;
+        }
+        return value;
+    }
+
+    //---------------------------------------------------------------------
+    // Set many parameters in dependency-safe order
+    std::vector<ParameterStatus> set_parameters(Pylon::CInstantCamera* p_camera,
+                                                const std::vector<std::string>& s_param_names,
+                                                const std::vector<ParameterValue>& new_values,
+                                                const bool b_verbose)
+    {
+        GenApi::INodeMap& nodemap = p_camera->GetNodeMap();
+        std::vector<ParameterStatus> status(s_param_names.size());
+
+        // Stable order by stage keeps selectors in front of their values.
+        // The sizes of the ROI are set before its offsets, whatever order
+        // the caller used, so an offset never limits the new size.
+        std::vector<size_t> i_order(s_param_names.size());
+        for(size_t i = 0; i < i_order.size(); i++)
+        {
+            i_order[i] = i;
+            status[i].s_name = s_param_names[i];
+        }
+        std::stable_sort(i_order.begin(), i_order.end(), [&](size_t a, size_t b)
+                { return parameter_stage(s_param_names[a]) < parameter_stage(s_param_names[b]); });
+
+        // Offsets which have to make room for a growing ROI
+        const char* s_sizes[] = {"Width", "Height"};
+        const char* s_offsets[] = {"OffsetX", "OffsetY"};
+        bool b_offset_given[] = {false, false};
+        bool b_offset_moved[] = {false, false};
+        int64_t i_old_offset[] = {0, 0};
+        for(size_t i = 0; i < s_param_names.size(); i++)
+        {
+            for(int i_axis = 0; i_axis < 2; i_axis++)
+            {
+                b_offset_given[i_axis] = b_offset_given[i_axis] || (s_param_names[i] == s_offsets[i_axis]);
+            }
+        }
+
+        for(size_t k = 0; k < i_order.size(); k++)
+        {
+            const size_t i = i_order[k];
+            try
+            {
+                for(int i_axis = 0; i_axis < 2; i_axis++)
+                {
+                    if(s_param_names[i] == s_sizes[i_axis] && !b_offset_moved[i_axis])
+                    {
+                        GenApi::CIntegerPtr p_offset = nodemap.GetNode(s_offsets[i_axis]);
+                        const int64_t i_offset = (p_offset.IsValid() && IsReadable(p_offset)) ? p_offset->GetValue() : 0;
+                        // A given offset is set after the size anyway, so it
+                        // is always zeroed first
+                        if(clear_offset(nodemap, s_sizes[i_axis], s_offsets[i_axis], as_int(new_values[i]),
+                                        b_offset_given[i_axis]))
+                        {
+                            b_offset_moved[i_axis] = true;
+                            i_old_offset[i_axis] = i_offset;
+                        }
+                    }
+                }
+
+                set_node(nodemap, s_param_names[i], new_values[i]);
+                status[i].b_success = true;
+                if(b_verbose)
+                {
+                    printf("Set Parameter \"%s\"\n", s_param_names[i].c_str());
+                }
+            }
+            catch (GenICam::GenericException &e)
+            {
+                status[i].s_message = e.GetDescription();
+                if(b_verbose)
+                {
+                    printf("Cannot set Parameter \"%s\": %s\n", s_param_names[i].c_str(), e.GetDescription());
+                }
+            }
+        }
+
+        // Put back offsets which were only moved to make room
+        for(int i_axis = 0; i_axis < 2; i_axis++)
+        {
+            if(b_offset_moved[i_axis] && !b_offset_given[i_axis])
+            {
+                try
+                {
+                    restore_offset(nodemap, s_offsets[i_axis], i_old_offset[i_axis]);
+                }
+                catch (GenICam::GenericException &e)
+                {
+                    // Offset stays at zero
+                }
+            }
+        }
+
+        return status;
+    }
+
+    //---------------------------------------------------------------------
+    // Get many parameters
+    std::vector<ParameterStatus> get_parameters(Pylon::CInstantCamera* p_camera,
+                                                const std::vector<std::string>& s_param_names,
+                                                std::vector<ParameterValue>& values,
+                                                const bool b_verbose)
+    {
+        GenApi::INodeMap& nodemap = p_camera->GetNodeMap();
+        std::vector<ParameterStatus> status(s_param_names.size());
+        values.assign(s_param_names.size(), ParameterValue());
+
+        for(size_t i = 0; i < s_param_names.size(); i++)
+        {
+            status[i].s_name = s_param_names[i];
+            try
+            {
+                GenApi::INode* p_node = nodemap.GetNode(s_param_names[i].c_str());
+                if(p_node == NULL)
+                {
+                    throw RUNTIME_EXCEPTION("Parameter does not exist.");
+                }
+                if(!IsReadable(p_node))
+                {
+                    throw RUNTIME_EXCEPTION("Parameter not readable.");
+                }
+
+                values[i] = get_value(p_node);
+                status[i].b_success = true;
+                if(b_verbose)
+                {
+                    printf("Read Parameter \"%s\": %s\n", s_param_names[i].c_str(),
+                            GenApi::CValuePtr(p_node)->ToString().c_str());
+                }
+            }
+            catch (GenICam::GenericException &e)
+            {
+                status[i].s_message = e.GetDescription();
+            }
+        }
+
+        return status;
+    }
 
-}
\ No newline at end of file
+}
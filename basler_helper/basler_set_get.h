@@ -5,11 +5,33 @@
 #define __BASLERSETGET_H_INCLUDED__
 
 #include <string>
+#include <vector>
+#include <stdint.h>
 #include <pylon/PylonIncludes.h>
 
 
 namespace BaslerHelper {
 
+    // Value of a parameter in a batch. The type is the one of the Matlab
+    // value when setting and the one of the camera node when getting.
+    struct ParameterValue
+    {
+        ParameterValue() : e_type(GenApi::intfIValue), i_value(0), d_value(0) {}
+        GenApi::EInterfaceType e_type;
+        int64_t i_value;            // intfIInteger
+        double d_value;             // intfIFloat, intfIBoolean
+        std::string s_value;        // intfIString, intfIEnumeration
+    };
+
+    // Result of setting or getting one parameter in a batch
+    struct ParameterStatus
+    {
+        ParameterStatus() : b_success(false) {}
+        std::string s_name;
+        bool b_success;
+        std::string s_message;
+    };
+
     // Set float parameter
     void set_parameter( Pylon::CInstantCamera* p_camera, 
                         const char* s_param_name, 
@@ -54,6 +76,30 @@ namespace BaslerHelper {
                         const char* s_param_name, 
                         const bool b_verbose);
     
+    // Read a node into a value of the node's type. Enumerations and all
+    // other types are read as string.
+    ParameterValue get_value(GenApi::INode* p_node);
+
+    // Set many parameters, the type of each is taken from its node. The
+    // parameters which change the sensor format are set first, then the
+    // size of the ROI, then its offset, then all others in the given order.
+    // Given offsets are zeroed before the size is set, others are only
+    // moved out of the way if the size grows and put back afterwards. A
+    // failing parameter does not stop the others, the status is returned
+    // in the given order.
+    std::vector<ParameterStatus> set_parameters(
+                        Pylon::CInstantCamera* p_camera,
+                        const std::vector<std::string>& s_param_names,
+                        const std::vector<ParameterValue>& new_values,
+                        const bool b_verbose);
+
+    // Get many parameters, the type of each is taken from its node
+    std::vector<ParameterStatus> get_parameters(
+                        Pylon::CInstantCamera* p_camera,
+                        const std::vector<std::string>& s_param_names,
+                        std::vector<ParameterValue>& values,
+                        const bool b_verbose);
+    
 }
 
 #endif 
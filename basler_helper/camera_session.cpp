@@ -0,0 +1,280 @@
+// camera_session.cpp - Persistent camera sessions for Basler cameras
+// 17.10.2026 / agent
+
+
+#include "camera_session.h"
+#include <map>
+#include <memory>
+#include <mex.h>
+#include <pylon/PylonIncludes.h>
+
+
+namespace {
+
+    // Module state, lives until the MEX file is cleared
+    bool b_pylon_initialized = false;
+    bool b_devices_valid = false;
+    Pylon::DeviceInfoList_t dil_devices;
+    std::map<std::string, std::unique_ptr<BaslerHelper::CameraSession> > m_sessions;
+
+    //---------------------------------------------------------------------
+    // Close all cameras and terminate Pylon when the MEX file is cleared
+    void at_exit()
+    {
+        m_sessions.clear();
+        dil_devices.clear();
+        b_devices_valid = false;
+        if(b_pylon_initialized)
+        {
+            Pylon::PylonTerminate();
+            b_pylon_initialized = false;
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Keep the MEX file in memory as long as cameras are open
+    void update_lock()
+    {
+        if(!m_sessions.empty() && !mexIsLocked())
+        {
+            mexLock();
+        }
+        else if(m_sessions.empty() && mexIsLocked())
+        {
+            mexUnlock();
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Find the serial number of a camera given by index or serial number
+    std::string find_serial_number(const mxArray* mxa_camera)
+    {
+        if(mxIsChar(mxa_camera))
+        {
+            // Copy the string and free the copy made by mxArrayToString
+            char* s_chars = mxArrayToString(mxa_camera);
+            const std::string s_serial_number(s_chars != NULL ? s_chars : "");
+            mxFree(s_chars);
+            return s_serial_number;
+        }
+
+        const int i_cam_number = (int)mxGetScalar(mxa_camera);
+        if(i_cam_number < 0)
+        {
+            throw RUNTIME_EXCEPTION("No camera with this index exists.");
+        }
+
+        // Re-enumerate once if the index is not known yet
+        const Pylon::DeviceInfoList_t* p_devices = &BaslerHelper::get_devices(false);
+        if((size_t)i_cam_number >= p_devices->size())
+        {
+            p_devices = &BaslerHelper::get_devices(true);
+        }
+        if(p_devices->empty())
+        {
+            throw RUNTIME_EXCEPTION("No camera found.");
+        }
+        if((size_t)i_cam_number >= p_devices->size())
+        {
+            throw RUNTIME_EXCEPTION("No camera with this index exists.");
+        }
+
+        return std::string((*p_devices)[i_cam_number].GetSerialNumber().c_str());
+    }
+
+    //---------------------------------------------------------------------
+    // Find the device info of a camera given by serial number
+    const Pylon::CDeviceInfo& find_device(const std::string& s_serial_number)
+    {
+        for(int i_refresh = 0; i_refresh < 2; i_refresh++)
+        {
+            const Pylon::DeviceInfoList_t& devices = BaslerHelper::get_devices(i_refresh > 0);
+            for(size_t i = 0; i < devices.size(); i++)
+            {
+                if(s_serial_number == devices[i].GetSerialNumber().c_str())
+                {
+                    return devices[i];
+                }
+            }
+        }
+        throw RUNTIME_EXCEPTION("No camera with this serial number exists.");
+    }
+}
+
+
+namespace BaslerHelper {
+
+    //---------------------------------------------------------------------
+    // Create camera object and open camera
+    CameraSession::CameraSession(const Pylon::CDeviceInfo& di_device)
+    {
+        m_camera.Attach(Pylon::CTlFactory::GetInstance().CreateDevice(di_device));
+        m_camera.Open();
+        m_format.reset(new AcquisitionFormatCache(&m_camera));
+        m_nodes.reset(new NodeCache(&m_camera.GetNodeMap()));
+    }
+
+    //---------------------------------------------------------------------
+    // Close camera, the device is destroyed by the CInstantCamera
+    CameraSession::~CameraSession()
+    {
+        try
+        {
+            m_continuous.reset();
+            m_stream.reset();
+            m_format.reset();
+            m_nodes.reset();
+            if(m_camera.IsGrabbing())
+            {
+                m_camera.StopGrabbing();
+            }
+            m_camera.Close();
+        }
+        catch (GenICam::GenericException &e)
+        {
+            // Nothing left to do for a camera which cannot be closed
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Serial number of the session's camera
+    std::string CameraSession::serial_number() const
+    {
+        return std::string(m_camera.GetDeviceInfo().GetSerialNumber().c_str());
+    }
+
+    //---------------------------------------------------------------------
+    // Start grabbing into the ring buffer
+    ContinuousGrab* CameraSession::start_continuous(const size_t i_buffer_size,
+                                                    const Pylon::EGrabStrategy egs_strategy)
+    {
+        stop_continuous();
+        m_continuous.reset(new ContinuousGrab(&m_camera, i_buffer_size, egs_strategy));
+        return m_continuous.get();
+    }
+
+    //---------------------------------------------------------------------
+    // Stop the continuous grab or stream, the camera can only grab once at
+    // a time
+    void CameraSession::stop_continuous()
+    {
+        m_continuous.reset();
+        m_stream.reset();
+    }
+
+    //---------------------------------------------------------------------
+    // Start streaming in chunks
+    ChunkStream* CameraSession::start_stream(   const size_t i_chunk_frames,
+                                                const size_t i_num_of_chunks,
+                                                const unsigned long long i_num_of_frames)
+    {
+        stop_continuous();
+        std::unique_ptr<FrameSource> p_source(new PylonSource(&m_camera, false, m_format.get()));
+        m_stream.reset(new ChunkStream(std::move(p_source), i_chunk_frames, i_num_of_chunks, i_num_of_frames));
+        return m_stream.get();
+    }
+
+    //---------------------------------------------------------------------
+    // Initialize Pylon, if not done yet
+    void init_pylon()
+    {
+        if(!b_pylon_initialized)
+        {
+            Pylon::PylonInitialize();
+            mexAtExit(at_exit);
+            b_pylon_initialized = true;
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Get list of attached devices
+    const Pylon::DeviceInfoList_t& get_devices(const bool b_refresh)
+    {
+        init_pylon();
+        if(b_refresh || !b_devices_valid)
+        {
+            dil_devices.clear();
+            Pylon::CTlFactory::GetInstance().EnumerateDevices(dil_devices);
+            b_devices_valid = true;
+        }
+        return dil_devices;
+    }
+
+    //---------------------------------------------------------------------
+    // Get session of the camera, open camera if needed
+    CameraSession* get_session(const mxArray* mxa_camera, const bool b_verbose)
+    {
+        init_pylon();
+        const std::string s_serial_number = find_serial_number(mxa_camera);
+
+        // Reuse open camera, unless it has been disconnected in between
+        auto it = m_sessions.find(s_serial_number);
+        if(it != m_sessions.end())
+        {
+            if(!it->second->camera()->IsCameraDeviceRemoved())
+            {
+                return it->second.get();
+            }
+            m_sessions.erase(it);
+            b_devices_valid = false;
+        }
+
+        // Open a new session
+        std::unique_ptr<CameraSession> p_session(new CameraSession(find_device(s_serial_number)));
+        CameraSession* p_result = p_session.get();
+        m_sessions[s_serial_number] = std::move(p_session);
+        update_lock();
+
+        if(b_verbose)
+        {
+            mexPrintf("Opened camera \"%s\" (%s)\n",
+                    p_result->camera()->GetDeviceInfo().GetModelName().c_str(),
+                    s_serial_number.c_str());
+        }
+        return p_result;
+    }
+
+    //---------------------------------------------------------------------
+    // Close session of the camera
+    void close_session(const mxArray* mxa_camera, const bool b_verbose)
+    {
+        init_pylon();
+        const std::string s_serial_number = find_serial_number(mxa_camera);
+
+        if(m_sessions.erase(s_serial_number) > 0 && b_verbose)
+        {
+            mexPrintf("Closed camera %s\n", s_serial_number.c_str());
+        }
+        update_lock();
+    }
+
+    //---------------------------------------------------------------------
+    // Close all sessions
+    void close_all_sessions(const bool b_verbose)
+    {
+        if(b_verbose)
+        {
+            mexPrintf("Closing %d camera(s)\n", (int)m_sessions.size());
+        }
+        m_sessions.clear();
+        update_lock();
+    }
+
+    //---------------------------------------------------------------------
+    // Cell array with serial number and model name of all open cameras
+    mxArray* list_sessions()
+    {
+        mxArray* mxa_output = mxCreateCellMatrix(m_sessions.size(),2);
+
+        int i=0;
+        for(auto it = m_sessions.begin(); it != m_sessions.end(); ++it)
+        {
+            mxSetCell(mxa_output,i,mxCreateString(it->first.c_str()));
+            mxSetCell(mxa_output,i+m_sessions.size(),mxCreateString(
+                    it->second->camera()->GetDeviceInfo().GetModelName().c_str()));
+            i++;
+        }
+        return mxa_output;
+    }
+
+}
@@ -0,0 +1,98 @@
+// camera_session.h - Persistent camera sessions for Basler cameras
+// 17.10.2026 / agent
+//
+// Pylon is initialized once and every camera stays open between calls
+// into the driver. The sessions live as long as the MEX module, which is
+// locked while at least one camera is open.
+
+#ifndef __CAMERASESSION_H_INCLUDED__
+#define __CAMERASESSION_H_INCLUDED__
+
+#include <memory>
+#include <string>
+#include <pylon/PylonIncludes.h>
+#include "continuous_grab.h"
+#include "chunk_stream.h"
+#include "acquisition_format.h"
+#include "node_cache.h"
+#include <matrix.h>
+
+
+namespace BaslerHelper {
+
+    //---------------------------------------------------------------------
+    // An opened camera which is kept alive between driver calls
+    class CameraSession
+    {
+    public:
+        CameraSession(const Pylon::CDeviceInfo& di_device);
+        ~CameraSession();
+
+        // Camera of this session
+        Pylon::CInstantCamera* camera() { return &m_camera; }
+
+        // Cached Width, Height, PixelFormat and PayloadSize of the camera
+        AcquisitionFormatCache* format() { return m_format.get(); }
+
+        // Node handles of the camera, looked up once per session
+        NodeCache* nodes() { return m_nodes.get(); }
+
+        // Serial number, used as key of the session
+        std::string serial_number() const;
+
+        // Start grabbing into a ring buffer of i_buffer_size frames in the
+        // background, a running continuous grab or stream is restarted
+        ContinuousGrab* start_continuous(const size_t i_buffer_size,
+                                         const Pylon::EGrabStrategy egs_strategy);
+
+        // Stop the continuous grab or stream, if running
+        void stop_continuous();
+
+        // Running continuous grab or NULL
+        ContinuousGrab* continuous() { return m_continuous.get(); }
+
+        // Start streaming i_num_of_frames frames (0: until stopped) in
+        // chunks of i_chunk_frames frames, see ChunkStream
+        ChunkStream* start_stream(  const size_t i_chunk_frames,
+                                    const size_t i_num_of_chunks,
+                                    const unsigned long long i_num_of_frames);
+
+        // Running stream or NULL
+        ChunkStream* stream() { return m_stream.get(); }
+
+    private:
+        CameraSession(const CameraSession&);
+        CameraSession& operator=(const CameraSession&);
+
+        Pylon::CInstantCamera m_camera;
+        std::unique_ptr<AcquisitionFormatCache> m_format;
+        std::unique_ptr<NodeCache> m_nodes;
+        std::unique_ptr<ContinuousGrab> m_continuous;
+        std::unique_ptr<ChunkStream> m_stream;
+    };
+
+    // Initialize Pylon, if not done yet
+    void init_pylon();
+
+    // Get list of attached devices. The list is cached, unless a refresh
+    // is requested.
+    const Pylon::DeviceInfoList_t& get_devices(const bool b_refresh);
+
+    // Get session of the camera given by index or serial number. The
+    // camera is opened if there is no session yet.
+    CameraSession* get_session( const mxArray* mxa_camera,
+                                const bool b_verbose);
+
+    // Close session of the camera given by index or serial number
+    void close_session( const mxArray* mxa_camera,
+                        const bool b_verbose);
+
+    // Close all sessions
+    void close_all_sessions(const bool b_verbose);
+
+    // Cell array with serial number and model name of all open cameras
+    mxArray* list_sessions();
+
+}
+
+#endif
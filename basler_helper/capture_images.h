@@ -7,151 +7,1032 @@
 
 #include <pylon/PylonIncludes.h>
 #include <mex.h>
+#include "frame_source.h"
+#include "frame_metadata.h"
+#include "transpose_image.h"
+#include "debayer_image.h"
+#include "unpack_image.h"
+#include "crop_image.h"
+#include "frame_reduce.h"
+#include "trigger_capture.h"
+#include "telemetry.h"
+#include "grab_options.h"
+#include "frame_queue.h"
+#include "raw_stream.h"
+#include "compressed_stream.h"
+#include <cstring>
+#include <memory>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include <boost/filesystem.hpp>
 #include <boost/format.hpp>
 
 namespace BaslerHelper {
 
     //---------------------------------------------------------------------
-    // Captures the specified number of images from the camera and saves
-    // those in the (already existing!) Matlab mxArray.
+    // A grabbed frame on its way from the grab thread to a worker
+    struct GrabbedFrame
+    {
+        GrabbedFrame() : i_frame(-1) {}
+        SourceFrame source_frame;
+        int i_frame;
+    };
+    
+    //---------------------------------------------------------------------
+    // Signals the end of grabbing and joins the worker threads when going
+    // out of scope, also if the grab loop is left by an exception
+    struct JoinThreads
+    {
+        JoinThreads(std::vector<std::thread>& workers, std::atomic<bool>& b_grab_done)
+            : workers(workers), b_grab_done(b_grab_done) {}
+        ~JoinThreads()
+        {
+            b_grab_done.store(true, std::memory_order_release);
+            for(size_t i = 0; i < workers.size(); i++)
+            {
+                workers[i].join();
+            }
+            workers.clear();
+        }
+        std::vector<std::thread>& workers;
+        std::atomic<bool>& b_grab_done;
+    };
+    
+    //---------------------------------------------------------------------
+    // Stops grabbing of a source when going out of scope, also if an error
+    // ends the capture
+    struct StopGrabbing
+    {
+        StopGrabbing(FrameSource* source) : source(source) {}
+        ~StopGrabbing()
+        {
+            try
+            {
+                source->stop_grabbing();
+            }
+            catch (...)
+            {
+                // Camera may have been removed
+            }
+        }
+        FrameSource* source;
+    };
+    
+    //---------------------------------------------------------------------
+    // Arms the trigger of a source, if any, until it goes out of scope.
+    // Grabbing is stopped before the trigger is disarmed.
+    struct ArmedTrigger
+    {
+        ArmedTrigger(FrameSource* source, const TriggerSettings& trigger)
+            : source(trigger.triggered() ? source : NULL)
+        {
+            if(this->source != NULL)
+            {
+                this->source->arm_trigger(trigger);
+            }
+        }
+        ~ArmedTrigger()
+        {
+            if(source != NULL)
+            {
+                try
+                {
+                    source->stop_grabbing();
+                    source->disarm_trigger();
+                }
+                catch (...)
+                {
+                }
+            }
+        }
+        FrameSource* source;
+    };
+    
+    //---------------------------------------------------------------------
+    // Send the software trigger of the frame, if any, and retrieve it.
+    // Returns the start of its latency, the trigger or the arrival. Throws
+    // a timeout exception if the frame does not arrive in time.
+    inline std::chrono::steady_clock::time_point retrieve_frame(FrameSource* source,
+                                                                const TriggerSettings& trigger,
+                                                                SourceFrame& frame)
+    {
+        if(trigger.software())
+        {
+            const std::chrono::steady_clock::time_point tp_trigger =
+                    source->execute_software_trigger(trigger.i_timeout_ms);
+            source->retrieve(trigger.i_timeout_ms, frame);
+            return tp_trigger;
+        }
+        source->retrieve(trigger.i_timeout_ms, frame);
+        return std::chrono::steady_clock::now();
+    }
+    
+    //---------------------------------------------------------------------
+    // Run a grab loop in the dedicated grab thread, if there is one, else
+    // in the calling thread
+    template <typename F>
+    void run_grab_loop(GrabThread* p_grab_thread, F f)
+    {
+        if(p_grab_thread != NULL)
+        {
+            p_grab_thread->run(f);
+        }
+        else
+        {
+            f();
+        }
+    }
+    
+    //---------------------------------------------------------------------
+    // Pause of the grab loop while it waits for a worker or writer. The
+    // grab thread may run at a real-time priority, where a yield does not
+    // let the other threads on its CPU run, so it sleeps briefly instead.
+    inline void wait_for_consumer()
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+    
+    //---------------------------------------------------------------------
+    // Color conversion if none is selected: Pylon's converter for Bayer
+    // and mono frames to RGB, as long as the native kernels are not shown
+    // to give the same colors faster. Frames which are only copied or
+    // unpacked use the native kernels.
+    inline ColorConversion default_conversion(  const Pylon::EPixelType ept_input_type,
+                                                const Pylon::EPixelType ept_output_type)
+    {
+        return Pylon::SamplesPerPixel(ept_output_type) > Pylon::SamplesPerPixel(ept_input_type) ?
+                ColorConversion_Pylon : ColorConversion_Bilinear;
+    }
+    
+    //---------------------------------------------------------------------
+    // Color conversion used for a frame: cc_method if there is a native
+    // kernel for the formats, else Pylon's converter. Packed frames kept
+    // in their format cannot be copied as they are and are always
+    // unpacked natively.
+    inline ColorConversion native_conversion(   const Pylon::EPixelType ept_input_type,
+                                                const Pylon::EPixelType ept_output_type,
+                                                const ColorConversion cc_method)
+    {
+        if(!can_convert_native(ept_input_type, ept_output_type))
+        {
+            return ColorConversion_Pylon;
+        }
+        if(cc_method == ColorConversion_Pylon && ept_input_type == ept_output_type)
+        {
+            return ColorConversion_Bilinear;
+        }
+        return cc_method;
+    }
+    
+    //---------------------------------------------------------------------
+    // Converts a grabbed frame, if needed, and copies it into its slice of
+    // the Matlab array. With a native cc_native, the frame is converted
+    // to ept_output_type straight into the Matlab array instead.
+    template <typename T>
+    void copy_frame(    const Pylon::IImage& im_frame,
+                        Pylon::CImageFormatConverter* py_converter,
+                        Pylon::CPylonImage& im_target_image,
+                        T* p_frame_output,
+                        const unsigned long long i_height,
+                        const unsigned long long i_width,
+                        const unsigned int i_samples_p_pixel,
+                        const ColorConversion cc_native = ColorConversion_Pylon,
+                        const Pylon::EPixelType ept_output_type = Pylon::PixelType_Undefined,
+                        ThreadTelemetry* p_thread_telemetry = NULL)
+    {
+        if(cc_native != ColorConversion_Pylon)
+        {
+            StageTimer timer(p_thread_telemetry, Stage_Convert);
+            convert_native(im_frame.GetBuffer(), im_frame.GetPixelType(), p_frame_output,
+                    ept_output_type, (size_t)i_height, (size_t)i_width, cc_native);
+            return;
+        }
+        
+        T* p_image_buffer;
+        if(py_converter != NULL)
+        {
+            StageTimer timer(p_thread_telemetry, Stage_Convert);
+            py_converter->Convert(im_target_image, im_frame);
+            p_image_buffer = static_cast<T*> (im_target_image.GetBuffer());
+        }
+        else
+        {
+            p_image_buffer = static_cast<T*> (const_cast<void*> (im_frame.GetBuffer()));
+        }
+        
+        // Save pixels to buffer: transpose to column-major and
+        // split color bands
+        StageTimer timer(p_thread_telemetry, Stage_Copy);
+        BaslerHelper::transpose_image(p_image_buffer, p_frame_output,
+                i_height, i_width, i_samples_p_pixel);
+    }
+    
+    //---------------------------------------------------------------------
+    // Converts a grabbed frame, if needed, and returns it row-major with
+    // interleaved bands, for cropping or reducing. Packed frames are
+    // unpacked into the buffer unpacked, other conversions are done by
+    // Pylon's converter.
     template <typename T>
-    void capture_images(    Pylon::CInstantCamera* camera, 
+    const T* row_major_frame(   const Pylon::IImage& im_frame,
+                                Pylon::CImageFormatConverter* py_converter,
+                                Pylon::CPylonImage& im_target_image,
+                                std::vector<uint16_t>& unpacked,
+                                const Pylon::EPixelType ept_output_type,
+                                const unsigned long long i_height,
+                                const unsigned long long i_width,
+                                const unsigned int i_samples_p_pixel)
+    {
+        Pylon::EPixelType ept_unpacked_type;
+        if(unpacked_format(im_frame.GetPixelType(), ept_unpacked_type) && i_samples_p_pixel == 1 &&
+                can_convert_native(im_frame.GetPixelType(), ept_output_type))
+        {
+            unpacked.resize((size_t)(i_height * i_width));
+            unpack_rows(im_frame.GetBuffer(), im_frame.GetPixelType(), &unpacked[0], (size_t)i_height, (size_t)i_width,
+                    ept_output_type == Pylon::PixelType_Mono16 ? 16 - packed_bit_depth(im_frame.GetPixelType()) : 0);
+            return reinterpret_cast<const T*> (&unpacked[0]);
+        }
+        else if(py_converter != NULL)
+        {
+            py_converter->Convert(im_target_image, im_frame);
+            return static_cast<const T*> (im_target_image.GetBuffer());
+        }
+        return static_cast<const T*> (im_frame.GetBuffer());
+    }
+    
+    //---------------------------------------------------------------------
+    // Number of frames lost between two grab results. The block ID is
+    // counted up by the camera, it is 0 if not supported.
+    inline int lost_frames(const unsigned long long i_block_id, unsigned long long& i_last_block_id)
+    {
+        int i_lost = 0;
+        if(i_block_id != 0 && i_last_block_id != 0 && i_block_id > i_last_block_id + 1)
+        {
+            i_lost = (int)(i_block_id - i_last_block_id - 1);
+        }
+        i_last_block_id = i_block_id;
+        return i_lost;
+    }
+    
+    //---------------------------------------------------------------------
+    // Captures the specified number of images from the source and saves
+    // those in p_output, which holds height x width x samples x frames
+    // values. The calling thread only retrieves the grab results,
+    // conversion and copy are done by i_num_of_workers threads. With 0
+    // workers, everything runs in the calling thread. Returns the number
+    // of dropped frames. The metadata of every frame is stored in
+    // p_metadata, if given. Bayer and mono frames are converted to RGB by
+    // the native kernels of cc_method, where they support the formats.
+    // With p_crop, only its windows are copied into its outputs, with
+    // p_accumulator, the frames are only added to it. p_output is not used
+    // in both cases. p_trigger arms the source's trigger and sets the
+    // timeout policy, without it the source runs free and a timeout of
+    // 5 s is an error. The latency of every stored frame is measured into
+    // p_latency, if given, the time of every stage into p_telemetry. The
+    // frames are retrieved in p_grab_thread, if given. No Matlab function
+    // is called, so this can run in any thread.
+    template <typename T>
+    int capture_images(     FrameSource* source, 
                             const int i_num_of_frames, 
-                            mxArray* mxa_output, 
+                            T* p_output, 
                             Pylon::EPixelType ept_output_type,
-                            bool b_verbose)
+                            const int i_num_of_workers,
+                            bool b_verbose,
+                            FrameMetadata* p_metadata = NULL,
+                            const ColorConversion cc_method = ColorConversion_Bilinear,
+                            const CropSettings* p_crop = NULL,
+                            FrameAccumulator<T>* p_accumulator = NULL,
+                            const TriggerSettings* p_trigger = NULL,
+                            LatencyHistogram* p_latency = NULL,
+                            Telemetry* p_telemetry = NULL,
+                            GrabThread* p_grab_thread = NULL)
     {
         // Get width and height 
-        const unsigned long long i_width = BaslerHelper::get_int(camera,"Width",b_verbose);
-        const unsigned long long i_height = BaslerHelper::get_int(camera,"Height",b_verbose);
+        const unsigned long long i_width = source->width();
+        const unsigned long long i_height = source->height();
         const unsigned long long i_numel = i_height * i_width;
         
         // Get Samples per pixel
         unsigned int i_samples_p_pixel;
         i_samples_p_pixel = Pylon::SamplesPerPixel(ept_output_type);    
         
-        // Get pixel format from camera
-        std::string s_pixel_type = BaslerHelper::get_string(camera,"PixelFormat",b_verbose);
-        Pylon::EPixelType ept_camera_type = Pylon::CPixelTypeMapper().GetPylonPixelTypeByName(s_pixel_type.c_str());
+        // Get pixel format from source
+        Pylon::EPixelType ept_camera_type = source->pixel_type();
+        
+        // Check if output conversion is needed
+        const bool b_convert_image = (ept_camera_type != ept_output_type) && 
+                Pylon::CImageFormatConverter::IsSupportedOutputFormat(ept_output_type);
+        const ColorConversion cc_native = native_conversion(ept_camera_type, ept_output_type, cc_method);
+        
+        const unsigned long long i_frame_numel = i_numel * i_samples_p_pixel;
         
-        // Init output conversion
+        // Copy, crop or accumulate a frame, with the converter, buffers and
+        // recorder of the calling thread
+        auto store_frame = [&](const Pylon::IImage& im_frame, const int i_frame,
+                Pylon::CImageFormatConverter* py_converter, Pylon::CPylonImage& im_target_image,
+                std::vector<uint16_t>& unpacked, FrameAccumulator<T>* p_thread_accumulator,
+                ThreadTelemetry* p_thread_telemetry)
+        {
+            if(p_crop == NULL && p_thread_accumulator == NULL)
+            {
+                copy_frame<T>(im_frame, py_converter, im_target_image, p_output + i_frame * i_frame_numel,
+                        i_height, i_width, i_samples_p_pixel, cc_native, ept_output_type, p_thread_telemetry);
+            }
+            else
+            {
+                const T* p_frame;
+                {
+                    StageTimer timer(p_thread_telemetry, Stage_Convert);
+                    p_frame = row_major_frame<T>(im_frame, py_converter, im_target_image, unpacked,
+                            ept_output_type, i_height, i_width, i_samples_p_pixel);
+                }
+                StageTimer timer(p_thread_telemetry, Stage_Copy);
+                if(p_crop != NULL)
+                {
+                    crop_frame(p_frame, (size_t)i_width, i_samples_p_pixel, *p_crop, i_frame);
+                }
+                else
+                {
+                    p_thread_accumulator->add(p_frame);
+                }
+            }
+            if(p_latency != NULL)
+            {
+                p_latency->stop(i_frame);
+            }
+        };
+        
+        // Start workers. Each of them has its own converter and
+        // accumulator, conversion and copy of different frames do not
+        // depend on each other.
+        FrameQueue<GrabbedFrame> queue(4 * (i_num_of_workers > 4 ? i_num_of_workers : 4));
+        std::mutex merge_mutex;
+        std::atomic<bool> b_grab_done(false);
+        std::atomic<int> i_failed_workers(0);
+        std::vector<std::exception_ptr> worker_errors(i_num_of_workers);
+        std::vector<std::thread> workers;
+        if(p_telemetry != NULL)
+        {
+            p_telemetry->prepare(i_num_of_workers + 1);
+        }
+        for(int i_worker = 0; i_worker < i_num_of_workers; i_worker++)
+        {
+            workers.push_back(std::thread([&, i_worker]()
+            {
+                try
+                {
+                    ThreadTelemetry* p_worker_telemetry = Telemetry::thread(p_telemetry, i_worker + 1);
+                    Pylon::CPylonImage im_target_image;
+                    Pylon::CImageFormatConverter py_converter;
+                    if(b_convert_image)
+                    {
+                        py_converter.OutputPixelFormat = ept_output_type;
+                    }
+                    std::vector<uint16_t> unpacked;
+                    std::unique_ptr<FrameAccumulator<T> > p_worker_accumulator;
+                    if(p_accumulator != NULL)
+                    {
+                        p_worker_accumulator.reset(new FrameAccumulator<T>(p_accumulator->mode(),
+                                (size_t)i_height, (size_t)i_width, i_samples_p_pixel));
+                    }
+                    
+                    GrabbedFrame frame;
+                    for(;;)
+                    {
+                        if(queue.pop(frame))
+                        {
+                            store_frame(frame.source_frame.image(), frame.i_frame, b_convert_image ? &py_converter : NULL,
+                                    im_target_image, unpacked, p_worker_accumulator.get(), p_worker_telemetry);
+                            
+                            // Hand buffer back to the source
+                            frame.source_frame.release();
+                        }
+                        else if(b_grab_done.load(std::memory_order_acquire) && queue.size() == 0)
+                        {
+                            break;
+                        }
+                        else
+                        {
+                            std::this_thread::yield();
+                        }
+                    }
+                    
+                    if(p_worker_accumulator)
+                    {
+                        std::lock_guard<std::mutex> lock(merge_mutex);
+                        p_accumulator->merge(*p_worker_accumulator);
+                    }
+                }
+                catch (...)
+                {
+                    worker_errors[i_worker] = std::current_exception();
+                    i_failed_workers.fetch_add(1, std::memory_order_release);
+                }
+            }));
+        }
+        
+        // Stop workers on any exit of this function
+        JoinThreads worker_join(workers, b_grab_done);
+        
+        // Converter of the calling thread, if there are no workers
         Pylon::CPylonImage im_target_image;
         Pylon::CImageFormatConverter py_converter;
-        bool b_convert_image = false;
-        if( (ept_camera_type != ept_output_type) && 
-                Pylon::CImageFormatConverter::IsSupportedOutputFormat(ept_output_type) )
+        if(b_convert_image)
         {
             py_converter.OutputPixelFormat = ept_output_type;
-            b_convert_image = true;
         }
+        std::vector<uint16_t> unpacked;
+        ThreadTelemetry* p_grab_telemetry = Telemetry::thread(p_telemetry, 0);
             
-        // Start capturing
-        camera->StartGrabbing(i_num_of_frames, Pylon::GrabStrategy_OneByOne);
-        Pylon::CGrabResultPtr p_grab_result;
-        
-        // Get results
-        for(int i_cur_frame=0; i_cur_frame<i_num_of_frames; i_cur_frame++)
-        {
-            camera->RetrieveResult(5000, p_grab_result, Pylon::TimeoutHandling_ThrowException);
-            if (p_grab_result->GrabSucceeded())
-            {   
-                T* p_output = static_cast<T*> (mxGetData(mxa_output));
-                T* p_image_buffer;
-                
-                if(b_convert_image)
+        // Metadata of the frames, frames not grabbed stay zero
+        if(p_metadata != NULL)
+        {
+            p_metadata->resize(i_num_of_frames);
+        }
+        if(p_latency != NULL)
+        {
+            p_latency->resize(i_num_of_frames);
+        }
+            
+        // Arm the trigger once, then start capturing
+        const TriggerSettings free_run;
+        const TriggerSettings& trigger = (p_trigger != NULL) ? *p_trigger : free_run;
+        ArmedTrigger armed_trigger(source, trigger);
+        source->start_grabbing(i_num_of_frames);
+        StopGrabbing stop_grabbing(source);
+        
+        // Get results, in the dedicated grab thread if there is one
+        int i_dropped = 0;
+        run_grab_loop(p_grab_thread, [&]()
+        {
+            SourceFrame source_frame;
+            unsigned long long i_last_block_id = 0;
+            for(int i_cur_frame=0; i_cur_frame<i_num_of_frames; i_cur_frame++)
+            {
+                if(i_num_of_workers > 0 && i_failed_workers.load(std::memory_order_acquire) == i_num_of_workers)
                 {
-                    py_converter.Convert(im_target_image, p_grab_result);
-                    p_image_buffer = static_cast<T*> (im_target_image.GetBuffer());
+                    source->stop_grabbing();
+                    break;
                 }
-                else
+            
+                // The latency of a software triggered frame starts at its
+                // trigger, else at its arrival
+                try
                 {
-                    p_image_buffer = static_cast<T*> (p_grab_result->GetBuffer());
+                    StageTimer timer(p_grab_telemetry, Stage_Retrieve);
+                    const std::chrono::steady_clock::time_point tp_start = retrieve_frame(source, trigger, source_frame);
+                    if(p_latency != NULL)
+                    {
+                        p_latency->tp_starts[i_cur_frame] = tp_start;
+                    }
                 }
+                catch (GenICam::TimeoutException&)
+                {
+                    if(trigger.to_policy == Timeout_Error)
+                    {
+                        throw;
+                    }
+                    else if(trigger.to_policy == Timeout_Skip)
+                    {
+                        i_dropped++;
+                        continue;
+                    }
                 
-                // For all bands
-                for (unsigned int i_c_band = 0; i_c_band < i_samples_p_pixel; i_c_band ++)
+                    // Frames not captured anymore count as dropped
+                    i_dropped += i_num_of_frames - i_cur_frame;
+                    source->stop_grabbing();
+                    break;
+                }
+                if(p_metadata != NULL)
                 {
-                    // Save pixels to buffer
-                    for (unsigned long long i=0; i < i_height; i++)
+                    p_metadata->set(i_cur_frame, source_frame);
+                }
+                if (source_frame.b_succeeded)
+                {   
+                    i_dropped += lost_frames(source_frame.i_block_id, i_last_block_id);
+                
+                    if(i_num_of_workers == 0)
+                    {
+                        store_frame(source_frame.image(), i_cur_frame, b_convert_image ? &py_converter : NULL,
+                                im_target_image, unpacked, p_accumulator, p_grab_telemetry);
+                    }
+                    else
                     {
-                        for (unsigned long long j=0; j < i_width; j++)
+                        // Queue frame, wait for a worker if the queue is full
+                        GrabbedFrame frame;
+                        frame.source_frame = source_frame;
+                        frame.i_frame = i_cur_frame;
+                        if(!queue.push(frame))
                         {
-                            p_output[i_cur_frame * (i_numel * i_samples_p_pixel)  // Which frame
-                                    + i_c_band * i_numel     // Which color band
-                                    +i                      // Which row
-                                    +j*i_height]            // Which colum
-                            = p_image_buffer[i_c_band+i_samples_p_pixel*(i*i_width+j)];
+                            StageTimer timer(p_grab_telemetry, Stage_Wait);
+                            while(!queue.push(frame))
+                            {
+                                if(i_failed_workers.load(std::memory_order_acquire) == i_num_of_workers)
+                                {
+                                    break;
+                                }
+                                wait_for_consumer();
+                            }
                         }
+                        if(p_telemetry != NULL)
+                        {
+                            p_telemetry->sample_queue_depth(queue.size());
+                        }
+                    }
+                    source_frame.release();
+                }
+                else
+                {
+                    i_dropped++;
+                    if(p_telemetry != NULL)
+                    {
+                        p_telemetry->count_incomplete();
                     }
                 }
             }
+        });
+        if(p_telemetry != NULL)
+        {
+            p_telemetry->set_dropped(i_dropped);
+        }
+        
+        // Wait for workers and forward their errors. Frames left in a full
+        // queue, if all workers failed, are released by the queue.
+        b_grab_done.store(true, std::memory_order_release);
+        for(size_t i = 0; i < workers.size(); i++)
+        {
+            workers[i].join();
+        }
+        workers.clear();
+        for(size_t i = 0; i < worker_errors.size(); i++)
+        {
+            if(worker_errors[i])
+            {
+                std::rethrow_exception(worker_errors[i]);
+            }
         }
 
+        return i_dropped;
+    }
+    
+    //---------------------------------------------------------------------
+    // Captures into the (already existing!) Matlab mxArray, see above
+    template <typename T>
+    int capture_images(     FrameSource* source, 
+                            const int i_num_of_frames, 
+                            mxArray* mxa_output, 
+                            Pylon::EPixelType ept_output_type,
+                            const int i_num_of_workers,
+                            bool b_verbose,
+                            FrameMetadata* p_metadata = NULL,
+                            const ColorConversion cc_method = ColorConversion_Bilinear,
+                            const TriggerSettings* p_trigger = NULL,
+                            LatencyHistogram* p_latency = NULL,
+                            Telemetry* p_telemetry = NULL,
+                            GrabThread* p_grab_thread = NULL)
+    {
+        return capture_images<T>(source, i_num_of_frames, static_cast<T*> (mxGetData(mxa_output)),
+                ept_output_type, i_num_of_workers, b_verbose, p_metadata, cc_method, NULL, NULL, p_trigger, p_latency,
+                p_telemetry, p_grab_thread);
     }
     
     //---------------------------------------------------------------------
-    // Captures the specified number of images from the camera and saves
-    // those in the path definded by s_save_path
-    void save_images(   Pylon::CInstantCamera* camera, 
-                        boost::filesystem::path bfp_save_path,
-                        const int i_num_of_frames, 
-                        Pylon::EPixelType ept_output_type,
-                        bool b_verbose)
+    // Captures the specified number of images from all sources at the same
+    // time, one grab thread per source, into the (already existing!)
+    // Matlab array of height x width x samples x frames x sources. The
+    // conversion threads are shared out among the sources. Returns the
+    // number of dropped frames of every source.
+    template <typename T>
+    std::vector<int> capture_images_multi(  const std::vector<FrameSource*>& sources,
+                                            const int i_num_of_frames,
+                                            mxArray* mxa_output,
+                                            Pylon::EPixelType ept_output_type,
+                                            const int i_num_of_workers,
+                                            bool b_verbose,
+                                            std::vector<FrameMetadata>& metadata)
     {
+        const size_t i_num_of_sources = sources.size();
+        const size_t i_source_numel = mxGetNumberOfElements(mxa_output) / std::max<size_t>(1, i_num_of_sources);
+        T* p_output = static_cast<T*> (mxGetData(mxa_output));
+        const int i_source_workers = i_num_of_workers / (int)std::max<size_t>(1, i_num_of_sources);
+        
+        std::vector<int> i_dropped(i_num_of_sources, 0);
+        std::vector<std::exception_ptr> grab_errors(i_num_of_sources);
+        metadata.resize(i_num_of_sources);
+        std::vector<std::thread> grabbers;
+        for(size_t i_source = 0; i_source < i_num_of_sources; i_source++)
+        {
+            grabbers.push_back(std::thread([&, i_source]()
+            {
+                try
+                {
+                    i_dropped[i_source] = capture_images<T>(sources[i_source], i_num_of_frames,
+                            p_output + i_source * i_source_numel, ept_output_type, i_source_workers,
+                            b_verbose, &metadata[i_source],
+                            default_conversion(sources[i_source]->pixel_type(), ept_output_type));
+                }
+                catch (...)
+                {
+                    grab_errors[i_source] = std::current_exception();
+                }
+            }));
+        }
+        for(size_t i = 0; i < grabbers.size(); i++)
+        {
+            grabbers[i].join();
+        }
+        
+        // Forward the first error, the other sources have finished anyway
+        for(size_t i = 0; i < grab_errors.size(); i++)
+        {
+            if(grab_errors[i])
+            {
+                std::rethrow_exception(grab_errors[i]);
+            }
+        }
+        return i_dropped;
+    }
+    
+    //---------------------------------------------------------------------
+    // Statistics of a save_images run
+    struct SaveStatistics
+    {
+        SaveStatistics() : i_saved(0), i_dropped(0), i_stalls(0), i_max_queue_depth(0), i_pool_size(0),
+                           i_raw_bytes(0), i_compressed_bytes(0), d_compress_seconds(0) {}
+        int i_saved;            // Frames written to disk
+        int i_dropped;          // Frames lost by the camera or failed grabs
+        int i_stalls;           // Grabs which had to wait for a free buffer
+        int i_max_queue_depth;  // Maximum number of frames waiting for a writer
+        int i_pool_size;        // Number of frame buffers
+        unsigned long long i_raw_bytes;         // Compressed streams: size of the
+        unsigned long long i_compressed_bytes;  // frames before and after, and
+        double d_compress_seconds;              // the time of all writers
+    };
+    
+    //---------------------------------------------------------------------
+    // A frame in the buffer pool waiting to be written
+    struct PooledFrame
+    {
+        PooledFrame() : i_slot(-1), i_frame(0), i_image_number(0), i_timestamp(0) {}
+        int i_slot;
+        unsigned long long i_frame;
+        long long i_image_number;
+        unsigned long long i_timestamp;
+    };
+    
+    //---------------------------------------------------------------------
+    // File formats of save_images
+    enum SaveFormat
+    {
+        SaveFormat_Tiff,        // One TIFF file per frame
+        SaveFormat_RawStream,   // All frames in one raw stream file
+        SaveFormat_Compressed   // All frames losslessly compressed in one file
+    };
+    
+    //---------------------------------------------------------------------
+    // Captures the specified number of images from the source and saves
+    // those in the path definded by s_save_path. For raw and compressed
+    // streams, the path is the name of the file, else a pattern for the
+    // TIFF file names. Compressed streams are compressed by the writers.
+    // The grabbed frames are copied into a fixed pool of buffers and
+    // written by i_num_of_writers background threads, so the disk does not
+    // throttle the acquisition. If all buffers are in use, the grab thread
+    // waits for a writer. The metadata of the saved frames, in the order
+    // of the raw stream, is stored in p_metadata, if given. p_trigger arms
+    // the source's trigger and sets the timeout policy like in
+    // capture_images. The time of every stage is stored in p_telemetry.
+    // The frames are retrieved in p_grab_thread, if given.
+    inline SaveStatistics save_images(  FrameSource* source, 
+                                        boost::filesystem::path bfp_save_path,
+                                        const int i_num_of_frames, 
+                                        Pylon::EPixelType ept_output_type,
+                                        const int i_num_of_writers,
+                                        const SaveFormat sf_format,
+                                        bool b_verbose,
+                                        FrameMetadata* p_metadata = NULL,
+                                        const TriggerSettings* p_trigger = NULL,
+                                        Telemetry* p_telemetry = NULL,
+                                        GrabThread* p_grab_thread = NULL)
+    {
+        SaveStatistics stats;
+        
         // Get width and height 
-        const unsigned long long i_width = BaslerHelper::get_int(camera,"Width",b_verbose);
-        const unsigned long long i_height = BaslerHelper::get_int(camera,"Height",b_verbose);
-        const unsigned long long i_numel = i_height * i_width;
+        const unsigned long long i_width = source->width();
+        const unsigned long long i_height = source->height();
         
-        // Get Samples per pixel
-        unsigned int i_samples_p_pixel;
-        i_samples_p_pixel = Pylon::SamplesPerPixel(ept_output_type);    
+        // Get pixel format from source
+        Pylon::EPixelType ept_camera_type = source->pixel_type();
         
-        // Get pixel format from camera
-        std::string s_pixel_type = BaslerHelper::get_string(camera,"PixelFormat",b_verbose);
-        Pylon::EPixelType ept_camera_type = Pylon::CPixelTypeMapper().GetPylonPixelTypeByName(s_pixel_type.c_str());
+        // Check if output conversion is needed
+        const bool b_convert_image = (ept_camera_type != ept_output_type) && 
+                Pylon::CImageFormatConverter::IsSupportedOutputFormat(ept_output_type);
         
-        // Init output conversion
-        Pylon::CPylonImage im_target_image;
-        Pylon::CImageFormatConverter py_converter;
-        bool b_convert_image = false;
-        if( (ept_camera_type != ept_output_type) && 
-                Pylon::CImageFormatConverter::IsSupportedOutputFormat(ept_output_type) )
+        // Size buffer pool to about 256 MB, but at least two frames per writer
+        const unsigned long long i_frame_bytes = std::max<unsigned long long>(1,
+                i_width * i_height * ((Pylon::BitPerPixel(ept_camera_type) + 7) / 8));
+        const int i_num_of_threads = std::max(1, i_num_of_writers);
+        const int i_pool_size = (int)std::min<unsigned long long>(256,
+                std::max<unsigned long long>(2 * i_num_of_threads, (256ULL << 20) / i_frame_bytes));
+        stats.i_pool_size = i_pool_size;
+        if(b_verbose)
         {
-            py_converter.OutputPixelFormat = ept_output_type;
-            b_convert_image = true;
+            mexPrintf("Using %d writer thread(s) and %d frame buffers\n", i_num_of_threads, i_pool_size);
+        }
+        
+        // Open raw stream file for all frames
+        std::unique_ptr<RawStreamWriter> p_raw_stream;
+        if(sf_format == SaveFormat_RawStream)
+        {
+            p_raw_stream.reset(new RawStreamWriter(bfp_save_path.string(), (uint32_t)i_width, (uint32_t)i_height,
+                    b_convert_image ? ept_output_type : ept_camera_type, i_num_of_frames));
+            if(b_verbose)
+            {
+                mexPrintf("Writing raw stream %s\n", p_raw_stream->is_direct() ? "unbuffered" : "buffered");
+            }
+        }
+        std::unique_ptr<CompressedStreamWriter> p_compressed_stream;
+        if(sf_format == SaveFormat_Compressed)
+        {
+            p_compressed_stream.reset(new CompressedStreamWriter(bfp_save_path.string(), (uint32_t)i_width, (uint32_t)i_height,
+                    b_convert_image ? ept_output_type : ept_camera_type, i_num_of_frames));
+        }
+        
+        std::vector<Pylon::CPylonImage> pool(i_pool_size);
+        FrameQueue<int> free_slots(i_pool_size);
+        FrameQueue<PooledFrame> filled_slots(i_pool_size);
+        for(int i = 0; i < i_pool_size; i++)
+        {
+            free_slots.push(i);
+        }
+        
+        // Start writers
+        std::atomic<bool> b_grab_done(false);
+        std::atomic<int> i_failed_writers(0);
+        std::atomic<int> i_saved(0);
+        std::atomic<unsigned long long> i_raw_bytes(0);
+        std::atomic<unsigned long long> i_compressed_bytes(0);
+        std::atomic<long long> i_compress_ns(0);
+        std::vector<std::exception_ptr> writer_errors(i_num_of_threads);
+        std::vector<std::thread> writers;
+        if(p_telemetry != NULL)
+        {
+            p_telemetry->prepare(i_num_of_threads + 1);
+        }
+        for(int i_writer = 0; i_writer < i_num_of_threads; i_writer++)
+        {
+            writers.push_back(std::thread([&, i_writer]()
+            {
+                try
+                {
+                    ThreadTelemetry* p_writer_telemetry = Telemetry::thread(p_telemetry, i_writer + 1);
+                    Pylon::CPylonImage im_target_image;
+                    Pylon::CImageFormatConverter py_converter;
+                    if(b_convert_image)
+                    {
+                        py_converter.OutputPixelFormat = ept_output_type;
+                    }
+                    
+                    // Aligned copy of the frame for unbuffered writes
+                    std::unique_ptr<AlignedBuffer> p_staging;
+                    if(p_raw_stream)
+                    {
+                        p_staging.reset(new AlignedBuffer((size_t)p_raw_stream->frame_stride()));
+                    }
+                    std::unique_ptr<FrameEncoder> p_encoder;
+                    if(p_compressed_stream)
+                    {
+                        p_encoder.reset(new FrameEncoder(p_compressed_stream->header(),
+                                b_convert_image ? ept_output_type : ept_camera_type));
+                    }
+                    
+                    PooledFrame frame;
+                    for(;;)
+                    {
+                        if(filled_slots.pop(frame))
+                        {
+                            // Convert image - if needed
+                            Pylon::CPylonImage& im_raw_image = pool[frame.i_slot];
+                            if(b_convert_image)
+                            {
+                                StageTimer timer(p_writer_telemetry, Stage_Convert);
+                                py_converter.Convert(im_target_image, im_raw_image);
+                            }
+                            
+                            const Pylon::IImage& im_save_image = b_convert_image ? 
+                                    static_cast<const Pylon::IImage&>(im_target_image) : im_raw_image;
+                            
+                            if(p_compressed_stream)
+                            {
+                                // Compress, then append to the compressed stream
+                                const std::chrono::steady_clock::time_point tp_start = std::chrono::steady_clock::now();
+                                const std::vector<uint8_t>* p_data;
+                                {
+                                    StageTimer timer(p_writer_telemetry, Stage_Compress);
+                                    p_data = &p_encoder->encode(im_save_image.GetBuffer());
+                                }
+                                i_compress_ns.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                        std::chrono::steady_clock::now() - tp_start).count(), std::memory_order_relaxed);
+                                i_raw_bytes.fetch_add(p_encoder->frame_bytes(), std::memory_order_relaxed);
+                                i_compressed_bytes.fetch_add(p_data->size(), std::memory_order_relaxed);
+
+                                StageTimer timer(p_writer_telemetry, Stage_Save);
+                                p_compressed_stream->write_frame(frame.i_frame, *p_data,
+                                        frame.i_timestamp, frame.i_image_number);
+                            }
+                            else if(p_raw_stream)
+                            {
+                                // Append to raw stream
+                                StageTimer timer(p_writer_telemetry, Stage_Save);
+                                memcpy(p_staging->data(), im_save_image.GetBuffer(), 
+                                        (size_t)std::min<unsigned long long>(p_raw_stream->frame_bytes(), im_save_image.GetImageSize()));
+                                p_raw_stream->write_frame(frame.i_frame, p_staging->data(),
+                                        frame.i_timestamp, frame.i_image_number);
+                            }
+                            else
+                            {
+                                // Create image file name
+                                StageTimer timer(p_writer_telemetry, Stage_Save);
+                                std::ostringstream os_out;
+                                os_out << boost::format(bfp_save_path.string()) % frame.i_image_number; 
+                                
+                                // Save image
+                                Pylon::CImagePersistence::Save( Pylon::ImageFileFormat_Tiff,
+                                        os_out.str().c_str(), im_save_image);
+                            }
+                            i_saved.fetch_add(1, std::memory_order_relaxed);
+                            
+                            // Return buffer to the pool
+                            free_slots.push(frame.i_slot);
+                        }
+                        else if(b_grab_done.load(std::memory_order_acquire) && filled_slots.size() == 0)
+                        {
+                            break;
+                        }
+                        else
+                        {
+                            std::this_thread::yield();
+                        }
+                    }
+                }
+                catch (...)
+                {
+                    writer_errors[i_writer] = std::current_exception();
+                    i_failed_writers.fetch_add(1, std::memory_order_release);
+                }
+            }));
+        }
+        
+        // Stop writers on any exit of this function
+        JoinThreads writer_join(writers, b_grab_done);
+        
+        if(p_metadata != NULL)
+        {
+            p_metadata->resize(i_num_of_frames);
         }
             
-        // Start capturing
-        camera->StartGrabbing(i_num_of_frames, Pylon::GrabStrategy_OneByOne);
-        Pylon::CGrabResultPtr p_grab_result;
+        // Arm the trigger once, then start capturing. Grabbing is stopped
+        // on any exit.
+        const TriggerSettings free_run;
+        const TriggerSettings& trigger = (p_trigger != NULL) ? *p_trigger : free_run;
+        ArmedTrigger armed_trigger(source, trigger);
+        source->start_grabbing(i_num_of_frames);
+        StopGrabbing stop_grabbing(source);
         
-        // Get results
-        for(int i_cur_frame=0; i_cur_frame<i_num_of_frames; i_cur_frame++)
+        // Get results, in the dedicated grab thread if there is one
+        ThreadTelemetry* p_grab_telemetry = Telemetry::thread(p_telemetry, 0);
+        unsigned long long i_queued = 0;
+        run_grab_loop(p_grab_thread, [&]()
         {
-            camera->RetrieveResult(5000, p_grab_result, Pylon::TimeoutHandling_ThrowException);
-            if (p_grab_result->GrabSucceeded())
-            {   
-                // Convert image - if needed
-                if(b_convert_image)
+            SourceFrame source_frame;
+            unsigned long long i_last_block_id = 0;
+            for(int i_cur_frame=0; i_cur_frame<i_num_of_frames; i_cur_frame++)
+            {
+                if(i_failed_writers.load(std::memory_order_acquire) > 0)
                 {
-                    py_converter.Convert(im_target_image, p_grab_result);
+                    source->stop_grabbing();
+                    break;
                 }
-                else
+            
+                try
+                {
+                    StageTimer timer(p_grab_telemetry, Stage_Retrieve);
+                    retrieve_frame(source, trigger, source_frame);
+                }
+                catch (GenICam::TimeoutException&)
                 {
-                    im_target_image.AttachGrabResultBuffer(p_grab_result);
+                    if(trigger.to_policy == Timeout_Error)
+                    {
+                        throw;
+                    }
+                    else if(trigger.to_policy == Timeout_Skip)
+                    {
+                        stats.i_dropped++;
+                        continue;
+                    }
+                    stats.i_dropped += i_num_of_frames - i_cur_frame;
+                    source->stop_grabbing();
+                    break;
                 }
+                if (source_frame.b_succeeded)
+                {   
+                    stats.i_dropped += lost_frames(source_frame.i_block_id, i_last_block_id);
                 
-                // Create image file name
-                std::ostringstream os_out;
-                os_out << boost::format(bfp_save_path.string()) % p_grab_result->GetImageNumber(); 
-
-                // Save image
-                Pylon::CImagePersistence::Save( Pylon::ImageFileFormat_Tiff,
-                                    os_out.str().c_str(), im_target_image);
+                    // Get a free buffer, wait for the writers if there is none
+                    int i_slot;
+                    if(!free_slots.pop(i_slot))
+                    {
+                        StageTimer timer(p_grab_telemetry, Stage_Wait);
+                        stats.i_stalls++;
+                        while(!free_slots.pop(i_slot))
+                        {
+                            if(i_failed_writers.load(std::memory_order_acquire) > 0)
+                            {
+                                break;
+                            }
+                            wait_for_consumer();
+                        }
+                        if(i_failed_writers.load(std::memory_order_acquire) > 0)
+                        {
+                            source->stop_grabbing();
+                            break;
+                        }
+                    }
+                
+                    // Copy frame and hand the grab buffer back to the source at once
+                    {
+                        StageTimer timer(p_grab_telemetry, Stage_Copy);
+                        pool[i_slot].CopyImage(source_frame.image());
+                    }
+                    PooledFrame frame;
+                    frame.i_slot = i_slot;
+                    frame.i_frame = i_queued++;
+                    frame.i_image_number = source_frame.i_image_number;
+                    frame.i_timestamp = source_frame.i_timestamp;
+                    if(p_metadata != NULL)
+                    {
+                        p_metadata->set(frame.i_frame, source_frame);
+                    }
+                    source_frame.release();
+                    filled_slots.push(frame);
+                    stats.i_max_queue_depth = std::max(stats.i_max_queue_depth, (int)filled_slots.size());
+                    if(p_telemetry != NULL)
+                    {
+                        p_telemetry->sample_queue_depth(filled_slots.size());
+                    }
+                }
+                else
+                {
+                    stats.i_dropped++;
+                    if(p_telemetry != NULL)
+                    {
+                        p_telemetry->count_incomplete();
+                    }
+                }
+            }
+        });
+        if(p_telemetry != NULL)
+        {
+            p_telemetry->set_dropped(stats.i_dropped);
+        }
+        
+        // Wait for writers and forward their errors
+        b_grab_done.store(true, std::memory_order_release);
+        for(size_t i = 0; i < writers.size(); i++)
+        {
+            writers[i].join();
+        }
+        writers.clear();
+        for(size_t i = 0; i < writer_errors.size(); i++)
+        {
+            if(writer_errors[i])
+            {
+                std::rethrow_exception(writer_errors[i]);
             }
         }
+        
+        // Write index of raw stream
+        if(p_raw_stream)
+        {
+            p_raw_stream->close(i_queued);
+        }
+        if(p_compressed_stream)
+        {
+            p_compressed_stream->close(i_queued);
+        }
+        if(p_metadata != NULL)
+        {
+            p_metadata->resize(i_queued);
+        }
+        
+        stats.i_saved = i_saved.load();
+        stats.i_raw_bytes = i_raw_bytes.load();
+        stats.i_compressed_bytes = i_compressed_bytes.load();
+        stats.d_compress_seconds = 1e-9 * (double)i_compress_ns.load();
+        return stats;
     }
     
     
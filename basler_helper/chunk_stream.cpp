@@ -0,0 +1,195 @@
+// chunk_stream.cpp - Streaming acquisition in chunks of frames
+// 17.10.2026 / agent
+
+
+#include "chunk_stream.h"
+#include "capture_images.h"
+#include <algorithm>
+#include <chrono>
+
+
+namespace BaslerHelper {
+
+    //---------------------------------------------------------------------
+    // Prepare the pool and start the thread grabbing the frames
+    ChunkStream::ChunkStream(   std::unique_ptr<FrameSource> p_source,
+                                const size_t i_chunk_frames,
+                                const size_t i_num_of_chunks,
+                                const unsigned long long i_num_of_frames)
+        : m_p_source(std::move(p_source)), m_i_chunk_frames(std::max<size_t>(i_chunk_frames, 1)),
+          m_i_num_of_frames(i_num_of_frames), m_chunks(std::max<size_t>(i_num_of_chunks, 2)),
+          m_free_chunks(m_chunks.size()), m_filled_chunks(m_chunks.size()),
+          m_b_stop(false), m_b_grab_done(false), m_i_grabbed(0), m_i_dropped(0), m_i_stalls(0)
+    {
+        for(size_t i = 0; i < m_chunks.size(); i++)
+        {
+            m_chunks[i].images.resize(m_i_chunk_frames);
+            m_free_chunks.push((int)i);
+        }
+        m_p_source->start_grabbing(m_i_num_of_frames);
+        m_thread = std::thread(&ChunkStream::run, this);
+    }
+
+    //---------------------------------------------------------------------
+    // Stop thread and grabbing
+    ChunkStream::~ChunkStream()
+    {
+        m_b_stop.store(true);
+        m_thread.join();
+        try
+        {
+            m_p_source->stop_grabbing();
+        }
+        catch (GenICam::GenericException &e)
+        {
+            // Camera may have been removed
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Grab thread: fill one chunk after the other, wait for Matlab if
+    // all chunks are full
+    void ChunkStream::run()
+    {
+        SourceFrame source_frame;
+        unsigned long long i_last_block_id = 0;
+        unsigned long long i_retrieved = 0;
+        int i_chunk = -1;
+        try
+        {
+            while(!m_b_stop.load() && (m_i_num_of_frames == 0 || i_retrieved < m_i_num_of_frames))
+            {
+                // Get an empty chunk
+                if(i_chunk < 0 && !m_free_chunks.pop(i_chunk))
+                {
+                    m_i_stalls.fetch_add(1);
+                    while(!m_b_stop.load() && !m_free_chunks.pop(i_chunk))
+                    {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    }
+                    if(m_b_stop.load())
+                    {
+                        break;
+                    }
+                }
+                StreamChunk& chunk = m_chunks[i_chunk];
+                if(chunk.i_count == 0)
+                {
+                    chunk.metadata.resize(m_i_chunk_frames);
+                }
+
+                // Wait for the next frame, the stop flag is checked in between
+                try
+                {
+                    m_p_source->retrieve(100, source_frame);
+                }
+                catch (GenICam::TimeoutException &e)
+                {
+                    continue;
+                }
+                i_retrieved++;
+
+                // Frames skipped by the grab engine also leave a gap in the
+                // block IDs, so the skipped count is only used without them.
+                // A failed frame counts towards the frames to grab.
+                const int i_lost = lost_frames(source_frame.i_block_id, i_last_block_id);
+                if(source_frame.i_block_id != 0)
+                {
+                    m_i_dropped.fetch_add(i_lost);
+                }
+                else if(source_frame.i_skipped > 0)
+                {
+                    m_i_dropped.fetch_add(source_frame.i_skipped);
+                }
+                if(!source_frame.b_succeeded)
+                {
+                    m_i_dropped.fetch_add(1);
+                    continue;
+                }
+
+                // Copy frame and hand the grab buffer back at once
+                chunk.images[chunk.i_count].CopyImage(source_frame.image());
+                chunk.metadata.set(chunk.i_count, source_frame);
+                source_frame.release();
+                chunk.i_count++;
+                m_i_grabbed.fetch_add(1);
+
+                // Publish full chunk
+                if(chunk.i_count == m_i_chunk_frames)
+                {
+                    m_filled_chunks.push(i_chunk);
+                    i_chunk = -1;
+                }
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_error = std::current_exception();
+        }
+
+        // Publish the last, partly filled chunk
+        if(i_chunk >= 0)
+        {
+            if(m_chunks[i_chunk].i_count > 0)
+            {
+                m_chunks[i_chunk].metadata.resize(m_chunks[i_chunk].i_count);
+                m_filled_chunks.push(i_chunk);
+            }
+            else
+            {
+                m_free_chunks.push(i_chunk);
+            }
+        }
+        m_b_grab_done.store(true);
+    }
+
+    //---------------------------------------------------------------------
+    // Wait for a filled chunk
+    StreamChunk* ChunkStream::next(const unsigned int i_timeout_ms)
+    {
+        const std::chrono::steady_clock::time_point tp_timeout =
+                std::chrono::steady_clock::now() + std::chrono::milliseconds(i_timeout_ms);
+        int i_chunk;
+        for(;;)
+        {
+            if(m_filled_chunks.pop(i_chunk))
+            {
+                return &m_chunks[i_chunk];
+            }
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if(m_error)
+                {
+                    std::rethrow_exception(m_error);
+                }
+            }
+            if(m_b_grab_done.load())
+            {
+                // A chunk may have been published right before
+                return m_filled_chunks.pop(i_chunk) ? &m_chunks[i_chunk] : NULL;
+            }
+            if(std::chrono::steady_clock::now() >= tp_timeout)
+            {
+                return NULL;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Hand a read chunk back to the pool
+    void ChunkStream::release(StreamChunk* p_chunk)
+    {
+        p_chunk->i_count = 0;
+        m_free_chunks.push((int)(p_chunk - &m_chunks[0]));
+    }
+
+    //---------------------------------------------------------------------
+    // All frames grabbed and read
+    bool ChunkStream::ended() const
+    {
+        return m_b_grab_done.load() && m_filled_chunks.size() == 0;
+    }
+
+}
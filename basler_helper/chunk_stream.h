@@ -0,0 +1,97 @@
+// chunk_stream.h - Streaming acquisition in chunks of frames
+// 17.10.2026 / agent
+//
+// A background thread grabs an unbounded number of frames and collects
+// them in chunks of a fixed number of frames. The chunks come from a fixed
+// pool and are handed back after Matlab has read them, so the memory used
+// is bounded by the pool, whatever the number of frames. The frames are
+// kept in the camera's pixel format and converted when they are read.
+
+#ifndef __CHUNKSTREAM_H_INCLUDED__
+#define __CHUNKSTREAM_H_INCLUDED__
+
+#include <pylon/PylonIncludes.h>
+#include "frame_source.h"
+#include "frame_metadata.h"
+#include "frame_queue.h"
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace BaslerHelper {
+
+    //---------------------------------------------------------------------
+    // Chunk of frames of the pool, the images are reused
+    struct StreamChunk
+    {
+        StreamChunk() : i_count(0) {}
+        std::vector<Pylon::CPylonImage> images;
+        FrameMetadata metadata;             // Of the frames in images
+        size_t i_count;                     // Frames in this chunk
+    };
+
+    //---------------------------------------------------------------------
+    // Grabs from a source into chunks until destroyed or all frames are
+    // grabbed
+    class ChunkStream
+    {
+    public:
+        // Grabs i_num_of_frames frames, 0 grabs until destroyed, into a pool
+        // of i_num_of_chunks chunks of i_chunk_frames frames each
+        ChunkStream(std::unique_ptr<FrameSource> p_source,
+                    const size_t i_chunk_frames,
+                    const size_t i_num_of_chunks,
+                    const unsigned long long i_num_of_frames);
+        ~ChunkStream();
+
+        // Next filled chunk, the last one may hold fewer frames. NULL if no
+        // chunk is filled within i_timeout_ms or the stream has ended.
+        // Rethrows an error of the grab thread. The chunk has to be handed
+        // back by release().
+        StreamChunk* next(const unsigned int i_timeout_ms);
+        void release(StreamChunk* p_chunk);
+
+        // True if all frames were grabbed and read
+        bool ended() const;
+
+        // Source of the frames
+        FrameSource* source() { return m_p_source.get(); }
+
+        size_t chunk_frames() const { return m_i_chunk_frames; }
+        size_t num_of_chunks() const { return m_chunks.size(); }
+
+        // Frames grabbed and lost since the start, and grabs which had to
+        // wait for a free chunk
+        unsigned long long frames_grabbed() const { return m_i_grabbed.load(); }
+        unsigned long long frames_dropped() const { return m_i_dropped.load(); }
+        unsigned long long stalls() const { return m_i_stalls.load(); }
+
+    private:
+        ChunkStream(const ChunkStream&);
+        ChunkStream& operator=(const ChunkStream&);
+
+        void run();
+
+        std::unique_ptr<FrameSource> m_p_source;
+        size_t m_i_chunk_frames;
+        unsigned long long m_i_num_of_frames;
+        std::vector<StreamChunk> m_chunks;
+        FrameQueue<int> m_free_chunks;
+        FrameQueue<int> m_filled_chunks;
+        std::mutex m_mutex;
+        std::exception_ptr m_error;
+        std::atomic<bool> m_b_stop;
+        std::atomic<bool> m_b_grab_done;
+        std::atomic<unsigned long long> m_i_grabbed;
+        std::atomic<unsigned long long> m_i_dropped;
+        std::atomic<unsigned long long> m_i_stalls;
+        std::thread m_thread;
+    };
+
+}
+
+#endif
@@ -0,0 +1,658 @@
+// compressed_stream.cpp - Single file container for losslessly compressed frames
+// 17.10.2026 / agent
+
+
+#include "compressed_stream.h"
+#include "unpack_image.h"
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+
+namespace {
+
+    // Samples per Rice parameter
+    const size_t GROUP_SIZE = 32;
+
+    // Group parameter of a group of zeros, which has no further bits
+    const uint32_t ZERO_GROUP = 31;
+
+    // Unary quotients from this length on are escaped, followed by the
+    // value in full
+    const uint32_t ESCAPE_LENGTH = 24;
+
+    // Flag in a block size for a block stored without coding
+    const uint32_t STORED_BLOCK = 0x80000000u;
+
+    // Index of the lowest set bit, i_value must not be 0
+    inline uint32_t lowest_bit(const uint32_t i_value)
+    {
+#if defined(_MSC_VER)
+        unsigned long i_index;
+        _BitScanForward(&i_index, i_value);
+        return (uint32_t)i_index;
+#else
+        return (uint32_t)__builtin_ctz(i_value);
+#endif
+    }
+
+    // Number of bits of i_value, 0 for 0
+    inline uint32_t bit_length(const uint32_t i_value)
+    {
+        if(i_value == 0)
+        {
+            return 0;
+        }
+#if defined(_MSC_VER)
+        unsigned long i_index;
+        _BitScanReverse(&i_index, i_value);
+        return (uint32_t)i_index + 1;
+#else
+        return 32 - (uint32_t)__builtin_clz(i_value);
+#endif
+    }
+
+    //---------------------------------------------------------------------
+    // Writes bits, lowest first, into a buffer large enough for all of
+    // them plus 8 bytes. Every put stores a whole word and advances by
+    // the completed bytes, so it has no branch. The container is little
+    // endian, like its header.
+    class BitWriter
+    {
+    public:
+        explicit BitWriter(uint8_t* p_data) : m_p_data(p_data), m_p_start(p_data), m_i_bits(0), m_i_count(0) {}
+
+        // Up to 56 bits
+        void put(const uint64_t i_value, const uint32_t i_count)
+        {
+            m_i_bits |= i_value << m_i_count;
+            m_i_count += i_count;
+            memcpy(m_p_data, &m_i_bits, 8);
+            m_p_data += m_i_count >> 3;
+            m_i_bits >>= m_i_count & ~7u;
+            m_i_count &= 7;
+        }
+
+        // Bytes written, including the last partial byte
+        size_t finish()
+        {
+            if(m_i_count > 0)
+            {
+                *m_p_data++ = (uint8_t)m_i_bits;
+            }
+            return (size_t)(m_p_data - m_p_start);
+        }
+
+    private:
+        uint8_t* m_p_data;
+        uint8_t* m_p_start;
+        uint64_t m_i_bits;
+        uint32_t m_i_count;
+    };
+
+    //---------------------------------------------------------------------
+    // Reads bits, lowest first. Reading past the end yields zeros, so a
+    // damaged block decodes to wrong values but never reads out of bounds.
+    class BitReader
+    {
+    public:
+        BitReader(const uint8_t* p_data, const size_t i_size)
+            : m_p_data(p_data), m_p_end(p_data + i_size), m_i_bits(0), m_i_count(0) {}
+
+        // Make at least 56 bits available, a word at a time away from the
+        // end. The container is little endian, like its header.
+        void refill()
+        {
+            if(m_p_end - m_p_data >= 8)
+            {
+                uint64_t i_word;
+                memcpy(&i_word, m_p_data, 8);
+                m_i_bits |= i_word << m_i_count;
+                m_p_data += (63 - m_i_count) >> 3;
+                m_i_count |= 56;
+                return;
+            }
+            while(m_i_count <= 56)
+            {
+                if(m_p_data < m_p_end)
+                {
+                    m_i_bits |= (uint64_t)*m_p_data++ << m_i_count;
+                }
+                m_i_count += 8;
+            }
+        }
+
+        uint32_t peek(const uint32_t i_count) const
+        {
+            return (uint32_t)(m_i_bits & ((1ULL << i_count) - 1));
+        }
+
+        void skip(const uint32_t i_count)
+        {
+            m_i_bits >>= i_count;
+            m_i_count -= i_count;
+        }
+
+        // Up to 32 bits
+        uint32_t get(const uint32_t i_count)
+        {
+            refill();
+            const uint32_t i_value = peek(i_count);
+            skip(i_count);
+            return i_value;
+        }
+
+    private:
+        const uint8_t* m_p_data;
+        const uint8_t* m_p_end;
+        uint64_t m_i_bits;
+        uint32_t m_i_count;
+    };
+
+    //---------------------------------------------------------------------
+    // LOCO-I median edge detector, written with masks and selects so that
+    // noisy frames do not cost branch mispredictions
+    inline int predict(const int a, const int b, const int c)
+    {
+        const int i_min = b ^ ((a ^ b) & -(int)(a < b));
+        const int i_max = a ^ b ^ i_min;
+        int i_prediction = a + b - c;
+        i_prediction = c >= i_max ? i_min : i_prediction;
+        i_prediction = c <= i_min ? i_max : i_prediction;
+        return i_prediction;
+    }
+
+    // Signed residuals of the sample width to unsigned, small first
+    inline uint16_t zigzag(const uint8_t i_residual)
+    {
+        return (uint16_t)(uint8_t)((i_residual << 1) ^ (uint8_t)((int8_t)i_residual >> 7));
+    }
+    inline uint16_t zigzag(const uint16_t i_residual)
+    {
+        return (uint16_t)((i_residual << 1) ^ (uint16_t)((int16_t)i_residual >> 15));
+    }
+    inline uint16_t unzigzag(const uint16_t i_value)
+    {
+        return (uint16_t)((i_value >> 1) ^ (uint16_t)(0 - (i_value & 1)));
+    }
+
+    //---------------------------------------------------------------------
+    // Zigzag mapped residuals of the rows of a block. The first samples of
+    // a row are predicted from above, the first rows of a block from the
+    // left only.
+    template <typename T>
+    void block_residuals(   const T* p_block,
+                            const size_t i_rows,
+                            const size_t i_samples_per_row,
+                            const size_t i_column_step,
+                            const size_t i_row_step,
+                            uint16_t* p_residuals)
+    {
+        const size_t i_first = std::min(i_column_step, i_samples_per_row);
+        for(size_t y = 0; y < i_rows; y++)
+        {
+            const T* p_row = p_block + y * i_samples_per_row;
+            if(y < i_row_step)
+            {
+                for(size_t x = 0; x < i_first; x++)
+                {
+                    *p_residuals++ = zigzag(p_row[x]);
+                }
+                for(size_t x = i_first; x < i_samples_per_row; x++)
+                {
+                    *p_residuals++ = zigzag((T)(p_row[x] - p_row[x - i_column_step]));
+                }
+            }
+            else
+            {
+                const T* p_up = p_row - i_row_step * i_samples_per_row;
+                for(size_t x = 0; x < i_first; x++)
+                {
+                    *p_residuals++ = zigzag((T)(p_row[x] - p_up[x]));
+                }
+                for(size_t x = i_first; x < i_samples_per_row; x++)
+                {
+                    const int i_prediction = predict(p_row[x - i_column_step], p_up[x], p_up[x - i_column_step]);
+                    *p_residuals++ = zigzag((T)(p_row[x] - i_prediction));
+                }
+            }
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Rows of a block from its residuals
+    template <typename T>
+    void block_samples( const uint16_t* p_residuals,
+                        const size_t i_rows,
+                        const size_t i_samples_per_row,
+                        const size_t i_column_step,
+                        const size_t i_row_step,
+                        T* p_block)
+    {
+        const size_t i_first = std::min(i_column_step, i_samples_per_row);
+        for(size_t y = 0; y < i_rows; y++)
+        {
+            T* p_row = p_block + y * i_samples_per_row;
+            if(y < i_row_step)
+            {
+                for(size_t x = 0; x < i_first; x++)
+                {
+                    p_row[x] = (T)unzigzag(*p_residuals++);
+                }
+                for(size_t x = i_first; x < i_samples_per_row; x++)
+                {
+                    p_row[x] = (T)(p_row[x - i_column_step] + unzigzag(*p_residuals++));
+                }
+            }
+            else
+            {
+                const T* p_up = p_row - i_row_step * i_samples_per_row;
+                for(size_t x = 0; x < i_first; x++)
+                {
+                    p_row[x] = (T)(p_up[x] + unzigzag(*p_residuals++));
+                }
+                for(size_t x = i_first; x < i_samples_per_row; x++)
+                {
+                    const int i_prediction = predict(p_row[x - i_column_step], p_up[x], p_up[x - i_column_step]);
+                    p_row[x] = (T)(i_prediction + unzigzag(*p_residuals++));
+                }
+            }
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Rice code the values in groups, the parameter of a group is the
+    // better of the two around its mean
+    size_t rice_encode(const uint16_t* p_values, const size_t i_count, const uint32_t i_bits, uint8_t* p_data)
+    {
+        BitWriter writer(p_data);
+        for(size_t i_start = 0; i_start < i_count; i_start += GROUP_SIZE)
+        {
+            const uint16_t* p_group = p_values + i_start;
+            const size_t i_size = std::min(GROUP_SIZE, i_count - i_start);
+            uint64_t i_sum = 0;
+            for(size_t i = 0; i < i_size; i++)
+            {
+                i_sum += p_group[i];
+            }
+            if(i_sum == 0)
+            {
+                writer.put(ZERO_GROUP, 5);
+                continue;
+            }
+
+            // Smallest k with 2^k at least the mean
+            const uint32_t i_mean = (uint32_t)((i_sum + i_size - 1) / i_size);
+            uint32_t k = std::min(bit_length(i_mean - 1), i_bits);
+            if(k > 0)
+            {
+                uint64_t i_cost_k = 0;
+                uint64_t i_cost_lower = 0;
+                for(size_t i = 0; i < i_size; i++)
+                {
+                    i_cost_k += p_group[i] >> k;
+                    i_cost_lower += p_group[i] >> (k - 1);
+                }
+                if(i_cost_lower < i_cost_k + i_size)
+                {
+                    k--;
+                }
+            }
+
+            // Quotient in unary, ones ended by a zero, then the remainder
+            writer.put(k, 5);
+            const uint32_t i_mask = (1u << k) - 1;
+            for(size_t i = 0; i < i_size; i++)
+            {
+                const uint32_t q = p_group[i] >> k;
+                if(q < ESCAPE_LENGTH)
+                {
+                    writer.put((((uint64_t)1 << q) - 1) | ((uint64_t)(p_group[i] & i_mask) << (q + 1)), q + 1 + k);
+                }
+                else
+                {
+                    writer.put((((uint64_t)1 << ESCAPE_LENGTH) - 1) | ((uint64_t)p_group[i] << ESCAPE_LENGTH),
+                            ESCAPE_LENGTH + i_bits);
+                }
+            }
+        }
+        return writer.finish();
+    }
+
+    //---------------------------------------------------------------------
+    // Decode i_count Rice coded values
+    void rice_decode(const uint8_t* p_data, const size_t i_size, const size_t i_count, const uint32_t i_bits, uint16_t* p_values)
+    {
+        BitReader reader(p_data, i_size);
+        const uint32_t i_escape_mask = (1u << ESCAPE_LENGTH) - 1;
+        for(size_t i_start = 0; i_start < i_count; i_start += GROUP_SIZE)
+        {
+            uint16_t* p_group = p_values + i_start;
+            const size_t i_group_size = std::min(GROUP_SIZE, i_count - i_start);
+            const uint32_t k = reader.get(5);
+            if(k == ZERO_GROUP)
+            {
+                std::fill(p_group, p_group + i_group_size, (uint16_t)0);
+                continue;
+            }
+            if(k > i_bits)
+            {
+                throw RUNTIME_EXCEPTION("Compressed frame is damaged.");
+            }
+            for(size_t i = 0; i < i_group_size; i++)
+            {
+                reader.refill();
+                const uint32_t i_ones = ~reader.peek(ESCAPE_LENGTH) & i_escape_mask;
+                if(i_ones == 0)
+                {
+                    reader.skip(ESCAPE_LENGTH);
+                    p_group[i] = (uint16_t)reader.peek(i_bits);
+                    reader.skip(i_bits);
+                }
+                else
+                {
+                    const uint32_t q = lowest_bit(i_ones);
+                    reader.skip(q + 1);
+                    p_group[i] = (uint16_t)((q << k) | reader.peek(k));
+                    reader.skip(k);
+                }
+            }
+        }
+    }
+
+    // Little endian block sizes
+    inline void put_size(uint8_t* p_data, const uint32_t i_size)
+    {
+        p_data[0] = (uint8_t)i_size;
+        p_data[1] = (uint8_t)(i_size >> 8);
+        p_data[2] = (uint8_t)(i_size >> 16);
+        p_data[3] = (uint8_t)(i_size >> 24);
+    }
+    inline uint32_t get_size(const uint8_t* p_data)
+    {
+        return (uint32_t)p_data[0] | ((uint32_t)p_data[1] << 8) | ((uint32_t)p_data[2] << 16) | ((uint32_t)p_data[3] << 24);
+    }
+
+    // Number of blocks of a frame
+    inline size_t block_count(const BaslerHelper::CompressedStreamHeader& header)
+    {
+        return (header.i_height + header.i_block_rows - 1) / header.i_block_rows;
+    }
+
+    //---------------------------------------------------------------------
+    // Code the blocks of a frame one after the other
+    template <typename T>
+    void encode_frame(  const BaslerHelper::CompressedStreamHeader& header,
+                        const T* p_frame,
+                        std::vector<uint16_t>& residuals,
+                        std::vector<uint8_t>& data)
+    {
+        const size_t i_blocks = block_count(header);
+        const size_t i_block_samples = (size_t)header.i_block_rows * header.i_samples_per_row;
+        residuals.resize(i_block_samples);
+
+        // Worst case: every value escaped, plus the group parameters
+        const size_t i_max_block_bytes = (i_block_samples * (ESCAPE_LENGTH + header.i_bits_per_sample)
+                + (i_block_samples / GROUP_SIZE + 1) * 5) / 8 + 8;
+        data.resize(i_blocks * 4 + i_blocks * i_max_block_bytes);
+
+        uint8_t* p_sizes = &data[0];
+        uint8_t* p_out = p_sizes + i_blocks * 4;
+        for(size_t b = 0; b < i_blocks; b++)
+        {
+            const size_t i_first_row = b * header.i_block_rows;
+            const size_t i_rows = std::min<size_t>(header.i_block_rows, header.i_height - i_first_row);
+            const size_t i_samples = i_rows * header.i_samples_per_row;
+            const T* p_block = p_frame + i_first_row * header.i_samples_per_row;
+
+            block_residuals(p_block, i_rows, header.i_samples_per_row, header.i_column_step, header.i_row_step, &residuals[0]);
+            size_t i_size = rice_encode(&residuals[0], i_samples, header.i_bits_per_sample, p_out);
+            uint32_t i_stored = 0;
+            if(i_size >= i_samples * sizeof(T))
+            {
+                // Noise, keep the samples
+                i_size = i_samples * sizeof(T);
+                memcpy(p_out, p_block, i_size);
+                i_stored = STORED_BLOCK;
+            }
+            put_size(p_sizes + b * 4, (uint32_t)i_size | i_stored);
+            p_out += i_size;
+        }
+        data.resize((size_t)(p_out - &data[0]));
+    }
+
+    //---------------------------------------------------------------------
+    // Decode the blocks of a frame
+    template <typename T>
+    void decode_blocks( const BaslerHelper::CompressedStreamHeader& header,
+                        const uint8_t* p_data,
+                        const uint64_t i_size,
+                        T* p_frame)
+    {
+        const size_t i_blocks = block_count(header);
+        if(i_size < i_blocks * 4)
+        {
+            throw RUNTIME_EXCEPTION("Compressed frame is damaged.");
+        }
+        std::vector<uint16_t> residuals((size_t)header.i_block_rows * header.i_samples_per_row);
+        const uint8_t* p_in = p_data + i_blocks * 4;
+        uint64_t i_remaining = i_size - i_blocks * 4;
+        for(size_t b = 0; b < i_blocks; b++)
+        {
+            const size_t i_first_row = b * header.i_block_rows;
+            const size_t i_rows = std::min<size_t>(header.i_block_rows, header.i_height - i_first_row);
+            const size_t i_samples = i_rows * header.i_samples_per_row;
+            T* p_block = p_frame + i_first_row * header.i_samples_per_row;
+
+            const uint32_t i_block_size = get_size(p_data + b * 4);
+            const uint32_t i_bytes = i_block_size & ~STORED_BLOCK;
+            if(i_bytes > i_remaining || ((i_block_size & STORED_BLOCK) != 0 && i_bytes != i_samples * sizeof(T)))
+            {
+                throw RUNTIME_EXCEPTION("Compressed frame is damaged.");
+            }
+            if((i_block_size & STORED_BLOCK) != 0)
+            {
+                memcpy(p_block, p_in, i_bytes);
+            }
+            else
+            {
+                rice_decode(p_in, i_bytes, i_samples, header.i_bits_per_sample, &residuals[0]);
+                block_samples(&residuals[0], i_rows, header.i_samples_per_row, header.i_column_step, header.i_row_step, p_block);
+            }
+            p_in += i_bytes;
+            i_remaining -= i_bytes;
+        }
+    }
+}
+
+
+namespace BaslerHelper {
+
+    //---------------------------------------------------------------------
+    // Packed formats are coded unpacked, the neighbours of Bayer samples
+    // are two samples away
+    void init_compressed_header(CompressedStreamHeader& header,
+                                const uint32_t i_width,
+                                const uint32_t i_height,
+                                const Pylon::EPixelType ept_pixel_type)
+    {
+        Pylon::EPixelType ept_stored_type = ept_pixel_type;
+        Pylon::EPixelType ept_unpacked_type;
+        if(unpacked_format(ept_pixel_type, ept_unpacked_type))
+        {
+            ept_stored_type = ept_unpacked_type;
+        }
+        const uint32_t i_bands = Pylon::SamplesPerPixel(ept_stored_type);
+        const uint32_t i_bits = Pylon::BitPerPixel(ept_stored_type);
+        if(i_bands == 0 || i_bits % i_bands != 0 || (i_bits / i_bands != 8 && i_bits / i_bands != 16))
+        {
+            throw RUNTIME_EXCEPTION("Pixel format %s cannot be compressed, save with another output type.",
+                    Pylon::CPixelTypeMapper::GetNameByPixelType(ept_pixel_type));
+        }
+
+        memset(&header, 0, sizeof(header));
+        memcpy(header.s_magic, COMPRESSED_STREAM_MAGIC, sizeof(header.s_magic));
+        header.i_version = COMPRESSED_STREAM_VERSION;
+        header.i_header_size = 256;
+        header.i_width = i_width;
+        header.i_height = i_height;
+        header.i_pixel_type = (int32_t)ept_stored_type;
+        header.i_bits_per_sample = i_bits / i_bands;
+        header.i_samples_per_row = i_width * i_bands;
+        header.i_column_step = Pylon::IsBayer(ept_stored_type) ? 2 : i_bands;
+        header.i_row_step = Pylon::IsBayer(ept_stored_type) ? 2 : 1;
+        header.i_block_rows = COMPRESSED_STREAM_BLOCK_ROWS;
+        header.i_frame_bytes = (uint64_t)header.i_samples_per_row * i_height * (header.i_bits_per_sample / 8);
+        strncpy(header.s_pixel_format,
+                Pylon::CPixelTypeMapper::GetNameByPixelType(ept_stored_type),
+                sizeof(header.s_pixel_format) - 1);
+    }
+
+    //---------------------------------------------------------------------
+    // Encoder for frames of a pixel type
+    FrameEncoder::FrameEncoder(const CompressedStreamHeader& header, const Pylon::EPixelType ept_pixel_type)
+        : m_header(header), m_ept_pixel_type(ept_pixel_type),
+          m_b_unpack(ept_pixel_type != (Pylon::EPixelType)header.i_pixel_type)
+    {
+        if(m_b_unpack)
+        {
+            m_i_frame_bytes = (uint64_t)packed_row_bytes(ept_pixel_type, header.i_width) * header.i_height;
+            m_unpacked.resize((size_t)header.i_width * header.i_height);
+        }
+        else
+        {
+            m_i_frame_bytes = header.i_frame_bytes;
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Compress a frame
+    const std::vector<uint8_t>& FrameEncoder::encode(const void* p_frame)
+    {
+        if(m_b_unpack)
+        {
+            unpack_rows(p_frame, m_ept_pixel_type, &m_unpacked[0], m_header.i_height, m_header.i_width, 0);
+            encode_frame(m_header, &m_unpacked[0], m_residuals, m_data);
+        }
+        else if(m_header.i_bits_per_sample == 8)
+        {
+            encode_frame(m_header, static_cast<const uint8_t*>(p_frame), m_residuals, m_data);
+        }
+        else
+        {
+            encode_frame(m_header, static_cast<const uint16_t*>(p_frame), m_residuals, m_data);
+        }
+        return m_data;
+    }
+
+    //---------------------------------------------------------------------
+    // Decompress a frame
+    void decode_frame(const CompressedStreamHeader& header, const uint8_t* p_data, const uint64_t i_size, void* p_frame)
+    {
+        if(header.i_bits_per_sample == 8)
+        {
+            decode_blocks(header, p_data, i_size, static_cast<uint8_t*>(p_frame));
+        }
+        else
+        {
+            decode_blocks(header, p_data, i_size, static_cast<uint16_t*>(p_frame));
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Create file and write a preliminary header, so that an aborted
+    // recording is recognized
+    CompressedStreamWriter::CompressedStreamWriter( const std::string& s_filename,
+                                                    const uint32_t i_width,
+                                                    const uint32_t i_height,
+                                                    const Pylon::EPixelType ept_pixel_type,
+                                                    const uint64_t i_frame_capacity)
+        : m_index(i_frame_capacity), m_i_end(0), m_i_frame_end(0), m_p_file(NULL)
+    {
+        init_compressed_header(m_header, i_width, i_height, ept_pixel_type);
+
+        m_p_file = fopen(s_filename.c_str(), "wb");
+        if(m_p_file == NULL)
+        {
+            throw RUNTIME_EXCEPTION("Cannot create file %s: %s", s_filename.c_str(), strerror(errno));
+        }
+        setvbuf(m_p_file, NULL, _IOFBF, 1 << 20);
+
+        std::vector<char> header_block(m_header.i_header_size, 0);
+        memcpy(&header_block[0], &m_header, sizeof(m_header));
+        if(fwrite(&header_block[0], 1, header_block.size(), m_p_file) != header_block.size())
+        {
+            fclose(m_p_file);
+            m_p_file = NULL;
+            throw RUNTIME_EXCEPTION("Cannot write to file %s.", s_filename.c_str());
+        }
+        m_i_end = m_header.i_header_size;
+    }
+
+    //---------------------------------------------------------------------
+    // Finish file if close was not called, e.g. after an error
+    CompressedStreamWriter::~CompressedStreamWriter()
+    {
+        try
+        {
+            if(m_p_file != NULL)
+            {
+                close(m_i_frame_end);
+            }
+        }
+        catch (GenICam::GenericException &e)
+        {
+            // Keep the frames written so far
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Append one frame, the compression runs before in the writer threads
+    void CompressedStreamWriter::write_frame(   const uint64_t i_frame,
+                                                const std::vector<uint8_t>& data,
+                                                const uint64_t i_timestamp,
+                                                const int64_t i_image_number)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(i_frame >= m_index.size())
+        {
+            throw RUNTIME_EXCEPTION("Compressed stream file is full.");
+        }
+        if(!data.empty() && fwrite(&data[0], 1, data.size(), m_p_file) != data.size())
+        {
+            throw RUNTIME_EXCEPTION("Cannot write to compressed stream file: %s", strerror(errno));
+        }
+        m_index[i_frame].i_offset = m_i_end;
+        m_index[i_frame].i_size = data.size();
+        m_index[i_frame].i_timestamp = i_timestamp;
+        m_index[i_frame].i_image_number = i_image_number;
+        m_i_end += data.size();
+        m_i_frame_end = std::max(m_i_frame_end, i_frame + 1);
+    }
+
+    //---------------------------------------------------------------------
+    // Write the index after the frames, aligned to 8 bytes, then the final
+    // header
+    void CompressedStreamWriter::close(const uint64_t i_frame_count)
+    {
+        FILE* p_file = m_p_file;
+        m_p_file = NULL;
+        m_header.i_frame_count = std::min<uint64_t>(i_frame_count, m_index.size());
+        m_header.i_index_offset = (m_i_end + 7) / 8 * 8;
+        const char s_padding[8] = {0};
+        bool b_ok = fwrite(s_padding, 1, (size_t)(m_header.i_index_offset - m_i_end), p_file) == m_header.i_index_offset - m_i_end;
+        b_ok = b_ok && (m_header.i_frame_count == 0 || fwrite(&m_index[0], sizeof(CompressedStreamIndexEntry),
+                (size_t)m_header.i_frame_count, p_file) == m_header.i_frame_count);
+        b_ok = b_ok && fseek(p_file, 0, SEEK_SET) == 0 && fwrite(&m_header, sizeof(m_header), 1, p_file) == 1;
+        b_ok = (fclose(p_file) == 0) && b_ok;
+        if(!b_ok)
+        {
+            throw RUNTIME_EXCEPTION("Cannot write index of compressed stream file.");
+        }
+    }
+
+}
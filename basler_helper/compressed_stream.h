@@ -0,0 +1,144 @@
+// compressed_stream.h - Single file container for losslessly compressed frames
+// 17.10.2026 / agent
+//
+// File layout:
+//   - Header (CompressedStreamHeader), padded to 256 bytes
+//   - Compressed frames, in the order they were finished
+//   - Frame index (CompressedStreamIndexEntry per frame), aligned to 8 bytes
+// A compressed frame starts with the sizes of its blocks (uint32 each),
+// followed by the blocks. A block holds i_block_rows rows and is coded on
+// its own: every sample is predicted from its neighbours of the same
+// colour (left, above and above left, LOCO-I median predictor), the
+// residuals are zigzag mapped and Rice coded in groups of 32 samples with
+// a parameter per group. Blocks which do not get smaller are stored.
+// Packed 10 and 12 bit formats are unpacked to 16 bit before coding.
+
+#ifndef __COMPRESSEDSTREAM_H_INCLUDED__
+#define __COMPRESSEDSTREAM_H_INCLUDED__
+
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <pylon/PylonIncludes.h>
+
+
+namespace BaslerHelper {
+
+    // File identification
+    const char COMPRESSED_STREAM_MAGIC[8] = {'B','S','L','C','M','P','0','1'};
+    const uint32_t COMPRESSED_STREAM_VERSION = 1;
+
+    // Rows per independently coded block
+    const uint32_t COMPRESSED_STREAM_BLOCK_ROWS = 16;
+
+    //---------------------------------------------------------------------
+    // File header, all offsets in bytes from the start of the file
+    struct CompressedStreamHeader
+    {
+        char     s_magic[8];
+        uint32_t i_version;
+        uint32_t i_header_size;
+        uint32_t i_width;
+        uint32_t i_height;
+        int32_t  i_pixel_type;          // Pylon::EPixelType of the decoded frames
+        uint32_t i_bits_per_sample;     // 8 or 16
+        uint32_t i_samples_per_row;
+        uint32_t i_column_step;         // Distance to the left neighbour of the same colour
+        uint32_t i_row_step;            // Distance to the upper neighbour of the same colour
+        uint32_t i_block_rows;
+        uint64_t i_frame_bytes;         // Size of a decoded frame
+        uint64_t i_frame_count;
+        uint64_t i_index_offset;
+        char     s_pixel_format[32];    // Pylon name of the pixel type
+    };
+
+    //---------------------------------------------------------------------
+    // Frame index entry, a size of 0 marks a frame which was not written
+    struct CompressedStreamIndexEntry
+    {
+        uint64_t i_offset;
+        uint64_t i_size;
+        uint64_t i_timestamp;           // Camera timestamp in ticks
+        int64_t  i_image_number;        // Pylon image number
+    };
+
+    // Fill the header for frames of a pixel type, the type of the decoded
+    // frames differs for packed formats. Throws for unsupported formats.
+    void init_compressed_header(CompressedStreamHeader& header,
+                                const uint32_t i_width,
+                                const uint32_t i_height,
+                                const Pylon::EPixelType ept_pixel_type);
+
+    //---------------------------------------------------------------------
+    // Compresses frames of one pixel type, one encoder per thread
+    class FrameEncoder
+    {
+    public:
+        FrameEncoder(   const CompressedStreamHeader& header,
+                        const Pylon::EPixelType ept_pixel_type);
+
+        // Compress a frame of the encoder's pixel type, the result is
+        // valid until the next call
+        const std::vector<uint8_t>& encode(const void* p_frame);
+
+        // Size of an uncompressed frame of the encoder's pixel type
+        uint64_t frame_bytes() const { return m_i_frame_bytes; }
+
+    private:
+        CompressedStreamHeader m_header;
+        Pylon::EPixelType m_ept_pixel_type;
+        bool m_b_unpack;
+        uint64_t m_i_frame_bytes;
+        std::vector<uint16_t> m_unpacked;
+        std::vector<uint16_t> m_residuals;
+        std::vector<uint8_t> m_data;
+    };
+
+    // Decompress a frame into i_frame_bytes of the header
+    void decode_frame(  const CompressedStreamHeader& header,
+                        const uint8_t* p_data,
+                        const uint64_t i_size,
+                        void* p_frame);
+
+    //---------------------------------------------------------------------
+    // Appends compressed frames to a container. Frames with different
+    // numbers may be written concurrently from several threads, in any
+    // order.
+    class CompressedStreamWriter
+    {
+    public:
+        CompressedStreamWriter( const std::string& s_filename,
+                                const uint32_t i_width,
+                                const uint32_t i_height,
+                                const Pylon::EPixelType ept_pixel_type,
+                                const uint64_t i_frame_capacity);
+        ~CompressedStreamWriter();
+
+        const CompressedStreamHeader& header() const { return m_header; }
+
+        // Append frame number i_frame
+        void write_frame(   const uint64_t i_frame,
+                            const std::vector<uint8_t>& data,
+                            const uint64_t i_timestamp,
+                            const int64_t i_image_number);
+
+        // Write index and header
+        void close(const uint64_t i_frame_count);
+
+    private:
+        CompressedStreamWriter(const CompressedStreamWriter&);
+        CompressedStreamWriter& operator=(const CompressedStreamWriter&);
+
+        CompressedStreamHeader m_header;
+        std::vector<CompressedStreamIndexEntry> m_index;
+        std::mutex m_mutex;
+        uint64_t m_i_end;
+        uint64_t m_i_frame_end;
+        FILE* m_p_file;
+    };
+
+}
+
+#endif
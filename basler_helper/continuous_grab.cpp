@@ -0,0 +1,156 @@
+// continuous_grab.cpp - Continuous acquisition into a ring buffer
+// 17.10.2026 / agent
+
+
+#include "continuous_grab.h"
+#include <algorithm>
+
+
+namespace BaslerHelper {
+
+    //---------------------------------------------------------------------
+    // Start grabbing and the thread retrieving the frames
+    ContinuousGrab::ContinuousGrab( Pylon::CInstantCamera* camera,
+                                    const size_t i_buffer_size,
+                                    const Pylon::EGrabStrategy egs_strategy)
+        : m_camera(camera), m_ring(std::max<size_t>(i_buffer_size, 1)),
+          m_b_stop(false), m_i_grabbed(0), m_i_dropped(0)
+    {
+        if(m_camera->IsGrabbing())
+        {
+            m_camera->StopGrabbing();
+        }
+        m_camera->StartGrabbing(egs_strategy);
+        m_thread = std::thread(&ContinuousGrab::run, this);
+    }
+
+    //---------------------------------------------------------------------
+    // Stop thread and grabbing
+    ContinuousGrab::~ContinuousGrab()
+    {
+        m_b_stop.store(true);
+        m_thread.join();
+        try
+        {
+            m_camera->StopGrabbing();
+        }
+        catch (GenICam::GenericException &e)
+        {
+            // Camera may have been removed
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Grab thread: copy every frame into the oldest slot of the ring
+    void ContinuousGrab::run()
+    {
+        std::shared_ptr<RingFrame> p_spare(new RingFrame);
+        Pylon::CGrabResultPtr p_grab_result;
+        unsigned long long i_sequence = 0;
+        size_t i_head = 0;
+        try
+        {
+            while(!m_b_stop.load() && m_camera->IsGrabbing())
+            {
+                if(!m_camera->RetrieveResult(100, p_grab_result, Pylon::TimeoutHandling_Return))
+                {
+                    continue;
+                }
+
+                // Frames skipped by the grab strategy and failed grabs
+                m_i_dropped.fetch_add(p_grab_result->GetNumberOfSkippedImages());
+                if(!p_grab_result->GrabSucceeded())
+                {
+                    m_i_dropped.fetch_add(1);
+                    continue;
+                }
+
+                // Correct the exposure before the frame is copied, to
+                // keep the loop short
+                {
+                    std::lock_guard<std::mutex> lock(m_exposure_mutex);
+                    if(m_p_exposure)
+                    {
+                        m_p_exposure->update(p_grab_result);
+                    }
+                }
+
+                // Do not overwrite a frame still read by Matlab
+                if(p_spare.use_count() != 1)
+                {
+                    p_spare.reset(new RingFrame);
+                }
+                p_spare->image.CopyImage(p_grab_result);
+                p_spare->i_image_number = p_grab_result->GetImageNumber();
+                p_spare->i_timestamp = p_grab_result->GetTimeStamp();
+                p_spare->i_sequence = i_sequence++;
+                p_grab_result.Release();
+
+                // Publish frame, the replaced one is reused next time
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_ring[i_head].swap(p_spare);
+                }
+                i_head = (i_head + 1) % m_ring.size();
+                m_i_grabbed.fetch_add(1);
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_error = std::current_exception();
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Swap the controller between two frames
+    void ContinuousGrab::set_exposure_controller(std::unique_ptr<ExposureController> p_controller)
+    {
+        std::lock_guard<std::mutex> lock(m_exposure_mutex);
+        m_p_exposure = std::move(p_controller);
+    }
+
+    //---------------------------------------------------------------------
+    // Copy of the controller's status
+    bool ContinuousGrab::exposure_status(ExposureStatus& status)
+    {
+        std::lock_guard<std::mutex> lock(m_exposure_mutex);
+        if(!m_p_exposure)
+        {
+            return false;
+        }
+        status = m_p_exposure->status();
+        return true;
+    }
+
+    //---------------------------------------------------------------------
+    // Newest frames, oldest first
+    std::vector<std::shared_ptr<const RingFrame> > ContinuousGrab::latest(const size_t i_num_of_frames)
+    {
+        std::vector<std::shared_ptr<const RingFrame> > frames;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if(m_error)
+            {
+                std::rethrow_exception(m_error);
+            }
+            for(size_t i = 0; i < m_ring.size(); i++)
+            {
+                if(m_ring[i])
+                {
+                    frames.push_back(m_ring[i]);
+                }
+            }
+        }
+
+        std::sort(frames.begin(), frames.end(),
+                [](const std::shared_ptr<const RingFrame>& a, const std::shared_ptr<const RingFrame>& b)
+                { return a->i_sequence < b->i_sequence; });
+        if(frames.size() > i_num_of_frames)
+        {
+            frames.erase(frames.begin(), frames.end() - i_num_of_frames);
+        }
+        return frames;
+    }
+
+}
@@ -0,0 +1,84 @@
+// continuous_grab.h - Continuous acquisition into a ring buffer
+// 17.10.2026 / agent
+//
+// A background thread retrieves the frames of a grabbing camera and keeps
+// the latest ones in a ring buffer. Matlab fetches copies of the newest
+// frames at its own rate without stopping the acquisition. An exposure
+// controller can be attached, it sees every frame as soon as it arrived.
+
+#ifndef __CONTINUOUSGRAB_H_INCLUDED__
+#define __CONTINUOUSGRAB_H_INCLUDED__
+
+#include <pylon/PylonIncludes.h>
+#include "exposure_control.h"
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace BaslerHelper {
+
+    //---------------------------------------------------------------------
+    // A frame in the ring buffer, stored in the camera's pixel format
+    struct RingFrame
+    {
+        RingFrame() : i_image_number(0), i_timestamp(0), i_sequence(0) {}
+        Pylon::CPylonImage image;
+        long long i_image_number;
+        unsigned long long i_timestamp;
+        unsigned long long i_sequence;      // Counts all frames of this grab
+    };
+
+    //---------------------------------------------------------------------
+    // Grabs continuously until destroyed
+    class ContinuousGrab
+    {
+    public:
+        ContinuousGrab( Pylon::CInstantCamera* camera,
+                        const size_t i_buffer_size,
+                        const Pylon::EGrabStrategy egs_strategy);
+        ~ContinuousGrab();
+
+        // Up to i_num_of_frames newest frames, oldest first. The frames are
+        // not overwritten while referenced. Rethrows an error of the grab
+        // thread.
+        std::vector<std::shared_ptr<const RingFrame> > latest(const size_t i_num_of_frames);
+
+        // Number of frames in the ring buffer
+        size_t buffer_size() const { return m_ring.size(); }
+
+        // Frames retrieved and lost since the start
+        unsigned long long frames_grabbed() const { return m_i_grabbed.load(); }
+        unsigned long long frames_dropped() const { return m_i_dropped.load(); }
+
+        // Attach an exposure controller, replacing the current one. NULL
+        // detaches it, the camera keeps the last written values.
+        void set_exposure_controller(std::unique_ptr<ExposureController> p_controller);
+
+        // Status of the attached controller, false if there is none
+        bool exposure_status(ExposureStatus& status);
+
+    private:
+        ContinuousGrab(const ContinuousGrab&);
+        ContinuousGrab& operator=(const ContinuousGrab&);
+
+        void run();
+
+        Pylon::CInstantCamera* m_camera;
+        std::vector<std::shared_ptr<RingFrame> > m_ring;
+        std::mutex m_mutex;
+        std::exception_ptr m_error;
+        std::atomic<bool> m_b_stop;
+        std::atomic<unsigned long long> m_i_grabbed;
+        std::atomic<unsigned long long> m_i_dropped;
+        std::unique_ptr<ExposureController> m_p_exposure;
+        std::mutex m_exposure_mutex;
+        std::thread m_thread;
+    };
+
+}
+
+#endif
@@ -0,0 +1,181 @@
+// crop_image.h - Copy windows of a frame into Matlab's memory layout
+// 17.10.2026 / agent
+//
+// Windows of a row-major frame are decimated or binned and written into
+// compact column-major arrays, so only the requested pixels are copied.
+// Strips of output rows are reduced into a small planar buffer and then
+// transposed into the output, with the SIMD kernels of transpose_image
+// for 8 and 16 bit samples.
+
+#ifndef __CROPIMAGE_H_INCLUDED__
+#define __CROPIMAGE_H_INCLUDED__
+
+#include "transpose_image.h"
+#include <cstddef>
+#include <limits>
+#include <stdint.h>
+#include <vector>
+
+
+namespace BaslerHelper {
+
+    // Output rows reduced before they are transposed into the output
+    const size_t CROP_STRIP_ROWS = 32;
+
+    //---------------------------------------------------------------------
+    // Reduction of factor x factor pixels to one
+    enum BinningMode
+    {
+        Binning_Decimate,       // Top left pixel of each block
+        Binning_Sum,            // Sum of the block, as double
+        Binning_Average         // Rounded mean of the block
+    };
+
+    //---------------------------------------------------------------------
+    // Window of the frame, in pixels of the frame
+    struct CropWindow
+    {
+        size_t i_x;
+        size_t i_y;
+        size_t i_width;
+        size_t i_height;
+    };
+
+    //---------------------------------------------------------------------
+    // Windows to copy instead of the whole frame, and their outputs
+    struct CropSettings
+    {
+        CropSettings() : i_factor(1), bm_mode(Binning_Decimate) {}
+        std::vector<CropWindow> windows;
+        unsigned int i_factor;
+        BinningMode bm_mode;
+        std::vector<void*> outputs;         // Array of each window, holding
+                                            // height x width x samples x
+                                            // frames values
+
+        size_t output_height(const size_t i_window) const { return windows[i_window].i_height / i_factor; }
+        size_t output_width(const size_t i_window) const { return windows[i_window].i_width / i_factor; }
+    };
+
+    //---------------------------------------------------------------------
+    // Transpose a reduced strip of one band into the output
+    inline void store_strip(const uint8_t* p_strip, uint8_t* p_dst, const size_t i_dst_stride,
+            const size_t i_rows, const size_t i_cols)
+    {
+        transpose_plane(p_strip, i_cols, p_dst, i_dst_stride, i_rows, i_cols);
+    }
+
+    inline void store_strip(const uint16_t* p_strip, uint16_t* p_dst, const size_t i_dst_stride,
+            const size_t i_rows, const size_t i_cols)
+    {
+        transpose_plane(p_strip, i_cols, p_dst, i_dst_stride, i_rows, i_cols);
+    }
+
+    template <typename T>
+    void store_strip(const T* p_strip, T* p_dst, const size_t i_dst_stride,
+            const size_t i_rows, const size_t i_cols)
+    {
+        for (size_t j = 0; j < i_cols; j++)
+        {
+            for (size_t i = 0; i < i_rows; i++)
+            {
+                p_dst[j*i_dst_stride + i] = p_strip[i*i_cols + j];
+            }
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Reduce a window of the frame p_src, i_src_width pixels of i_bands
+    // samples per row, into the height x width x bands output p_dst
+    template <typename T_in, typename T_out>
+    void crop_window(   const T_in* p_src,
+                        const size_t i_src_width,
+                        const unsigned int i_bands,
+                        const CropWindow& window,
+                        const unsigned int i_factor,
+                        const BinningMode bm_mode,
+                        T_out* p_dst)
+    {
+        const size_t i_height = window.i_height / i_factor;
+        const size_t i_width = window.i_width / i_factor;
+        const size_t i_src_stride = i_src_width * i_bands;
+        const T_in* p_window = p_src + window.i_y * i_src_stride + window.i_x * i_bands;
+
+        // Strip of each band, kept per thread, every worker copies frames
+        static thread_local std::vector<T_out> strip;
+        strip.resize(i_bands * CROP_STRIP_ROWS * i_width);
+
+        for (size_t i0 = 0; i0 < i_height; i0 += CROP_STRIP_ROWS)
+        {
+            const size_t i_rows = (i0 + CROP_STRIP_ROWS < i_height) ? CROP_STRIP_ROWS : i_height - i0;
+            for (size_t i = 0; i < i_rows; i++)
+            {
+                const T_in* p_row = p_window + (i0 + i) * i_factor * i_src_stride;
+                for (unsigned int b = 0; b < i_bands; b++)
+                {
+                    T_out* p_strip_row = &strip[(b * CROP_STRIP_ROWS + i) * i_width];
+                    for (size_t j = 0; j < i_width; j++)
+                    {
+                        const T_in* p_block = p_row + j * i_factor * i_bands + b;
+                        if (bm_mode == Binning_Decimate || i_factor == 1)
+                        {
+                            p_strip_row[j] = (T_out)p_block[0];
+                            continue;
+                        }
+                        double d_sum = 0;
+                        for (unsigned int u = 0; u < i_factor; u++)
+                        {
+                            for (unsigned int v = 0; v < i_factor; v++)
+                            {
+                                d_sum += p_block[u * i_src_stride + v * i_bands];
+                            }
+                        }
+                        if (bm_mode == Binning_Sum)
+                        {
+                            p_strip_row[j] = (T_out)d_sum;
+                        }
+                        else
+                        {
+                            p_strip_row[j] = (T_out)(d_sum / (i_factor * i_factor) +
+                                    (std::numeric_limits<T_out>::is_integer ? 0.5 : 0.0));
+                        }
+                    }
+                }
+            }
+            for (unsigned int b = 0; b < i_bands; b++)
+            {
+                store_strip(&strip[b * CROP_STRIP_ROWS * i_width], p_dst + b * i_height * i_width + i0,
+                        i_height, i_rows, i_width);
+            }
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Reduce all windows of a frame into frame i_frame of their outputs.
+    // Sums are written as double, else as T.
+    template <typename T>
+    void crop_frame(const T* p_src,
+                    const size_t i_src_width,
+                    const unsigned int i_bands,
+                    const CropSettings& crop,
+                    const size_t i_frame)
+    {
+        for (size_t k = 0; k < crop.windows.size(); k++)
+        {
+            const size_t i_numel = crop.output_height(k) * crop.output_width(k) * i_bands;
+            if (crop.bm_mode == Binning_Sum)
+            {
+                crop_window(p_src, i_src_width, i_bands, crop.windows[k], crop.i_factor, crop.bm_mode,
+                        static_cast<double*>(crop.outputs[k]) + i_frame * i_numel);
+            }
+            else
+            {
+                crop_window(p_src, i_src_width, i_bands, crop.windows[k], crop.i_factor, crop.bm_mode,
+                        static_cast<T*>(crop.outputs[k]) + i_frame * i_numel);
+            }
+        }
+    }
+
+}
+
+#endif
@@ -0,0 +1,506 @@
+// debayer_image.cpp - Native color conversion into Matlab's memory layout
+// 17.10.2026 / agent
+//
+// Bilinear interpolation computes, for every pixel of a row, the average
+// of its horizontal, vertical, diagonal and cross neighbours and picks
+// the right one per color and column parity. This runs with SSE2 on 16
+// (8 bit) or 8 (16 bit) pixels at once. The gradient-corrected kernels
+// need signed 32 bit sums of a 5x5 neighbourhood and run scalar. Rows
+// and columns outside the image are mirrored, which keeps the Bayer
+// pattern intact.
+
+
+#include "debayer_image.h"
+#include "transpose_image.h"
+#include "unpack_image.h"
+#include <cstring>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define BASLER_HAS_X86
+#include <emmintrin.h>
+#endif
+
+
+namespace {
+
+    // Rows interpolated before they are transposed into the output
+    const size_t DEBAYER_STRIP_ROWS = 32;
+
+    //---------------------------------------------------------------------
+    // Position of the red pixel in the 2x2 Bayer tile
+    struct BayerLayout
+    {
+        size_t i_red_row;       // 0 or 1
+        size_t i_red_col;       // 0 or 1
+    };
+
+    //---------------------------------------------------------------------
+    // Layout and bit depth of a Bayer format, false for other formats
+    bool bayer_format(const Pylon::EPixelType ept_type, BayerLayout& layout, unsigned int& i_bits)
+    {
+        switch (ept_type)
+        {
+            case Pylon::PixelType_BayerRG8:  layout.i_red_row = 0; layout.i_red_col = 0; i_bits = 8;  return true;
+            case Pylon::PixelType_BayerGR8:  layout.i_red_row = 0; layout.i_red_col = 1; i_bits = 8;  return true;
+            case Pylon::PixelType_BayerGB8:  layout.i_red_row = 1; layout.i_red_col = 0; i_bits = 8;  return true;
+            case Pylon::PixelType_BayerBG8:  layout.i_red_row = 1; layout.i_red_col = 1; i_bits = 8;  return true;
+            case Pylon::PixelType_BayerRG10: layout.i_red_row = 0; layout.i_red_col = 0; i_bits = 10; return true;
+            case Pylon::PixelType_BayerGR10: layout.i_red_row = 0; layout.i_red_col = 1; i_bits = 10; return true;
+            case Pylon::PixelType_BayerGB10: layout.i_red_row = 1; layout.i_red_col = 0; i_bits = 10; return true;
+            case Pylon::PixelType_BayerBG10: layout.i_red_row = 1; layout.i_red_col = 1; i_bits = 10; return true;
+            case Pylon::PixelType_BayerRG12: layout.i_red_row = 0; layout.i_red_col = 0; i_bits = 12; return true;
+            case Pylon::PixelType_BayerGR12: layout.i_red_row = 0; layout.i_red_col = 1; i_bits = 12; return true;
+            case Pylon::PixelType_BayerGB12: layout.i_red_row = 1; layout.i_red_col = 0; i_bits = 12; return true;
+            case Pylon::PixelType_BayerBG12: layout.i_red_row = 1; layout.i_red_col = 1; i_bits = 12; return true;
+            default: return false;
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Bit depth of an unpacked mono format, false for other formats
+    bool mono_format(const Pylon::EPixelType ept_type, unsigned int& i_bits)
+    {
+        switch (ept_type)
+        {
+            case Pylon::PixelType_Mono8:  i_bits = 8;  return true;
+            case Pylon::PixelType_Mono10: i_bits = 10; return true;
+            case Pylon::PixelType_Mono12: i_bits = 12; return true;
+            case Pylon::PixelType_Mono16: i_bits = 16; return true;
+            default: return false;
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Bit depth and plane of red, green and blue of an output format,
+    // false for other formats
+    bool output_format(const Pylon::EPixelType ept_type, unsigned int& i_bits, size_t i_planes[3])
+    {
+        i_planes[0] = 0; i_planes[1] = 1; i_planes[2] = 2;
+        switch (ept_type)
+        {
+            case Pylon::PixelType_RGB8packed:
+            case Pylon::PixelType_RGB8planar:
+                i_bits = 8;
+                return true;
+            case Pylon::PixelType_BGR8packed:
+                i_bits = 8;
+                i_planes[0] = 2; i_planes[2] = 0;
+                return true;
+            case Pylon::PixelType_RGB16packed:
+            case Pylon::PixelType_RGB16planar:
+                i_bits = 16;
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Index of a mirrored row or column
+    inline size_t mirror(ptrdiff_t i, const size_t i_size)
+    {
+        if (i < 0)
+        {
+            i = -i;
+        }
+        if (i >= (ptrdiff_t)i_size)
+        {
+            i = 2*(ptrdiff_t)i_size - 2 - i;
+        }
+        return i < 0 ? 0 : (size_t)i;
+    }
+
+    //---------------------------------------------------------------------
+    // Rounded average, the same as the SSE2 instructions compute
+    template <typename T>
+    inline T average(const T a, const T b)
+    {
+        return (T)(((unsigned int)a + (unsigned int)b + 1) >> 1);
+    }
+
+    //---------------------------------------------------------------------
+    // Bilinear interpolation of columns [i_col_begin,i_col_end) of a row.
+    // b_red_row tells if the row holds red or blue pixels, i_red_col is
+    // the column parity of the red (red row) or green (blue row) pixels.
+    template <typename T>
+    void bilinear_pixels(   const T* p_up, const T* p_mid, const T* p_down,
+                            const size_t i_width, const bool b_red_row, const size_t i_red_col,
+                            const size_t i_col_begin, const size_t i_col_end,
+                            T* p_red, T* p_green, T* p_blue)
+    {
+        for (size_t c = i_col_begin; c < i_col_end; c++)
+        {
+            const size_t cl = mirror((ptrdiff_t)c - 1, i_width);
+            const size_t cr = mirror((ptrdiff_t)c + 1, i_width);
+            const T C = p_mid[c];
+            const T H = average(p_mid[cl], p_mid[cr]);
+            const T V = average(p_up[c], p_down[c]);
+            const T X = average(average(p_up[cl], p_up[cr]), average(p_down[cl], p_down[cr]));
+            const T P = average(H, V);
+            const bool b_first = (c & 1) == i_red_col;
+            if (b_red_row)
+            {
+                p_red[c] = b_first ? C : H;
+                p_green[c] = b_first ? P : C;
+                p_blue[c] = b_first ? X : V;
+            }
+            else
+            {
+                p_red[c] = b_first ? V : X;
+                p_green[c] = b_first ? C : P;
+                p_blue[c] = b_first ? H : C;
+            }
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // No SIMD kernel, all columns are done by bilinear_pixels
+    template <typename T>
+    size_t bilinear_simd(   const T*, const T*, const T*, const bool, const size_t,
+                            const size_t i_col_begin, const size_t, T*, T*, T*)
+    {
+        return i_col_begin;
+    }
+
+#ifdef BASLER_HAS_X86
+
+    //---------------------------------------------------------------------
+    // Pick a where the mask is set, else b
+    inline __m128i select(const __m128i m, const __m128i a, const __m128i b)
+    {
+        return _mm_or_si128(_mm_and_si128(m, a), _mm_andnot_si128(m, b));
+    }
+
+    //---------------------------------------------------------------------
+    // SSE2: 16 pixels of 8 bit per step, starting at an even column.
+    // Returns the first column not done.
+    size_t bilinear_simd(   const uint8_t* p_up, const uint8_t* p_mid, const uint8_t* p_down,
+                            const bool b_red_row, const size_t i_red_col,
+                            const size_t i_col_begin, const size_t i_col_end,
+                            uint8_t* p_red, uint8_t* p_green, uint8_t* p_blue)
+    {
+        const __m128i m_even = _mm_set1_epi16(0x00FF);
+        const __m128i m_first = i_red_col == 0 ? m_even : _mm_andnot_si128(m_even, _mm_set1_epi8((char)0xFF));
+        size_t c = i_col_begin;
+        for (; c + 16 < i_col_end; c += 16)
+        {
+            const __m128i C = _mm_loadu_si128((const __m128i*)(p_mid + c));
+            const __m128i H = _mm_avg_epu8(_mm_loadu_si128((const __m128i*)(p_mid + c - 1)),
+                                           _mm_loadu_si128((const __m128i*)(p_mid + c + 1)));
+            const __m128i V = _mm_avg_epu8(_mm_loadu_si128((const __m128i*)(p_up + c)),
+                                           _mm_loadu_si128((const __m128i*)(p_down + c)));
+            const __m128i X = _mm_avg_epu8(
+                    _mm_avg_epu8(_mm_loadu_si128((const __m128i*)(p_up + c - 1)), _mm_loadu_si128((const __m128i*)(p_up + c + 1))),
+                    _mm_avg_epu8(_mm_loadu_si128((const __m128i*)(p_down + c - 1)), _mm_loadu_si128((const __m128i*)(p_down + c + 1))));
+            const __m128i P = _mm_avg_epu8(H, V);
+            if (b_red_row)
+            {
+                _mm_storeu_si128((__m128i*)(p_red + c), select(m_first, C, H));
+                _mm_storeu_si128((__m128i*)(p_green + c), select(m_first, P, C));
+                _mm_storeu_si128((__m128i*)(p_blue + c), select(m_first, X, V));
+            }
+            else
+            {
+                _mm_storeu_si128((__m128i*)(p_red + c), select(m_first, V, X));
+                _mm_storeu_si128((__m128i*)(p_green + c), select(m_first, C, P));
+                _mm_storeu_si128((__m128i*)(p_blue + c), select(m_first, H, C));
+            }
+        }
+        return c;
+    }
+
+    //---------------------------------------------------------------------
+    // SSE2: 8 pixels of 16 bit per step, starting at an even column.
+    // Returns the first column not done.
+    size_t bilinear_simd(   const uint16_t* p_up, const uint16_t* p_mid, const uint16_t* p_down,
+                            const bool b_red_row, const size_t i_red_col,
+                            const size_t i_col_begin, const size_t i_col_end,
+                            uint16_t* p_red, uint16_t* p_green, uint16_t* p_blue)
+    {
+        const __m128i m_even = _mm_set1_epi32(0x0000FFFF);
+        const __m128i m_first = i_red_col == 0 ? m_even : _mm_andnot_si128(m_even, _mm_set1_epi8((char)0xFF));
+        size_t c = i_col_begin;
+        for (; c + 8 < i_col_end; c += 8)
+        {
+            const __m128i C = _mm_loadu_si128((const __m128i*)(p_mid + c));
+            const __m128i H = _mm_avg_epu16(_mm_loadu_si128((const __m128i*)(p_mid + c - 1)),
+                                            _mm_loadu_si128((const __m128i*)(p_mid + c + 1)));
+            const __m128i V = _mm_avg_epu16(_mm_loadu_si128((const __m128i*)(p_up + c)),
+                                            _mm_loadu_si128((const __m128i*)(p_down + c)));
+            const __m128i X = _mm_avg_epu16(
+                    _mm_avg_epu16(_mm_loadu_si128((const __m128i*)(p_up + c - 1)), _mm_loadu_si128((const __m128i*)(p_up + c + 1))),
+                    _mm_avg_epu16(_mm_loadu_si128((const __m128i*)(p_down + c - 1)), _mm_loadu_si128((const __m128i*)(p_down + c + 1))));
+            const __m128i P = _mm_avg_epu16(H, V);
+            if (b_red_row)
+            {
+                _mm_storeu_si128((__m128i*)(p_red + c), select(m_first, C, H));
+                _mm_storeu_si128((__m128i*)(p_green + c), select(m_first, P, C));
+                _mm_storeu_si128((__m128i*)(p_blue + c), select(m_first, X, V));
+            }
+            else
+            {
+                _mm_storeu_si128((__m128i*)(p_red + c), select(m_first, V, X));
+                _mm_storeu_si128((__m128i*)(p_green + c), select(m_first, C, P));
+                _mm_storeu_si128((__m128i*)(p_blue + c), select(m_first, H, C));
+            }
+        }
+        return c;
+    }
+
+#endif
+
+    //---------------------------------------------------------------------
+    // Bilinear interpolation of a row, SIMD for the inner columns
+    template <typename T>
+    void bilinear_row(  const T* p_up, const T* p_mid, const T* p_down,
+                        const size_t i_width, const bool b_red_row, const size_t i_red_col,
+                        T* p_red, T* p_green, T* p_blue)
+    {
+        const size_t i_inner_begin = i_width < 2 ? i_width : 2;
+        const size_t i_inner_end = i_width < 1 ? 0 : i_width - 1;
+        bilinear_pixels(p_up, p_mid, p_down, i_width, b_red_row, i_red_col, 0, i_inner_begin, p_red, p_green, p_blue);
+        const size_t c = (i_inner_begin < i_inner_end) ? bilinear_simd(p_up, p_mid, p_down, b_red_row, i_red_col,
+                i_inner_begin, i_inner_end, p_red, p_green, p_blue) : i_inner_begin;
+        bilinear_pixels(p_up, p_mid, p_down, i_width, b_red_row, i_red_col, c, i_width, p_red, p_green, p_blue);
+    }
+
+    //---------------------------------------------------------------------
+    // Round a sum of 16 times the value and clip it to [0,i_max]
+    template <typename T>
+    inline T clip16(const int i_sum, const int i_max)
+    {
+        const int i_value = (i_sum + 8) >> 4;
+        return (T)(i_value < 0 ? 0 : (i_value > i_max ? i_max : i_value));
+    }
+
+    //---------------------------------------------------------------------
+    // Gradient-corrected linear interpolation of a row (Malvar, He and
+    // Cutler 2004), p_rows are the rows -2..2 around the row
+    template <typename T>
+    void gradient_row(  const T* const p_rows[5],
+                        const size_t i_width, const bool b_red_row, const size_t i_red_col,
+                        const int i_max, T* p_red, T* p_green, T* p_blue)
+    {
+        for (size_t c = 0; c < i_width; c++)
+        {
+            size_t cc[5];
+            for (int k = 0; k < 5; k++)
+            {
+                cc[k] = mirror((ptrdiff_t)c + k - 2, i_width);
+            }
+            const int C = p_rows[2][c];
+            const int N = p_rows[1][c], S = p_rows[3][c], W = p_rows[2][cc[1]], E = p_rows[2][cc[3]];
+            const int NN = p_rows[0][c], SS = p_rows[4][c], WW = p_rows[2][cc[0]], EE = p_rows[2][cc[4]];
+            const int D = p_rows[1][cc[1]] + p_rows[1][cc[3]] + p_rows[3][cc[1]] + p_rows[3][cc[3]];
+
+            // Sums of 16 times the interpolated value
+            const bool b_first = (c & 1) == i_red_col;
+            if (b_first != b_red_row)
+            {
+                // Green pixel, red or blue left/right and up/down
+                const int i_horizontal = 10*C + 8*(W + E) - 2*D - 2*(WW + EE) + (NN + SS);
+                const int i_vertical = 10*C + 8*(N + S) - 2*D - 2*(NN + SS) + (WW + EE);
+                p_green[c] = (T)C;
+                p_red[c] = clip16<T>(b_red_row ? i_horizontal : i_vertical, i_max);
+                p_blue[c] = clip16<T>(b_red_row ? i_vertical : i_horizontal, i_max);
+            }
+            else
+            {
+                // Red or blue pixel, green in the cross, the other color
+                // in the diagonals
+                const int i_green = 8*C + 4*(N + S + W + E) - 2*(NN + SS + WW + EE);
+                const int i_other = 12*C + 4*D - 3*(NN + SS + WW + EE);
+                p_green[c] = clip16<T>(i_green, i_max);
+                p_red[c] = b_red_row ? (T)C : clip16<T>(i_other, i_max);
+                p_blue[c] = b_red_row ? clip16<T>(i_other, i_max) : (T)C;
+            }
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Interpolate strips of rows and transpose their planes into the
+    // output. Values are shifted left by i_shift bits.
+    template <typename T>
+    void convert_bayer( const T* p_src,
+                        T* p_dst,
+                        const size_t i_height,
+                        const size_t i_width,
+                        const BayerLayout& layout,
+                        const unsigned int i_bits,
+                        const unsigned int i_shift,
+                        const size_t i_planes[3],
+                        const BaslerHelper::ColorConversion cc_method)
+    {
+        // Strip buffers are kept per thread, every worker converts frames
+        static thread_local std::vector<T> strip;
+        strip.resize(3 * DEBAYER_STRIP_ROWS * i_width);
+        T* p_strip[3] = { &strip[0], &strip[DEBAYER_STRIP_ROWS * i_width], &strip[2 * DEBAYER_STRIP_ROWS * i_width] };
+        const int i_max = (1 << i_bits) - 1;
+
+        for (size_t i0 = 0; i0 < i_height; i0 += DEBAYER_STRIP_ROWS)
+        {
+            const size_t i_rows = (i0 + DEBAYER_STRIP_ROWS < i_height) ? DEBAYER_STRIP_ROWS : i_height - i0;
+            for (size_t i = 0; i < i_rows; i++)
+            {
+                const size_t r = i0 + i;
+                const bool b_red_row = (r & 1) == layout.i_red_row;
+                T* p_red = p_strip[0] + i * i_width;
+                T* p_green = p_strip[1] + i * i_width;
+                T* p_blue = p_strip[2] + i * i_width;
+                if (cc_method == BaslerHelper::ColorConversion_GradientCorrected)
+                {
+                    const T* p_rows[5];
+                    for (int k = 0; k < 5; k++)
+                    {
+                        p_rows[k] = p_src + mirror((ptrdiff_t)r + k - 2, i_height) * i_width;
+                    }
+                    gradient_row(p_rows, i_width, b_red_row, layout.i_red_col, i_max, p_red, p_green, p_blue);
+                }
+                else
+                {
+                    bilinear_row(p_src + mirror((ptrdiff_t)r - 1, i_height) * i_width, p_src + r * i_width,
+                            p_src + mirror((ptrdiff_t)r + 1, i_height) * i_width,
+                            i_width, b_red_row, layout.i_red_col, p_red, p_green, p_blue);
+                }
+            }
+
+            for (int k = 0; k < 3; k++)
+            {
+                if (i_shift > 0)
+                {
+                    for (size_t i = 0; i < i_rows * i_width; i++)
+                    {
+                        p_strip[k][i] = (T)(p_strip[k][i] << i_shift);
+                    }
+                }
+                BaslerHelper::transpose_plane(p_strip[k], i_width,
+                        p_dst + i_planes[k] * i_height * i_width + i0, i_height, i_rows, i_width);
+            }
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Transpose a mono frame into the first plane and copy it into the
+    // others
+    template <typename T>
+    void convert_mono(  const T* p_src,
+                        T* p_dst,
+                        const size_t i_height,
+                        const size_t i_width,
+                        const unsigned int i_shift)
+    {
+        const size_t i_numel = i_height * i_width;
+        BaslerHelper::transpose_image(p_src, p_dst, i_height, i_width, 1);
+        if (i_shift > 0)
+        {
+            for (size_t i = 0; i < i_numel; i++)
+            {
+                p_dst[i] = (T)(p_dst[i] << i_shift);
+            }
+        }
+        memcpy(p_dst + i_numel, p_dst, i_numel * sizeof(T));
+        memcpy(p_dst + 2 * i_numel, p_dst, i_numel * sizeof(T));
+    }
+}
+
+
+namespace BaslerHelper {
+
+    //---------------------------------------------------------------------
+    // Check for a native kernel
+    bool can_convert_native(const Pylon::EPixelType ept_input_type, const Pylon::EPixelType ept_output_type)
+    {
+        BayerLayout layout;
+        unsigned int i_input_bits, i_output_bits;
+        size_t i_planes[3];
+
+        // Packed frames are unpacked, or unpacked and converted to RGB
+        Pylon::EPixelType ept_unpacked_type;
+        if (unpacked_format(ept_input_type, ept_unpacked_type))
+        {
+            if (ept_output_type == ept_input_type || ept_output_type == ept_unpacked_type ||
+                    (ept_output_type == Pylon::PixelType_Mono16 && mono_format(ept_unpacked_type, i_input_bits)))
+            {
+                return true;
+            }
+        }
+
+        if (!output_format(ept_output_type, i_output_bits, i_planes))
+        {
+            return false;
+        }
+        if (!bayer_format(ept_unpacked_type, layout, i_input_bits) && !mono_format(ept_unpacked_type, i_input_bits))
+        {
+            return false;
+        }
+        return (i_input_bits == 8) == (i_output_bits == 8);
+    }
+
+    //---------------------------------------------------------------------
+    // Convert a frame with the native kernels
+    void convert_native(const void* p_src,
+                        const Pylon::EPixelType ept_input_type,
+                        void* p_dst,
+                        const Pylon::EPixelType ept_output_type,
+                        const size_t i_height,
+                        const size_t i_width,
+                        const ColorConversion cc_method)
+    {
+        BayerLayout layout;
+        unsigned int i_input_bits, i_output_bits;
+        size_t i_planes[3];
+
+        // Packed frames: unpack only, to Mono16 shifted to the most
+        // significant bits. Else unpack the whole frame before the color
+        // conversion, which needs the rows around each row.
+        Pylon::EPixelType ept_unpacked_type;
+        if (unpacked_format(ept_input_type, ept_unpacked_type))
+        {
+            if (!output_format(ept_output_type, i_output_bits, i_planes))
+            {
+                if (!mono_format(ept_unpacked_type, i_input_bits))
+                {
+                    bayer_format(ept_unpacked_type, layout, i_input_bits);
+                }
+                unpack_image(p_src, ept_input_type, static_cast<uint16_t*>(p_dst), i_height, i_width,
+                        ept_output_type == Pylon::PixelType_Mono16 ? 16 - i_input_bits : 0);
+                return;
+            }
+            static thread_local std::vector<uint16_t> unpacked;
+            unpacked.resize(i_height * i_width);
+            unpack_rows(p_src, ept_input_type, &unpacked[0], i_height, i_width, 0);
+            convert_native(&unpacked[0], ept_unpacked_type, p_dst, ept_output_type, i_height, i_width, cc_method);
+            return;
+        }
+
+        output_format(ept_output_type, i_output_bits, i_planes);
+        if (bayer_format(ept_input_type, layout, i_input_bits))
+        {
+            if (i_input_bits == 8)
+            {
+                convert_bayer(static_cast<const uint8_t*>(p_src), static_cast<uint8_t*>(p_dst),
+                        i_height, i_width, layout, i_input_bits, 0, i_planes, cc_method);
+            }
+            else
+            {
+                convert_bayer(static_cast<const uint16_t*>(p_src), static_cast<uint16_t*>(p_dst),
+                        i_height, i_width, layout, i_input_bits, 16 - i_input_bits, i_planes, cc_method);
+            }
+        }
+        else if (mono_format(ept_input_type, i_input_bits))
+        {
+            if (i_input_bits == 8)
+            {
+                convert_mono(static_cast<const uint8_t*>(p_src), static_cast<uint8_t*>(p_dst),
+                        i_height, i_width, 0);
+            }
+            else
+            {
+                convert_mono(static_cast<const uint16_t*>(p_src), static_cast<uint16_t*>(p_dst),
+                        i_height, i_width, 16 - i_input_bits);
+            }
+        }
+    }
+
+}
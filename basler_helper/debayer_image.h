@@ -0,0 +1,54 @@
+// debayer_image.h - Native color conversion into Matlab's memory layout
+// 17.10.2026 / agent
+//
+// Bayer and mono frames are converted to RGB and written into the
+// column-major, band-planar Matlab array in one pass, instead of a
+// conversion by Pylon into a packed image followed by transpose_image.
+// The image is processed in strips of rows: the color planes of a strip
+// are interpolated into small row-major buffers which stay in the cache
+// and are then transposed into the output with the transpose_image
+// kernels. Pixel formats without a native kernel use Pylon's converter.
+
+#ifndef __DEBAYERIMAGE_H_INCLUDED__
+#define __DEBAYERIMAGE_H_INCLUDED__
+
+#include <pylon/PylonIncludes.h>
+#include <cstddef>
+
+
+namespace BaslerHelper {
+
+    //---------------------------------------------------------------------
+    // Color conversion of Bayer frames
+    enum ColorConversion
+    {
+        ColorConversion_Pylon,              // Always use CImageFormatConverter
+        ColorConversion_Bilinear,           // Native bilinear interpolation
+        ColorConversion_GradientCorrected   // Native gradient-corrected linear
+                                            // interpolation (Malvar, He and
+                                            // Cutler), sharper edges
+    };
+
+    // True if frames of ept_input_type can be converted to ept_output_type
+    // natively: Bayer RG/GB/GR/BG 8, 10 and 12 and Mono 8, 10, 12 and 16 to
+    // RGB8/BGR8 (8 bit input) or RGB16 (10 to 16 bit input). Packed 10
+    // and 12 bit formats (see unpack_image.h) are also unpacked to their
+    // own or the unpacked format, mono ones also to Mono16.
+    bool can_convert_native(const Pylon::EPixelType ept_input_type,
+                            const Pylon::EPixelType ept_output_type);
+
+    // Convert a frame into the height x width x 3 (x 1 if unpacked only)
+    // column-major output. 10 and 12 bit values are shifted to the most
+    // significant bits for RGB16 and Mono16, like Pylon's converter does.
+    // Needs can_convert_native.
+    void convert_native(const void* p_src,
+                        const Pylon::EPixelType ept_input_type,
+                        void* p_dst,
+                        const Pylon::EPixelType ept_output_type,
+                        const size_t i_height,
+                        const size_t i_width,
+                        const ColorConversion cc_method);
+
+}
+
+#endif
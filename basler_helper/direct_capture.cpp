@@ -0,0 +1,240 @@
+// direct_capture.cpp - Grab frames directly into a Matlab array
+// 17.10.2026 / agent
+
+
+#include "direct_capture.h"
+#include "basler_set_get.h"
+#include "capture_images.h"
+#include <chrono>
+#include <cstring>
+#include <vector>
+#include <mex.h>
+
+
+namespace {
+
+    //---------------------------------------------------------------------
+    // Stops grabbing and restores the camera's own buffers when going out
+    // of scope. The output array must not be touched by Pylon afterwards.
+    struct RestoreBufferFactory
+    {
+        RestoreBufferFactory(Pylon::CInstantCamera* camera)
+            : camera(camera), i_max_num_buffer(camera->MaxNumBuffer.GetValue()) {}
+        ~RestoreBufferFactory()
+        {
+            try
+            {
+                if(camera->IsGrabbing())
+                {
+                    camera->StopGrabbing();
+                }
+                camera->SetBufferFactory(NULL, Pylon::Cleanup_None);
+                camera->MaxNumBuffer = i_max_num_buffer;
+            }
+            catch (GenICam::GenericException &e)
+            {
+                // Camera may have been removed
+            }
+        }
+        Pylon::CInstantCamera* camera;
+        int64_t i_max_num_buffer;
+    };
+}
+
+
+namespace BaslerHelper {
+
+    //---------------------------------------------------------------------
+    // Buffer factory for the frames of the output array
+    OutputBufferFactory::OutputBufferFactory(uint8_t* p_output, const size_t i_frame_bytes, const size_t i_num_of_frames)
+        : m_p_output(p_output), m_i_frame_bytes(i_frame_bytes), m_i_num_of_frames(i_num_of_frames), m_i_allocated(0)
+    {
+    }
+
+    //---------------------------------------------------------------------
+    // Hand out the next frame of the output array
+    void OutputBufferFactory::AllocateBuffer(size_t i_buffer_size, void** p_created_buffer, intptr_t& i_buffer_context)
+    {
+        if(i_buffer_size > m_i_frame_bytes)
+        {
+            throw RUNTIME_EXCEPTION("Grab buffer of %u bytes does not fit into a frame of %u bytes.",
+                    (unsigned int)i_buffer_size, (unsigned int)m_i_frame_bytes);
+        }
+        if(m_i_allocated >= m_i_num_of_frames)
+        {
+            throw RUNTIME_EXCEPTION("More grab buffers than frames requested.");
+        }
+        *p_created_buffer = m_p_output + m_i_allocated * m_i_frame_bytes;
+        i_buffer_context = (intptr_t)m_i_allocated;
+        m_i_allocated++;
+    }
+
+    //---------------------------------------------------------------------
+    // The output array is freed by Matlab
+    void OutputBufferFactory::FreeBuffer(void* p_created_buffer, intptr_t i_buffer_context)
+    {
+    }
+
+    //---------------------------------------------------------------------
+    // The factory is owned by the caller
+    void OutputBufferFactory::DestroyBufferFactory()
+    {
+    }
+
+    //---------------------------------------------------------------------
+    // Check if no conversion is needed and the payload is the bare image
+    bool can_capture_direct(FrameSource* source, const Pylon::EPixelType ept_output_type)
+    {
+        Pylon::EPixelType ept_camera_type = source->pixel_type();
+        const unsigned int i_bits = Pylon::BitPerPixel(ept_camera_type);
+        if(ept_camera_type != ept_output_type || Pylon::SamplesPerPixel(ept_camera_type) != 1 || (i_bits != 8 && i_bits != 16))
+        {
+            return false;
+        }
+
+        // Chunk data is appended to the image
+        return source->payload_size() == source->width() * source->height() * i_bits / 8;
+    }
+
+    //---------------------------------------------------------------------
+    // Grab into the output array
+    int capture_images_direct(FrameSource* source, const int i_num_of_frames, mxArray* mxa_output,
+            const bool b_verbose, FrameMetadata* p_metadata, const TriggerSettings* p_trigger,
+            LatencyHistogram* p_latency, GrabThread* p_grab_thread)
+    {
+        Pylon::CInstantCamera* camera = source->camera();
+        if(camera == NULL)
+        {
+            throw RUNTIME_EXCEPTION("Grabbing directly into the output array needs a camera.");
+        }
+        const size_t i_frame_bytes = mxGetNumberOfElements(mxa_output) / i_num_of_frames * mxGetElementSize(mxa_output);
+        uint8_t* p_output = static_cast<uint8_t*> (mxGetData(mxa_output));
+
+        // One buffer per frame, so that no frame is overwritten
+        OutputBufferFactory factory(p_output, i_frame_bytes, i_num_of_frames);
+        if(camera->IsGrabbing())
+        {
+            camera->StopGrabbing();
+        }
+        RestoreBufferFactory restore(camera);
+        camera->SetBufferFactory(&factory, Pylon::Cleanup_None);
+        camera->MaxNumBuffer = i_num_of_frames;
+        if(b_verbose)
+        {
+            mexPrintf("Grabbing directly into the output array\n");
+        }
+        if(p_latency != NULL)
+        {
+            p_latency->resize(i_num_of_frames);
+        }
+
+        // Arm the trigger once. Keep all results, a released buffer would
+        // be queued again.
+        const TriggerSettings free_run;
+        const TriggerSettings& trigger = (p_trigger != NULL) ? *p_trigger : free_run;
+        ArmedTrigger armed_trigger(source, trigger);
+        camera->StartGrabbing(i_num_of_frames, Pylon::GrabStrategy_OneByOne);
+        std::vector<Pylon::CGrabResultPtr> results(i_num_of_frames);
+        // Also after an error, grabbing stops before the results are
+        // released, so that their buffers are not queued again
+        StopGrabbing stop_grabbing(source);
+        int i_dropped = 0;
+        bool b_in_order = true;
+        run_grab_loop(p_grab_thread, [&]()
+        {
+            unsigned long long i_last_block_id = 0;
+            for(int i_cur_frame=0; i_cur_frame<i_num_of_frames; i_cur_frame++)
+            {
+                // A frame not arriving in time is handled like in
+                // capture_images, its slice stays zero
+                try
+                {
+                    std::chrono::steady_clock::time_point tp_start;
+                    if(trigger.software())
+                    {
+                        tp_start = source->execute_software_trigger(trigger.i_timeout_ms);
+                    }
+                    if(!camera->RetrieveResult(trigger.i_timeout_ms, results[i_cur_frame], Pylon::TimeoutHandling_Return)
+                       || !results[i_cur_frame].IsValid())
+                    {
+                        results[i_cur_frame].Release();
+                        throw TIMEOUT_EXCEPTION("No frame retrieved within %u ms.", trigger.i_timeout_ms);
+                    }
+                    if(p_latency != NULL)
+                    {
+                        p_latency->tp_starts[i_cur_frame] = trigger.software() ? tp_start : std::chrono::steady_clock::now();
+                    }
+                }
+                catch (GenICam::TimeoutException&)
+                {
+                    if(trigger.to_policy == Timeout_Error)
+                    {
+                        throw;
+                    }
+                    b_in_order = false;
+                    if(trigger.to_policy == Timeout_Skip)
+                    {
+                        i_dropped++;
+                        continue;
+                    }
+                    i_dropped += i_num_of_frames - i_cur_frame;
+                    break;
+                }
+                if(results[i_cur_frame]->GrabSucceeded())
+                {
+                    i_dropped += lost_frames(results[i_cur_frame]->GetBlockID(), i_last_block_id);
+                }
+                else
+                {
+                    i_dropped++;
+                    memset(results[i_cur_frame]->GetBuffer(), 0, i_frame_bytes);
+                }
+                b_in_order = b_in_order && (results[i_cur_frame]->GetBufferContext() == i_cur_frame);
+                if(p_latency != NULL)
+                {
+                    p_latency->stop(i_cur_frame);
+                }
+            }
+        });
+        camera->StopGrabbing();
+
+        // Metadata in the order of retrieval, like the frames below
+        if(p_metadata != NULL)
+        {
+            p_metadata->resize(i_num_of_frames);
+            SourceFrame frame;
+            for(int i_cur_frame=0; i_cur_frame<i_num_of_frames; i_cur_frame++)
+            {
+                if(results[i_cur_frame].IsValid())
+                {
+                    frame.p_grab_result = results[i_cur_frame];
+                    read_grab_result(frame);
+                    p_metadata->set(i_cur_frame, frame);
+                }
+            }
+        }
+
+        // Buffers are filled in the order they were queued, but sort the
+        // frames by retrieval if the grab engine did it differently or a
+        // frame timed out. Frames not retrieved are zero.
+        if(!b_in_order)
+        {
+            std::vector<uint8_t> frames(p_output, p_output + i_num_of_frames * i_frame_bytes);
+            for(int i_cur_frame=0; i_cur_frame<i_num_of_frames; i_cur_frame++)
+            {
+                if(results[i_cur_frame].IsValid())
+                {
+                    memcpy(p_output + i_cur_frame * i_frame_bytes,
+                            &frames[0] + results[i_cur_frame]->GetBufferContext() * i_frame_bytes, i_frame_bytes);
+                }
+                else
+                {
+                    memset(p_output + i_cur_frame * i_frame_bytes, 0, i_frame_bytes);
+                }
+            }
+        }
+
+        return i_dropped;
+    }
+
+}
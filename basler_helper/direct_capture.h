@@ -0,0 +1,66 @@
+// direct_capture.h - Grab frames directly into a Matlab array
+// 17.10.2026 / agent
+//
+// A buffer factory hands slices of the output array to Pylon as grab
+// buffers, so the camera writes every frame straight into its final place.
+// The frames stay row-major, Matlab sees them transposed (width x height).
+// This only works if the camera's frames need no conversion, i.e. for
+// unpacked mono formats returned in the camera's pixel format.
+
+#ifndef __DIRECTCAPTURE_H_INCLUDED__
+#define __DIRECTCAPTURE_H_INCLUDED__
+
+#include <pylon/PylonIncludes.h>
+#include <matrix.h>
+#include "frame_metadata.h"
+#include "frame_source.h"
+#include "grab_options.h"
+#include "trigger_capture.h"
+#include <stdint.h>
+
+
+namespace BaslerHelper {
+
+    //---------------------------------------------------------------------
+    // Hands out one slice of the output array per grab buffer
+    class OutputBufferFactory : public Pylon::IBufferFactory
+    {
+    public:
+        OutputBufferFactory(uint8_t* p_output, const size_t i_frame_bytes, const size_t i_num_of_frames);
+
+        void AllocateBuffer(size_t i_buffer_size, void** p_created_buffer, intptr_t& i_buffer_context);
+        void FreeBuffer(void* p_created_buffer, intptr_t i_buffer_context);
+        void DestroyBufferFactory();
+
+    private:
+        uint8_t* m_p_output;
+        size_t m_i_frame_bytes;
+        size_t m_i_num_of_frames;
+        size_t m_i_allocated;
+    };
+
+    // True if the frames of the source can be grabbed directly into an
+    // array of type ept_output_type
+    bool can_capture_direct(FrameSource* source,
+                            const Pylon::EPixelType ept_output_type);
+
+    // Captures the specified number of images directly into the (already
+    // existing!) width x height x frames Matlab array. source has to be a
+    // camera. Returns the number of dropped frames, their slices are set
+    // to zero. The metadata of every frame is stored in p_metadata, if
+    // given. p_trigger arms the camera's trigger and sets the timeout
+    // policy, without it the camera runs free and a timeout of 5 s is an
+    // error. The latency of every frame is measured into p_latency, if
+    // given. The frames are retrieved in p_grab_thread, if given.
+    int capture_images_direct(  FrameSource* source,
+                                const int i_num_of_frames,
+                                mxArray* mxa_output,
+                                const bool b_verbose,
+                                FrameMetadata* p_metadata = NULL,
+                                const TriggerSettings* p_trigger = NULL,
+                                LatencyHistogram* p_latency = NULL,
+                                GrabThread* p_grab_thread = NULL);
+
+}
+
+#endif
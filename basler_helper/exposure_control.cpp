@@ -0,0 +1,302 @@
+// exposure_control.cpp - Closed-loop exposure and gain control in the grab thread
+// 17.10.2026 / agent
+
+
+#include "exposure_control.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <mex.h>
+
+
+namespace {
+
+    //---------------------------------------------------------------------
+    // Non-negative field of the settings struct, d_value is kept if it is
+    // missing or empty
+    void get_setting(const mxArray* mxa_settings, const char* s_name, double& d_value)
+    {
+        const mxArray* mxa_field = mxGetField(mxa_settings, 0, s_name);
+        if(mxa_field != NULL && !mxIsEmpty(mxa_field))
+        {
+            d_value = mxGetScalar(mxa_field);
+            if(!(d_value >= 0) || std::isinf(d_value))
+            {
+                mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                        "%s must be a non-negative number.", s_name);
+            }
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Count every i_step-th pixel of every i_step-th row into four partial
+    // histograms, so that consecutive equal samples do not wait for each
+    // other's increment
+    template <typename T>
+    void count_samples( const uint8_t* p_image,
+                        const size_t i_width,
+                        const size_t i_height,
+                        const size_t i_row_bytes,
+                        const unsigned int i_samples,
+                        const unsigned int i_shift,
+                        const size_t i_step,
+                        uint32_t p_partial[4][256])
+    {
+        for(size_t y = 0; y < i_height; y += i_step)
+        {
+            const T* p_row = reinterpret_cast<const T*>(p_image + y * i_row_bytes);
+            if(i_samples == 1)
+            {
+                size_t x = 0;
+                for(; x + 3 * i_step < i_width; x += 4 * i_step)
+                {
+                    p_partial[0][std::min<unsigned int>(p_row[x] >> i_shift, 255)]++;
+                    p_partial[1][std::min<unsigned int>(p_row[x + i_step] >> i_shift, 255)]++;
+                    p_partial[2][std::min<unsigned int>(p_row[x + 2 * i_step] >> i_shift, 255)]++;
+                    p_partial[3][std::min<unsigned int>(p_row[x + 3 * i_step] >> i_shift, 255)]++;
+                }
+                for(; x < i_width; x += i_step)
+                {
+                    p_partial[0][std::min<unsigned int>(p_row[x] >> i_shift, 255)]++;
+                }
+            }
+            else
+            {
+                for(size_t x = 0; x < i_width; x += i_step)
+                {
+                    const T* p_pixel = p_row + x * i_samples;
+                    for(unsigned int s = 0; s < i_samples; s++)
+                    {
+                        p_partial[s & 3][std::min<unsigned int>(p_pixel[s] >> i_shift, 255)]++;
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+namespace BaslerHelper {
+
+    //---------------------------------------------------------------------
+    // Read the fields of the settings struct
+    void parse_exposure_settings(const mxArray* mxa_settings, ExposureSettings& settings)
+    {
+        if(!mxIsStruct(mxa_settings))
+        {
+            mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                    "settings must be a struct, see help baslerAutoExposure.");
+        }
+        double d_every = settings.i_every;
+        double d_subsample = settings.i_subsample;
+        get_setting(mxa_settings, "Target", settings.d_target);
+        get_setting(mxa_settings, "Kp", settings.d_kp);
+        get_setting(mxa_settings, "Ki", settings.d_ki);
+        get_setting(mxa_settings, "Tolerance", settings.d_tolerance);
+        get_setting(mxa_settings, "Every", d_every);
+        get_setting(mxa_settings, "Subsample", d_subsample);
+        get_setting(mxa_settings, "ExposureMin", settings.d_exposure_min);
+        get_setting(mxa_settings, "ExposureMax", settings.d_exposure_max);
+        get_setting(mxa_settings, "GainMax", settings.d_gain_max);
+        if(settings.d_target <= 0 || settings.d_target >= 1)
+        {
+            mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                    "Target must be between 0 and 1.");
+        }
+        if(d_every < 1 || d_subsample < 1 || d_every > 1e6 || d_subsample > 1e6)
+        {
+            mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                    "Every and Subsample must be positive integers.");
+        }
+        settings.i_every = (unsigned int)d_every;
+        settings.i_subsample = (unsigned int)d_subsample;
+    }
+
+    //---------------------------------------------------------------------
+    // Unpacked formats with 8 or 16 bit samples
+    bool can_measure_brightness(const Pylon::EPixelType ept_pixel_type)
+    {
+        const unsigned int i_samples = Pylon::SamplesPerPixel(ept_pixel_type);
+        const unsigned int i_bits = Pylon::BitPerPixel(ept_pixel_type);
+        return i_samples > 0 && !Pylon::IsPacked(ept_pixel_type) && !Pylon::IsPlanar(ept_pixel_type)
+                && (i_bits == 8 * i_samples || i_bits == 16 * i_samples) && Pylon::BitDepth(ept_pixel_type) >= 8;
+    }
+
+    //---------------------------------------------------------------------
+    // Histogram of the upper 8 bits of the subsampled pixels
+    void brightness_histogram(  const void* p_image,
+                                const Pylon::EPixelType ept_pixel_type,
+                                const size_t i_width,
+                                const size_t i_height,
+                                const size_t i_row_bytes,
+                                const unsigned int i_subsample,
+                                uint32_t p_histogram[256])
+    {
+        uint32_t p_partial[4][256];
+        memset(p_partial, 0, sizeof(p_partial));
+
+        const unsigned int i_samples = Pylon::SamplesPerPixel(ept_pixel_type);
+        const unsigned int i_shift = Pylon::BitDepth(ept_pixel_type) - 8;
+        const size_t i_step = std::max<unsigned int>(i_subsample, 1);
+        if(Pylon::BitPerPixel(ept_pixel_type) == 8 * i_samples)
+        {
+            count_samples<uint8_t>(static_cast<const uint8_t*>(p_image), i_width, i_height, i_row_bytes,
+                    i_samples, i_shift, i_step, p_partial);
+        }
+        else
+        {
+            count_samples<uint16_t>(static_cast<const uint8_t*>(p_image), i_width, i_height, i_row_bytes,
+                    i_samples, i_shift, i_step, p_partial);
+        }
+
+        for(int i = 0; i < 256; i++)
+        {
+            p_histogram[i] = p_partial[0][i] + p_partial[1][i] + p_partial[2][i] + p_partial[3][i];
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Take the handles and limits, start from the current settings
+    ExposureController::ExposureController( NodeCache& nodes,
+                                            const ExposureSettings& settings,
+                                            const Pylon::EPixelType ept_pixel_type,
+                                            const bool b_verbose)
+        : m_settings(settings), m_p_exposure(NULL), m_p_gain(NULL), m_d_gain_min(0), m_d_integral(0), m_i_wait(0)
+    {
+        if(!can_measure_brightness(ept_pixel_type))
+        {
+            throw RUNTIME_EXCEPTION("Auto exposure needs an unpacked pixel format with 8 or 16 bit samples.");
+        }
+
+        // GigE cameras of the first generation name the exposure differently
+        const char* s_exposure = nodes.contains("ExposureTime") ? "ExposureTime" : "ExposureTimeAbs";
+        m_p_exposure = &nodes.float_node(s_exposure);
+        if(nodes.contains("ExposureAuto") && IsWritable(nodes.node("ExposureAuto")))
+        {
+            nodes.set_string("ExposureAuto", "Off", b_verbose);
+        }
+        const double d_exposure_min = std::max(m_settings.d_exposure_min, m_p_exposure->GetMin());
+        const double d_exposure_max = m_settings.d_exposure_max > 0 ?
+                std::min(m_settings.d_exposure_max, m_p_exposure->GetMax()) : m_p_exposure->GetMax();
+        if(d_exposure_min > d_exposure_max)
+        {
+            throw RUNTIME_EXCEPTION("ExposureMin is above ExposureMax or the camera's maximum.");
+        }
+        m_settings.d_exposure_min = d_exposure_min;
+        m_settings.d_exposure_max = d_exposure_max;
+
+        // Gain in dB, as named by SFNC
+        double d_gain = 0;
+        double d_gain_max = 0;
+        if(m_settings.d_gain_max > 0)
+        {
+            if(!nodes.contains("Gain"))
+            {
+                throw RUNTIME_EXCEPTION("The camera has no Gain in dB, set GainMax to 0.");
+            }
+            m_p_gain = &nodes.float_node("Gain");
+            if(nodes.contains("GainAuto") && IsWritable(nodes.node("GainAuto")))
+            {
+                nodes.set_string("GainAuto", "Off", b_verbose);
+            }
+            m_d_gain_min = m_p_gain->GetMin();
+            d_gain_max = std::max(std::min(m_settings.d_gain_max, m_p_gain->GetMax()), m_d_gain_min);
+            m_settings.d_gain_max = d_gain_max;
+            d_gain = m_p_gain->GetValue();
+        }
+
+        // Range of ln(exposure * linear gain) and the starting point
+        const double d_ln_db = std::log(10.0) / 20.0;
+        m_d_u_min = std::log(d_exposure_min) + (m_p_gain != NULL ? m_d_gain_min * d_ln_db : 0);
+        m_d_u_max = std::log(d_exposure_max) + (m_p_gain != NULL ? d_gain_max * d_ln_db : 0);
+        m_status.d_exposure = m_p_exposure->GetValue();
+        m_status.d_gain = d_gain;
+        m_d_u0 = std::min(std::max(std::log(std::max(m_status.d_exposure, d_exposure_min)) + d_gain * d_ln_db,
+                m_d_u_min), m_d_u_max);
+
+        if(b_verbose)
+        {
+            mexPrintf("Auto exposure to %.2f of full scale, %s %.1f to %.1f us", m_settings.d_target, s_exposure,
+                    d_exposure_min, d_exposure_max);
+            if(m_p_gain != NULL)
+            {
+                mexPrintf(", Gain %.1f to %.1f dB", m_d_gain_min, d_gain_max);
+            }
+            mexPrintf(", every %u frame(s)\n", m_settings.i_every);
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Measure the frame, run the control law and write the result
+    void ExposureController::update(const Pylon::CGrabResultPtr& p_grab_result)
+    {
+        m_status.i_frames++;
+        if(m_i_wait > 0)
+        {
+            m_i_wait--;
+            return;
+        }
+        const std::chrono::steady_clock::time_point tp_start = std::chrono::steady_clock::now();
+
+        // Mean brightness of the frame
+        const Pylon::EPixelType ept_pixel_type = p_grab_result->GetPixelType();
+        if(!can_measure_brightness(ept_pixel_type))
+        {
+            throw RUNTIME_EXCEPTION("Auto exposure needs an unpacked pixel format with 8 or 16 bit samples.");
+        }
+        const size_t i_width = p_grab_result->GetWidth();
+        const size_t i_row_bytes = i_width * Pylon::BitPerPixel(ept_pixel_type) / 8 + p_grab_result->GetPaddingX();
+        uint32_t p_histogram[256];
+        brightness_histogram(p_grab_result->GetBuffer(), ept_pixel_type, i_width, p_grab_result->GetHeight(),
+                i_row_bytes, m_settings.i_subsample, p_histogram);
+        double d_count = 0;
+        double d_sum = 0;
+        for(int i = 0; i < 256; i++)
+        {
+            d_count += p_histogram[i];
+            d_sum += (double)i * p_histogram[i];
+        }
+        m_status.d_brightness = d_count > 0 ? d_sum / d_count / 255.0 : 0;
+        m_status.i_updates++;
+        m_i_wait = m_settings.i_every - 1;
+
+        // Nothing to do within the tolerance, the integral is kept
+        const double d_error = std::log(m_settings.d_target / std::max(m_status.d_brightness, 0.5 / 255.0));
+        if(std::fabs(d_error) <= std::log1p(m_settings.d_tolerance))
+        {
+            m_status.d_update_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - tp_start).count();
+            return;
+        }
+
+        // PI law, the integral follows the limited output
+        m_d_integral += d_error;
+        double d_u = m_d_u0 + m_settings.d_kp * d_error + m_settings.d_ki * m_d_integral;
+        if(d_u < m_d_u_min || d_u > m_d_u_max)
+        {
+            d_u = std::min(std::max(d_u, m_d_u_min), m_d_u_max);
+            if(m_settings.d_ki > 0)
+            {
+                m_d_integral = (d_u - m_d_u0 - m_settings.d_kp * d_error) / m_settings.d_ki;
+            }
+        }
+
+        // Exposure first, gain for the rest
+        const double d_ln_db = std::log(10.0) / 20.0;
+        const double d_gain_min = m_p_gain != NULL ? m_d_gain_min : 0;
+        const double d_exposure = std::min(std::max(std::exp(d_u - d_gain_min * d_ln_db),
+                m_settings.d_exposure_min), m_settings.d_exposure_max);
+        m_p_exposure->SetValue(d_exposure);
+        m_status.d_exposure = d_exposure;
+        if(m_p_gain != NULL)
+        {
+            const double d_gain = std::min(std::max((d_u - std::log(d_exposure)) / d_ln_db, m_d_gain_min),
+                    m_settings.d_gain_max);
+            m_p_gain->SetValue(d_gain);
+            m_status.d_gain = d_gain;
+        }
+        m_status.i_writes++;
+        m_status.d_update_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - tp_start).count();
+    }
+
+}
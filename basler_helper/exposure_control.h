@@ -0,0 +1,115 @@
+// exposure_control.h - Closed-loop exposure and gain control in the grab thread
+// 17.10.2026 / agent
+//
+// The controller runs in the thread which retrieves the frames, so a new
+// exposure is written as soon as a frame has arrived instead of after a
+// round trip through Matlab. The brightness of a frame is the mean of a
+// histogram of every i_subsample-th pixel in both directions. A PI law
+// works on the logarithm of exposure time times linear gain, where the
+// camera's response is linear:
+//   e = ln(target / brightness)
+//   u = u0 + Kp * e + Ki * sum(e)
+// Exposure time is raised first, gain only once the exposure reaches its
+// maximum. The integral is held while the output is limited. Exposure and
+// gain are written through node handles taken from the session's
+// NodeCache, nothing is read from the camera in the loop.
+
+#ifndef __EXPOSURECONTROL_H_INCLUDED__
+#define __EXPOSURECONTROL_H_INCLUDED__
+
+#include <pylon/PylonIncludes.h>
+#include <matrix.h>
+#include "node_cache.h"
+#include <stddef.h>
+#include <stdint.h>
+
+
+namespace BaslerHelper {
+
+    //---------------------------------------------------------------------
+    // Settings of the controller, limits of 0 take the camera's limits
+    struct ExposureSettings
+    {
+        ExposureSettings() : d_target(0.45), d_kp(0), d_ki(0.8), d_tolerance(0.02), i_every(2), i_subsample(4),
+                             d_exposure_min(0), d_exposure_max(0), d_gain_max(0) {}
+        double d_target;                    // Mean brightness, 0 to 1 of full scale
+        double d_kp;                        // Proportional gain on ln(target / brightness)
+        double d_ki;                        // Integral gain, per update
+        double d_tolerance;                 // Relative error without a write
+        unsigned int i_every;               // Frames between updates, the
+                                            // frame after a write is still
+                                            // exposed with the old value
+        unsigned int i_subsample;           // Pixel step of the histogram
+        double d_exposure_min;              // In us
+        double d_exposure_max;              // In us
+        double d_gain_max;                  // In dB, 0 leaves the gain alone
+    };
+
+    // Read the fields of a settings struct, all are optional
+    void parse_exposure_settings(const mxArray* mxa_settings, ExposureSettings& settings);
+
+    // True if brightness_histogram supports frames of the pixel type
+    bool can_measure_brightness(const Pylon::EPixelType ept_pixel_type);
+
+    // Histogram of the upper 8 bits of every i_subsample-th pixel in both
+    // directions, over all samples of a pixel. i_row_bytes includes the
+    // padding.
+    void brightness_histogram(  const void* p_image,
+                                const Pylon::EPixelType ept_pixel_type,
+                                const size_t i_width,
+                                const size_t i_height,
+                                const size_t i_row_bytes,
+                                const unsigned int i_subsample,
+                                uint32_t p_histogram[256]);
+
+    //---------------------------------------------------------------------
+    // State of the controller after its last update
+    struct ExposureStatus
+    {
+        ExposureStatus() : i_frames(0), i_updates(0), i_writes(0), d_brightness(0), d_exposure(0), d_gain(0),
+                           d_update_seconds(0) {}
+        unsigned long long i_frames;        // Frames seen
+        unsigned long long i_updates;       // Frames measured
+        unsigned long long i_writes;        // Updates which wrote to the camera
+        double d_brightness;                // Mean of the last measured frame, 0 to 1
+        double d_exposure;                  // Written exposure time, in us
+        double d_gain;                      // Written gain, in dB
+        double d_update_seconds;            // Histogram and write of the last update
+    };
+
+    //---------------------------------------------------------------------
+    // Controls ExposureTime and Gain of a camera from its frames. The
+    // constructor runs in the Matlab thread, update in the grab thread.
+    class ExposureController
+    {
+    public:
+        // Switches ExposureAuto and GainAuto off and takes the current
+        // exposure and gain as starting point. Throws if the camera has
+        // no float exposure time or its frames cannot be measured.
+        ExposureController( NodeCache& nodes,
+                            const ExposureSettings& settings,
+                            const Pylon::EPixelType ept_pixel_type,
+                            const bool b_verbose);
+
+        // Measure a frame and write new values if it is due
+        void update(const Pylon::CGrabResultPtr& p_grab_result);
+
+        const ExposureStatus& status() const { return m_status; }
+        const ExposureSettings& settings() const { return m_settings; }
+
+    private:
+        ExposureSettings m_settings;
+        GenApi::IFloat* m_p_exposure;
+        GenApi::IFloat* m_p_gain;           // NULL if the gain is not controlled
+        double m_d_gain_min;
+        double m_d_u0;                      // ln(exposure * linear gain) at the start
+        double m_d_u_min;
+        double m_d_u_max;
+        double m_d_integral;
+        unsigned int m_i_wait;              // Frames until the next update
+        ExposureStatus m_status;
+    };
+
+}
+
+#endif
@@ -0,0 +1,87 @@
+// frame_metadata.cpp - Per-frame metadata of a capture
+// 17.10.2026 / agent
+
+
+#include "frame_metadata.h"
+#include <cstdio>
+#include <cstring>
+#include <mex.h>
+
+
+namespace {
+
+    //---------------------------------------------------------------------
+    // n x 1 Matlab array of a metadata field
+    template <typename T>
+    mxArray* column_to_array(const std::vector<T>& values, const mxClassID mx_class)
+    {
+        mxArray* mxa_column = mxCreateNumericMatrix(values.size(), 1, mx_class, mxREAL);
+        if(!values.empty())
+        {
+            memcpy(mxGetData(mxa_column), &values[0], values.size() * sizeof(T));
+        }
+        return mxa_column;
+    }
+
+    //---------------------------------------------------------------------
+    // Append a metadata field to the sidecar file
+    template <typename T>
+    bool write_column(FILE* p_file, const std::vector<T>& values)
+    {
+        return values.empty() || fwrite(&values[0], sizeof(T), values.size(), p_file) == values.size();
+    }
+}
+
+
+namespace BaslerHelper {
+
+    //---------------------------------------------------------------------
+    // Matlab struct with one n x 1 array per field
+    mxArray* metadata_to_struct(const FrameMetadata& metadata)
+    {
+        const char* s_fields[] = {"timestamps", "imageNumbers", "blockIds", "skippedImages",
+                                  "exposureTimes", "frameCounters", "succeeded"};
+        mxArray* mxa_metadata = mxCreateStructMatrix(1, 1, 7, s_fields);
+        mxSetField(mxa_metadata, 0, "timestamps", column_to_array(metadata.i_timestamps, mxUINT64_CLASS));
+        mxSetField(mxa_metadata, 0, "imageNumbers", column_to_array(metadata.i_image_numbers, mxINT64_CLASS));
+        mxSetField(mxa_metadata, 0, "blockIds", column_to_array(metadata.i_block_ids, mxUINT64_CLASS));
+        mxSetField(mxa_metadata, 0, "skippedImages", column_to_array(metadata.i_skipped_images, mxINT64_CLASS));
+        mxSetField(mxa_metadata, 0, "exposureTimes", column_to_array(metadata.d_exposure_times, mxDOUBLE_CLASS));
+        mxSetField(mxa_metadata, 0, "frameCounters", column_to_array(metadata.i_frame_counters, mxINT64_CLASS));
+
+        mxArray* mxa_succeeded = mxCreateLogicalMatrix(metadata.size(), 1);
+        for(size_t i = 0; i < metadata.size(); i++)
+        {
+            mxGetLogicals(mxa_succeeded)[i] = metadata.b_succeeded[i] != 0;
+        }
+        mxSetField(mxa_metadata, 0, "succeeded", mxa_succeeded);
+        return mxa_metadata;
+    }
+
+    //---------------------------------------------------------------------
+    // Write the metadata column by column
+    void write_metadata(const std::string& s_filename, const FrameMetadata& metadata)
+    {
+        FILE* p_file = fopen(s_filename.c_str(), "wb");
+        if(p_file == NULL)
+        {
+            throw RUNTIME_EXCEPTION("Cannot create file %s.", s_filename.c_str());
+        }
+        const uint64_t i_num_of_frames = metadata.size();
+        bool b_ok = fwrite(FRAME_METADATA_MAGIC, 1, sizeof(FRAME_METADATA_MAGIC), p_file) == sizeof(FRAME_METADATA_MAGIC) &&
+                fwrite(&i_num_of_frames, sizeof(i_num_of_frames), 1, p_file) == 1 &&
+                write_column(p_file, metadata.i_timestamps) &&
+                write_column(p_file, metadata.i_image_numbers) &&
+                write_column(p_file, metadata.i_block_ids) &&
+                write_column(p_file, metadata.i_skipped_images) &&
+                write_column(p_file, metadata.d_exposure_times) &&
+                write_column(p_file, metadata.i_frame_counters) &&
+                write_column(p_file, metadata.b_succeeded);
+        b_ok = (fclose(p_file) == 0) && b_ok;
+        if(!b_ok)
+        {
+            throw RUNTIME_EXCEPTION("Cannot write to file %s.", s_filename.c_str());
+        }
+    }
+
+}
@@ -0,0 +1,96 @@
+// frame_metadata.h - Per-frame metadata of a capture
+// 17.10.2026 / agent
+//
+// The metadata is kept as one array per field, so that it can be handed
+// to Matlab and written to disk column by column. The grab thread only
+// stores a few values into preallocated arrays per frame.
+//
+// Sidecar file layout (little endian):
+//   - Magic "BSLMETA1" and the number of frames n (uint64)
+//   - n timestamps (uint64), n image numbers (int64), n block IDs
+//     (uint64), n skipped image counts (int64), n exposure times (double,
+//     NaN without chunk data), n frame counters (int64, -1 without chunk
+//     data) and n success flags (uint8)
+
+#ifndef __FRAMEMETADATA_H_INCLUDED__
+#define __FRAMEMETADATA_H_INCLUDED__
+
+#include "frame_source.h"
+#include <matrix.h>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+
+namespace BaslerHelper {
+
+    // File identification
+    const char FRAME_METADATA_MAGIC[8] = {'B','S','L','M','E','T','A','1'};
+
+    //---------------------------------------------------------------------
+    // Metadata of all frames of a capture
+    struct FrameMetadata
+    {
+        // Preallocate for i_num_of_frames frames
+        void resize(const size_t i_num_of_frames)
+        {
+            i_timestamps.resize(i_num_of_frames, 0);
+            i_image_numbers.resize(i_num_of_frames, 0);
+            i_block_ids.resize(i_num_of_frames, 0);
+            i_skipped_images.resize(i_num_of_frames, 0);
+            d_exposure_times.resize(i_num_of_frames, 0);
+            i_frame_counters.resize(i_num_of_frames, 0);
+            b_succeeded.resize(i_num_of_frames, 0);
+        }
+
+        // Store the metadata of a frame
+        void set(const size_t i_frame, const SourceFrame& frame)
+        {
+            i_timestamps[i_frame] = frame.i_timestamp;
+            i_image_numbers[i_frame] = frame.i_image_number;
+            i_block_ids[i_frame] = frame.i_block_id;
+            i_skipped_images[i_frame] = frame.i_skipped;
+            d_exposure_times[i_frame] = frame.d_exposure_time;
+            i_frame_counters[i_frame] = frame.i_frame_counter;
+            b_succeeded[i_frame] = frame.b_succeeded ? 1 : 0;
+        }
+
+        size_t size() const { return i_timestamps.size(); }
+
+        // Metadata of the frames i_order[0], i_order[1], ...
+        FrameMetadata select(const std::vector<size_t>& i_order) const
+        {
+            FrameMetadata selected;
+            selected.resize(i_order.size());
+            for(size_t i = 0; i < i_order.size(); i++)
+            {
+                const size_t j = i_order[i];
+                selected.i_timestamps[i] = i_timestamps[j];
+                selected.i_image_numbers[i] = i_image_numbers[j];
+                selected.i_block_ids[i] = i_block_ids[j];
+                selected.i_skipped_images[i] = i_skipped_images[j];
+                selected.d_exposure_times[i] = d_exposure_times[j];
+                selected.i_frame_counters[i] = i_frame_counters[j];
+                selected.b_succeeded[i] = b_succeeded[j];
+            }
+            return selected;
+        }
+
+        std::vector<uint64_t> i_timestamps;
+        std::vector<int64_t>  i_image_numbers;
+        std::vector<uint64_t> i_block_ids;
+        std::vector<int64_t>  i_skipped_images;
+        std::vector<double>   d_exposure_times;     // Chunk ExposureTime in us
+        std::vector<int64_t>  i_frame_counters;     // Chunk frame counter
+        std::vector<uint8_t>  b_succeeded;
+    };
+
+    // Matlab struct with one n x 1 array per field
+    mxArray* metadata_to_struct(const FrameMetadata& metadata);
+
+    // Write the metadata to a sidecar file, see above
+    void write_metadata(const std::string& s_filename, const FrameMetadata& metadata);
+
+}
+
+#endif
@@ -0,0 +1,132 @@
+// frame_queue.h - Bounded lock-free queue to pass frames between threads
+// 17.10.2026 / agent
+//
+// Multi-producer / multi-consumer ring buffer after D. Vyukov: every slot
+// carries a sequence number telling whether it is free for the producer of
+// a given round or filled for the consumer of that round.
+
+#ifndef __FRAMEQUEUE_H_INCLUDED__
+#define __FRAMEQUEUE_H_INCLUDED__
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+
+namespace BaslerHelper {
+
+    template <typename T>
+    class FrameQueue
+    {
+    public:
+        // The capacity is rounded up to a power of two
+        explicit FrameQueue(size_t i_capacity)
+        {
+            size_t i_size = 2;
+            while (i_size < i_capacity)
+            {
+                i_size *= 2;
+            }
+            m_mask = i_size - 1;
+            m_slots = std::vector<Slot>(i_size);
+            for (size_t i = 0; i < i_size; i++)
+            {
+                m_slots[i].i_sequence.store(i, std::memory_order_relaxed);
+            }
+            m_enqueue_pos.store(0, std::memory_order_relaxed);
+            m_dequeue_pos.store(0, std::memory_order_relaxed);
+        }
+
+        // Add an element, returns false if the queue is full
+        bool push(const T& value)
+        {
+            size_t i_pos = m_enqueue_pos.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                Slot& slot = m_slots[i_pos & m_mask];
+                const size_t i_seq = slot.i_sequence.load(std::memory_order_acquire);
+                const std::ptrdiff_t i_diff = (std::ptrdiff_t)i_seq - (std::ptrdiff_t)i_pos;
+                if (i_diff == 0)
+                {
+                    if (m_enqueue_pos.compare_exchange_weak(i_pos, i_pos + 1, std::memory_order_relaxed))
+                    {
+                        slot.value = value;
+                        slot.i_sequence.store(i_pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (i_diff < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    i_pos = m_enqueue_pos.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        // Remove an element, returns false if the queue is empty
+        bool pop(T& value)
+        {
+            size_t i_pos = m_dequeue_pos.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                Slot& slot = m_slots[i_pos & m_mask];
+                const size_t i_seq = slot.i_sequence.load(std::memory_order_acquire);
+                const std::ptrdiff_t i_diff = (std::ptrdiff_t)i_seq - (std::ptrdiff_t)(i_pos + 1);
+                if (i_diff == 0)
+                {
+                    if (m_dequeue_pos.compare_exchange_weak(i_pos, i_pos + 1, std::memory_order_relaxed))
+                    {
+                        value = slot.value;
+                        slot.value = T();
+                        slot.i_sequence.store(i_pos + m_mask + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (i_diff < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    i_pos = m_dequeue_pos.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        // Approximate number of queued elements
+        size_t size() const
+        {
+            const size_t i_enqueue = m_enqueue_pos.load(std::memory_order_relaxed);
+            const size_t i_dequeue = m_dequeue_pos.load(std::memory_order_relaxed);
+            return i_enqueue > i_dequeue ? i_enqueue - i_dequeue : 0;
+        }
+
+    private:
+        FrameQueue(const FrameQueue&);
+        FrameQueue& operator=(const FrameQueue&);
+
+        struct Slot
+        {
+            Slot() : i_sequence(0) {}
+            Slot(const Slot& other) : i_sequence(other.i_sequence.load()), value(other.value) {}
+            std::atomic<size_t> i_sequence;
+            T value;
+        };
+
+        std::vector<Slot> m_slots;
+        size_t m_mask;
+
+        // Producer and consumer positions on separate cache lines
+        char m_pad0[64];
+        std::atomic<size_t> m_enqueue_pos;
+        char m_pad1[64];
+        std::atomic<size_t> m_dequeue_pos;
+        char m_pad2[64];
+    };
+
+}
+
+#endif
@@ -0,0 +1,186 @@
+// frame_reduce.cpp - Reduce frames while they are captured
+// 17.10.2026 / agent
+//
+// SSE2 kernels for 8 and 16 bit frames. The samples are widened to 32 bit
+// for the sums, squares are widened to 64 bit. SSE2 has no unsigned 16
+// bit maximum, so the values are moved into the signed range first.
+
+
+#include "frame_reduce.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define BASLER_HAS_X86
+#include <emmintrin.h>
+#endif
+
+
+namespace {
+
+#ifdef BASLER_HAS_X86
+
+    //---------------------------------------------------------------------
+    // Add four 32 bit values to p_sum
+    inline void add_u32(uint32_t* p_sum, const __m128i v)
+    {
+        _mm_storeu_si128((__m128i*)p_sum, _mm_add_epi32(_mm_loadu_si128((const __m128i*)p_sum), v));
+    }
+
+    //---------------------------------------------------------------------
+    // Add the squares of four 32 bit values below 2^16 to p_sum
+    inline void add_squares_u64(uint64_t* p_sum, const __m128i v)
+    {
+        const __m128i m_even = _mm_mul_epu32(v, v);
+        const __m128i m_odd = _mm_mul_epu32(_mm_srli_epi64(v, 32), _mm_srli_epi64(v, 32));
+        _mm_storeu_si128((__m128i*)p_sum, _mm_add_epi64(_mm_loadu_si128((const __m128i*)p_sum),
+                _mm_unpacklo_epi64(m_even, m_odd)));
+        _mm_storeu_si128((__m128i*)(p_sum + 2), _mm_add_epi64(_mm_loadu_si128((const __m128i*)(p_sum + 2)),
+                _mm_unpackhi_epi64(m_even, m_odd)));
+    }
+
+#endif
+}
+
+
+namespace BaslerHelper {
+
+    //---------------------------------------------------------------------
+    // 8 bit sums
+    void accumulate_sum(const uint8_t* p_src, uint32_t* p_sum, const size_t i_numel)
+    {
+        size_t i = 0;
+#ifdef BASLER_HAS_X86
+        const __m128i m_zero = _mm_setzero_si128();
+        for (; i + 16 <= i_numel; i += 16)
+        {
+            const __m128i v = _mm_loadu_si128((const __m128i*)(p_src + i));
+            const __m128i v_lo = _mm_unpacklo_epi8(v, m_zero);
+            const __m128i v_hi = _mm_unpackhi_epi8(v, m_zero);
+            add_u32(p_sum + i,      _mm_unpacklo_epi16(v_lo, m_zero));
+            add_u32(p_sum + i + 4,  _mm_unpackhi_epi16(v_lo, m_zero));
+            add_u32(p_sum + i + 8,  _mm_unpacklo_epi16(v_hi, m_zero));
+            add_u32(p_sum + i + 12, _mm_unpackhi_epi16(v_hi, m_zero));
+        }
+#endif
+        accumulate_sum<uint8_t>(p_src + i, p_sum + i, i_numel - i);
+    }
+
+    //---------------------------------------------------------------------
+    // 16 bit sums
+    void accumulate_sum(const uint16_t* p_src, uint32_t* p_sum, const size_t i_numel)
+    {
+        size_t i = 0;
+#ifdef BASLER_HAS_X86
+        const __m128i m_zero = _mm_setzero_si128();
+        for (; i + 8 <= i_numel; i += 8)
+        {
+            const __m128i v = _mm_loadu_si128((const __m128i*)(p_src + i));
+            add_u32(p_sum + i,     _mm_unpacklo_epi16(v, m_zero));
+            add_u32(p_sum + i + 4, _mm_unpackhi_epi16(v, m_zero));
+        }
+#endif
+        accumulate_sum<uint16_t>(p_src + i, p_sum + i, i_numel - i);
+    }
+
+    //---------------------------------------------------------------------
+    // 8 bit sums of squares
+    void accumulate_sum_squares(const uint8_t* p_src, uint64_t* p_sum, const size_t i_numel)
+    {
+        size_t i = 0;
+#ifdef BASLER_HAS_X86
+        const __m128i m_zero = _mm_setzero_si128();
+        for (; i + 16 <= i_numel; i += 16)
+        {
+            const __m128i v = _mm_loadu_si128((const __m128i*)(p_src + i));
+            const __m128i v_lo = _mm_unpacklo_epi8(v, m_zero);
+            const __m128i v_hi = _mm_unpackhi_epi8(v, m_zero);
+            add_squares_u64(p_sum + i,      _mm_unpacklo_epi16(v_lo, m_zero));
+            add_squares_u64(p_sum + i + 4,  _mm_unpackhi_epi16(v_lo, m_zero));
+            add_squares_u64(p_sum + i + 8,  _mm_unpacklo_epi16(v_hi, m_zero));
+            add_squares_u64(p_sum + i + 12, _mm_unpackhi_epi16(v_hi, m_zero));
+        }
+#endif
+        accumulate_sum_squares<uint8_t>(p_src + i, p_sum + i, i_numel - i);
+    }
+
+    //---------------------------------------------------------------------
+    // 16 bit sums of squares
+    void accumulate_sum_squares(const uint16_t* p_src, uint64_t* p_sum, const size_t i_numel)
+    {
+        size_t i = 0;
+#ifdef BASLER_HAS_X86
+        const __m128i m_zero = _mm_setzero_si128();
+        for (; i + 8 <= i_numel; i += 8)
+        {
+            const __m128i v = _mm_loadu_si128((const __m128i*)(p_src + i));
+            add_squares_u64(p_sum + i,     _mm_unpacklo_epi16(v, m_zero));
+            add_squares_u64(p_sum + i + 4, _mm_unpackhi_epi16(v, m_zero));
+        }
+#endif
+        accumulate_sum_squares<uint16_t>(p_src + i, p_sum + i, i_numel - i);
+    }
+
+    //---------------------------------------------------------------------
+    // 8 bit maximum
+    void accumulate_max(const uint8_t* p_src, uint8_t* p_max, const size_t i_numel)
+    {
+        size_t i = 0;
+#ifdef BASLER_HAS_X86
+        for (; i + 16 <= i_numel; i += 16)
+        {
+            _mm_storeu_si128((__m128i*)(p_max + i), _mm_max_epu8(_mm_loadu_si128((const __m128i*)(p_src + i)),
+                    _mm_loadu_si128((const __m128i*)(p_max + i))));
+        }
+#endif
+        accumulate_max<uint8_t>(p_src + i, p_max + i, i_numel - i);
+    }
+
+    //---------------------------------------------------------------------
+    // 16 bit maximum
+    void accumulate_max(const uint16_t* p_src, uint16_t* p_max, const size_t i_numel)
+    {
+        size_t i = 0;
+#ifdef BASLER_HAS_X86
+        const __m128i m_sign = _mm_set1_epi16((short)0x8000);
+        for (; i + 8 <= i_numel; i += 8)
+        {
+            const __m128i v = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(p_src + i)), m_sign);
+            const __m128i m = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(p_max + i)), m_sign);
+            _mm_storeu_si128((__m128i*)(p_max + i), _mm_xor_si128(_mm_max_epi16(v, m), m_sign));
+        }
+#endif
+        accumulate_max<uint16_t>(p_src + i, p_max + i, i_numel - i);
+    }
+
+    //---------------------------------------------------------------------
+    // 8 bit minimum
+    void accumulate_min(const uint8_t* p_src, uint8_t* p_min, const size_t i_numel)
+    {
+        size_t i = 0;
+#ifdef BASLER_HAS_X86
+        for (; i + 16 <= i_numel; i += 16)
+        {
+            _mm_storeu_si128((__m128i*)(p_min + i), _mm_min_epu8(_mm_loadu_si128((const __m128i*)(p_src + i)),
+                    _mm_loadu_si128((const __m128i*)(p_min + i))));
+        }
+#endif
+        accumulate_min<uint8_t>(p_src + i, p_min + i, i_numel - i);
+    }
+
+    //---------------------------------------------------------------------
+    // 16 bit minimum
+    void accumulate_min(const uint16_t* p_src, uint16_t* p_min, const size_t i_numel)
+    {
+        size_t i = 0;
+#ifdef BASLER_HAS_X86
+        const __m128i m_sign = _mm_set1_epi16((short)0x8000);
+        for (; i + 8 <= i_numel; i += 8)
+        {
+            const __m128i v = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(p_src + i)), m_sign);
+            const __m128i m = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(p_min + i)), m_sign);
+            _mm_storeu_si128((__m128i*)(p_min + i), _mm_xor_si128(_mm_min_epi16(v, m), m_sign));
+        }
+#endif
+        accumulate_min<uint16_t>(p_src + i, p_min + i, i_numel - i);
+    }
+
+}
@@ -0,0 +1,279 @@
+// frame_reduce.h - Reduce frames while they are captured
+// 17.10.2026 / agent
+//
+// Instead of returning all frames, their mean, variance, sum, maximum or
+// minimum is accumulated as they arrive. Every thread accumulates the
+// row-major frames into its own accumulator, the accumulators are merged
+// and transposed into Matlab's memory layout once at the end, so the
+// memory does not grow with the number of frames. Sums are kept in 32 bit
+// and moved into 64 bit every FLUSH_FRAMES frames, which keeps the SIMD
+// kernels narrow without overflow for 16 bit frames.
+
+#ifndef __FRAMEREDUCE_H_INCLUDED__
+#define __FRAMEREDUCE_H_INCLUDED__
+
+#include <cstddef>
+#include <cstring>
+#include <stdint.h>
+#include <vector>
+
+
+namespace BaslerHelper {
+
+    //---------------------------------------------------------------------
+    // Reduction of the frames
+    enum ReduceMode
+    {
+        Reduce_None,
+        Reduce_Mean,
+        Reduce_Var,             // Sample variance, like var in Matlab
+        Reduce_Sum,
+        Reduce_Max,
+        Reduce_Min
+    };
+
+    // Most conversion threads while reducing. Each of them has its own
+    // accumulator of the whole frame, besides the one they are merged into.
+    const int MAX_REDUCE_WORKERS = 2;
+
+    //---------------------------------------------------------------------
+    // Scalar kernels, used for all types without a SIMD kernel
+    template <typename T>
+    void accumulate_sum(const T* p_src, uint32_t* p_sum, const size_t i_numel)
+    {
+        for (size_t i = 0; i < i_numel; i++)
+        {
+            p_sum[i] += (uint32_t)p_src[i];
+        }
+    }
+
+    template <typename T>
+    void accumulate_sum_squares(const T* p_src, uint64_t* p_sum, const size_t i_numel)
+    {
+        for (size_t i = 0; i < i_numel; i++)
+        {
+            p_sum[i] += (uint64_t)p_src[i] * (uint64_t)p_src[i];
+        }
+    }
+
+    template <typename T>
+    void accumulate_max(const T* p_src, T* p_max, const size_t i_numel)
+    {
+        for (size_t i = 0; i < i_numel; i++)
+        {
+            p_max[i] = p_src[i] > p_max[i] ? p_src[i] : p_max[i];
+        }
+    }
+
+    template <typename T>
+    void accumulate_min(const T* p_src, T* p_min, const size_t i_numel)
+    {
+        for (size_t i = 0; i < i_numel; i++)
+        {
+            p_min[i] = p_src[i] < p_min[i] ? p_src[i] : p_min[i];
+        }
+    }
+
+    // Add the values of a frame to 32 bit sums
+    void accumulate_sum(const uint8_t* p_src, uint32_t* p_sum, const size_t i_numel);
+    void accumulate_sum(const uint16_t* p_src, uint32_t* p_sum, const size_t i_numel);
+
+    // Add the squared values of a frame to 64 bit sums
+    void accumulate_sum_squares(const uint8_t* p_src, uint64_t* p_sum, const size_t i_numel);
+    void accumulate_sum_squares(const uint16_t* p_src, uint64_t* p_sum, const size_t i_numel);
+
+    // Keep the larger or smaller values
+    void accumulate_max(const uint8_t* p_src, uint8_t* p_max, const size_t i_numel);
+    void accumulate_max(const uint16_t* p_src, uint16_t* p_max, const size_t i_numel);
+    void accumulate_min(const uint8_t* p_src, uint8_t* p_min, const size_t i_numel);
+    void accumulate_min(const uint16_t* p_src, uint16_t* p_min, const size_t i_numel);
+
+    //---------------------------------------------------------------------
+    // Accumulates frames of i_height x i_width pixels of i_bands samples,
+    // row-major with interleaved bands. 8 and 16 bit samples use SIMD
+    // kernels.
+    template <typename T>
+    class FrameAccumulator
+    {
+    public:
+        // Frames after which the 32 bit sums are moved into 64 bit
+        static const unsigned int FLUSH_FRAMES = 65536;
+
+        FrameAccumulator(const ReduceMode rm_mode, const size_t i_height, const size_t i_width, const unsigned int i_bands)
+            : m_rm_mode(rm_mode), m_i_height(i_height), m_i_width(i_width), m_i_bands(i_bands),
+              m_i_numel(i_height * i_width * i_bands), m_i_frames(0), m_i_pending(0)
+        {
+            if (has_sum())
+            {
+                m_sum32.assign(m_i_numel, 0);
+                m_sum.assign(m_i_numel, 0);
+            }
+            if (m_rm_mode == Reduce_Var)
+            {
+                m_sum_squares.assign(m_i_numel, 0);
+            }
+            if (m_rm_mode == Reduce_Max || m_rm_mode == Reduce_Min)
+            {
+                m_extreme.assign(m_i_numel, 0);
+            }
+        }
+
+        // Add a frame
+        void add(const T* p_frame)
+        {
+            if (has_sum())
+            {
+                accumulate_sum(p_frame, &m_sum32[0], m_i_numel);
+                if (++m_i_pending == FLUSH_FRAMES)
+                {
+                    flush();
+                }
+            }
+            if (m_rm_mode == Reduce_Var)
+            {
+                accumulate_sum_squares(p_frame, &m_sum_squares[0], m_i_numel);
+            }
+            if (m_rm_mode == Reduce_Max || m_rm_mode == Reduce_Min)
+            {
+                if (m_i_frames == 0)
+                {
+                    memcpy(&m_extreme[0], p_frame, m_i_numel * sizeof(T));
+                }
+                else if (m_rm_mode == Reduce_Max)
+                {
+                    accumulate_max(p_frame, &m_extreme[0], m_i_numel);
+                }
+                else
+                {
+                    accumulate_min(p_frame, &m_extreme[0], m_i_numel);
+                }
+            }
+            m_i_frames++;
+        }
+
+        // Add the frames of another accumulator of the same size and mode
+        void merge(FrameAccumulator& other)
+        {
+            if (other.m_i_frames == 0)
+            {
+                return;
+            }
+            flush();
+            other.flush();
+            for (size_t i = 0; i < m_sum.size(); i++)
+            {
+                m_sum[i] += other.m_sum[i];
+            }
+            for (size_t i = 0; i < m_sum_squares.size(); i++)
+            {
+                m_sum_squares[i] += other.m_sum_squares[i];
+            }
+            if (m_i_frames == 0)
+            {
+                m_extreme = other.m_extreme;
+            }
+            else if (m_rm_mode == Reduce_Max)
+            {
+                accumulate_max(&other.m_extreme[0], &m_extreme[0], m_i_numel);
+            }
+            else if (m_rm_mode == Reduce_Min)
+            {
+                accumulate_min(&other.m_extreme[0], &m_extreme[0], m_i_numel);
+            }
+            m_i_frames += other.m_i_frames;
+        }
+
+        // Write the result into the column-major, band-planar output.
+        // p_dark, if given, is subtracted from each frame, it has the
+        // layout of the output.
+        void result(double* p_dst, const double* p_dark = NULL)
+        {
+            flush();
+            const double d_frames = (double)m_i_frames;
+            const size_t i_plane = m_i_height * m_i_width;
+            for (size_t i = 0; i < m_i_height; i++)
+            {
+                for (size_t j = 0; j < m_i_width; j++)
+                {
+                    for (unsigned int b = 0; b < m_i_bands; b++)
+                    {
+                        const size_t i_src = (i * m_i_width + j) * m_i_bands + b;
+                        const size_t i_dst = b * i_plane + j * m_i_height + i;
+                        const double d_dark = p_dark != NULL ? p_dark[i_dst] : 0.0;
+                        double d_value;
+                        switch (m_rm_mode)
+                        {
+                            case Reduce_Mean:
+                                d_value = (double)m_sum[i_src] / d_frames - d_dark;
+                                break;
+                            case Reduce_Sum:
+                                d_value = (double)m_sum[i_src] - d_frames * d_dark;
+                                break;
+                            case Reduce_Var:
+                                // Subtracting the dark frame does not
+                                // change the variance
+                                d_value = m_i_frames < 2 ? 0.0 : squared_deviations(i_src) / (d_frames - 1);
+                                break;
+                            default:
+                                d_value = (double)m_extreme[i_src] - d_dark;
+                                break;
+                        }
+                        p_dst[i_dst] = d_value;
+                    }
+                }
+            }
+        }
+
+        ReduceMode mode() const { return m_rm_mode; }
+        unsigned long long frames() const { return m_i_frames; }
+
+    private:
+        bool has_sum() const
+        {
+            return m_rm_mode == Reduce_Mean || m_rm_mode == Reduce_Var || m_rm_mode == Reduce_Sum;
+        }
+
+        // Sum of the squared deviations from the mean of a sample. With the
+        // integer part q and the remainder r of the mean, it is
+        // sum((x - q)^2) - r^2 / N, where the first term is exact in 64 bit
+        // integers. Only the small second term is rounded, so there is no
+        // cancellation between two large sums.
+        double squared_deviations(const size_t i) const
+        {
+            const uint64_t i_q = m_sum[i] / m_i_frames;
+            const uint64_t i_r = m_sum[i] % m_i_frames;
+            const uint64_t i_deviations = m_sum_squares[i] - i_q * (m_sum[i] + i_r);
+            return (double)i_deviations - (double)i_r * ((double)i_r / (double)m_i_frames);
+        }
+
+        // Move the 32 bit sums into the 64 bit ones
+        void flush()
+        {
+            if (m_i_pending == 0)
+            {
+                return;
+            }
+            for (size_t i = 0; i < m_i_numel; i++)
+            {
+                m_sum[i] += m_sum32[i];
+                m_sum32[i] = 0;
+            }
+            m_i_pending = 0;
+        }
+
+        ReduceMode m_rm_mode;
+        size_t m_i_height;
+        size_t m_i_width;
+        unsigned int m_i_bands;
+        size_t m_i_numel;
+        unsigned long long m_i_frames;
+        unsigned int m_i_pending;           // Frames in m_sum32
+        std::vector<uint32_t> m_sum32;
+        std::vector<uint64_t> m_sum;
+        std::vector<uint64_t> m_sum_squares;
+        std::vector<T> m_extreme;           // Maximum or minimum
+    };
+
+}
+
+#endif
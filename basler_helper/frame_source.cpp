@@ -0,0 +1,388 @@
+// frame_source.cpp - Sources of frames for the capture functions
+// 17.10.2026 / agent
+
+
+#include "frame_source.h"
+#include "basler_set_get.h"
+#include "camera_session.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <thread>
+#include <mex.h>
+
+
+namespace BaslerHelper {
+
+    //---------------------------------------------------------------------
+    // Read the frame's metadata, chunk values only if the camera sent them
+    void read_grab_result(SourceFrame& frame)
+    {
+        Pylon::CGrabResultPtr& p_result = frame.p_grab_result;
+        frame.b_succeeded = p_result->GrabSucceeded();
+        frame.i_block_id = p_result->GetBlockID();
+        frame.i_image_number = p_result->GetImageNumber();
+        frame.i_timestamp = p_result->GetTimeStamp();
+        frame.i_skipped = p_result->GetNumberOfSkippedImages();
+        frame.d_exposure_time = std::numeric_limits<double>::quiet_NaN();
+        frame.i_frame_counter = -1;
+        if(frame.b_succeeded && p_result->IsChunkDataAvailable())
+        {
+            // The frame counter is named differently by GigE and USB cameras
+            GenApi::INodeMap& chunks = p_result->GetChunkDataNodeMap();
+            GenApi::CFloatPtr p_exposure_time = chunks.GetNode("ChunkExposureTime");
+            GenApi::CIntegerPtr p_frame_counter = chunks.GetNode("ChunkFramecounter");
+            if(!p_frame_counter.IsValid())
+            {
+                p_frame_counter = chunks.GetNode("ChunkFrameID");
+            }
+            if(GenApi::IsReadable(p_exposure_time))
+            {
+                frame.d_exposure_time = p_exposure_time->GetValue();
+            }
+            if(GenApi::IsReadable(p_frame_counter))
+            {
+                frame.i_frame_counter = p_frame_counter->GetValue();
+            }
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Source of an open camera
+    PylonSource::PylonSource(Pylon::CInstantCamera* camera, const bool b_verbose, AcquisitionFormatCache* p_format)
+        : m_camera(camera), m_b_verbose(b_verbose), m_p_format(p_format), m_b_armed(false)
+    {
+    }
+
+    //---------------------------------------------------------------------
+    // Format of the camera, the nodes are only read after a change
+    const AcquisitionFormat& PylonSource::format()
+    {
+        if(m_p_format == NULL)
+        {
+            m_own_format.reset(new AcquisitionFormatCache(m_camera));
+            m_p_format = m_own_format.get();
+        }
+        return m_p_format->get(m_b_verbose);
+    }
+
+    unsigned long long PylonSource::width()
+    {
+        return format().i_width;
+    }
+
+    unsigned long long PylonSource::height()
+    {
+        return format().i_height;
+    }
+
+    Pylon::EPixelType PylonSource::pixel_type()
+    {
+        return format().ept_pixel_type;
+    }
+
+    unsigned long long PylonSource::payload_size()
+    {
+        return format().i_payload_size;
+    }
+
+    //---------------------------------------------------------------------
+    // Start capturing, stop a grab left over from an aborted call first
+    void PylonSource::start_grabbing(const size_t i_num_of_frames)
+    {
+        if(m_camera->IsGrabbing())
+        {
+            m_camera->StopGrabbing();
+        }
+        if(i_num_of_frames == 0)
+        {
+            m_camera->StartGrabbing(Pylon::GrabStrategy_OneByOne);
+        }
+        else
+        {
+            m_camera->StartGrabbing(i_num_of_frames, Pylon::GrabStrategy_OneByOne);
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Next grab result, the frame keeps its buffer
+    void PylonSource::retrieve(const unsigned int i_timeout_ms, SourceFrame& frame)
+    {
+        frame.release();
+        if(!m_camera->RetrieveResult(i_timeout_ms, frame.p_grab_result, Pylon::TimeoutHandling_Return)
+           || !frame.p_grab_result.IsValid())
+        {
+            frame.release();
+            throw TIMEOUT_EXCEPTION("No frame retrieved within %u ms.", i_timeout_ms);
+        }
+        read_grab_result(frame);
+    }
+
+    void PylonSource::stop_grabbing()
+    {
+        m_camera->StopGrabbing();
+    }
+
+    //---------------------------------------------------------------------
+    // Trigger every frame, the previous trigger selector and settings of
+    // the frame start trigger are kept for disarm. If a setting fails, the
+    // previous ones are restored and the source is not armed.
+    void PylonSource::arm_trigger(const TriggerSettings& trigger)
+    {
+        m_s_trigger_selector = BaslerHelper::get_string(m_camera, "TriggerSelector", m_b_verbose);
+        BaslerHelper::set_parameter(m_camera, "TriggerSelector", "FrameStart", m_b_verbose);
+        m_s_trigger_mode = BaslerHelper::get_string(m_camera, "TriggerMode", m_b_verbose);
+        m_s_trigger_source = BaslerHelper::get_string(m_camera, "TriggerSource", m_b_verbose);
+        m_s_trigger_activation = BaslerHelper::get_string(m_camera, "TriggerActivation", m_b_verbose);
+
+        try
+        {
+            BaslerHelper::set_parameter(m_camera, "TriggerSource", trigger.s_source.c_str(), m_b_verbose);
+            if(!trigger.s_activation.empty())
+            {
+                BaslerHelper::set_parameter(m_camera, "TriggerActivation", trigger.s_activation.c_str(), m_b_verbose);
+            }
+            BaslerHelper::set_parameter(m_camera, "TriggerMode", "On", m_b_verbose);
+        }
+        catch (GenICam::GenericException&)
+        {
+            try
+            {
+                restore_trigger();
+            }
+            catch (GenICam::GenericException&)
+            {
+                // Report the error of arming
+            }
+            throw;
+        }
+        m_b_armed = true;
+    }
+
+    void PylonSource::disarm_trigger()
+    {
+        if(!m_b_armed)
+        {
+            return;
+        }
+        m_b_armed = false;
+        restore_trigger();
+    }
+
+    void PylonSource::restore_trigger()
+    {
+        BaslerHelper::set_parameter(m_camera, "TriggerSelector", "FrameStart", m_b_verbose);
+        BaslerHelper::set_parameter(m_camera, "TriggerMode", m_s_trigger_mode.c_str(), m_b_verbose);
+        BaslerHelper::set_parameter(m_camera, "TriggerSource", m_s_trigger_source.c_str(), m_b_verbose);
+        BaslerHelper::set_parameter(m_camera, "TriggerActivation", m_s_trigger_activation.c_str(), m_b_verbose);
+        BaslerHelper::set_parameter(m_camera, "TriggerSelector", m_s_trigger_selector.c_str(), m_b_verbose);
+    }
+
+    //---------------------------------------------------------------------
+    // Wait until the camera accepts a frame trigger, then send it
+    std::chrono::steady_clock::time_point PylonSource::execute_software_trigger(const unsigned int i_timeout_ms)
+    {
+        m_camera->WaitForFrameTriggerReady(i_timeout_ms, Pylon::TimeoutHandling_ThrowException);
+        const std::chrono::steady_clock::time_point tp_trigger = std::chrono::steady_clock::now();
+        m_camera->ExecuteSoftwareTrigger();
+        return tp_trigger;
+    }
+
+    //---------------------------------------------------------------------
+    // Prepare a test pattern of two rows, every frame shows it shifted
+    SyntheticSource::SyntheticSource(   const unsigned long long i_width,
+                                        const unsigned long long i_height,
+                                        const Pylon::EPixelType ept_pixel_type,
+                                        const double d_frame_rate,
+                                        const unsigned long long i_drop_every)
+        : m_i_width(i_width), m_i_height(i_height), m_ept_pixel_type(ept_pixel_type),
+          m_i_row_bytes((size_t)((i_width * Pylon::BitPerPixel(ept_pixel_type) + 7) / 8)),
+          m_period(std::chrono::steady_clock::duration::zero()),
+          m_i_drop_every(i_drop_every), m_i_remaining(0), m_b_unbounded(false), m_i_block_id(0),
+          m_b_triggered(false), m_i_pending_triggers(0)
+    {
+        if(i_width == 0 || i_height == 0 || Pylon::BitPerPixel(ept_pixel_type) == 0)
+        {
+            throw RUNTIME_EXCEPTION("Invalid format of the synthetic source.");
+        }
+        if(d_frame_rate > 0)
+        {
+            m_period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::duration<double>(1.0 / d_frame_rate));
+        }
+        m_pattern.resize(2 * m_i_row_bytes);
+        for(size_t i = 0; i < m_pattern.size(); i++)
+        {
+            m_pattern[i] = (unsigned char)(i * 3);
+        }
+    }
+
+    void SyntheticSource::start_grabbing(const size_t i_num_of_frames)
+    {
+        m_i_remaining = i_num_of_frames;
+        m_b_unbounded = (i_num_of_frames == 0);
+        m_start = std::chrono::steady_clock::now();
+        m_next_frame = m_start;
+        m_i_pending_triggers = 0;
+    }
+
+    //---------------------------------------------------------------------
+    // Generate the next frame at the frame rate
+    void SyntheticSource::retrieve(const unsigned int i_timeout_ms, SourceFrame& frame)
+    {
+        frame.release();
+        if(m_i_remaining == 0 && !m_b_unbounded)
+        {
+            throw RUNTIME_EXCEPTION("The synthetic source is not grabbing.");
+        }
+
+        // Without a pending trigger, no frame is generated
+        if(m_b_triggered && m_i_pending_triggers == 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(i_timeout_ms));
+            throw TIMEOUT_EXCEPTION("Synthetic frame not triggered within %u ms.", i_timeout_ms);
+        }
+
+        // Inject a lost frame, it uses up its frame time
+        m_i_block_id++;
+        if(m_i_drop_every > 0 && m_i_block_id % m_i_drop_every == 0)
+        {
+            m_i_block_id++;
+            m_next_frame += m_period;
+        }
+
+        // Wait for the frame time, a triggered frame starts at its trigger
+        // at the earliest
+        const std::chrono::steady_clock::time_point tp_timeout =
+                std::chrono::steady_clock::now() + std::chrono::milliseconds(i_timeout_ms);
+        if(m_b_triggered)
+        {
+            m_i_pending_triggers--;
+            m_next_frame = std::max(m_next_frame, m_last_trigger);
+        }
+        if(m_next_frame > tp_timeout)
+        {
+            std::this_thread::sleep_until(tp_timeout);
+            throw TIMEOUT_EXCEPTION("Synthetic frame not ready within %u ms.", i_timeout_ms);
+        }
+        std::this_thread::sleep_until(m_next_frame);
+        m_next_frame += m_period;
+        if(!m_b_unbounded)
+        {
+            m_i_remaining--;
+        }
+
+        // Reuse a buffer which is not referenced anymore
+        std::shared_ptr<Pylon::CPylonImage> p_image;
+        for(size_t i = 0; i < m_buffers.size() && !p_image; i++)
+        {
+            if(m_buffers[i].use_count() == 1)
+            {
+                p_image = m_buffers[i];
+            }
+        }
+        if(!p_image)
+        {
+            p_image.reset(new Pylon::CPylonImage);
+            p_image->Reset(m_ept_pixel_type, (uint32_t)m_i_width, (uint32_t)m_i_height);
+            m_buffers.push_back(p_image);
+        }
+
+        // Shift the pattern by one byte per frame
+        unsigned char* p_buffer = static_cast<unsigned char*>(p_image->GetBuffer());
+        for(unsigned long long i_row = 0; i_row < m_i_height; i_row++)
+        {
+            memcpy(p_buffer + i_row * m_i_row_bytes,
+                    &m_pattern[(size_t)((i_row + m_i_block_id) % m_i_row_bytes)], m_i_row_bytes);
+        }
+
+        frame.p_synthetic = p_image;
+        frame.b_succeeded = true;
+        frame.i_block_id = m_i_block_id;
+        frame.i_image_number = (long long)m_i_block_id;
+        frame.i_timestamp = (unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - m_start).count();
+        frame.i_skipped = 0;
+        frame.d_exposure_time = std::numeric_limits<double>::quiet_NaN();
+        frame.i_frame_counter = -1;
+    }
+
+    void SyntheticSource::stop_grabbing()
+    {
+        m_i_remaining = 0;
+        m_b_unbounded = false;
+    }
+
+    //---------------------------------------------------------------------
+    // Only software triggers can be generated without hardware
+    void SyntheticSource::arm_trigger(const TriggerSettings& trigger)
+    {
+        if(!trigger.software())
+        {
+            throw RUNTIME_EXCEPTION("The synthetic source only supports the trigger source Software.");
+        }
+        m_b_triggered = true;
+        m_i_pending_triggers = 0;
+    }
+
+    void SyntheticSource::disarm_trigger()
+    {
+        m_b_triggered = false;
+    }
+
+    std::chrono::steady_clock::time_point SyntheticSource::execute_software_trigger(const unsigned int i_timeout_ms)
+    {
+        if(!m_b_triggered)
+        {
+            throw RUNTIME_EXCEPTION("The synthetic source is not armed for a software trigger.");
+        }
+        m_last_trigger = std::chrono::steady_clock::now();
+        m_i_pending_triggers++;
+        return m_last_trigger;
+    }
+
+    //---------------------------------------------------------------------
+    // Synthetic source for a struct, else the camera's session
+    std::unique_ptr<FrameSource> create_source(const mxArray* mxa_camera, const bool b_verbose)
+    {
+        if(!mxIsStruct(mxa_camera))
+        {
+            // Get camera, it stays open between calls. A continuous grab
+            // is stopped, the camera can only grab once at a time.
+            BaslerHelper::CameraSession* p_session = BaslerHelper::get_session(mxa_camera, b_verbose);
+            p_session->stop_continuous();
+            if(b_verbose)
+            {
+                mexPrintf("Using camera \"%s\"\n", p_session->camera()->GetDeviceInfo().GetModelName().c_str());
+            }
+            return std::unique_ptr<FrameSource>(new PylonSource(p_session->camera(), b_verbose, p_session->format()));
+        }
+
+        // Format of the synthetic frames
+        const mxArray* mxa_width = mxGetField(mxa_camera, 0, "Width");
+        const mxArray* mxa_height = mxGetField(mxa_camera, 0, "Height");
+        const mxArray* mxa_pixel_format = mxGetField(mxa_camera, 0, "PixelFormat");
+        const mxArray* mxa_frame_rate = mxGetField(mxa_camera, 0, "FrameRate");
+        const mxArray* mxa_drop_every = mxGetField(mxa_camera, 0, "DropEvery");
+        if(mxa_width == NULL || mxa_height == NULL || mxa_pixel_format == NULL || !mxIsChar(mxa_pixel_format))
+        {
+            throw RUNTIME_EXCEPTION("A synthetic source needs the fields Width, Height and PixelFormat.");
+        }
+        const Pylon::EPixelType ept_pixel_type =
+                Pylon::CPixelTypeMapper().GetPylonPixelTypeByName(mxArrayToString(mxa_pixel_format));
+        const double d_frame_rate = (mxa_frame_rate != NULL && !mxIsEmpty(mxa_frame_rate)) ? mxGetScalar(mxa_frame_rate) : 0;
+        const double d_drop_every = (mxa_drop_every != NULL && !mxIsEmpty(mxa_drop_every)) ? mxGetScalar(mxa_drop_every) : 0;
+
+        std::unique_ptr<FrameSource> p_source(new SyntheticSource(
+                (unsigned long long)mxGetScalar(mxa_width), (unsigned long long)mxGetScalar(mxa_height),
+                ept_pixel_type, d_frame_rate, (unsigned long long)std::max(0.0, d_drop_every)));
+        if(b_verbose)
+        {
+            mexPrintf("Using synthetic source %llux%llu %s at %g fps\n", p_source->width(), p_source->height(),
+                    mxArrayToString(mxa_pixel_format), d_frame_rate);
+        }
+        return p_source;
+    }
+
+}
@@ -0,0 +1,192 @@
+// frame_source.h - Sources of frames for the capture functions
+// 17.10.2026 / agent
+//
+// capture_images and save_images get their frames from a FrameSource.
+// PylonSource grabs from an open camera, SyntheticSource generates frames
+// with a given size, pixel format and frame rate without any hardware, so
+// the capture paths can be run and profiled without a camera. Both can be
+// armed for a software trigger, PylonSource also for line triggers.
+
+#ifndef __FRAMESOURCE_H_INCLUDED__
+#define __FRAMESOURCE_H_INCLUDED__
+
+#include <pylon/PylonIncludes.h>
+#include <matrix.h>
+#include "trigger_capture.h"
+#include "acquisition_format.h"
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+namespace BaslerHelper {
+
+    //---------------------------------------------------------------------
+    // A grabbed frame. It refers to the source's buffer, which is not
+    // reused before the frame is released.
+    struct SourceFrame
+    {
+        SourceFrame() : b_succeeded(false), i_block_id(0), i_image_number(0), i_timestamp(0), i_skipped(0),
+                        d_exposure_time(std::numeric_limits<double>::quiet_NaN()), i_frame_counter(-1) {}
+
+        // Image of the frame, for conversion and copy
+        const Pylon::IImage& image() const
+        {
+            return p_grab_result.IsValid() ? static_cast<const Pylon::IImage&>(p_grab_result) : *p_synthetic;
+        }
+
+        // Hand the buffer back to the source
+        void release()
+        {
+            p_grab_result.Release();
+            p_synthetic.reset();
+        }
+
+        Pylon::CGrabResultPtr p_grab_result;                    // PylonSource
+        std::shared_ptr<const Pylon::CPylonImage> p_synthetic;  // SyntheticSource
+        bool b_succeeded;
+        unsigned long long i_block_id;      // Counted up per frame, 0 if not supported
+        long long i_image_number;
+        unsigned long long i_timestamp;
+        long long i_skipped;                // Frames skipped by the grab strategy
+        double d_exposure_time;             // Chunk ExposureTime, NaN without chunk data
+        long long i_frame_counter;          // Chunk frame counter, -1 without chunk data
+    };
+
+    // Fill the frame's metadata from its grab result
+    void read_grab_result(SourceFrame& frame);
+
+    //---------------------------------------------------------------------
+    // Interface of all frame sources
+    class FrameSource
+    {
+    public:
+        virtual ~FrameSource() {}
+
+        // Format of the frames
+        virtual unsigned long long width() = 0;
+        virtual unsigned long long height() = 0;
+        virtual Pylon::EPixelType pixel_type() = 0;
+
+        // Size of a grab buffer, larger than the image with chunk data
+        virtual unsigned long long payload_size() = 0;
+
+        // Grab i_num_of_frames frames one by one, 0 grabs until stopped
+        virtual void start_grabbing(const size_t i_num_of_frames) = 0;
+
+        // Wait for the next frame, throws a timeout exception
+        virtual void retrieve(const unsigned int i_timeout_ms, SourceFrame& frame) = 0;
+
+        // Stop grabbing before all frames were retrieved
+        virtual void stop_grabbing() = 0;
+
+        // Arm the frame trigger before grabbing, disarm restores the
+        // trigger settings of before
+        virtual void arm_trigger(const TriggerSettings& trigger) = 0;
+        virtual void disarm_trigger() = 0;
+
+        // Trigger the next frame, once the source is ready for it. Returns
+        // the time the trigger was sent.
+        virtual std::chrono::steady_clock::time_point execute_software_trigger(const unsigned int i_timeout_ms) = 0;
+
+        // Camera of the source, NULL if there is none
+        virtual Pylon::CInstantCamera* camera() { return NULL; }
+    };
+
+    //---------------------------------------------------------------------
+    // Frames of a Pylon camera
+    class PylonSource : public FrameSource
+    {
+    public:
+        // The format is taken from the session's cache p_format if given,
+        // else it is cached for the lifetime of the source
+        PylonSource(Pylon::CInstantCamera* camera,
+                    const bool b_verbose,
+                    AcquisitionFormatCache* p_format = NULL);
+
+        unsigned long long width();
+        unsigned long long height();
+        Pylon::EPixelType pixel_type();
+        unsigned long long payload_size();
+        void start_grabbing(const size_t i_num_of_frames);
+        void retrieve(const unsigned int i_timeout_ms, SourceFrame& frame);
+        void stop_grabbing();
+        void arm_trigger(const TriggerSettings& trigger);
+        void disarm_trigger();
+        std::chrono::steady_clock::time_point execute_software_trigger(const unsigned int i_timeout_ms);
+        Pylon::CInstantCamera* camera() { return m_camera; }
+
+    private:
+        // Format of the camera, from m_p_format or m_own_format
+        const AcquisitionFormat& format();
+
+        // Set the trigger settings from before arming
+        void restore_trigger();
+
+        Pylon::CInstantCamera* m_camera;
+        bool m_b_verbose;
+        AcquisitionFormatCache* m_p_format;
+        std::unique_ptr<AcquisitionFormatCache> m_own_format;
+        bool m_b_armed;
+        std::string m_s_trigger_selector;   // Settings before arming
+        std::string m_s_trigger_mode;
+        std::string m_s_trigger_source;
+        std::string m_s_trigger_activation;
+    };
+
+    //---------------------------------------------------------------------
+    // Generated frames of a moving test pattern
+    class SyntheticSource : public FrameSource
+    {
+    public:
+        // A frame rate of 0 delivers frames as fast as possible. Every
+        // i_drop_every-th frame is lost, 0 drops none.
+        SyntheticSource(const unsigned long long i_width,
+                        const unsigned long long i_height,
+                        const Pylon::EPixelType ept_pixel_type,
+                        const double d_frame_rate,
+                        const unsigned long long i_drop_every);
+
+        unsigned long long width() { return m_i_width; }
+        unsigned long long height() { return m_i_height; }
+        Pylon::EPixelType pixel_type() { return m_ept_pixel_type; }
+        unsigned long long payload_size() { return m_i_row_bytes * m_i_height; }
+        void start_grabbing(const size_t i_num_of_frames);
+        void retrieve(const unsigned int i_timeout_ms, SourceFrame& frame);
+        void stop_grabbing();
+        void arm_trigger(const TriggerSettings& trigger);
+        void disarm_trigger();
+        std::chrono::steady_clock::time_point execute_software_trigger(const unsigned int i_timeout_ms);
+
+    private:
+        unsigned long long m_i_width;
+        unsigned long long m_i_height;
+        Pylon::EPixelType m_ept_pixel_type;
+        size_t m_i_row_bytes;
+        std::chrono::steady_clock::duration m_period;
+        unsigned long long m_i_drop_every;
+
+        std::vector<unsigned char> m_pattern;
+        std::vector<std::shared_ptr<Pylon::CPylonImage> > m_buffers;
+        std::chrono::steady_clock::time_point m_next_frame;
+        std::chrono::steady_clock::time_point m_start;
+        size_t m_i_remaining;
+        bool m_b_unbounded;
+        unsigned long long m_i_block_id;
+        bool m_b_triggered;
+        size_t m_i_pending_triggers;
+        std::chrono::steady_clock::time_point m_last_trigger;
+    };
+
+    // Source for the camera argument of a driver function: a struct with
+    // the fields Width, Height, PixelFormat and optionally FrameRate and
+    // DropEvery gives a SyntheticSource, else the camera's session is used
+    // and a continuous grab on it is stopped.
+    std::unique_ptr<FrameSource> create_source( const mxArray* mxa_camera,
+                                                const bool b_verbose);
+
+}
+
+#endif
@@ -0,0 +1,335 @@
+// grab_options.cpp - Tuning of the grab engine and the grab thread
+// 17.10.2026 / agent
+
+
+#include "grab_options.h"
+#include <algorithm>
+#include <cstdio>
+#include <limits>
+#include <mex.h>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+
+namespace {
+
+    //---------------------------------------------------------------------
+    // Set an integer node if the camera has it, false if it has not
+    bool set_int_node(GenApi::INodeMap& node_map, const char* s_name, const int64_t i_value, const bool b_verbose)
+    {
+        GenApi::CIntegerPtr p_node = node_map.GetNode(s_name);
+        if(!GenApi::IsWritable(p_node))
+        {
+            return false;
+        }
+        p_node->SetValue(i_value);
+        if(b_verbose)
+        {
+            mexPrintf("Set \"%s\" to %lld\n", s_name, (long long)i_value);
+        }
+        return true;
+    }
+
+    //---------------------------------------------------------------------
+    // Value of an integer node, NaN if it cannot be read
+    double read_int_node(GenApi::INodeMap& node_map, const char* s_name)
+    {
+        GenApi::CIntegerPtr p_node = node_map.GetNode(s_name);
+        return GenApi::IsReadable(p_node) ? (double)p_node->GetValue() : std::numeric_limits<double>::quiet_NaN();
+    }
+
+    //---------------------------------------------------------------------
+    // Integer field of the options struct, i_value is kept if it is
+    // missing or empty
+    template <typename T>
+    void get_option(const mxArray* mxa_options, const char* s_name, T& i_value)
+    {
+        const mxArray* mxa_field = mxGetField(mxa_options, 0, s_name);
+        if(mxa_field != NULL && !mxIsEmpty(mxa_field))
+        {
+            const double d_value = mxGetScalar(mxa_field);
+            if(!(d_value >= 0) || d_value > (double)std::numeric_limits<int>::max())
+            {
+                mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                        "%s must be a non-negative integer.", s_name);
+            }
+            i_value = (T)d_value;
+        }
+    }
+}
+
+
+namespace BaslerHelper {
+
+    //---------------------------------------------------------------------
+    // Pin and raise the calling thread, note what is not permitted
+    GrabThreadTuning::GrabThreadTuning(const GrabOptions& options)
+        : m_b_pinned(false), m_b_raised(false)
+    {
+        if(options.i_grab_cpu < 0 && options.i_grab_priority <= 0)
+        {
+            return;
+        }
+        char s_message[160];
+#if defined(__linux__)
+        if(options.i_grab_cpu >= 0)
+        {
+            cpu_set_t cs_grab;
+            CPU_ZERO(&cs_grab);
+            CPU_SET(options.i_grab_cpu, &cs_grab);
+            m_b_pinned = pthread_getaffinity_np(pthread_self(), sizeof(m_cpu_set), &m_cpu_set) == 0 &&
+                    pthread_setaffinity_np(pthread_self(), sizeof(cs_grab), &cs_grab) == 0;
+            if(!m_b_pinned)
+            {
+                snprintf(s_message, sizeof(s_message), "Cannot pin the grab thread to CPU %d. ", options.i_grab_cpu);
+                m_s_warning += s_message;
+            }
+        }
+        if(options.i_grab_priority > 0)
+        {
+            sched_param sp_grab;
+            sp_grab.sched_priority = std::min(options.i_grab_priority, sched_get_priority_max(SCHED_FIFO));
+            m_b_raised = pthread_getschedparam(pthread_self(), &m_i_policy, &m_sched_param) == 0 &&
+                    pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp_grab) == 0;
+            if(!m_b_raised)
+            {
+                snprintf(s_message, sizeof(s_message),
+                        "Cannot raise the grab thread to real-time priority %d, it needs CAP_SYS_NICE or an rtprio limit.",
+                        (int)sp_grab.sched_priority);
+                m_s_warning += s_message;
+            }
+        }
+#elif defined(_WIN32)
+        if(options.i_grab_cpu >= 0)
+        {
+            m_i_affinity = (uintptr_t)SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << options.i_grab_cpu);
+            m_b_pinned = m_i_affinity != 0;
+            if(!m_b_pinned)
+            {
+                snprintf(s_message, sizeof(s_message), "Cannot pin the grab thread to CPU %d. ", options.i_grab_cpu);
+                m_s_warning += s_message;
+            }
+        }
+        if(options.i_grab_priority > 0)
+        {
+            m_i_priority = GetThreadPriority(GetCurrentThread());
+            m_b_raised = SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL) != 0;
+            if(!m_b_raised)
+            {
+                m_s_warning += "Cannot raise the priority of the grab thread.";
+            }
+        }
+#else
+        m_s_warning = "Pinning and raising the grab thread is not supported on this platform.";
+#endif
+    }
+
+    //---------------------------------------------------------------------
+    // Restore the affinity and priority of the thread
+    GrabThreadTuning::~GrabThreadTuning()
+    {
+#if defined(__linux__)
+        if(m_b_raised)
+        {
+            pthread_setschedparam(pthread_self(), m_i_policy, &m_sched_param);
+        }
+        if(m_b_pinned)
+        {
+            pthread_setaffinity_np(pthread_self(), sizeof(m_cpu_set), &m_cpu_set);
+        }
+#elif defined(_WIN32)
+        if(m_b_raised)
+        {
+            SetThreadPriority(GetCurrentThread(), m_i_priority);
+        }
+        if(m_b_pinned)
+        {
+            SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)m_i_affinity);
+        }
+#endif
+    }
+
+    //---------------------------------------------------------------------
+    // Warning and verbose output of the grab thread's tuning
+    void GrabThread::report(const bool b_verbose) const
+    {
+        if(!m_s_warning.empty())
+        {
+            mexWarnMsgIdAndTxt("baslerDriver:Warning:GrabThread", "%s", m_s_warning.c_str());
+        }
+        if(b_verbose && (m_b_pinned || m_b_raised))
+        {
+            mexPrintf("Grab thread pinned: %d, raised: %d\n", (int)m_b_pinned, (int)m_b_raised);
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Collect the pairs into a new struct, or check the fields of the
+    // given one
+    mxArray* options_to_struct(const int i_num_of_args, const mxArray* mxa_args[],
+            const std::vector<std::string>& s_other_names)
+    {
+        const char* s_grab_names[] = {"MaxNumBuffer", "PacketSize", "InterPacketDelay", "MaxTransferSize",
+                                      "NumMaxQueuedUrbs", "EnginePriority", "GrabThreadCpu",
+                                      "GrabThreadPriority", "Telemetry", "TraceFile"};
+        std::vector<std::string> s_names(s_grab_names, s_grab_names + sizeof(s_grab_names) / sizeof(s_grab_names[0]));
+        s_names.insert(s_names.end(), s_other_names.begin(), s_other_names.end());
+
+        mxArray* mxa_options = NULL;
+        if(i_num_of_args == 0 || (i_num_of_args == 1 && mxIsEmpty(mxa_args[0])))
+        {
+            return NULL;
+        }
+        else if(i_num_of_args == 1 && mxIsStruct(mxa_args[0]))
+        {
+            mxa_options = mxDuplicateArray(mxa_args[0]);
+        }
+        else if(i_num_of_args % 2 == 0)
+        {
+            mxa_options = mxCreateStructMatrix(1, 1, 0, NULL);
+            for(int i = 0; i < i_num_of_args; i += 2)
+            {
+                if(!mxIsChar(mxa_args[i]))
+                {
+                    mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                            "Option names must be strings.");
+                }
+                const std::string s_name = mxArrayToString(mxa_args[i]);
+                int i_field = mxGetFieldNumber(mxa_options, s_name.c_str());
+                if(i_field < 0)
+                {
+                    i_field = mxAddField(mxa_options, s_name.c_str());
+                }
+                mxSetFieldByNumber(mxa_options, 0, i_field, mxDuplicateArray(mxa_args[i + 1]));
+            }
+        }
+        else
+        {
+            mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                    "options must be a struct or name/value pairs.");
+        }
+
+        for(int i = 0; i < mxGetNumberOfFields(mxa_options); i++)
+        {
+            const std::string s_name = mxGetFieldNameByNumber(mxa_options, i);
+            if(std::find(s_names.begin(), s_names.end(), s_name) == s_names.end())
+            {
+                mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                        "Unknown option \"%s\".", s_name.c_str());
+            }
+        }
+        return mxa_options;
+    }
+
+    //---------------------------------------------------------------------
+    // Read the fields of the options struct, all are optional
+    void parse_grab_options(const mxArray* mxa_options, GrabOptions& options)
+    {
+        if(!mxIsStruct(mxa_options))
+        {
+            mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                    "options must be a struct or name/value pairs.");
+        }
+        get_option(mxa_options, "MaxNumBuffer", options.i_max_num_buffer);
+        get_option(mxa_options, "PacketSize", options.i_packet_size);
+        get_option(mxa_options, "InterPacketDelay", options.i_inter_packet_delay);
+        get_option(mxa_options, "MaxTransferSize", options.i_max_transfer_size);
+        get_option(mxa_options, "NumMaxQueuedUrbs", options.i_num_max_queued_urbs);
+        get_option(mxa_options, "EnginePriority", options.i_engine_priority);
+        get_option(mxa_options, "GrabThreadCpu", options.i_grab_cpu);
+        get_option(mxa_options, "GrabThreadPriority", options.i_grab_priority);
+        
+        const mxArray* mxa_telemetry = mxGetField(mxa_options, 0, "Telemetry");
+        if(mxa_telemetry != NULL && !mxIsEmpty(mxa_telemetry))
+        {
+            options.b_telemetry = mxGetScalar(mxa_telemetry) != 0;
+        }
+        const mxArray* mxa_trace_file = mxGetField(mxa_options, 0, "TraceFile");
+        if(mxa_trace_file != NULL && !mxIsEmpty(mxa_trace_file))
+        {
+            if(!mxIsChar(mxa_trace_file))
+            {
+                mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                        "TraceFile must be a file name.");
+            }
+            options.s_trace_file = mxArrayToString(mxa_trace_file);
+            options.b_telemetry = true;
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Set the given options, the transport layer specific ones only if the
+    // camera has them
+    void apply_grab_options(Pylon::CInstantCamera* p_camera, const GrabOptions& options, const bool b_verbose)
+    {
+        if(options.i_max_num_buffer >= 0)
+        {
+            p_camera->MaxNumBuffer.SetValue(options.i_max_num_buffer);
+        }
+        if(options.i_engine_priority >= 0)
+        {
+            p_camera->InternalGrabEngineThreadPriorityOverride.SetValue(true);
+            p_camera->InternalGrabEngineThreadPriority.SetValue(options.i_engine_priority);
+        }
+        if(options.i_packet_size >= 0 && !set_int_node(p_camera->GetNodeMap(), "GevSCPSPacketSize", options.i_packet_size, b_verbose))
+        {
+            mexWarnMsgIdAndTxt("baslerDriver:Warning:GrabOption", "The camera has no GevSCPSPacketSize, PacketSize is ignored.");
+        }
+        if(options.i_inter_packet_delay >= 0 && !set_int_node(p_camera->GetNodeMap(), "GevSCPD", options.i_inter_packet_delay, b_verbose))
+        {
+            mexWarnMsgIdAndTxt("baslerDriver:Warning:GrabOption", "The camera has no GevSCPD, InterPacketDelay is ignored.");
+        }
+        if(options.i_max_transfer_size >= 0 &&
+                !set_int_node(p_camera->GetStreamGrabberNodeMap(), "MaxTransferSize", options.i_max_transfer_size, b_verbose))
+        {
+            mexWarnMsgIdAndTxt("baslerDriver:Warning:GrabOption", "The stream grabber has no MaxTransferSize, it is ignored.");
+        }
+        if(options.i_num_max_queued_urbs >= 0 &&
+                !set_int_node(p_camera->GetStreamGrabberNodeMap(), "NumMaxQueuedUrbs", options.i_num_max_queued_urbs, b_verbose))
+        {
+            mexWarnMsgIdAndTxt("baslerDriver:Warning:GrabOption", "The stream grabber has no NumMaxQueuedUrbs, it is ignored.");
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Counters of GigE and USB stream grabbers, all NaN without a camera
+    StreamStatistics read_stream_statistics(Pylon::CInstantCamera* p_camera)
+    {
+        StreamStatistics statistics;
+        if(p_camera == NULL)
+        {
+            const double d_nan = std::numeric_limits<double>::quiet_NaN();
+            statistics.d_total_buffers = statistics.d_failed_buffers = statistics.d_buffer_underruns = d_nan;
+            statistics.d_missed_frames = statistics.d_resend_requests = statistics.d_resend_packets = d_nan;
+            return statistics;
+        }
+        GenApi::INodeMap& node_map = p_camera->GetStreamGrabberNodeMap();
+        statistics.d_total_buffers = read_int_node(node_map, "Statistic_Total_Buffer_Count");
+        statistics.d_failed_buffers = read_int_node(node_map, "Statistic_Failed_Buffer_Count");
+        statistics.d_buffer_underruns = read_int_node(node_map, "Statistic_Buffer_Underrun_Count");
+        statistics.d_missed_frames = read_int_node(node_map, "Statistic_Missed_Frame_Count");
+        statistics.d_resend_requests = read_int_node(node_map, "Statistic_Resend_Request_Count");
+        statistics.d_resend_packets = read_int_node(node_map, "Statistic_Resend_Packet_Count");
+        return statistics;
+    }
+
+    //---------------------------------------------------------------------
+    // Matlab struct with one scalar per counter
+    mxArray* stream_statistics_to_struct(const StreamStatistics& statistics)
+    {
+        const char* s_fields[] = {"totalBuffers", "failedBuffers", "bufferUnderruns",
+                                  "missedFrames", "resendRequests", "resendPackets"};
+        mxArray* mxa_statistics = mxCreateStructMatrix(1, 1, 6, s_fields);
+        mxSetField(mxa_statistics, 0, "totalBuffers", mxCreateDoubleScalar(statistics.d_total_buffers));
+        mxSetField(mxa_statistics, 0, "failedBuffers", mxCreateDoubleScalar(statistics.d_failed_buffers));
+        mxSetField(mxa_statistics, 0, "bufferUnderruns", mxCreateDoubleScalar(statistics.d_buffer_underruns));
+        mxSetField(mxa_statistics, 0, "missedFrames", mxCreateDoubleScalar(statistics.d_missed_frames));
+        mxSetField(mxa_statistics, 0, "resendRequests", mxCreateDoubleScalar(statistics.d_resend_requests));
+        mxSetField(mxa_statistics, 0, "resendPackets", mxCreateDoubleScalar(statistics.d_resend_packets));
+        return mxa_statistics;
+    }
+
+}
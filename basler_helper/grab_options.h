@@ -0,0 +1,173 @@
+// grab_options.h - Tuning of the grab engine and the grab thread
+// 17.10.2026 / agent
+//
+// The number of Pylon buffers, the GigE packet size and inter-packet
+// delay, the USB transfer sizes and the priority of Pylon's grab engine
+// thread are set before grabbing; they stay set on the camera. The
+// frames can be retrieved by a dedicated thread, pinned to a CPU and run
+// at a real-time priority for the capture. The statistics of the stream
+// grabber, and the telemetry of the capture stages, show whether the
+// settings keep up with the camera.
+
+#ifndef __GRABOPTIONS_H_INCLUDED__
+#define __GRABOPTIONS_H_INCLUDED__
+
+#include <pylon/PylonIncludes.h>
+#include <matrix.h>
+#include <exception>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+
+namespace BaslerHelper {
+
+    //---------------------------------------------------------------------
+    // Options of a capture, negative values keep the current setting
+    struct GrabOptions
+    {
+        GrabOptions() : i_max_num_buffer(-1), i_packet_size(-1), i_inter_packet_delay(-1),
+                        i_max_transfer_size(-1), i_num_max_queued_urbs(-1), i_engine_priority(-1),
+                        i_grab_cpu(-1), i_grab_priority(-1), b_telemetry(false) {}
+        int64_t i_max_num_buffer;           // Pylon buffers
+        int64_t i_packet_size;              // GevSCPSPacketSize, in bytes
+        int64_t i_inter_packet_delay;       // GevSCPD, in ticks
+        int64_t i_max_transfer_size;        // USB stream grabber, in bytes
+        int64_t i_num_max_queued_urbs;      // USB stream grabber
+        int64_t i_engine_priority;          // Pylon's grab engine thread
+        int i_grab_cpu;                     // CPU of the grab thread
+        int i_grab_priority;                // Real-time priority of the grab
+                                            // thread, 1 to 99
+        bool b_telemetry;                   // Time the stages of the capture
+        std::string s_trace_file;           // Chrome trace of the stages
+    };
+
+    //---------------------------------------------------------------------
+    // Counters of the stream grabber since grabbing started, NaN where the
+    // transport layer does not provide them
+    struct StreamStatistics
+    {
+        double d_total_buffers;
+        double d_failed_buffers;
+        double d_buffer_underruns;
+        double d_missed_frames;
+        double d_resend_requests;
+        double d_resend_packets;
+    };
+
+    //---------------------------------------------------------------------
+    // Pins the calling thread to a CPU and raises its priority, both as
+    // far as permitted, and restores them when going out of scope. Does
+    // not call Matlab, what was not permitted is left in warning().
+    class GrabThreadTuning
+    {
+    public:
+        GrabThreadTuning(const GrabOptions& options);
+        ~GrabThreadTuning();
+
+        bool pinned() const { return m_b_pinned; }
+        bool raised() const { return m_b_raised; }
+        const std::string& warning() const { return m_s_warning; }
+
+    private:
+        GrabThreadTuning(const GrabThreadTuning&);
+        GrabThreadTuning& operator=(const GrabThreadTuning&);
+
+        bool m_b_pinned;
+        bool m_b_raised;
+        std::string m_s_warning;
+#if defined(__linux__)
+        cpu_set_t m_cpu_set;
+        int m_i_policy;
+        sched_param m_sched_param;
+#elif defined(_WIN32)
+        uintptr_t m_i_affinity;
+        int m_i_priority;
+#endif
+    };
+
+    //---------------------------------------------------------------------
+    // Runs the grab loop of a capture. If the options pin or raise the grab
+    // thread, the loop runs in a dedicated thread with these settings and
+    // the calling thread waits for it, so Matlab's own thread is never
+    // pinned or raised. Else the loop runs in the calling thread. The loop
+    // must not call Matlab.
+    class GrabThread
+    {
+    public:
+        GrabThread(const GrabOptions& options)
+            : m_options(options), m_b_pinned(false), m_b_raised(false) {}
+
+        // Run f and rethrow its errors
+        template <typename F>
+        void run(F f)
+        {
+            if(m_options.i_grab_cpu < 0 && m_options.i_grab_priority <= 0)
+            {
+                f();
+                return;
+            }
+            std::exception_ptr error;
+            std::thread thread([&]()
+            {
+                GrabThreadTuning tuning(m_options);
+                m_b_pinned = tuning.pinned();
+                m_b_raised = tuning.raised();
+                m_s_warning = tuning.warning();
+                try
+                {
+                    f();
+                }
+                catch (...)
+                {
+                    error = std::current_exception();
+                }
+            });
+            thread.join();
+            if(error)
+            {
+                std::rethrow_exception(error);
+            }
+        }
+
+        // Warn about the tuning which was not permitted, only in the
+        // Matlab thread
+        void report(const bool b_verbose) const;
+
+    private:
+        GrabOptions m_options;
+        bool m_b_pinned;
+        bool m_b_raised;
+        std::string m_s_warning;
+    };
+
+    // Options of a driver function as struct, from one struct or from
+    // name/value pairs. Names other than those of the grab options and
+    // s_other_names are an argument error. NULL without options.
+    mxArray* options_to_struct( const int i_num_of_args,
+                                const mxArray* mxa_args[],
+                                const std::vector<std::string>& s_other_names);
+
+    // Read the grab options of the options struct of a driver function
+    void parse_grab_options(const mxArray* mxa_options, GrabOptions& options);
+
+    // Set the options on the camera, before grabbing
+    void apply_grab_options(Pylon::CInstantCamera* p_camera,
+                            const GrabOptions& options,
+                            const bool b_verbose);
+
+    // Read the stream grabber's counters, p_camera may be NULL
+    StreamStatistics read_stream_statistics(Pylon::CInstantCamera* p_camera);
+
+    // Matlab struct of the counters
+    mxArray* stream_statistics_to_struct(const StreamStatistics& statistics);
+
+}
+
+#endif
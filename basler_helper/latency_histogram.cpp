@@ -0,0 +1,56 @@
+// latency_histogram.cpp - Latencies of repeated operations and their percentiles
+// 17.10.2026 / agent
+
+
+#include "latency_histogram.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <mex.h>
+
+
+namespace BaslerHelper {
+
+    //---------------------------------------------------------------------
+    // Linear interpolation between the sorted latencies
+    double LatencyHistogram::percentile(const double d_percent) const
+    {
+        std::vector<double> d_sorted;
+        for(size_t i = 0; i < d_latencies.size(); i++)
+        {
+            if(!std::isnan(d_latencies[i]))
+            {
+                d_sorted.push_back(d_latencies[i]);
+            }
+        }
+        if(d_sorted.empty())
+        {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+        std::sort(d_sorted.begin(), d_sorted.end());
+        const double d_position = std::min(std::max(d_percent, 0.0), 100.0) / 100.0 * (double)(d_sorted.size() - 1);
+        const size_t i_lower = (size_t)d_position;
+        const size_t i_upper = std::min(i_lower + 1, d_sorted.size() - 1);
+        return d_sorted[i_lower] + (d_position - (double)i_lower) * (d_sorted[i_upper] - d_sorted[i_lower]);
+    }
+
+    //---------------------------------------------------------------------
+    // Matlab struct of the latencies and their percentiles
+    mxArray* latency_to_struct(const LatencyHistogram& latency)
+    {
+        const char* s_fields[] = {"latencies", "median", "p90", "p99", "max"};
+        mxArray* mxa_latency = mxCreateStructMatrix(1, 1, 5, s_fields);
+        mxArray* mxa_latencies = mxCreateDoubleMatrix(latency.d_latencies.size(), 1, mxREAL);
+        if(!latency.d_latencies.empty())
+        {
+            memcpy(mxGetPr(mxa_latencies), &latency.d_latencies[0], latency.d_latencies.size() * sizeof(double));
+        }
+        mxSetField(mxa_latency, 0, "latencies", mxa_latencies);
+        mxSetField(mxa_latency, 0, "median", mxCreateDoubleScalar(latency.percentile(50)));
+        mxSetField(mxa_latency, 0, "p90", mxCreateDoubleScalar(latency.percentile(90)));
+        mxSetField(mxa_latency, 0, "p99", mxCreateDoubleScalar(latency.percentile(99)));
+        mxSetField(mxa_latency, 0, "max", mxCreateDoubleScalar(latency.percentile(100)));
+        return mxa_latency;
+    }
+
+}
@@ -0,0 +1,51 @@
+// latency_histogram.h - Latencies of repeated operations and their percentiles
+// 17.10.2026 / agent
+//
+// Stores the latency of every frame of a capture or every access to a
+// parameter, from a start time set by the caller until stop is called,
+// and returns their percentiles to Matlab.
+
+#ifndef __LATENCYHISTOGRAM_H_INCLUDED__
+#define __LATENCYHISTOGRAM_H_INCLUDED__
+
+#include <matrix.h>
+#include <chrono>
+#include <limits>
+#include <vector>
+
+
+namespace BaslerHelper {
+
+    //---------------------------------------------------------------------
+    // Latency of every operation, from its start until it is done
+    struct LatencyHistogram
+    {
+        // Preallocate for i_num_of_operations operations
+        void resize(const size_t i_num_of_operations)
+        {
+            tp_starts.resize(i_num_of_operations);
+            d_latencies.assign(i_num_of_operations, std::numeric_limits<double>::quiet_NaN());
+        }
+
+        // Store the latency of an operation, called by the thread which
+        // completes it
+        void stop(const size_t i_operation)
+        {
+            d_latencies[i_operation] = std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - tp_starts[i_operation]).count();
+        }
+
+        // Percentile of the measured latencies, NaN if there are none
+        double percentile(const double d_percent) const;
+
+        std::vector<std::chrono::steady_clock::time_point> tp_starts;
+        std::vector<double> d_latencies;    // In s, NaN if not stored
+    };
+
+    // Matlab struct with the latencies (n x 1, in s) and their median,
+    // 90th and 99th percentile and maximum
+    mxArray* latency_to_struct(const LatencyHistogram& latency);
+
+}
+
+#endif
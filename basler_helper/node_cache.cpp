@@ -0,0 +1,264 @@
+// node_cache.cpp - Node handles of a camera, looked up once by name
+// 17.10.2026 / agent
+
+
+#include "node_cache.h"
+#include <mex.h>
+
+
+namespace BaslerHelper {
+
+    //---------------------------------------------------------------------
+    // Policy for its name
+    ReadPolicy parse_read_policy(const std::string& s_policy)
+    {
+        if(s_policy == "Cached")
+        {
+            return ReadPolicy_Cached;
+        }
+        if(s_policy == "Polled")
+        {
+            return ReadPolicy_Polled;
+        }
+        if(s_policy == "Device")
+        {
+            return ReadPolicy_Device;
+        }
+        throw RUNTIME_EXCEPTION("Unknown read policy \"%s\", use Cached, Polled or Device.", s_policy.c_str());
+    }
+
+    //---------------------------------------------------------------------
+    // Name of a policy
+    const char* read_policy_name(const ReadPolicy rp_policy)
+    {
+        switch(rp_policy)
+        {
+            case ReadPolicy_Polled: return "Polled";
+            case ReadPolicy_Device: return "Device";
+            default:                return "Cached";
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Empty cache, the policy keeps GenApi's caching
+    NodeCache::NodeCache(GenApi::INodeMap* p_nodemap)
+        : m_p_nodemap(p_nodemap), m_rp_policy(ReadPolicy_Cached), m_tp_last_poll(std::chrono::steady_clock::now())
+    {
+    }
+
+    //---------------------------------------------------------------------
+    // Look up a node and its interfaces once
+    NodeCache::Entry* NodeCache::lookup(const std::string& s_name)
+    {
+        std::unordered_map<std::string, Entry>::iterator it = m_nodes.find(s_name);
+        if(it != m_nodes.end())
+        {
+            return &it->second;
+        }
+
+        GenApi::INode* p_node = m_p_nodemap->GetNode(s_name.c_str());
+        if(p_node == NULL)
+        {
+            return NULL;
+        }
+        Entry new_entry;
+        new_entry.p_node = p_node;
+        new_entry.p_float = dynamic_cast<GenApi::IFloat*>(p_node);
+        new_entry.p_int = dynamic_cast<GenApi::IInteger*>(p_node);
+        new_entry.p_bool = dynamic_cast<GenApi::IBoolean*>(p_node);
+        new_entry.p_value = dynamic_cast<GenApi::IValue*>(p_node);
+        return &(m_nodes[s_name] = new_entry);
+    }
+
+    NodeCache::Entry& NodeCache::entry(const std::string& s_name)
+    {
+        Entry* p_entry = lookup(s_name);
+        if(p_entry == NULL)
+        {
+            throw RUNTIME_EXCEPTION("Parameter \"%s\" does not exist.", s_name.c_str());
+        }
+        return *p_entry;
+    }
+
+    GenApi::INode* NodeCache::node(const std::string& s_name)
+    {
+        return entry(s_name).p_node;
+    }
+
+    GenApi::IFloat& NodeCache::float_node(const std::string& s_name)
+    {
+        GenApi::IFloat* p_float = entry(s_name).p_float;
+        if(p_float == NULL)
+        {
+            throw RUNTIME_EXCEPTION("Parameter \"%s\" is not a float.", s_name.c_str());
+        }
+        return *p_float;
+    }
+
+    GenApi::IInteger& NodeCache::int_node(const std::string& s_name)
+    {
+        GenApi::IInteger* p_int = entry(s_name).p_int;
+        if(p_int == NULL)
+        {
+            throw RUNTIME_EXCEPTION("Parameter \"%s\" is not an integer.", s_name.c_str());
+        }
+        return *p_int;
+    }
+
+    GenApi::IBoolean& NodeCache::bool_node(const std::string& s_name)
+    {
+        GenApi::IBoolean* p_bool = entry(s_name).p_bool;
+        if(p_bool == NULL)
+        {
+            throw RUNTIME_EXCEPTION("Parameter \"%s\" is not a boolean.", s_name.c_str());
+        }
+        return *p_bool;
+    }
+
+    GenApi::IValue& NodeCache::value_node(const std::string& s_name)
+    {
+        GenApi::IValue* p_value = entry(s_name).p_value;
+        if(p_value == NULL)
+        {
+            throw RUNTIME_EXCEPTION("Parameter \"%s\" has no value.", s_name.c_str());
+        }
+        return *p_value;
+    }
+
+    //---------------------------------------------------------------------
+    // Poll the node map with the time since the last poll, or drop the
+    // node's cached value
+    void NodeCache::prepare_read(GenApi::INode* p_node)
+    {
+        if(m_rp_policy == ReadPolicy_Polled)
+        {
+            const std::chrono::steady_clock::time_point tp_now = std::chrono::steady_clock::now();
+            const int64_t i_elapsed_ms =
+                    std::chrono::duration_cast<std::chrono::milliseconds>(tp_now - m_tp_last_poll).count();
+            if(i_elapsed_ms > 0)
+            {
+                m_p_nodemap->Poll(i_elapsed_ms);
+                m_tp_last_poll = tp_now;
+            }
+        }
+        else if(m_rp_policy == ReadPolicy_Device)
+        {
+            p_node->InvalidateNode();
+        }
+    }
+
+    void NodeCache::set_read_policy(const ReadPolicy rp_policy)
+    {
+        m_rp_policy = rp_policy;
+        m_tp_last_poll = std::chrono::steady_clock::now();
+    }
+
+    //---------------------------------------------------------------------
+    // Read values
+    double NodeCache::get_float(const std::string& s_name, const bool b_verbose)
+    {
+        GenApi::IFloat& node = float_node(s_name);
+        prepare_read(node.GetNode());
+        const double d_value = node.GetValue();
+        if(b_verbose)
+        {
+            mexPrintf("Read Parameter \"%s\": %f\n", s_name.c_str(), d_value);
+        }
+        return d_value;
+    }
+
+    int64_t NodeCache::get_int(const std::string& s_name, const bool b_verbose)
+    {
+        GenApi::IInteger& node = int_node(s_name);
+        prepare_read(node.GetNode());
+        const int64_t i_value = node.GetValue();
+        if(b_verbose)
+        {
+            mexPrintf("Read Parameter \"%s\": %lld\n", s_name.c_str(), (long long)i_value);
+        }
+        return i_value;
+    }
+
+    bool NodeCache::get_bool(const std::string& s_name, const bool b_verbose)
+    {
+        GenApi::IBoolean& node = bool_node(s_name);
+        prepare_read(node.GetNode());
+        const bool b_value = node.GetValue();
+        if(b_verbose)
+        {
+            mexPrintf("Read Parameter \"%s\": %d\n", s_name.c_str(), (int)b_value);
+        }
+        return b_value;
+    }
+
+    std::string NodeCache::get_string(const std::string& s_name, const bool b_verbose)
+    {
+        GenApi::IValue& node = value_node(s_name);
+        prepare_read(node.GetNode());
+        const std::string s_value(node.ToString().c_str());
+        if(b_verbose)
+        {
+            mexPrintf("Read Parameter \"%s\": %s\n", s_name.c_str(), s_value.c_str());
+        }
+        return s_value;
+    }
+
+    //---------------------------------------------------------------------
+    // Write values
+    void NodeCache::set_float(const std::string& s_name, const double d_value, const bool b_verbose)
+    {
+        GenApi::IFloat& node = float_node(s_name);
+        if(!GenApi::IsWritable(&node))
+        {
+            throw RUNTIME_EXCEPTION("Parameter \"%s\" not writable.", s_name.c_str());
+        }
+        node.SetValue(d_value);
+        if(b_verbose)
+        {
+            mexPrintf("Set Parameter \"%s\" to %f\n", s_name.c_str(), d_value);
+        }
+    }
+
+    void NodeCache::set_int(const std::string& s_name, const int64_t i_value, const bool b_verbose)
+    {
+        GenApi::IInteger& node = int_node(s_name);
+        if(!GenApi::IsWritable(&node))
+        {
+            throw RUNTIME_EXCEPTION("Parameter \"%s\" not writable.", s_name.c_str());
+        }
+        node.SetValue(i_value);
+        if(b_verbose)
+        {
+            mexPrintf("Set Parameter \"%s\" to %lld\n", s_name.c_str(), (long long)i_value);
+        }
+    }
+
+    void NodeCache::set_bool(const std::string& s_name, const bool b_value, const bool b_verbose)
+    {
+        GenApi::IBoolean& node = bool_node(s_name);
+        if(!GenApi::IsWritable(&node))
+        {
+            throw RUNTIME_EXCEPTION("Parameter \"%s\" not writable.", s_name.c_str());
+        }
+        node.SetValue(b_value);
+        if(b_verbose)
+        {
+            mexPrintf("Set Parameter \"%s\" to %d\n", s_name.c_str(), (int)b_value);
+        }
+    }
+
+    void NodeCache::set_string(const std::string& s_name, const std::string& s_value, const bool b_verbose)
+    {
+        GenApi::IValue& node = value_node(s_name);
+        if(!GenApi::IsWritable(&node))
+        {
+            throw RUNTIME_EXCEPTION("Parameter \"%s\" not writable.", s_name.c_str());
+        }
+        node.FromString(s_value.c_str());
+        if(b_verbose)
+        {
+            mexPrintf("Set Parameter \"%s\" to %s\n", s_name.c_str(), s_value.c_str());
+        }
+    }
+
+}
@@ -0,0 +1,109 @@
+// node_cache.h - Node handles of a camera, looked up once by name
+// 17.10.2026 / agent
+//
+// GetNodeMap().GetNode(name) searches the node map by string on every
+// call. Closed-loop control touches the same few nodes thousands of
+// times, so the camera session keeps the handles of all nodes used so far.
+// The typed accessors return the node's interface, which callers may keep
+// for the lifetime of the session and use without any lookup.
+//
+// The read policy decides where values come from:
+//   - Cached: GenApi's own cache, values which were written or read are
+//     returned without a round trip until GenApi invalidates them
+//   - Polled: the node map is polled before a read, so nodes with a
+//     polling time (e.g. ExposureTime during ExposureAuto) are refreshed
+//     once it has elapsed
+//   - Device: every read invalidates the node and fetches the value from
+//     the camera
+
+#ifndef __NODECACHE_H_INCLUDED__
+#define __NODECACHE_H_INCLUDED__
+
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <stdint.h>
+#include <pylon/PylonIncludes.h>
+
+
+namespace BaslerHelper {
+
+    // Where node values are read from
+    enum ReadPolicy
+    {
+        ReadPolicy_Cached,
+        ReadPolicy_Polled,
+        ReadPolicy_Device
+    };
+
+    // Policy for its name (Cached, Polled or Device), throws for others
+    ReadPolicy parse_read_policy(const std::string& s_policy);
+
+    // Name of a policy
+    const char* read_policy_name(const ReadPolicy rp_policy);
+
+    //---------------------------------------------------------------------
+    // Handles of the nodes of one node map, which has to outlive the cache
+    class NodeCache
+    {
+    public:
+        NodeCache(GenApi::INodeMap* p_nodemap);
+
+        // Node of the name, looked up on first use. Throws if the camera
+        // has no such node.
+        GenApi::INode* node(const std::string& s_name);
+
+        // True if the camera has a node of the name
+        bool contains(const std::string& s_name) { return lookup(s_name) != NULL; }
+
+        // Typed interfaces, throw if the node has another type
+        GenApi::IFloat& float_node(const std::string& s_name);
+        GenApi::IInteger& int_node(const std::string& s_name);
+        GenApi::IBoolean& bool_node(const std::string& s_name);
+        GenApi::IValue& value_node(const std::string& s_name);
+
+        // Apply the read policy before reading a node through its handle
+        void prepare_read(GenApi::INode* p_node);
+
+        // Read values, following the read policy. Strings are read from
+        // enumerations or string nodes.
+        double get_float(const std::string& s_name, const bool b_verbose);
+        int64_t get_int(const std::string& s_name, const bool b_verbose);
+        bool get_bool(const std::string& s_name, const bool b_verbose);
+        std::string get_string(const std::string& s_name, const bool b_verbose);
+
+        // Write values, throw if the node is not writable
+        void set_float(const std::string& s_name, const double d_value, const bool b_verbose);
+        void set_int(const std::string& s_name, const int64_t i_value, const bool b_verbose);
+        void set_bool(const std::string& s_name, const bool b_value, const bool b_verbose);
+        void set_string(const std::string& s_name, const std::string& s_value, const bool b_verbose);
+
+        ReadPolicy read_policy() const { return m_rp_policy; }
+        void set_read_policy(const ReadPolicy rp_policy);
+
+        // Forget all handles, e.g. after the node map was replaced
+        void clear() { m_nodes.clear(); }
+
+    private:
+        struct Entry
+        {
+            GenApi::INode* p_node;
+            GenApi::IFloat* p_float;
+            GenApi::IInteger* p_int;
+            GenApi::IBoolean* p_bool;
+            GenApi::IValue* p_value;
+        };
+
+        // Entry of the node, NULL if there is no such node
+        Entry* lookup(const std::string& s_name);
+        Entry& entry(const std::string& s_name);
+
+        GenApi::INodeMap* m_p_nodemap;
+        std::unordered_map<std::string, Entry> m_nodes;
+        ReadPolicy m_rp_policy;
+        std::chrono::steady_clock::time_point m_tp_last_poll;
+    };
+
+}
+
+#endif
@@ -0,0 +1,283 @@
+// raw_stream.cpp - Single file container for raw frame sequences
+// 17.10.2026 / agent
+
+
+// O_DIRECT needs _GNU_SOURCE before any system header
+#if !defined(_WIN32) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include "raw_stream.h"
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <malloc.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+
+namespace BaslerHelper {
+
+    //---------------------------------------------------------------------
+    // Allocate aligned memory
+    AlignedBuffer::AlignedBuffer(size_t i_size) : m_p_data(NULL), m_i_size(i_size)
+    {
+#ifdef _WIN32
+        m_p_data = _aligned_malloc(i_size, RAW_STREAM_ALIGNMENT);
+#else
+        if(posix_memalign(&m_p_data, RAW_STREAM_ALIGNMENT, i_size) != 0)
+        {
+            m_p_data = NULL;
+        }
+#endif
+        if(m_p_data == NULL)
+        {
+            throw RUNTIME_EXCEPTION("Cannot allocate frame buffer.");
+        }
+        memset(m_p_data, 0, i_size);
+    }
+
+    //---------------------------------------------------------------------
+    // Free aligned memory
+    AlignedBuffer::~AlignedBuffer()
+    {
+#ifdef _WIN32
+        _aligned_free(m_p_data);
+#else
+        free(m_p_data);
+#endif
+    }
+
+    //---------------------------------------------------------------------
+    // No file yet
+#ifdef _WIN32
+    FileHandle::FileHandle() : m_handle(INVALID_HANDLE_VALUE)
+#else
+    FileHandle::FileHandle() : m_handle(-1)
+#endif
+    {
+    }
+
+    FileHandle::~FileHandle()
+    {
+#ifdef _WIN32
+        reset(INVALID_HANDLE_VALUE);
+#else
+        reset(-1);
+#endif
+    }
+
+    //---------------------------------------------------------------------
+    // Close the owned file
+    void FileHandle::reset(Native handle)
+    {
+        if(valid())
+        {
+#ifdef _WIN32
+            CloseHandle(m_handle);
+#else
+            ::close(m_handle);
+#endif
+        }
+        m_handle = handle;
+    }
+
+    bool FileHandle::valid() const
+    {
+#ifdef _WIN32
+        return m_handle != INVALID_HANDLE_VALUE && m_handle != NULL;
+#else
+        return m_handle >= 0;
+#endif
+    }
+
+    //---------------------------------------------------------------------
+    // Create file and preallocate all frames
+    RawStreamWriter::RawStreamWriter(   const std::string& s_filename,
+                                        const uint32_t i_width,
+                                        const uint32_t i_height,
+                                        const Pylon::EPixelType ept_pixel_type,
+                                        const uint64_t i_frame_capacity)
+        : m_index(i_frame_capacity), m_i_frame_end(0), m_b_direct(false), m_b_closed(false)
+    {
+        // Fill header
+        memset(&m_header, 0, sizeof(m_header));
+        memcpy(m_header.s_magic, RAW_STREAM_MAGIC, sizeof(m_header.s_magic));
+        m_header.i_version = RAW_STREAM_VERSION;
+        m_header.i_header_size = (uint32_t)raw_stream_align(sizeof(RawStreamHeader));
+        m_header.i_width = i_width;
+        m_header.i_height = i_height;
+        m_header.i_pixel_type = (int32_t)ept_pixel_type;
+        m_header.i_bits_per_pixel = Pylon::BitPerPixel(ept_pixel_type);
+        m_header.i_frame_bytes = ((uint64_t)i_width * i_height * m_header.i_bits_per_pixel + 7) / 8;
+        m_header.i_frame_stride = raw_stream_align(m_header.i_frame_bytes);
+        m_header.i_frame_capacity = i_frame_capacity;
+        m_header.i_frame_count = 0;
+        m_header.i_index_offset = m_header.i_header_size;
+        m_header.i_data_offset = m_header.i_index_offset
+                + raw_stream_align(i_frame_capacity * sizeof(RawStreamIndexEntry));
+        strncpy(m_header.s_pixel_format,
+                Pylon::CPixelTypeMapper::GetNameByPixelType(ept_pixel_type),
+                sizeof(m_header.s_pixel_format) - 1);
+
+        const uint64_t i_file_size = m_header.i_data_offset + i_frame_capacity * m_header.i_frame_stride;
+
+        // The handles are closed by their members if the constructor fails
+#ifdef _WIN32
+        // Unbuffered handle for the frames, buffered one for header and index
+        m_direct.reset(CreateFileA(s_filename.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_NO_BUFFERING, NULL));
+        m_b_direct = m_direct.valid();
+        m_file.reset(CreateFileA(s_filename.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                NULL, m_b_direct ? OPEN_EXISTING : CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL));
+        if(!m_file.valid())
+        {
+            throw RUNTIME_EXCEPTION("Cannot create file %s.", s_filename.c_str());
+        }
+
+        // Preallocate
+        LARGE_INTEGER li_size;
+        li_size.QuadPart = (LONGLONG)i_file_size;
+        if(!SetFilePointerEx(m_file.get(), li_size, NULL, FILE_BEGIN) || !SetEndOfFile(m_file.get()))
+        {
+            throw RUNTIME_EXCEPTION("Cannot preallocate %llu bytes for %s.",
+                    (unsigned long long)i_file_size, s_filename.c_str());
+        }
+#else
+        // Unbuffered descriptor for the frames, buffered one for header and
+        // index. O_DIRECT is not supported by all file systems, e.g. tmpfs.
+#ifdef O_DIRECT
+        m_direct.reset(open(s_filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644));
+#endif
+        m_b_direct = m_direct.valid();
+        m_file.reset(open(s_filename.c_str(), O_RDWR | O_CREAT | (m_b_direct ? 0 : O_TRUNC), 0644));
+        if(!m_file.valid())
+        {
+            throw RUNTIME_EXCEPTION("Cannot create file %s: %s", s_filename.c_str(), strerror(errno));
+        }
+
+        // Preallocate
+        int i_result = ftruncate(m_file.get(), (off_t)i_file_size);
+#if defined(__linux__)
+        if(i_result == 0)
+        {
+            i_result = posix_fallocate(m_file.get(), 0, (off_t)i_file_size);
+        }
+#endif
+        if(i_result != 0)
+        {
+            throw RUNTIME_EXCEPTION("Cannot preallocate %llu bytes for %s.",
+                    (unsigned long long)i_file_size, s_filename.c_str());
+        }
+#endif
+
+        // Header and empty index, so that an aborted recording is readable
+        write_at(false, 0, &m_header, sizeof(m_header));
+    }
+
+    //---------------------------------------------------------------------
+    // Finish file if close was not called, e.g. after an error
+    RawStreamWriter::~RawStreamWriter()
+    {
+        try
+        {
+            if(!m_b_closed)
+            {
+                close(m_i_frame_end.load());
+            }
+        }
+        catch (GenICam::GenericException &e)
+        {
+            // Keep the frames written so far
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Write data at a file position
+    void RawStreamWriter::write_at(const bool b_direct, const uint64_t i_offset, const void* p_data, const uint64_t i_size)
+    {
+        const char* p_bytes = static_cast<const char*>(p_data);
+        uint64_t i_written = 0;
+        while(i_written < i_size)
+        {
+#ifdef _WIN32
+            OVERLAPPED ov_position;
+            memset(&ov_position, 0, sizeof(ov_position));
+            ov_position.Offset = (DWORD)((i_offset + i_written) & 0xFFFFFFFF);
+            ov_position.OffsetHigh = (DWORD)((i_offset + i_written) >> 32);
+            const DWORD i_chunk = (DWORD)std::min<uint64_t>(i_size - i_written, 1u << 30);
+            DWORD i_done = 0;
+            if(!WriteFile(b_direct ? m_direct.get() : m_file.get(), p_bytes + i_written, i_chunk, &i_done, &ov_position) || i_done == 0)
+            {
+                throw RUNTIME_EXCEPTION("Cannot write to raw stream file.");
+            }
+#else
+            const ssize_t i_done = pwrite(b_direct ? m_direct.get() : m_file.get(),
+                    p_bytes + i_written, (size_t)(i_size - i_written), (off_t)(i_offset + i_written));
+            if(i_done < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if(i_done <= 0)
+            {
+                throw RUNTIME_EXCEPTION("Cannot write to raw stream file: %s", strerror(errno));
+            }
+#endif
+            i_written += (uint64_t)i_done;
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Write one frame
+    void RawStreamWriter::write_frame(const uint64_t i_frame, const void* p_buffer, const uint64_t i_timestamp, const int64_t i_image_number)
+    {
+        if(i_frame >= m_header.i_frame_capacity)
+        {
+            throw RUNTIME_EXCEPTION("Raw stream file is full.");
+        }
+        write_at(m_b_direct, m_header.i_data_offset + i_frame * m_header.i_frame_stride,
+                p_buffer, m_header.i_frame_stride);
+        m_index[i_frame].i_timestamp = i_timestamp;
+        m_index[i_frame].i_image_number = i_image_number;
+
+        // Remember end of the written frames
+        uint64_t i_end = m_i_frame_end.load();
+        while(i_end < i_frame + 1 && !m_i_frame_end.compare_exchange_weak(i_end, i_frame + 1))
+        {
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Write header and index, shrink file to the written frames
+    void RawStreamWriter::close(const uint64_t i_frame_count)
+    {
+        m_b_closed = true;
+        m_header.i_frame_count = std::min(i_frame_count, m_header.i_frame_capacity);
+        if(!m_index.empty())
+        {
+            write_at(false, m_header.i_index_offset, &m_index[0], m_index.size() * sizeof(RawStreamIndexEntry));
+        }
+        write_at(false, 0, &m_header, sizeof(m_header));
+
+        const uint64_t i_file_size = m_header.i_data_offset + m_header.i_frame_count * m_header.i_frame_stride;
+#ifdef _WIN32
+        LARGE_INTEGER li_size;
+        li_size.QuadPart = (LONGLONG)i_file_size;
+        SetFilePointerEx(m_file.get(), li_size, NULL, FILE_BEGIN);
+        SetEndOfFile(m_file.get());
+#else
+        if(ftruncate(m_file.get(), (off_t)i_file_size) != 0)
+        {
+            throw RUNTIME_EXCEPTION("Cannot truncate raw stream file: %s", strerror(errno));
+        }
+#endif
+    }
+
+}
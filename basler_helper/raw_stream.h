@@ -0,0 +1,154 @@
+// raw_stream.h - Single file container for raw frame sequences
+// 17.10.2026 / agent
+//
+// File layout:
+//   - Header (RawStreamHeader), padded to 4096 bytes
+//   - Frame index (RawStreamIndexEntry per frame), padded to 4096 bytes
+//   - Frame payloads, each starting at a multiple of 4096 bytes
+// The file is preallocated for the requested number of frames and written
+// with O_DIRECT / FILE_FLAG_NO_BUFFERING where the file system allows it.
+
+#ifndef __RAWSTREAM_H_INCLUDED__
+#define __RAWSTREAM_H_INCLUDED__
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <pylon/PylonIncludes.h>
+
+
+namespace BaslerHelper {
+
+    // Alignment of header, index and frames
+    const uint64_t RAW_STREAM_ALIGNMENT = 4096;
+
+    // File identification
+    const char RAW_STREAM_MAGIC[8] = {'B','S','L','R','A','W','0','1'};
+    const uint32_t RAW_STREAM_VERSION = 1;
+
+    //---------------------------------------------------------------------
+    // File header, all offsets in bytes from the start of the file
+    struct RawStreamHeader
+    {
+        char     s_magic[8];
+        uint32_t i_version;
+        uint32_t i_header_size;
+        uint32_t i_width;
+        uint32_t i_height;
+        int32_t  i_pixel_type;          // Pylon::EPixelType
+        uint32_t i_bits_per_pixel;
+        uint64_t i_frame_bytes;         // Payload size of one frame
+        uint64_t i_frame_stride;        // Distance between two frames
+        uint64_t i_frame_capacity;      // Number of preallocated frames
+        uint64_t i_frame_count;         // Number of written frames
+        uint64_t i_index_offset;
+        uint64_t i_data_offset;
+        char     s_pixel_format[32];    // Pylon name of the pixel type
+    };
+
+    //---------------------------------------------------------------------
+    // Frame index entry
+    struct RawStreamIndexEntry
+    {
+        uint64_t i_timestamp;           // Camera timestamp in ticks
+        int64_t  i_image_number;        // Pylon image number
+    };
+
+    //---------------------------------------------------------------------
+    // Memory aligned for unbuffered file I/O
+    class AlignedBuffer
+    {
+    public:
+        explicit AlignedBuffer(size_t i_size);
+        ~AlignedBuffer();
+        void* data() { return m_p_data; }
+        size_t size() const { return m_i_size; }
+
+    private:
+        AlignedBuffer(const AlignedBuffer&);
+        AlignedBuffer& operator=(const AlignedBuffer&);
+
+        void* m_p_data;
+        size_t m_i_size;
+    };
+
+    //---------------------------------------------------------------------
+    // File descriptor, a HANDLE on Windows, closed when going out of scope
+    class FileHandle
+    {
+    public:
+#ifdef _WIN32
+        typedef void* Native;
+#else
+        typedef int Native;
+#endif
+        FileHandle();
+        ~FileHandle();
+
+        // Close the current file and own handle, an invalid handle owns none
+        void reset(Native handle);
+        Native get() const { return m_handle; }
+        bool valid() const;
+
+    private:
+        FileHandle(const FileHandle&);
+        FileHandle& operator=(const FileHandle&);
+
+        Native m_handle;
+    };
+
+    //---------------------------------------------------------------------
+    // Writes frames into a preallocated container. Frames with different
+    // numbers may be written concurrently from several threads.
+    class RawStreamWriter
+    {
+    public:
+        RawStreamWriter(const std::string& s_filename,
+                        const uint32_t i_width,
+                        const uint32_t i_height,
+                        const Pylon::EPixelType ept_pixel_type,
+                        const uint64_t i_frame_capacity);
+        ~RawStreamWriter();
+
+        // Size of the buffers passed to write_frame
+        uint64_t frame_bytes() const { return m_header.i_frame_bytes; }
+        uint64_t frame_stride() const { return m_header.i_frame_stride; }
+
+        // Write frame number i_frame. p_buffer has to be aligned to
+        // RAW_STREAM_ALIGNMENT and hold frame_stride() bytes.
+        void write_frame(   const uint64_t i_frame,
+                            const void* p_buffer,
+                            const uint64_t i_timestamp,
+                            const int64_t i_image_number);
+
+        // Write header and index, shrink file to the written frames
+        void close(const uint64_t i_frame_count);
+
+        // True if the frames bypass the operating system's file cache
+        bool is_direct() const { return m_b_direct; }
+
+    private:
+        RawStreamWriter(const RawStreamWriter&);
+        RawStreamWriter& operator=(const RawStreamWriter&);
+
+        void write_at(const bool b_direct, const uint64_t i_offset, const void* p_data, const uint64_t i_size);
+
+        RawStreamHeader m_header;
+        std::vector<RawStreamIndexEntry> m_index;
+        std::atomic<uint64_t> m_i_frame_end;
+        bool m_b_direct;
+        bool m_b_closed;
+        FileHandle m_direct;            // Unbuffered, if supported
+        FileHandle m_file;              // Buffered
+    };
+
+    // Round up to the alignment of the container
+    inline uint64_t raw_stream_align(const uint64_t i_size)
+    {
+        return (i_size + RAW_STREAM_ALIGNMENT - 1) / RAW_STREAM_ALIGNMENT * RAW_STREAM_ALIGNMENT;
+    }
+
+}
+
+#endif
@@ -0,0 +1,206 @@
+// telemetry.cpp - Timing of the stages of a capture
+// 17.10.2026 / agent
+
+
+#include "telemetry.h"
+#include <pylon/PylonIncludes.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <mex.h>
+
+
+namespace {
+
+    // Names of the stages in the struct and the trace
+    const char* STAGE_NAMES[] = {"retrieve", "wait", "convert", "copy", "compress", "save"};
+
+    // Seconds of a number of nanoseconds
+    double to_seconds(const double d_ns)
+    {
+        return d_ns * 1e-9;
+    }
+}
+
+
+namespace BaslerHelper {
+
+    //---------------------------------------------------------------------
+    // Empty histograms of all stages
+    ThreadTelemetry::ThreadTelemetry(const bool b_trace)
+        : m_b_trace(b_trace), m_histograms(Stage_Count, std::vector<uint64_t>(TELEMETRY_BUCKETS, 0)),
+          m_events(b_trace ? TELEMETRY_MAX_EVENTS : 0), m_i_num_events(0), m_i_dropped_events(0)
+    {
+        for(int i = 0; i < Stage_Count; i++)
+        {
+            m_i_counts[i] = 0;
+            m_i_total_ns[i] = 0;
+            m_i_max_ns[i] = 0;
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Middle of a bucket in ns
+    double ThreadTelemetry::bucket_value(const unsigned int i_bucket)
+    {
+        if(i_bucket < TELEMETRY_SUB_BUCKETS)
+        {
+            return (double)i_bucket;
+        }
+        const unsigned int i_msb = i_bucket / TELEMETRY_SUB_BUCKETS;
+        const double d_width = (double)(1ULL << (i_msb - 3));
+        return (TELEMETRY_SUB_BUCKETS + i_bucket % TELEMETRY_SUB_BUCKETS + 0.5) * d_width;
+    }
+
+    //---------------------------------------------------------------------
+    // Empty telemetry, the time of its creation is 0 in the trace
+    Telemetry::Telemetry(const bool b_trace)
+        : m_b_trace(b_trace), m_tp_origin(std::chrono::steady_clock::now()), m_i_queue_samples(0),
+          m_i_queue_depth_sum(0), m_i_max_queue_depth(0), m_i_incomplete(0), m_i_dropped(0)
+    {
+    }
+
+    void Telemetry::prepare(const size_t i_num_of_threads)
+    {
+        while(m_threads.size() < i_num_of_threads)
+        {
+            m_threads.push_back(std::unique_ptr<ThreadTelemetry>(new ThreadTelemetry(m_b_trace)));
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Walk the merged histogram up to the percentile
+    double Telemetry::percentile(const TelemetryStage ts_stage, const double d_percent) const
+    {
+        uint64_t i_count = 0;
+        for(size_t t = 0; t < m_threads.size(); t++)
+        {
+            i_count += m_threads[t]->m_i_counts[ts_stage];
+        }
+        if(i_count == 0)
+        {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+        const uint64_t i_rank = std::max<uint64_t>(1, (uint64_t)(d_percent / 100.0 * (double)i_count + 0.5));
+        uint64_t i_seen = 0;
+        for(unsigned int b = 0; b < TELEMETRY_BUCKETS; b++)
+        {
+            for(size_t t = 0; t < m_threads.size(); t++)
+            {
+                i_seen += m_threads[t]->m_histograms[ts_stage][b];
+            }
+            if(i_seen >= i_rank)
+            {
+                return to_seconds(ThreadTelemetry::bucket_value(b));
+            }
+        }
+        return to_seconds(ThreadTelemetry::bucket_value(TELEMETRY_BUCKETS - 1));
+    }
+
+    //---------------------------------------------------------------------
+    // One struct per stage with count, total, p50, p99 and max (in s), the
+    // queue depth (max and mean) and the dropped and incomplete frames
+    mxArray* Telemetry::to_struct() const
+    {
+        const char* s_fields[] = {"retrieve", "wait", "convert", "copy", "compress", "save",
+                                  "queueDepth", "droppedFrames", "incompleteFrames", "threads"};
+        mxArray* mxa_telemetry = mxCreateStructMatrix(1, 1, 10, s_fields);
+
+        const char* s_stage_fields[] = {"count", "total", "p50", "p99", "max"};
+        for(int s = 0; s < Stage_Count; s++)
+        {
+            uint64_t i_count = 0;
+            uint64_t i_total_ns = 0;
+            uint64_t i_max_ns = 0;
+            for(size_t t = 0; t < m_threads.size(); t++)
+            {
+                i_count += m_threads[t]->m_i_counts[s];
+                i_total_ns += m_threads[t]->m_i_total_ns[s];
+                i_max_ns = std::max(i_max_ns, m_threads[t]->m_i_max_ns[s]);
+            }
+            mxArray* mxa_stage = mxCreateStructMatrix(1, 1, 5, s_stage_fields);
+            mxSetField(mxa_stage, 0, "count", mxCreateDoubleScalar((double)i_count));
+            mxSetField(mxa_stage, 0, "total", mxCreateDoubleScalar(to_seconds((double)i_total_ns)));
+            mxSetField(mxa_stage, 0, "p50", mxCreateDoubleScalar(percentile((TelemetryStage)s, 50)));
+            mxSetField(mxa_stage, 0, "p99", mxCreateDoubleScalar(percentile((TelemetryStage)s, 99)));
+            mxSetField(mxa_stage, 0, "max", mxCreateDoubleScalar(i_count > 0 ? to_seconds((double)i_max_ns) :
+                    std::numeric_limits<double>::quiet_NaN()));
+            mxSetField(mxa_telemetry, 0, STAGE_NAMES[s], mxa_stage);
+        }
+
+        const char* s_queue_fields[] = {"max", "mean"};
+        mxArray* mxa_queue = mxCreateStructMatrix(1, 1, 2, s_queue_fields);
+        mxSetField(mxa_queue, 0, "max", mxCreateDoubleScalar((double)m_i_max_queue_depth));
+        mxSetField(mxa_queue, 0, "mean", mxCreateDoubleScalar(m_i_queue_samples > 0 ?
+                (double)m_i_queue_depth_sum / (double)m_i_queue_samples : 0.0));
+        mxSetField(mxa_telemetry, 0, "queueDepth", mxa_queue);
+        mxSetField(mxa_telemetry, 0, "droppedFrames", mxCreateDoubleScalar((double)m_i_dropped));
+        mxSetField(mxa_telemetry, 0, "incompleteFrames", mxCreateDoubleScalar((double)m_i_incomplete));
+        mxSetField(mxa_telemetry, 0, "threads", mxCreateDoubleScalar((double)m_threads.size()));
+        return mxa_telemetry;
+    }
+
+    //---------------------------------------------------------------------
+    // One line per stage, in ms
+    void Telemetry::print() const
+    {
+        for(int s = 0; s < Stage_Count; s++)
+        {
+            const double d_p50 = percentile((TelemetryStage)s, 50);
+            if(!std::isnan(d_p50))
+            {
+                mexPrintf("  %-8s p50 %8.3f ms, p99 %8.3f ms\n", STAGE_NAMES[s], 1000 * d_p50,
+                        1000 * percentile((TelemetryStage)s, 99));
+            }
+        }
+        mexPrintf("  queue depth max %d, %llu incomplete frame(s)\n", (int)m_i_max_queue_depth, m_i_incomplete);
+    }
+
+    //---------------------------------------------------------------------
+    // Complete events ("ph":"X") in us since the creation, one track per
+    // thread
+    void Telemetry::write_trace(const std::string& s_filename) const
+    {
+        FILE* p_file = fopen(s_filename.c_str(), "w");
+        if(p_file == NULL)
+        {
+            throw RUNTIME_EXCEPTION("Cannot create file %s.", s_filename.c_str());
+        }
+        bool b_ok = fprintf(p_file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n") > 0;
+        for(size_t t = 0; t < m_threads.size() && b_ok; t++)
+        {
+            char s_thread_name[32];
+            snprintf(s_thread_name, sizeof(s_thread_name), t == 0 ? "grab" : "worker %d", (int)t);
+            b_ok = fprintf(p_file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                    t == 0 ? "" : ",\n", (int)t, s_thread_name) > 0;
+            const std::vector<TraceEvent>& events = m_threads[t]->m_events;
+            for(size_t i = 0; i < m_threads[t]->m_i_num_events && b_ok; i++)
+            {
+                const double d_start_us = std::chrono::duration<double, std::micro>(events[i].tp_start - m_tp_origin).count();
+                const double d_duration_us = std::chrono::duration<double, std::micro>(events[i].d_duration).count();
+                b_ok = fprintf(p_file, ",\n{\"name\":\"%s\",\"cat\":\"capture\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                        STAGE_NAMES[events[i].ts_stage], (int)t, d_start_us, d_duration_us) > 0;
+            }
+        }
+        b_ok = b_ok && fprintf(p_file, "\n]}\n") > 0;
+        b_ok = (fclose(p_file) == 0) && b_ok;
+        if(!b_ok)
+        {
+            throw RUNTIME_EXCEPTION("Cannot write to file %s.", s_filename.c_str());
+        }
+
+        uint64_t i_dropped = 0;
+        for(size_t t = 0; t < m_threads.size(); t++)
+        {
+            i_dropped += m_threads[t]->m_i_dropped_events;
+        }
+        if(i_dropped > 0)
+        {
+            mexWarnMsgIdAndTxt("baslerDriver:Warning:TraceTruncated",
+                    "%llu trace event(s) were dropped, only the first %u of every thread are written.",
+                    (unsigned long long)i_dropped, (unsigned int)TELEMETRY_MAX_EVENTS);
+        }
+    }
+
+}
@@ -0,0 +1,203 @@
+// telemetry.h - Timing of the stages of a capture
+// 17.10.2026 / agent
+//
+// Every thread of a capture times its stages (waiting for a frame,
+// waiting for a queue or buffer, conversion, copy into the output,
+// compression and saving) into its own histograms, so recording needs
+// neither locks nor atomics. The histograms have 8 buckets per power of
+// two nanoseconds, the middle of a bucket is within 1/16 (about 6 %) of
+// every duration in it. The threads' recorders are only read after the
+// threads were joined. Optionally, every stage is also kept as an event
+// for a Chrome trace (chrome://tracing, Perfetto), in a buffer allocated
+// before the capture; events beyond it are counted and dropped.
+//
+// The instrumentation is always compiled in. Without a Telemetry, the
+// capture functions get a NULL recorder and StageTimer does nothing.
+
+#ifndef __TELEMETRY_H_INCLUDED__
+#define __TELEMETRY_H_INCLUDED__
+
+#include <matrix.h>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+
+namespace BaslerHelper {
+
+    //---------------------------------------------------------------------
+    // Timed stages of a capture
+    enum TelemetryStage
+    {
+        Stage_Retrieve,         // Waiting for the next frame of the source
+        Stage_Wait,             // Waiting for a full queue or a free buffer
+        Stage_Convert,          // Pylon or native conversion, unpacking
+        Stage_Copy,             // Transpose, crop or accumulate, buffer copy
+        Stage_Compress,         // Lossless compression before saving
+        Stage_Save,             // Writing a frame to disk
+        Stage_Count
+    };
+
+    // Buckets of a histogram, 8 per power of two
+    const unsigned int TELEMETRY_SUB_BUCKETS = 8;
+    const unsigned int TELEMETRY_BUCKETS = 64 * TELEMETRY_SUB_BUCKETS;
+
+    // Trace events kept per thread at most
+    const size_t TELEMETRY_MAX_EVENTS = 1 << 16;
+
+    //---------------------------------------------------------------------
+    // Stage of a thread, for the trace
+    struct TraceEvent
+    {
+        TelemetryStage ts_stage;
+        std::chrono::steady_clock::time_point tp_start;
+        std::chrono::steady_clock::duration d_duration;
+    };
+
+    //---------------------------------------------------------------------
+    // Recorder of one thread, only used by that thread
+    class ThreadTelemetry
+    {
+    public:
+        ThreadTelemetry(const bool b_trace);
+
+        // Add a stage which ran from tp_start to tp_end
+        void record(const TelemetryStage ts_stage,
+                    const std::chrono::steady_clock::time_point tp_start,
+                    const std::chrono::steady_clock::time_point tp_end)
+        {
+            const uint64_t i_ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(tp_end - tp_start).count();
+            m_histograms[ts_stage][bucket(i_ns)]++;
+            m_i_counts[ts_stage]++;
+            m_i_total_ns[ts_stage] += i_ns;
+            m_i_max_ns[ts_stage] = i_ns > m_i_max_ns[ts_stage] ? i_ns : m_i_max_ns[ts_stage];
+            if(m_b_trace)
+            {
+                if(m_i_num_events < m_events.size())
+                {
+                    TraceEvent& event = m_events[m_i_num_events++];
+                    event.ts_stage = ts_stage;
+                    event.tp_start = tp_start;
+                    event.d_duration = tp_end - tp_start;
+                }
+                else
+                {
+                    m_i_dropped_events++;
+                }
+            }
+        }
+
+        // Histogram bucket of a duration
+        static unsigned int bucket(const uint64_t i_ns)
+        {
+            if(i_ns < TELEMETRY_SUB_BUCKETS)
+            {
+                return (unsigned int)i_ns;
+            }
+            unsigned int i_msb = 0;
+            while((i_ns >> (i_msb + 1)) != 0)
+            {
+                i_msb++;
+            }
+            return i_msb * TELEMETRY_SUB_BUCKETS +
+                    (unsigned int)((i_ns >> (i_msb - 3)) & (TELEMETRY_SUB_BUCKETS - 1));
+        }
+
+        // Middle of a bucket in ns
+        static double bucket_value(const unsigned int i_bucket);
+
+    private:
+        friend class Telemetry;
+        bool m_b_trace;
+        std::vector<std::vector<uint64_t> > m_histograms;
+        uint64_t m_i_counts[Stage_Count];
+        uint64_t m_i_total_ns[Stage_Count];
+        uint64_t m_i_max_ns[Stage_Count];
+        std::vector<TraceEvent> m_events;   // Fixed size, the first m_i_num_events are used
+        size_t m_i_num_events;
+        uint64_t m_i_dropped_events;
+    };
+
+    //---------------------------------------------------------------------
+    // Times a stage from construction to destruction, if p_thread is set
+    class StageTimer
+    {
+    public:
+        StageTimer(ThreadTelemetry* p_thread, const TelemetryStage ts_stage)
+            : m_p_thread(p_thread), m_ts_stage(ts_stage)
+        {
+            if(m_p_thread != NULL)
+            {
+                m_tp_start = std::chrono::steady_clock::now();
+            }
+        }
+        ~StageTimer()
+        {
+            if(m_p_thread != NULL)
+            {
+                m_p_thread->record(m_ts_stage, m_tp_start, std::chrono::steady_clock::now());
+            }
+        }
+
+    private:
+        ThreadTelemetry* m_p_thread;
+        TelemetryStage m_ts_stage;
+        std::chrono::steady_clock::time_point m_tp_start;
+    };
+
+    //---------------------------------------------------------------------
+    // Telemetry of a capture. The grab thread is thread 0, it also samples
+    // the queue depth and counts the dropped and incomplete frames.
+    class Telemetry
+    {
+    public:
+        Telemetry(const bool b_trace);
+
+        // Create the recorders before the threads start
+        void prepare(const size_t i_num_of_threads);
+
+        // Recorder of a thread, NULL for a NULL telemetry
+        static ThreadTelemetry* thread(Telemetry* p_telemetry, const size_t i_thread)
+        {
+            return p_telemetry != NULL ? p_telemetry->m_threads[i_thread].get() : NULL;
+        }
+
+        // Called by the grab thread
+        void sample_queue_depth(const size_t i_depth)
+        {
+            m_i_queue_samples++;
+            m_i_queue_depth_sum += i_depth;
+            m_i_max_queue_depth = i_depth > m_i_max_queue_depth ? i_depth : m_i_max_queue_depth;
+        }
+        void count_incomplete() { m_i_incomplete++; }
+        void set_dropped(const unsigned long long i_dropped) { m_i_dropped = i_dropped; }
+
+        // Percentile of the durations of a stage of all threads, in s
+        double percentile(const TelemetryStage ts_stage, const double d_percent) const;
+
+        // Matlab struct with the statistics of every stage, see telemetry.cpp
+        mxArray* to_struct() const;
+
+        // Print the p50 and p99 of every stage which ran
+        void print() const;
+
+        // Write the events of all threads as Chrome trace-event JSON, warn
+        // if events were dropped
+        void write_trace(const std::string& s_filename) const;
+
+    private:
+        bool m_b_trace;
+        std::chrono::steady_clock::time_point m_tp_origin;
+        std::vector<std::unique_ptr<ThreadTelemetry> > m_threads;
+        unsigned long long m_i_queue_samples;
+        unsigned long long m_i_queue_depth_sum;
+        size_t m_i_max_queue_depth;
+        unsigned long long m_i_incomplete;
+        unsigned long long m_i_dropped;
+    };
+
+}
+
+#endif
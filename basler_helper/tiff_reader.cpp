@@ -0,0 +1,231 @@
+// tiff_reader.cpp - Read uncompressed TIFF files as written by baslerSaveData
+// 17.10.2026 / agent
+
+
+#include "tiff_reader.h"
+#include <pylon/PylonIncludes.h>
+#include <algorithm>
+#include <cstring>
+
+
+namespace {
+
+    // Tags of baseline TIFF
+    const uint16_t TAG_IMAGE_WIDTH = 256;
+    const uint16_t TAG_IMAGE_LENGTH = 257;
+    const uint16_t TAG_BITS_PER_SAMPLE = 258;
+    const uint16_t TAG_COMPRESSION = 259;
+    const uint16_t TAG_STRIP_OFFSETS = 273;
+    const uint16_t TAG_SAMPLES_PER_PIXEL = 277;
+    const uint16_t TAG_STRIP_BYTE_COUNTS = 279;
+    const uint16_t TAG_PLANAR_CONFIGURATION = 284;
+
+    // Field types
+    const uint16_t TYPE_BYTE = 1;
+    const uint16_t TYPE_SHORT = 3;
+    const uint16_t TYPE_LONG = 4;
+
+    //---------------------------------------------------------------------
+    // Reads the integers of a file in its byte order
+    class TiffFile
+    {
+    public:
+        TiffFile(const uint8_t* p_file, const size_t i_file_size, const bool b_big_endian)
+            : m_p_file(p_file), m_i_file_size(i_file_size), m_b_big_endian(b_big_endian) {}
+
+        bool contains(const uint64_t i_offset, const uint64_t i_size) const
+        {
+            return i_offset <= m_i_file_size && i_size <= m_i_file_size - i_offset;
+        }
+
+        uint32_t get(const uint64_t i_offset, const unsigned int i_size) const
+        {
+            uint32_t i_value = 0;
+            for(unsigned int i = 0; i < i_size; i++)
+            {
+                const uint32_t i_byte = m_p_file[i_offset + (m_b_big_endian ? i : i_size - 1 - i)];
+                i_value = (i_value << 8) | i_byte;
+            }
+            return i_value;
+        }
+
+        // Values of a directory entry, which are inline if they fit into
+        // its 4 byte value field
+        bool values(const uint64_t i_entry, std::vector<uint64_t>& i_values) const
+        {
+            const uint16_t i_type = (uint16_t)get(i_entry + 2, 2);
+            const uint32_t i_count = get(i_entry + 4, 4);
+            const unsigned int i_size = i_type == TYPE_BYTE ? 1 : i_type == TYPE_SHORT ? 2 : i_type == TYPE_LONG ? 4 : 0;
+            if(i_size == 0)
+            {
+                return false;
+            }
+            const uint64_t i_offset = (uint64_t)i_count * i_size <= 4 ? i_entry + 8 : get(i_entry + 8, 4);
+            if(!contains(i_offset, (uint64_t)i_count * i_size))
+            {
+                return false;
+            }
+            i_values.resize(i_count);
+            for(uint32_t i = 0; i < i_count; i++)
+            {
+                i_values[i] = get(i_offset + (uint64_t)i * i_size, i_size);
+            }
+            return true;
+        }
+
+    private:
+        const uint8_t* m_p_file;
+        size_t m_i_file_size;
+        bool m_b_big_endian;
+    };
+
+    // True on big endian hosts
+    bool host_big_endian()
+    {
+        const uint16_t i_one = 1;
+        return *(const uint8_t*)&i_one == 0;
+    }
+}
+
+
+namespace BaslerHelper {
+
+    //---------------------------------------------------------------------
+    // Read the tags of the first image file directory
+    void parse_tiff(const uint8_t* p_file,
+                    const size_t i_file_size,
+                    const std::string& s_filename,
+                    TiffLayout& layout)
+    {
+        if(i_file_size < 8 || !((p_file[0] == 'I' && p_file[1] == 'I') || (p_file[0] == 'M' && p_file[1] == 'M')))
+        {
+            throw RUNTIME_EXCEPTION("%s is not a TIFF file.", s_filename.c_str());
+        }
+        const bool b_big_endian = p_file[0] == 'M';
+        const TiffFile file(p_file, i_file_size, b_big_endian);
+        if(file.get(2, 2) != 42)
+        {
+            throw RUNTIME_EXCEPTION("%s is not a TIFF file.", s_filename.c_str());
+        }
+        const uint64_t i_directory = file.get(4, 4);
+        if(!file.contains(i_directory, 2) || !file.contains(i_directory + 2, 12 * (uint64_t)file.get(i_directory, 2)))
+        {
+            throw RUNTIME_EXCEPTION("TIFF file %s is truncated.", s_filename.c_str());
+        }
+
+        // Defaults of baseline TIFF
+        uint64_t i_width = 0;
+        uint64_t i_height = 0;
+        uint64_t i_bands = 1;
+        uint64_t i_bits = 1;
+        uint64_t i_compression = 1;
+        uint64_t i_planar = 1;
+        layout.i_strip_offsets.clear();
+        layout.i_strip_bytes.clear();
+
+        const uint32_t i_entries = file.get(i_directory, 2);
+        std::vector<uint64_t> i_values;
+        for(uint32_t e = 0; e < i_entries; e++)
+        {
+            const uint64_t i_entry = i_directory + 2 + 12 * (uint64_t)e;
+            const uint16_t i_tag = (uint16_t)file.get(i_entry, 2);
+            if(i_tag != TAG_IMAGE_WIDTH && i_tag != TAG_IMAGE_LENGTH && i_tag != TAG_BITS_PER_SAMPLE
+                    && i_tag != TAG_COMPRESSION && i_tag != TAG_STRIP_OFFSETS && i_tag != TAG_SAMPLES_PER_PIXEL
+                    && i_tag != TAG_STRIP_BYTE_COUNTS && i_tag != TAG_PLANAR_CONFIGURATION)
+            {
+                continue;
+            }
+            if(!file.values(i_entry, i_values) || i_values.empty())
+            {
+                throw RUNTIME_EXCEPTION("TIFF file %s is damaged.", s_filename.c_str());
+            }
+            switch(i_tag)
+            {
+                case TAG_IMAGE_WIDTH: i_width = i_values[0]; break;
+                case TAG_IMAGE_LENGTH: i_height = i_values[0]; break;
+                case TAG_BITS_PER_SAMPLE:
+                    // All samples need the same size
+                    i_bits = i_values[0];
+                    if(std::count(i_values.begin(), i_values.end(), i_bits) != (std::ptrdiff_t)i_values.size())
+                    {
+                        i_bits = 0;
+                    }
+                    break;
+                case TAG_COMPRESSION: i_compression = i_values[0]; break;
+                case TAG_STRIP_OFFSETS: layout.i_strip_offsets = i_values; break;
+                case TAG_SAMPLES_PER_PIXEL: i_bands = i_values[0]; break;
+                case TAG_STRIP_BYTE_COUNTS: layout.i_strip_bytes = i_values; break;
+                case TAG_PLANAR_CONFIGURATION: i_planar = i_values[0]; break;
+            }
+        }
+
+        if(i_compression != 1 || i_planar != 1 || (i_bits != 8 && i_bits != 16) || i_bands == 0)
+        {
+            throw RUNTIME_EXCEPTION("%s is not an uncompressed 8 or 16 bit TIFF file.", s_filename.c_str());
+        }
+        if(i_width == 0 || i_height == 0 || layout.i_strip_offsets.empty()
+                || layout.i_strip_offsets.size() != layout.i_strip_bytes.size())
+        {
+            throw RUNTIME_EXCEPTION("TIFF file %s is damaged.", s_filename.c_str());
+        }
+        layout.i_width = (uint32_t)i_width;
+        layout.i_height = (uint32_t)i_height;
+        layout.i_bands = (uint32_t)i_bands;
+        layout.i_bits = (uint32_t)i_bits;
+        layout.b_swap = i_bits == 16 && b_big_endian != host_big_endian();
+
+        // The strips have to hold the whole image
+        uint64_t i_total = 0;
+        for(size_t s = 0; s < layout.i_strip_offsets.size(); s++)
+        {
+            if(!file.contains(layout.i_strip_offsets[s], layout.i_strip_bytes[s]))
+            {
+                throw RUNTIME_EXCEPTION("TIFF file %s is truncated.", s_filename.c_str());
+            }
+            i_total += layout.i_strip_bytes[s];
+        }
+        if(i_total < layout.frame_bytes())
+        {
+            throw RUNTIME_EXCEPTION("TIFF file %s is truncated.", s_filename.c_str());
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Pixels in place if possible, else gathered from the strips. 16 bit
+    // pixels are only used in place if they are aligned.
+    const void* tiff_pixels(const uint8_t* p_file,
+                            const size_t i_file_size,
+                            const TiffLayout& layout,
+                            std::vector<uint8_t>& scratch)
+    {
+        const size_t i_frame_bytes = layout.frame_bytes();
+        bool b_contiguous = true;
+        for(size_t s = 1; s < layout.i_strip_offsets.size() && b_contiguous; s++)
+        {
+            b_contiguous = layout.i_strip_offsets[s] == layout.i_strip_offsets[s - 1] + layout.i_strip_bytes[s - 1];
+        }
+        if(b_contiguous && !layout.b_swap && layout.i_strip_offsets[0] + i_frame_bytes <= i_file_size
+                && (layout.i_bits == 8 || layout.i_strip_offsets[0] % 2 == 0))
+        {
+            return p_file + layout.i_strip_offsets[0];
+        }
+
+        scratch.resize(i_frame_bytes);
+        size_t i_copied = 0;
+        for(size_t s = 0; s < layout.i_strip_offsets.size() && i_copied < i_frame_bytes; s++)
+        {
+            const size_t i_bytes = (size_t)std::min<uint64_t>(layout.i_strip_bytes[s], i_frame_bytes - i_copied);
+            memcpy(&scratch[i_copied], p_file + layout.i_strip_offsets[s], i_bytes);
+            i_copied += i_bytes;
+        }
+        if(layout.b_swap)
+        {
+            for(size_t i = 0; i + 1 < i_frame_bytes; i += 2)
+            {
+                std::swap(scratch[i], scratch[i + 1]);
+            }
+        }
+        return &scratch[0];
+    }
+
+}
@@ -0,0 +1,51 @@
+// tiff_reader.h - Read uncompressed TIFF files as written by baslerSaveData
+// 17.10.2026 / agent
+//
+// Pylon writes one uncompressed, chunky TIFF per frame. Only such files
+// are read here: 8 or 16 bits per sample, any number of samples per pixel,
+// any strip layout and both byte orders. The pixels are returned as one
+// row-major block, in place if the strips follow each other and the byte
+// order is the native one, else copied. The functions keep no state, so
+// several threads can read files at the same time.
+
+#ifndef __TIFFREADER_H_INCLUDED__
+#define __TIFFREADER_H_INCLUDED__
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+
+namespace BaslerHelper {
+
+    //---------------------------------------------------------------------
+    // Image and strips of the first directory of a TIFF file
+    struct TiffLayout
+    {
+        uint32_t i_width;
+        uint32_t i_height;
+        uint32_t i_bands;
+        uint32_t i_bits;                    // Per sample, 8 or 16
+        bool b_swap;                        // Byte order differs from the host
+        std::vector<uint64_t> i_strip_offsets;
+        std::vector<uint64_t> i_strip_bytes;
+
+        size_t frame_bytes() const { return (size_t)i_width * i_height * i_bands * (i_bits / 8); }
+    };
+
+    // Parse the first image of the file, throws for unsupported files
+    void parse_tiff(const uint8_t* p_file,
+                    const size_t i_file_size,
+                    const std::string& s_filename,
+                    TiffLayout& layout);
+
+    // Row-major pixels of the image, in the file or in scratch
+    const void* tiff_pixels(const uint8_t* p_file,
+                            const size_t i_file_size,
+                            const TiffLayout& layout,
+                            std::vector<uint8_t>& scratch);
+
+}
+
+#endif
@@ -0,0 +1,487 @@
+// transpose_image.cpp - Copy camera images into Matlab's memory layout
+// 17.10.2026 / agent
+//
+// Single band 8 and 16 bit images are transposed with in-register SIMD
+// kernels. The AVX2 kernels are compiled for AVX2 only and selected at
+// runtime, all other CPUs use SSE2 or the scalar code. With the AVX2
+// kernels, 8 bit images of 2 to 4 bands are split into planes tile by tile
+// with pshufb and the planes transposed like single band images. All other
+// images use the tiled scalar code.
+
+
+#include "transpose_image.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define BASLER_HAS_X86
+#include <emmintrin.h>
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+
+// One unpack stage of the in-register transpose: combines register q with
+// register q+D of each group of 2*D registers
+#define TRANSPOSE_STAGE(UNPACK_LO, UNPACK_HI, V_IN, V_OUT, N, D)            \
+    for (int g = 0; g < (N); g += 2*(D))                                    \
+    {                                                                       \
+        for (int q = 0; q < (D); q++)                                       \
+        {                                                                   \
+            V_OUT[g+2*q]   = UNPACK_LO(V_IN[g+q], V_IN[g+q+(D)]);           \
+            V_OUT[g+2*q+1] = UNPACK_HI(V_IN[g+q], V_IN[g+q+(D)]);           \
+        }                                                                   \
+    }
+
+
+namespace {
+
+    // Kernel transposing one block of pixels, strides in elements
+    template <typename T>
+    struct Kernel
+    {
+        typedef void (*Type)(const T* p_src, size_t i_src_stride, T* p_dst, size_t i_dst_stride);
+    };
+
+    //---------------------------------------------------------------------
+    // Scalar transpose of rows [i_row_begin,i_row_end) and columns
+    // [i_col_begin,i_col_end) of a single band plane, strides in elements
+    template <typename T>
+    void transpose_strided( const T* p_src,
+                            const size_t i_src_stride,
+                            T* p_dst,
+                            const size_t i_dst_stride,
+                            const size_t i_row_begin,
+                            const size_t i_row_end,
+                            const size_t i_col_begin,
+                            const size_t i_col_end)
+    {
+        for (size_t j = i_col_begin; j < i_col_end; j++)
+        {
+            for (size_t i = i_row_begin; i < i_row_end; i++)
+            {
+                p_dst[j*i_dst_stride + i] = p_src[i*i_src_stride + j];
+            }
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Transpose a single band plane with a kernel for blocks of KR rows and
+    // KC columns, the remaining rows and columns are copied by the scalar
+    // code. Row i of the source starts at p_src + i*i_src_stride, column j
+    // of the destination at p_dst + j*i_dst_stride.
+    template <typename T, size_t KR, size_t KC>
+    void transpose_blocks(  const T* p_src,
+                            const size_t i_src_stride,
+                            T* p_dst,
+                            const size_t i_dst_stride,
+                            const size_t i_height,
+                            const size_t i_width,
+                            typename Kernel<T>::Type kernel)
+    {
+        const size_t i_rows = i_height - i_height % KR;
+        const size_t i_cols = i_width - i_width % KC;
+        const size_t i_tile = BaslerHelper::TRANSPOSE_TILE_SIZE;
+
+        for (size_t i0 = 0; i0 < i_rows; i0 += i_tile)
+        {
+            const size_t i_row_end = (i0 + i_tile < i_rows) ? i0 + i_tile : i_rows;
+            for (size_t j0 = 0; j0 < i_cols; j0 += i_tile)
+            {
+                const size_t i_col_end = (j0 + i_tile < i_cols) ? j0 + i_tile : i_cols;
+                for (size_t j = j0; j < i_col_end; j += KC)
+                {
+                    for (size_t i = i0; i < i_row_end; i += KR)
+                    {
+                        kernel(p_src + i*i_src_stride + j, i_src_stride, p_dst + j*i_dst_stride + i, i_dst_stride);
+                    }
+                }
+            }
+        }
+
+        transpose_strided(p_src, i_src_stride, p_dst, i_dst_stride, i_rows, i_height, 0, i_width);
+        transpose_strided(p_src, i_src_stride, p_dst, i_dst_stride, 0, i_rows, i_cols, i_width);
+    }
+
+#ifdef BASLER_HAS_X86
+
+    //---------------------------------------------------------------------
+    // SSE2: 16x16 block of 8 bit pixels
+    void transpose_sse2_u8(const uint8_t* p_src, size_t i_src_stride, uint8_t* p_dst, size_t i_dst_stride)
+    {
+        __m128i a[16], b[16];
+        for (int k = 0; k < 16; k++)
+        {
+            a[k] = _mm_loadu_si128((const __m128i*)(p_src + k*i_src_stride));
+        }
+        TRANSPOSE_STAGE(_mm_unpacklo_epi8,  _mm_unpackhi_epi8,  a, b, 16, 1)
+        TRANSPOSE_STAGE(_mm_unpacklo_epi16, _mm_unpackhi_epi16, b, a, 16, 2)
+        TRANSPOSE_STAGE(_mm_unpacklo_epi32, _mm_unpackhi_epi32, a, b, 16, 4)
+        TRANSPOSE_STAGE(_mm_unpacklo_epi64, _mm_unpackhi_epi64, b, a, 16, 8)
+        for (int k = 0; k < 16; k++)
+        {
+            _mm_storeu_si128((__m128i*)(p_dst + k*i_dst_stride), a[k]);
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // SSE2: 8x8 block of 16 bit pixels
+    void transpose_sse2_u16(const uint16_t* p_src, size_t i_src_stride, uint16_t* p_dst, size_t i_dst_stride)
+    {
+        __m128i a[8], b[8];
+        for (int k = 0; k < 8; k++)
+        {
+            a[k] = _mm_loadu_si128((const __m128i*)(p_src + k*i_src_stride));
+        }
+        TRANSPOSE_STAGE(_mm_unpacklo_epi16, _mm_unpackhi_epi16, a, b, 8, 1)
+        TRANSPOSE_STAGE(_mm_unpacklo_epi32, _mm_unpackhi_epi32, b, a, 8, 2)
+        TRANSPOSE_STAGE(_mm_unpacklo_epi64, _mm_unpackhi_epi64, a, b, 8, 4)
+        for (int k = 0; k < 8; k++)
+        {
+            _mm_storeu_si128((__m128i*)(p_dst + k*i_dst_stride), b[k]);
+        }
+    }
+
+#if defined(__GNUC__) && !defined(__AVX2__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#define BASLER_POP_TARGET
+#endif
+
+    // The AVX2 kernels transpose both 128 bit lanes independently, so they
+    // handle blocks twice as wide as high. Fewer source rows per block
+    // also keep power-of-two row strides from thrashing the L1 cache.
+
+    //---------------------------------------------------------------------
+    // AVX2: 16x32 block of 8 bit pixels
+    void transpose_avx2_u8(const uint8_t* p_src, size_t i_src_stride, uint8_t* p_dst, size_t i_dst_stride)
+    {
+        __m256i a[16], b[16];
+        for (int k = 0; k < 16; k++)
+        {
+            a[k] = _mm256_loadu_si256((const __m256i*)(p_src + k*i_src_stride));
+        }
+        TRANSPOSE_STAGE(_mm256_unpacklo_epi8,  _mm256_unpackhi_epi8,  a, b, 16, 1)
+        TRANSPOSE_STAGE(_mm256_unpacklo_epi16, _mm256_unpackhi_epi16, b, a, 16, 2)
+        TRANSPOSE_STAGE(_mm256_unpacklo_epi32, _mm256_unpackhi_epi32, a, b, 16, 4)
+        TRANSPOSE_STAGE(_mm256_unpacklo_epi64, _mm256_unpackhi_epi64, b, a, 16, 8)
+        for (int k = 0; k < 16; k++)
+        {
+            _mm_storeu_si128((__m128i*)(p_dst + k*i_dst_stride), _mm256_castsi256_si128(a[k]));
+            _mm_storeu_si128((__m128i*)(p_dst + (k+16)*i_dst_stride), _mm256_extracti128_si256(a[k], 1));
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // AVX2: 8x16 block of 16 bit pixels
+    void transpose_avx2_u16(const uint16_t* p_src, size_t i_src_stride, uint16_t* p_dst, size_t i_dst_stride)
+    {
+        __m256i a[8], b[8];
+        for (int k = 0; k < 8; k++)
+        {
+            a[k] = _mm256_loadu_si256((const __m256i*)(p_src + k*i_src_stride));
+        }
+        TRANSPOSE_STAGE(_mm256_unpacklo_epi16, _mm256_unpackhi_epi16, a, b, 8, 1)
+        TRANSPOSE_STAGE(_mm256_unpacklo_epi32, _mm256_unpackhi_epi32, b, a, 8, 2)
+        TRANSPOSE_STAGE(_mm256_unpacklo_epi64, _mm256_unpackhi_epi64, a, b, 8, 4)
+        for (int k = 0; k < 8; k++)
+        {
+            _mm_storeu_si128((__m128i*)(p_dst + k*i_dst_stride), _mm256_castsi256_si128(b[k]));
+            _mm_storeu_si128((__m128i*)(p_dst + (k+8)*i_dst_stride), _mm256_extracti128_si256(b[k], 1));
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Split the interleaved pixels of a tile into one row-major plane of
+    // i_rows x i_tile_cols elements per band, 16 bytes of each band at a
+    // time:
+    // byte p of the output of band b is gathered with pshufb from byte
+    // (k*I_BANDS + b)*sizeof(T) + t of the I_BANDS input registers, for
+    // pixel k = p / sizeof(T) and t = p % sizeof(T). The rest of a row is
+    // split by the scalar code.
+    template <typename T, unsigned int I_BANDS>
+    void split_tile_ssse3(  const T* p_src,
+                            const size_t i_src_stride,
+                            T* p_planes,
+                            const size_t i_tile_cols,
+                            const size_t i_rows,
+                            const size_t i_cols)
+    {
+        __m128i m_masks[I_BANDS][I_BANDS];
+        for (unsigned int b = 0; b < I_BANDS; b++)
+        {
+            uint8_t i_masks[I_BANDS][16];
+            for (unsigned int p = 0; p < 16; p++)
+            {
+                const unsigned int i_byte = (unsigned int)(((p / sizeof(T)) * I_BANDS + b) * sizeof(T) + p % sizeof(T));
+                for (unsigned int r = 0; r < I_BANDS; r++)
+                {
+                    i_masks[r][p] = (i_byte / 16 == r) ? (uint8_t)(i_byte % 16) : 0x80;
+                }
+            }
+            for (unsigned int r = 0; r < I_BANDS; r++)
+            {
+                m_masks[b][r] = _mm_loadu_si128((const __m128i*)i_masks[r]);
+            }
+        }
+
+        const size_t i_step = 16 / sizeof(T);
+        const size_t i_simd_cols = i_cols - i_cols % i_step;
+        for (size_t i = 0; i < i_rows; i++)
+        {
+            const T* p_row = p_src + i*i_src_stride;
+            T* p_plane_row = p_planes + i*i_tile_cols;
+            for (size_t j = 0; j < i_simd_cols; j += i_step)
+            {
+                __m128i v[I_BANDS];
+                for (unsigned int r = 0; r < I_BANDS; r++)
+                {
+                    v[r] = _mm_loadu_si128((const __m128i*)(p_row + j*I_BANDS) + r);
+                }
+                for (unsigned int b = 0; b < I_BANDS; b++)
+                {
+                    __m128i m_band = _mm_shuffle_epi8(v[0], m_masks[b][0]);
+                    for (unsigned int r = 1; r < I_BANDS; r++)
+                    {
+                        m_band = _mm_or_si128(m_band, _mm_shuffle_epi8(v[r], m_masks[b][r]));
+                    }
+                    _mm_storeu_si128((__m128i*)(p_plane_row + b*i_rows*i_tile_cols + j), m_band);
+                }
+            }
+            for (size_t j = i_simd_cols; j < i_cols; j++)
+            {
+                for (unsigned int b = 0; b < I_BANDS; b++)
+                {
+                    p_plane_row[b*i_rows*i_tile_cols + j] = p_row[j*I_BANDS + b];
+                }
+            }
+        }
+    }
+
+#ifdef BASLER_POP_TARGET
+#pragma GCC pop_options
+#undef BASLER_POP_TARGET
+#endif
+
+    //---------------------------------------------------------------------
+    // Check if CPU and OS support AVX2
+    bool cpu_has_avx2()
+    {
+#if defined(_MSC_VER)
+        int i_info[4];
+        __cpuid(i_info, 0);
+        if (i_info[0] < 7)
+        {
+            return false;
+        }
+        __cpuid(i_info, 1);
+        const bool b_os_avx = (i_info[2] & (1 << 27)) && (i_info[2] & (1 << 28))
+                && ((_xgetbv(0) & 0x6) == 0x6);
+        __cpuidex(i_info, 7, 0);
+        return b_os_avx && (i_info[1] & (1 << 5));
+#elif defined(__GNUC__)
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+#else
+        return false;
+#endif
+    }
+
+#endif
+
+    // Available kernel sets
+    enum KernelSet { KERNEL_SCALAR, KERNEL_SSE2, KERNEL_AVX2 };
+
+    //---------------------------------------------------------------------
+    // Choose kernel set once
+    KernelSet kernel_set()
+    {
+#ifdef BASLER_HAS_X86
+        static const KernelSet ks_kernel = cpu_has_avx2() ? KERNEL_AVX2 : KERNEL_SSE2;
+#else
+        static const KernelSet ks_kernel = KERNEL_SCALAR;
+#endif
+        return ks_kernel;
+    }
+}
+
+
+namespace {
+
+    // Most bands split by transpose_bands
+    const unsigned int MAX_SPLIT_BANDS = 4;
+
+    //---------------------------------------------------------------------
+    // Tiled scalar transpose, with the number of bands known at compile
+    // time for 2 to 4 bands, so that the loop over the bands is unrolled
+    template <typename T>
+    void transpose_tiled(const T* p_src, T* p_dst, const size_t i_height, const size_t i_width, const unsigned int i_bands)
+    {
+        switch (i_bands)
+        {
+            case 2:
+                BaslerHelper::transpose_image<T>(p_src, p_dst, i_height, i_width, 2);
+                break;
+            case 3:
+                BaslerHelper::transpose_image<T>(p_src, p_dst, i_height, i_width, 3);
+                break;
+            case 4:
+                BaslerHelper::transpose_image<T>(p_src, p_dst, i_height, i_width, 4);
+                break;
+            default:
+                BaslerHelper::transpose_image<T>(p_src, p_dst, i_height, i_width, i_bands);
+                break;
+        }
+    }
+
+#ifdef BASLER_HAS_X86
+
+    //---------------------------------------------------------------------
+    // Transpose an image of 2 to 4 interleaved bands: each tile is split
+    // into planes in the cache, which are transposed with the kernels of
+    // single band images. Only used with the AVX2 kernel set, pshufb is
+    // available on all of these CPUs.
+    template <typename T>
+    void transpose_bands(   const T* p_src,
+                            T* p_dst,
+                            const size_t i_height,
+                            const size_t i_width,
+                            const unsigned int i_bands)
+    {
+        // Tiles are 64 bytes wide, so that the planes of 4 bands and the
+        // source rows fit into the L1 cache
+        const size_t i_tile_rows = BaslerHelper::TRANSPOSE_TILE_SIZE;
+        const size_t i_tile_cols = BaslerHelper::TRANSPOSE_TILE_SIZE / sizeof(T);
+        const size_t i_numel = i_height * i_width;
+        T planes[MAX_SPLIT_BANDS * BaslerHelper::TRANSPOSE_TILE_SIZE * BaslerHelper::TRANSPOSE_TILE_SIZE / sizeof(T)];
+        for (size_t i0 = 0; i0 < i_height; i0 += i_tile_rows)
+        {
+            const size_t i_rows = (i0 + i_tile_rows < i_height) ? i_tile_rows : i_height - i0;
+            for (size_t j0 = 0; j0 < i_width; j0 += i_tile_cols)
+            {
+                const size_t i_cols = (j0 + i_tile_cols < i_width) ? i_tile_cols : i_width - j0;
+                const T* p_tile = p_src + (i0*i_width + j0)*i_bands;
+                switch (i_bands)
+                {
+                    case 2:
+                        split_tile_ssse3<T,2>(p_tile, i_width*i_bands, planes, i_tile_cols, i_rows, i_cols);
+                        break;
+                    case 3:
+                        split_tile_ssse3<T,3>(p_tile, i_width*i_bands, planes, i_tile_cols, i_rows, i_cols);
+                        break;
+                    default:
+                        split_tile_ssse3<T,4>(p_tile, i_width*i_bands, planes, i_tile_cols, i_rows, i_cols);
+                        break;
+                }
+                for (unsigned int b = 0; b < i_bands; b++)
+                {
+                    BaslerHelper::transpose_plane(planes + b*i_rows*i_tile_cols, i_tile_cols,
+                            p_dst + b*i_numel + j0*i_height + i0, i_height, i_rows, i_cols);
+                }
+            }
+        }
+    }
+
+#endif
+}
+
+
+namespace BaslerHelper {
+
+    //---------------------------------------------------------------------
+    // 8 bit transpose
+    void transpose_image(const uint8_t* p_src, uint8_t* p_dst, const size_t i_height, const size_t i_width, const unsigned int i_bands)
+    {
+        if (i_bands == 1)
+        {
+            transpose_plane(p_src, i_width, p_dst, i_height, i_height, i_width);
+            return;
+        }
+#ifdef BASLER_HAS_X86
+        if (i_bands <= MAX_SPLIT_BANDS && kernel_set() == KERNEL_AVX2)
+        {
+            transpose_bands(p_src, p_dst, i_height, i_width, i_bands);
+            return;
+        }
+#endif
+        transpose_tiled(p_src, p_dst, i_height, i_width, i_bands);
+    }
+
+    //---------------------------------------------------------------------
+    // 16 bit transpose
+    void transpose_image(const uint16_t* p_src, uint16_t* p_dst, const size_t i_height, const size_t i_width, const unsigned int i_bands)
+    {
+        if (i_bands == 1)
+        {
+            transpose_plane(p_src, i_width, p_dst, i_height, i_height, i_width);
+            return;
+        }
+        // The split into planes is not faster than the tiled code for 16 bit
+        transpose_tiled(p_src, p_dst, i_height, i_width, i_bands);
+    }
+
+    //---------------------------------------------------------------------
+    // 8 bit transpose of a part of a plane
+    void transpose_plane(const uint8_t* p_src, const size_t i_src_stride, uint8_t* p_dst, const size_t i_dst_stride,
+            const size_t i_rows, const size_t i_cols)
+    {
+        switch (kernel_set())
+        {
+#ifdef BASLER_HAS_X86
+            case KERNEL_AVX2:
+                transpose_blocks<uint8_t,16,32>(p_src, i_src_stride, p_dst, i_dst_stride, i_rows, i_cols, transpose_avx2_u8);
+                return;
+            case KERNEL_SSE2:
+                transpose_blocks<uint8_t,16,16>(p_src, i_src_stride, p_dst, i_dst_stride, i_rows, i_cols, transpose_sse2_u8);
+                return;
+#endif
+            default:
+                transpose_strided(p_src, i_src_stride, p_dst, i_dst_stride, 0, i_rows, 0, i_cols);
+                return;
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // 16 bit transpose of a part of a plane
+    void transpose_plane(const uint16_t* p_src, const size_t i_src_stride, uint16_t* p_dst, const size_t i_dst_stride,
+            const size_t i_rows, const size_t i_cols)
+    {
+        switch (kernel_set())
+        {
+#ifdef BASLER_HAS_X86
+            case KERNEL_AVX2:
+                transpose_blocks<uint16_t,8,16>(p_src, i_src_stride, p_dst, i_dst_stride, i_rows, i_cols, transpose_avx2_u16);
+                return;
+            case KERNEL_SSE2:
+                transpose_blocks<uint16_t,8,8>(p_src, i_src_stride, p_dst, i_dst_stride, i_rows, i_cols, transpose_sse2_u16);
+                return;
+#endif
+            default:
+                transpose_strided(p_src, i_src_stride, p_dst, i_dst_stride, 0, i_rows, 0, i_cols);
+                return;
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Name of the kernel set chosen at runtime
+    const char* transpose_kernel_name()
+    {
+        switch (kernel_set())
+        {
+            case KERNEL_AVX2:
+                return "avx2";
+            case KERNEL_SSE2:
+                return "sse2";
+            default:
+                return "scalar";
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // AVX2 kernels chosen
+    bool use_avx2_kernels()
+    {
+        return kernel_set() == KERNEL_AVX2;
+    }
+
+}
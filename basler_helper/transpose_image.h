@@ -0,0 +1,110 @@
+// transpose_image.h - Copy camera images into Matlab's memory layout
+// 17.10.2026 / agent
+//
+// Camera images are row-major with interleaved color bands, Matlab arrays
+// are column-major with one plane per band. The image is processed in
+// tiles which fit into the L1 cache, all bands are split in the same pass.
+
+#ifndef __TRANSPOSEIMAGE_H_INCLUDED__
+#define __TRANSPOSEIMAGE_H_INCLUDED__
+
+#include <cstddef>
+#include <stdint.h>
+
+
+namespace BaslerHelper {
+
+    // Edge length of the tiles, in pixels
+    const size_t TRANSPOSE_TILE_SIZE = 64;
+
+    //---------------------------------------------------------------------
+    // Copy the pixels of rows [i_row_begin,i_row_end) and columns
+    // [i_col_begin,i_col_end) into the column-major, band-planar output
+    template <typename T>
+    inline void transpose_block(const T* p_src,
+                                T* p_dst,
+                                const size_t i_height,
+                                const size_t i_width,
+                                const unsigned int i_bands,
+                                const size_t i_row_begin,
+                                const size_t i_row_end,
+                                const size_t i_col_begin,
+                                const size_t i_col_end)
+    {
+        const size_t i_numel = i_height * i_width;
+        for (size_t j = i_col_begin; j < i_col_end; j++)
+        {
+            for (size_t i = i_row_begin; i < i_row_end; i++)
+            {
+                const T* p_pixel = p_src + i_bands*(i*i_width + j);
+                for (unsigned int i_c_band = 0; i_c_band < i_bands; i_c_band++)
+                {
+                    p_dst[i_c_band*i_numel + j*i_height + i] = p_pixel[i_c_band];
+                }
+            }
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Tiled scalar transpose, used for all types without a SIMD kernel
+    template <typename T>
+    void transpose_image(   const T* p_src,
+                            T* p_dst,
+                            const size_t i_height,
+                            const size_t i_width,
+                            const unsigned int i_bands)
+    {
+        for (size_t i0 = 0; i0 < i_height; i0 += TRANSPOSE_TILE_SIZE)
+        {
+            const size_t i_row_end = (i0 + TRANSPOSE_TILE_SIZE < i_height) ? i0 + TRANSPOSE_TILE_SIZE : i_height;
+            for (size_t j0 = 0; j0 < i_width; j0 += TRANSPOSE_TILE_SIZE)
+            {
+                const size_t i_col_end = (j0 + TRANSPOSE_TILE_SIZE < i_width) ? j0 + TRANSPOSE_TILE_SIZE : i_width;
+                transpose_block(p_src, p_dst, i_height, i_width, i_bands, i0, i_row_end, j0, i_col_end);
+            }
+        }
+    }
+
+    // 8 bit transpose, uses SSE2 or AVX2 kernels for single band images and
+    // the AVX2 kernels for 2 to 4 bands
+    void transpose_image(   const uint8_t* p_src,
+                            uint8_t* p_dst,
+                            const size_t i_height,
+                            const size_t i_width,
+                            const unsigned int i_bands);
+
+    // 16 bit transpose, uses SSE2 or AVX2 kernels for single band images
+    void transpose_image(   const uint16_t* p_src,
+                            uint16_t* p_dst,
+                            const size_t i_height,
+                            const size_t i_width,
+                            const unsigned int i_bands);
+
+    // Transpose i_rows x i_cols pixels of a single band plane: row i of
+    // the source starts at p_src + i*i_src_stride, column j of the
+    // destination at p_dst + j*i_dst_stride. Used to write tiles of a
+    // larger image, uses the same kernels as transpose_image.
+    void transpose_plane(   const uint8_t* p_src,
+                            const size_t i_src_stride,
+                            uint8_t* p_dst,
+                            const size_t i_dst_stride,
+                            const size_t i_rows,
+                            const size_t i_cols);
+
+    void transpose_plane(   const uint16_t* p_src,
+                            const size_t i_src_stride,
+                            uint16_t* p_dst,
+                            const size_t i_dst_stride,
+                            const size_t i_rows,
+                            const size_t i_cols);
+
+    // Name of the kernel set chosen at runtime ("avx2", "sse2" or "scalar")
+    const char* transpose_kernel_name();
+
+    // True if the AVX2 kernels are chosen, for other kernels of the driver
+    // which only come in an AVX2 and a scalar version
+    bool use_avx2_kernels();
+
+}
+
+#endif
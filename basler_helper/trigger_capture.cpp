@@ -0,0 +1,69 @@
+// trigger_capture.cpp - Triggered acquisition and its latency
+// 17.10.2026 / agent
+
+
+#include "trigger_capture.h"
+#include <string>
+#include <mex.h>
+
+
+namespace BaslerHelper {
+
+    //---------------------------------------------------------------------
+    // Read the source, activation, timeout and timeout policy of the
+    // trigger struct
+    void parse_trigger(const mxArray* mxa_trigger, TriggerSettings& trigger)
+    {
+        if(!mxIsStruct(mxa_trigger))
+        {
+            mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                    "Trigger must be a struct with the fields Source, Activation, Timeout and OnTimeout.");
+        }
+        const mxArray* mxa_source = mxGetField(mxa_trigger, 0, "Source");
+        if(mxa_source != NULL && !mxIsEmpty(mxa_source))
+        {
+            trigger.s_source = mxArrayToString(mxa_source);
+        }
+        const mxArray* mxa_activation = mxGetField(mxa_trigger, 0, "Activation");
+        if(mxa_activation != NULL && !mxIsEmpty(mxa_activation))
+        {
+            trigger.s_activation = mxArrayToString(mxa_activation);
+        }
+        
+        const mxArray* mxa_timeout = mxGetField(mxa_trigger, 0, "Timeout");
+        if(mxa_timeout != NULL && !mxIsEmpty(mxa_timeout))
+        {
+            const double d_timeout = mxGetScalar(mxa_timeout);
+            if(!(d_timeout >= 0) || d_timeout > 4e6)
+            {
+                mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                        "Timeout must be between 0 and 4e6 s.");
+            }
+            trigger.i_timeout_ms = (unsigned int)(d_timeout * 1000);
+        }
+        
+        const mxArray* mxa_policy = mxGetField(mxa_trigger, 0, "OnTimeout");
+        if(mxa_policy != NULL && !mxIsEmpty(mxa_policy))
+        {
+            const std::string s_policy = mxArrayToString(mxa_policy);
+            if(s_policy == "error")
+            {
+                trigger.to_policy = Timeout_Error;
+            }
+            else if(s_policy == "skip")
+            {
+                trigger.to_policy = Timeout_Skip;
+            }
+            else if(s_policy == "stop")
+            {
+                trigger.to_policy = Timeout_Stop;
+            }
+            else
+            {
+                mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
+                        "Unknown OnTimeout, use 'error', 'skip' or 'stop'.");
+            }
+        }
+    }
+
+}
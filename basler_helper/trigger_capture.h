@@ -0,0 +1,54 @@
+// trigger_capture.h - Triggered acquisition and its latency
+// 17.10.2026 / agent
+//
+// Instead of running free, a source can be armed once for a software
+// trigger or a hardware line trigger before the capture starts. With a
+// software trigger, the grab thread triggers every frame itself and the
+// latency from the trigger to the frame in the Matlab array is measured.
+// The host does not know when a line trigger fired, so there the latency
+// is measured from the arrival of the frame. The timeout policy sets what
+// happens if a frame does not arrive in time.
+
+#ifndef __TRIGGERCAPTURE_H_INCLUDED__
+#define __TRIGGERCAPTURE_H_INCLUDED__
+
+#include "latency_histogram.h"
+#include <matrix.h>
+#include <string>
+
+
+namespace BaslerHelper {
+
+    //---------------------------------------------------------------------
+    // Reaction to a frame not arriving within the timeout
+    enum TimeoutPolicy
+    {
+        Timeout_Error,          // Abort the capture with an error
+        Timeout_Skip,           // Count the frame as dropped and go on
+        Timeout_Stop            // Return the frames captured so far
+    };
+
+    //---------------------------------------------------------------------
+    // Trigger and timeout of a capture
+    struct TriggerSettings
+    {
+        TriggerSettings() : i_timeout_ms(5000), to_policy(Timeout_Error) {}
+        std::string s_source;               // TriggerSource, e.g. Software or
+                                            // Line1, empty runs free
+        std::string s_activation;           // TriggerActivation, e.g.
+                                            // RisingEdge, empty keeps the
+                                            // camera's
+        unsigned int i_timeout_ms;          // Per frame
+        TimeoutPolicy to_policy;
+
+        bool triggered() const { return !s_source.empty(); }
+        bool software() const { return s_source == "Software"; }
+    };
+
+    // Read the fields Source, Activation, Timeout (in s) and OnTimeout of
+    // a Matlab trigger struct into trigger, argument errors go to Matlab
+    void parse_trigger(const mxArray* mxa_trigger, TriggerSettings& trigger);
+
+}
+
+#endif
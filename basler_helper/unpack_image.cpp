@@ -0,0 +1,278 @@
+// unpack_image.cpp - Unpack packed 10 and 12 bit frames
+// 17.10.2026 / agent
+//
+// There are two families of packing. The GenICam "p" formats pack the
+// pixels bit by bit, least significant bit first: 4 pixels in 5 bytes
+// (10p) or 2 pixels in 3 bytes (12p). Basler's older "packed" formats
+// store 2 pixels in 3 bytes, the high bits of each pixel in a byte of its
+// own and the low bits of both in the byte in between. The AVX2 kernels
+// unpack 16 pixels per step: a byte shuffle moves the two bytes holding
+// each pixel into a 16 bit word, shifts and masks then extract the
+// pixel. Other CPUs and the rest of a row use the scalar code.
+
+
+#include "unpack_image.h"
+#include "transpose_image.h"
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define BASLER_HAS_X86
+#include <immintrin.h>
+#endif
+
+
+namespace {
+
+    // Rows unpacked before they are transposed into the output
+    const size_t UNPACK_STRIP_ROWS = 32;
+
+    //---------------------------------------------------------------------
+    // Packing of the pixels
+    enum Packing
+    {
+        Packing_None,
+        Packing_10p,            // 4 pixels in 5 bytes, LSB first
+        Packing_12p,            // 2 pixels in 3 bytes, LSB first
+        Packing_10packed,       // 2 pixels in 3 bytes, Basler
+        Packing_12packed        // 2 pixels in 3 bytes, Basler
+    };
+
+    //---------------------------------------------------------------------
+    // Packing of a format and the unpacked format
+    Packing packing(const Pylon::EPixelType ept_type, Pylon::EPixelType& ept_unpacked)
+    {
+        switch (ept_type)
+        {
+            case Pylon::PixelType_Mono10p:          ept_unpacked = Pylon::PixelType_Mono10;    return Packing_10p;
+            case Pylon::PixelType_Mono12p:          ept_unpacked = Pylon::PixelType_Mono12;    return Packing_12p;
+            case Pylon::PixelType_Mono10packed:     ept_unpacked = Pylon::PixelType_Mono10;    return Packing_10packed;
+            case Pylon::PixelType_Mono12packed:     ept_unpacked = Pylon::PixelType_Mono12;    return Packing_12packed;
+            case Pylon::PixelType_BayerGR10p:       ept_unpacked = Pylon::PixelType_BayerGR10; return Packing_10p;
+            case Pylon::PixelType_BayerRG10p:       ept_unpacked = Pylon::PixelType_BayerRG10; return Packing_10p;
+            case Pylon::PixelType_BayerGB10p:       ept_unpacked = Pylon::PixelType_BayerGB10; return Packing_10p;
+            case Pylon::PixelType_BayerBG10p:       ept_unpacked = Pylon::PixelType_BayerBG10; return Packing_10p;
+            case Pylon::PixelType_BayerGR12p:       ept_unpacked = Pylon::PixelType_BayerGR12; return Packing_12p;
+            case Pylon::PixelType_BayerRG12p:       ept_unpacked = Pylon::PixelType_BayerRG12; return Packing_12p;
+            case Pylon::PixelType_BayerGB12p:       ept_unpacked = Pylon::PixelType_BayerGB12; return Packing_12p;
+            case Pylon::PixelType_BayerBG12p:       ept_unpacked = Pylon::PixelType_BayerBG12; return Packing_12p;
+            case Pylon::PixelType_BayerGR12Packed:  ept_unpacked = Pylon::PixelType_BayerGR12; return Packing_12packed;
+            case Pylon::PixelType_BayerRG12Packed:  ept_unpacked = Pylon::PixelType_BayerRG12; return Packing_12packed;
+            case Pylon::PixelType_BayerGB12Packed:  ept_unpacked = Pylon::PixelType_BayerGB12; return Packing_12packed;
+            case Pylon::PixelType_BayerBG12Packed:  ept_unpacked = Pylon::PixelType_BayerBG12; return Packing_12packed;
+            default:                                ept_unpacked = ept_type;                   return Packing_None;
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Unpack pixels [i_col_begin,i_col_end) of a row
+    void unpack_pixels( const uint8_t* p_src,
+                        const Packing pk_packing,
+                        uint16_t* p_dst,
+                        const size_t i_col_begin,
+                        const size_t i_col_end,
+                        const unsigned int i_shift)
+    {
+        for (size_t j = i_col_begin; j < i_col_end; j++)
+        {
+            unsigned int i_value;
+            if (pk_packing == Packing_10p || pk_packing == Packing_12p)
+            {
+                // Both bytes of the pixel, then the bit offset
+                const unsigned int i_bits = pk_packing == Packing_10p ? 10 : 12;
+                const size_t i_bit = j * i_bits;
+                const uint8_t* p_byte = p_src + i_bit / 8;
+                i_value = ((p_byte[0] | (p_byte[1] << 8)) >> (i_bit % 8)) & ((1u << i_bits) - 1);
+            }
+            else
+            {
+                const uint8_t* p_pair = p_src + (j / 2) * 3;
+                const unsigned int i_low = (j & 1) ? (p_pair[1] >> 4) : p_pair[1];
+                const uint8_t i_high = (j & 1) ? p_pair[2] : p_pair[0];
+                i_value = pk_packing == Packing_12packed ?
+                        ((i_high << 4) | (i_low & 0xF)) : ((i_high << 2) | (i_low & 0x3));
+            }
+            p_dst[j] = (uint16_t)(i_value << i_shift);
+        }
+    }
+
+#ifdef BASLER_HAS_X86
+
+#if defined(__GNUC__) && !defined(__AVX2__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#define BASLER_POP_TARGET
+#endif
+
+    //---------------------------------------------------------------------
+    // AVX2: 16 pixels per step, 8 from each 128 bit lane. Returns the
+    // first pixel not done.
+    size_t unpack_avx2( const uint8_t* p_src,
+                        const Packing pk_packing,
+                        uint16_t* p_dst,
+                        const size_t i_width,
+                        const size_t i_row_bytes,
+                        const unsigned int i_shift)
+    {
+        // Bytes holding 8 pixels, and the low and high byte of each pixel
+        const size_t i_lane_bytes = pk_packing == Packing_10p ? 10 : 12;
+        __m256i m_shuffle;
+        switch (pk_packing)
+        {
+            case Packing_10p:
+                m_shuffle = _mm256_setr_epi8(0,1, 1,2, 2,3, 3,4, 5,6, 6,7, 7,8, 8,9,
+                                             0,1, 1,2, 2,3, 3,4, 5,6, 6,7, 7,8, 8,9);
+                break;
+            case Packing_12p:
+                m_shuffle = _mm256_setr_epi8(0,1, 1,2, 3,4, 4,5, 6,7, 7,8, 9,10, 10,11,
+                                             0,1, 1,2, 3,4, 4,5, 6,7, 7,8, 9,10, 10,11);
+                break;
+            default:
+                // Low bits byte below the high bits byte
+                m_shuffle = _mm256_setr_epi8(1,0, 1,2, 4,3, 4,5, 7,6, 7,8, 10,9, 10,11,
+                                             1,0, 1,2, 4,3, 4,5, 7,6, 7,8, 10,9, 10,11);
+                break;
+        }
+        const __m128i m_shift = _mm_cvtsi32_si128((int)i_shift);
+        const __m256i m_even = _mm256_set1_epi32(0x0000FFFF);
+        const __m256i m_odd = _mm256_set1_epi32((int)0xFFFF0000);
+
+        size_t j = 0;
+        size_t i_byte = 0;
+        for (; j + 16 <= i_width && i_byte + i_lane_bytes + 16 <= i_row_bytes; j += 16, i_byte += 2 * i_lane_bytes)
+        {
+            const __m256i v = _mm256_shuffle_epi8(_mm256_inserti128_si256(
+                    _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(p_src + i_byte))),
+                    _mm_loadu_si128((const __m128i*)(p_src + i_byte + i_lane_bytes)), 1), m_shuffle);
+            __m256i r;
+            switch (pk_packing)
+            {
+                case Packing_10p:
+                {
+                    // Pixel k of 4 starts at bit 2k of its word
+                    const __m256i m_1 = _mm256_setr_epi16(-1,0,0,0,-1,0,0,0,-1,0,0,0,-1,0,0,0);
+                    const __m256i m_2 = _mm256_slli_si256(m_1, 2);
+                    const __m256i m_3 = _mm256_slli_si256(m_1, 4);
+                    const __m256i m_4 = _mm256_slli_si256(m_1, 6);
+                    r = _mm256_or_si256(
+                            _mm256_or_si256(_mm256_and_si256(v, m_1), _mm256_and_si256(_mm256_srli_epi16(v, 2), m_2)),
+                            _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi16(v, 4), m_3), _mm256_and_si256(_mm256_srli_epi16(v, 6), m_4)));
+                    r = _mm256_and_si256(r, _mm256_set1_epi16(0x03FF));
+                    break;
+                }
+                case Packing_12p:
+                    // Even pixels in the low 12 bits, odd ones in the high
+                    r = _mm256_or_si256(_mm256_and_si256(v, _mm256_and_si256(m_even, _mm256_set1_epi16(0x0FFF))),
+                                        _mm256_and_si256(_mm256_srli_epi16(v, 4), m_odd));
+                    break;
+                case Packing_12packed:
+                {
+                    // High bits byte << 4, low nibble or high nibble of
+                    // the low bits byte
+                    const __m256i s = _mm256_srli_epi16(v, 4);
+                    r = _mm256_or_si256(_mm256_and_si256(s, _mm256_set1_epi16(0x0FF0)),
+                            _mm256_and_si256(_mm256_or_si256(_mm256_and_si256(v, m_even), _mm256_and_si256(s, m_odd)),
+                                             _mm256_set1_epi16(0x000F)));
+                    break;
+                }
+                default:
+                {
+                    // High bits byte << 2, bits 0-1 or 4-5 of the low bits
+                    // byte
+                    const __m256i s = _mm256_srli_epi16(v, 4);
+                    r = _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi16(v, 6), _mm256_set1_epi16(0x03FC)),
+                            _mm256_and_si256(_mm256_or_si256(_mm256_and_si256(v, m_even), _mm256_and_si256(s, m_odd)),
+                                             _mm256_set1_epi16(0x0003)));
+                    break;
+                }
+            }
+            _mm256_storeu_si256((__m256i*)(p_dst + j), _mm256_sll_epi16(r, m_shift));
+        }
+        return j;
+    }
+
+#ifdef BASLER_POP_TARGET
+#pragma GCC pop_options
+#undef BASLER_POP_TARGET
+#endif
+
+#endif
+}
+
+
+namespace BaslerHelper {
+
+    //---------------------------------------------------------------------
+    // Unpack kernel available
+    bool unpacked_format(const Pylon::EPixelType ept_packed, Pylon::EPixelType& ept_unpacked)
+    {
+        return packing(ept_packed, ept_unpacked) != Packing_None;
+    }
+
+    //---------------------------------------------------------------------
+    // Bits of an unpacked pixel
+    unsigned int packed_bit_depth(const Pylon::EPixelType ept_packed)
+    {
+        Pylon::EPixelType ept_unpacked;
+        const Packing pk_packing = packing(ept_packed, ept_unpacked);
+        return (pk_packing == Packing_10p || pk_packing == Packing_10packed) ? 10 : 12;
+    }
+
+    //---------------------------------------------------------------------
+    // Bytes of a packed row
+    size_t packed_row_bytes(const Pylon::EPixelType ept_packed, const size_t i_width)
+    {
+        Pylon::EPixelType ept_unpacked;
+        const size_t i_bits = packing(ept_packed, ept_unpacked) == Packing_10p ? 10 : 12;
+        return (i_width * i_bits + 7) / 8;
+    }
+
+    //---------------------------------------------------------------------
+    // Unpack a row
+    void unpack_row(const uint8_t* p_src, const Pylon::EPixelType ept_packed, uint16_t* p_dst,
+            const size_t i_width, const unsigned int i_shift)
+    {
+        Pylon::EPixelType ept_unpacked;
+        const Packing pk_packing = packing(ept_packed, ept_unpacked);
+        size_t j = 0;
+#ifdef BASLER_HAS_X86
+        if (use_avx2_kernels())
+        {
+            j = unpack_avx2(p_src, pk_packing, p_dst, i_width, packed_row_bytes(ept_packed, i_width), i_shift);
+        }
+#endif
+        unpack_pixels(p_src, pk_packing, p_dst, j, i_width, i_shift);
+    }
+
+    //---------------------------------------------------------------------
+    // Unpack a frame, row-major
+    void unpack_rows(const void* p_src, const Pylon::EPixelType ept_packed, uint16_t* p_dst,
+            const size_t i_height, const size_t i_width, const unsigned int i_shift)
+    {
+        const size_t i_row_bytes = packed_row_bytes(ept_packed, i_width);
+        for (size_t i = 0; i < i_height; i++)
+        {
+            unpack_row(static_cast<const uint8_t*>(p_src) + i * i_row_bytes, ept_packed,
+                    p_dst + i * i_width, i_width, i_shift);
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Unpack a frame in strips and transpose them into the output
+    void unpack_image(const void* p_src, const Pylon::EPixelType ept_packed, uint16_t* p_dst,
+            const size_t i_height, const size_t i_width, const unsigned int i_shift)
+    {
+        // Strip buffer is kept per thread, every worker converts frames
+        static thread_local std::vector<uint16_t> strip;
+        strip.resize(UNPACK_STRIP_ROWS * i_width);
+        const size_t i_row_bytes = packed_row_bytes(ept_packed, i_width);
+
+        for (size_t i0 = 0; i0 < i_height; i0 += UNPACK_STRIP_ROWS)
+        {
+            const size_t i_rows = (i0 + UNPACK_STRIP_ROWS < i_height) ? UNPACK_STRIP_ROWS : i_height - i0;
+            unpack_rows(static_cast<const uint8_t*>(p_src) + i0 * i_row_bytes, ept_packed,
+                    &strip[0], i_rows, i_width, i_shift);
+            transpose_plane(&strip[0], i_width, p_dst + i0, i_height, i_rows, i_width);
+        }
+    }
+
+}
@@ -0,0 +1,59 @@
+// unpack_image.h - Unpack packed 10 and 12 bit frames
+// 17.10.2026 / agent
+//
+// Packed mono and Bayer frames (Mono10p, Mono12p, Mono10packed,
+// Mono12packed, Bayer 10p, 12p and 12Packed) are unpacked to 16 bit and
+// written into the column-major Matlab array in one pass: strips of rows
+// are unpacked into a small buffer which stays in the cache and then
+// transposed into the output. Rows are padded to whole bytes, like Pylon
+// computes the stride.
+
+#ifndef __UNPACKIMAGE_H_INCLUDED__
+#define __UNPACKIMAGE_H_INCLUDED__
+
+#include <pylon/PylonIncludes.h>
+#include <cstddef>
+#include <stdint.h>
+
+
+namespace BaslerHelper {
+
+    // True if ept_packed is a packed format with an unpack kernel.
+    // ept_unpacked is set to the unpacked format with the same bit depth
+    // (e.g. Mono12 for Mono12p).
+    bool unpacked_format(   const Pylon::EPixelType ept_packed,
+                            Pylon::EPixelType& ept_unpacked);
+
+    // Bits per pixel of a packed format once unpacked, 10 or 12
+    unsigned int packed_bit_depth(const Pylon::EPixelType ept_packed);
+
+    // Bytes of a row of i_width packed pixels
+    size_t packed_row_bytes(const Pylon::EPixelType ept_packed,
+                            const size_t i_width);
+
+    // Unpack a row and shift the values left by i_shift bits
+    void unpack_row(const uint8_t* p_src,
+                    const Pylon::EPixelType ept_packed,
+                    uint16_t* p_dst,
+                    const size_t i_width,
+                    const unsigned int i_shift);
+
+    // Unpack a frame into a row-major image
+    void unpack_rows(   const void* p_src,
+                        const Pylon::EPixelType ept_packed,
+                        uint16_t* p_dst,
+                        const size_t i_height,
+                        const size_t i_width,
+                        const unsigned int i_shift);
+
+    // Unpack a frame into the column-major Matlab array
+    void unpack_image(  const void* p_src,
+                        const Pylon::EPixelType ept_packed,
+                        uint16_t* p_dst,
+                        const size_t i_height,
+                        const size_t i_width,
+                        const unsigned int i_shift);
+
+}
+
+#endif
@@ -4,28 +4,89 @@ function make(varargin)
 % Usage:
 %          make            Compiles the driver
 %          make clean      Removes all autogenerated files
+%          make tests      Compiles the C++ tests and benchmarks in test,
+%                          after the driver was compiled
 %
 
 %% Files to build
-% Driver functions
+% Driver functions, all compiled into the single MEX file baslerDriver
 drivers = {                             ...
+            'baslerDriver.cpp';         ...
+            'baslerSession.cpp';        ...
             'baslerFindCameras.cpp';    ...
             'baslerSetParameter.cpp';   ...
             'baslerGetParameter.cpp';   ...
+            'baslerParameters.cpp';     ...
             'baslerGetData.cpp';        ...
+            'baslerGetMultiData.cpp';   ...
             'baslerSaveData.cpp';       ...
+            'baslerReadRaw.cpp';        ...
+            'baslerReadTiff.cpp';       ...
+            'baslerGrabbing.cpp';       ...
+            'baslerStream.cpp';         ...
+            'private/baslerGetRawCameraParams.cpp'; ...
           };
 
 % Shared libraries:   path           name         additional flags
 libraries = {  'basler_helper', 'basler_set_get.cpp',      '-c';      ...
-               'private',  'baslerGetRawCameraParams.cpp', '';       ...
+               'basler_helper', 'camera_session.cpp',      '-c';      ...
+               'basler_helper', 'acquisition_format.cpp',  '-c';      ...
+               'basler_helper', 'node_cache.cpp',          '-c';      ...
+               'basler_helper', 'transpose_image.cpp',     '-c';      ...
+               'basler_helper', 'debayer_image.cpp',       '-c';      ...
+               'basler_helper', 'unpack_image.cpp',        '-c';      ...
+               'basler_helper', 'frame_reduce.cpp',        '-c';      ...
+               'basler_helper', 'latency_histogram.cpp',   '-c';      ...
+               'basler_helper', 'trigger_capture.cpp',     '-c';      ...
+               'basler_helper', 'grab_options.cpp',        '-c';      ...
+               'basler_helper', 'telemetry.cpp',           '-c';      ...
+               'basler_helper', 'raw_stream.cpp',          '-c';      ...
+               'basler_helper', 'compressed_stream.cpp',   '-c';      ...
+               'basler_helper', 'tiff_reader.cpp',         '-c';      ...
+               'basler_helper', 'exposure_control.cpp',    '-c';      ...
+               'basler_helper', 'continuous_grab.cpp',     '-c';      ...
+               'basler_helper', 'direct_capture.cpp',      '-c';      ...
+               'basler_helper', 'frame_source.cpp',        '-c';      ...
+               'basler_helper', 'frame_metadata.cpp',      '-c';      ...
+               'basler_helper', 'chunk_stream.cpp',        '-c';      ...
             };
 libraryObjects = { 'basler_helper/basler_set_get.obj'; ...
+                   'basler_helper/camera_session.obj'; ...
+                   'basler_helper/acquisition_format.obj'; ...
+                   'basler_helper/node_cache.obj'; ...
+                   'basler_helper/transpose_image.obj'; ...
+                   'basler_helper/debayer_image.obj'; ...
+                   'basler_helper/unpack_image.obj'; ...
+                   'basler_helper/frame_reduce.obj'; ...
+                   'basler_helper/latency_histogram.obj'; ...
+                   'basler_helper/trigger_capture.obj'; ...
+                   'basler_helper/grab_options.obj'; ...
+                   'basler_helper/telemetry.obj'; ...
+                   'basler_helper/raw_stream.obj'; ...
+                   'basler_helper/compressed_stream.obj'; ...
+                   'basler_helper/tiff_reader.obj'; ...
+                   'basler_helper/exposure_control.obj'; ...
+                   'basler_helper/continuous_grab.obj'; ...
+                   'basler_helper/direct_capture.obj'; ...
+                   'basler_helper/frame_source.obj'; ...
+                   'basler_helper/frame_metadata.obj'; ...
+                   'basler_helper/chunk_stream.obj'; ...
             };
 
+% Standalone C++ tests and benchmarks, linked with the driver's objects
+tests = {                                       ...
+            'test/benchmarkCompression.cpp';    ...
+            'test/benchmarkSyntheticSource.cpp'; ...
+            'test/benchmarkTranspose.cpp';      ...
+            'test/testDebayer.cpp';             ...
+            'test/testFrameReduce.cpp';         ...
+            'test/testUnpack.cpp';              ...
+        };
+
 % MEX and compiler flags
 flags = {   '-largeArrayDims',...
-            '"CXXFLAGS=$CXXFLAGS -std=c++0x -fpermissive -fPIC -DNDEBUG"', ...
+            '"CXXFLAGS=$CXXFLAGS -std=c++0x -fpermissive -fPIC -pthread -DNDEBUG"', ...
+            '"LDFLAGS=$LDFLAGS -pthread"', ...
             ... '-g', ...      % debug symbols
             ... '-v', ...      % verbose
         };
@@ -57,15 +118,23 @@ switch nargin
             cd('..');
         end
 
-        % Build drivers
+        % Build driver
         fprintf('=> Creating Functions\n');
-        for k=1:size(drivers,1)
-            mex(flags{:},ipaths,lpaths,libraryObjects{:},drivers{k})
-        end
+        mex(flags{:},ipaths,lpaths,libraryObjects{:},drivers{:})
         
-    case 1 %CLEAN
+    case 1 %CLEAN or TESTS
+        if strcmp(varargin{1},'tests')
+            % Executables with Matlab's libraries, run them outside of
+            % Matlab with its binaries on the path
+            fprintf('=> Creating Tests\n');
+            for k=1:numel(tests)
+                mex(flags{:},'-client','engine',ipaths,'-Ibasler_helper',lpaths,'-lmx','-lmex', ...
+                    '-outdir','test',libraryObjects{:},tests{k})
+            end
+        end
         if strcmp(varargin{1},'clean')
             delete('*.pdb','*.mex*','*.obj','*.lib','*.exp');
+            delete('test/*.exe','test/*.pdb','test/*.obj');
             for k=1:size(libraries,1)
                 cd(libraries{k,1});
                 delete('*.pdb','*.mex*','*.obj','*.lib','*.exp');
@@ -1,122 +1,178 @@
 // baslerGetRawCameraParams.cpp - INTERNAL FUNCTION!!!
-// Returns the complete list of camera parameters, including their 
-// visibility
+// Returns a struct of all camera parameters up to the given visibility,
+// see baslerCameraInfo.m
 
 #include <pylon/PylonIncludes.h>
+#include "../basler_helper/basler_driver.h"
+#include "../basler_helper/camera_session.h"
+#include "../basler_helper/basler_set_get.h"
+
+#include <cctype>
+#include <chrono>
+#include <string>
+#include <vector>
 
 #include <matrix.h>
 #include <mex.h>
 
-void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
-{       
+
+namespace {
+
+    // Parts of the names of internal nodes
+    const char* s_internal_names[] = { "_ConvertTo", "_ConvertFrom", "Fao", "_adrCalc",
+                                       "_Reg", "Status", "available", "Available" };
+
+    //---------------------------------------------------------------------
+    // True for nodes which are of no interest to the user: internal
+    // helper nodes, numbered duplicates (N followed by digits, or 6 and
+    // more digits) and names which are no valid Matlab field names
+    bool is_internal(const std::string& s_name)
+    {
+        if(s_name.empty() || s_name.size() > 63 || !isalpha((unsigned char)s_name[0]))
+        {
+            return true;
+        }
+        for(size_t i = 0; i < sizeof(s_internal_names) / sizeof(s_internal_names[0]); i++)
+        {
+            if(s_name.find(s_internal_names[i]) != std::string::npos)
+            {
+                return true;
+            }
+        }
+
+        int i_digits = 0;
+        for(size_t i = 0; i < s_name.size(); i++)
+        {
+            if(!isalnum((unsigned char)s_name[i]) && s_name[i] != '_')
+            {
+                return true;
+            }
+            if(s_name[i] == 'N' && i + 1 < s_name.size() && isdigit((unsigned char)s_name[i+1]))
+            {
+                return true;
+            }
+            i_digits = isdigit((unsigned char)s_name[i]) ? i_digits + 1 : 0;
+            if(i_digits >= 6)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+
+void baslerGetRawCameraParams(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
     // Parse parameters
     if(nrhs < 1)
     {
         mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
-                "Not enough arguments. Use help baslerCameraInfo for further information."); 
+                "Not enough arguments. Use help baslerCameraInfo for further information.");
     }
-    else if(nrhs > 1)
+    else if(nrhs > 3)
     {
         mexErrMsgIdAndTxt( "baslerDriver:Error:ArgumentError",
-                "Too many arguments. Use help baslerCameraInfo for further information."); 
+                "Too many arguments. Use help baslerCameraInfo for further information.");
+    }
+
+    // Get visibility, default: Beginner
+    int i_visibility = (int)GenApi::Beginner;
+    if(nrhs >= 2 && mxGetNumberOfElements(prhs[1]) >= 1)
+    {
+        i_visibility = (int)mxGetScalar(prhs[1]);
+    }
+
+    // Get verbose parameter
+    bool b_verbose = 0;
+    if(nrhs >= 3 && mxGetNumberOfElements(prhs[2]) >= 1)
+    {
+        b_verbose = (int)mxGetScalar(prhs[2]) != 0;
     }
-    const int i_cam_number = (int)mxGetScalar(prhs[0]);    
-    
-    // Initiatlize Pylon
-    Pylon::PylonAutoInitTerm auto_init_term;
-    
+
     try
     {
-        // Get the transport layer factory.
-        Pylon::CTlFactory& tlFactory = Pylon::CTlFactory::GetInstance();
-        
-        // Get all attached devices
-        Pylon::DeviceInfoList_t devices;
-        int i_num_of_cameras = tlFactory.EnumerateDevices(devices);
-        if ( i_num_of_cameras == 0 )
-        {
-            throw RUNTIME_EXCEPTION( "No camera found.");
-        }
-        
-        // Check if camera exists
-        if (i_cam_number > i_num_of_cameras-1 )
-        {
-            throw RUNTIME_EXCEPTION("No camera with this index exists.");
-        }
-        
-        // Create camera object
-        Pylon::CInstantCamera camera(tlFactory.CreateDevice(devices[i_cam_number]));
-        
-        // Open Camera
-        camera.Open();
-        
+        const std::chrono::steady_clock::time_point tp_start = std::chrono::steady_clock::now();
+
+        // Get camera, it stays open between calls
+        Pylon::CInstantCamera& camera = *BaslerHelper::get_session(prhs[0], b_verbose)->camera();
+
         // Find nodes
         GenApi::NodeList_t nl_nodes;
         camera.GetNodeMap().GetNodes(nl_nodes);
-        
-        // Init output
-        plhs[0] = mxCreateCellMatrix(nl_nodes.size(),3);
-        
-        int i=0;
+
+        // Read all visible value nodes
+        std::vector<std::string> s_names;
+        std::vector<BaslerHelper::ParameterValue> values;
         for(GenApi::NodeList_t::iterator it=nl_nodes.begin(); it != nl_nodes.end(); ++it)
         {
-            int i_cur_vis = (int)(*it)->GetVisibility();
-
-            // Set Node name
-            mxSetCell(plhs[0],i,mxCreateString((*it)->GetName()));
+            if((int)(*it)->GetVisibility() > i_visibility || !IsReadable(*it))
+            {
+                continue;
+            }
+            const GenApi::EInterfaceType e_type = (*it)->GetPrincipalInterfaceType();
+            if(e_type != GenApi::intfIBoolean && e_type != GenApi::intfIInteger &&
+                    e_type != GenApi::intfIFloat && e_type != GenApi::intfIEnumeration)
+            {
+                continue;
+            }
+            const std::string s_name((*it)->GetName().c_str());
+            if(is_internal(s_name))
+            {
+                continue;
+            }
 
-            // Try to find correct Node type
-            try 
+            try
             {
-                GenApi::CPointer<GenApi::IBoolean> p_cur_node = camera.GetNodeMap().GetNode((*it)->GetName());
-                mxSetCell(plhs[0],i+nl_nodes.size(),mxCreateString(p_cur_node->ToString()));
+                values.push_back(BaslerHelper::get_value(*it));
+                s_names.push_back(s_name);
             }
             catch(GenICam::GenericException &e)
             {
-                try 
-                {
-                    GenApi::CPointer<GenApi::IInteger> p_cur_node = camera.GetNodeMap().GetNode((*it)->GetName());
-                    mxSetCell(plhs[0],i+nl_nodes.size(),mxCreateString(p_cur_node->ToString()));
-                }
-                catch(GenICam::GenericException &e)
-                {
-                    try 
-                    {
-                        GenApi::CPointer<GenApi::IFloat> p_cur_node = camera.GetNodeMap().GetNode((*it)->GetName());
-                        mxSetCell(plhs[0],i+nl_nodes.size(),mxCreateString(p_cur_node->ToString()));
-                    }
-                    catch(GenICam::GenericException &e)
-                    {
-
-                        try 
-                        {
-                            GenApi::CPointer<GenApi::IEnumeration> p_cur_node = camera.GetNodeMap().GetNode((*it)->GetName());
-                            mxSetCell(plhs[0],i+nl_nodes.size(),mxCreateString(p_cur_node->ToString()));
-                        }
-                        catch(GenICam::GenericException &e)
-                        {
-
-                        }
-                    }
-                }
+                // Node not readable in the current camera state
+            }
+        }
+
+        // Create struct, numbers as numbers and enumerations as strings
+        std::vector<const char*> s_fields(s_names.size());
+        for(size_t i = 0; i < s_names.size(); i++)
+        {
+            s_fields[i] = s_names[i].c_str();
+        }
+        plhs[0] = mxCreateStructMatrix(1, 1, (int)s_fields.size(), s_fields.empty() ? NULL : &s_fields[0]);
+        for(size_t i = 0; i < values.size(); i++)
+        {
+            mxArray* mxa_value;
+            switch(values[i].e_type)
+            {
+                case GenApi::intfIInteger:
+                    mxa_value = mxCreateNumericMatrix(1, 1, mxINT64_CLASS, mxREAL);
+                    *(int64_t*)mxGetData(mxa_value) = values[i].i_value;
+                    break;
+                case GenApi::intfIFloat:
+                    mxa_value = mxCreateDoubleScalar(values[i].d_value);
+                    break;
+                case GenApi::intfIBoolean:
+                    mxa_value = mxCreateLogicalScalar(values[i].d_value != 0);
+                    break;
+                default:
+                    mxa_value = mxCreateString(values[i].s_value.c_str());
+                    break;
             }
+            mxSetFieldByNumber(plhs[0], 0, (int)i, mxa_value);
+        }
 
-            // Visibility
-            mxSetCell(plhs[0],i+2*nl_nodes.size(),mxCreateDoubleScalar(i_cur_vis));
-            
-            // Counter variable
-            i++;
+        if(b_verbose)
+        {
+            const double d_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - tp_start).count();
+            mexPrintf("Read %d of %d node(s) in %.3f s\n", (int)values.size(), (int)nl_nodes.size(), d_seconds);
         }
-        
-        // Close camera
-        camera.Close();
     }
     catch (GenICam::GenericException &e)
     {
         // Error handling.
         mexErrMsgIdAndTxt("baslerDriver:Error:CameraError",e.GetDescription());
     }
-    
+
     return;
 }
-
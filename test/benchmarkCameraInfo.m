@@ -0,0 +1,51 @@
+function results = benchmarkCameraInfo(nRuns)
+% benchmarkCameraInfo.m - Time of baslerCameraInfo on an emulated camera
+%
+%  Reads the camera info of an emulated camera nRuns (default=20) times
+%  for each visibility, with the camera kept open. For comparison, the
+%  same parameters are read once with one baslerGetParameter call each.
+%  Prints and returns the number of parameters and the median time of
+%  baslerCameraInfo and the time of the loop in ms.
+%
+%  Usage:
+%    benchmarkCameraInfo();
+%    results = benchmarkCameraInfo(nRuns);
+%
+
+if nargin < 1
+    nRuns = 20;
+end
+
+camera = emulatedCamera();
+baslerOpenCamera(camera);
+
+names = {'Beginner', 'Expert', 'Guru'};
+results = struct('visibility', names, 'parameters', NaN, 'milliseconds', NaN, ...
+                 'loopMilliseconds', NaN);
+for v = 1:numel(names)
+    baslerCameraInfo(camera, v-1);     % warm up
+    milliseconds = zeros(nRuns, 1);
+    for r = 1:nRuns
+        tStart = tic;
+        info = baslerCameraInfo(camera, v-1);
+        milliseconds(r) = 1000 * toc(tStart);
+    end
+
+    parameters = fieldnames(info);
+    tStart = tic;
+    for p = 1:numel(parameters)
+        try
+            baslerGetParameter(camera, parameters{p});
+        catch
+            % Parameters which cannot be read alone are skipped
+        end
+    end
+    results(v).loopMilliseconds = 1000 * toc(tStart);
+
+    results(v).parameters = numel(parameters);
+    results(v).milliseconds = median(milliseconds);
+    fprintf('%-8s %4d parameters, baslerCameraInfo %8.2f ms, one call each %8.2f ms\n', ...
+            names{v}, results(v).parameters, results(v).milliseconds, results(v).loopMilliseconds);
+end
+
+end
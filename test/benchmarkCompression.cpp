@@ -0,0 +1,174 @@
+// benchmarkCompression.cpp - Ratio and speed of the compressed stream codec
+// 17.10.2026 / agent
+//
+// Encodes synthetic frames with the FrameEncoder of baslerSaveData's .bcmp
+// streams, decodes them with decode_frame and checks that every frame
+// round-trips exactly. Prints the compression ratio and the encode and
+// decode speed on one core, in MB/s of uncompressed frame data, for:
+//   - a diagonal test pattern, like the camera's test image
+//   - a smooth scene with sensor noise, in Mono8, Mono12 and BayerRG8
+//   - random noise, which is stored uncompressed
+// Returns 1 if a frame does not round-trip.
+//
+// Build with "make tests" in Matlab, or from the test directory:
+//   g++ -O2 -std=c++11 -I../basler_helper $(pylon-config --cflags) benchmarkCompression.cpp ../basler_helper/compressed_stream.cpp ../basler_helper/unpack_image.cpp ../basler_helper/transpose_image.cpp $(pylon-config --libs) -o benchmarkCompression
+//   benchmarkCompression [width height repetitions]    (default 1920 1080 20)
+
+
+#include <pylon/PylonIncludes.h>
+#include "compressed_stream.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+
+namespace {
+
+    // Content of a synthetic frame
+    enum Pattern
+    {
+        Pattern_Diagonal,
+        Pattern_Scene,
+        Pattern_Noise
+    };
+
+    struct BenchmarkCase
+    {
+        const char* s_name;
+        Pylon::EPixelType ept_type;
+        Pattern pt_pattern;
+    };
+
+    const BenchmarkCase CASES[] = {
+        {"Mono8 diagonal test pattern",     Pylon::PixelType_Mono8,     Pattern_Diagonal},
+        {"Mono8 smooth scene + noise",      Pylon::PixelType_Mono8,     Pattern_Scene},
+        {"Mono12 smooth scene + noise",     Pylon::PixelType_Mono12,    Pattern_Scene},
+        {"BayerRG8 smooth scene + noise",   Pylon::PixelType_BayerRG8,  Pattern_Scene},
+        {"Mono8 random noise",              Pylon::PixelType_Mono8,     Pattern_Noise},
+    };
+
+    //---------------------------------------------------------------------
+    // Sample (i,j) of a frame with i_bits bits per sample. The scene is a
+    // slow wave with gaussian noise of about 1 % of the range, a Bayer
+    // frame gets a different gain on each colour.
+    uint16_t sample(const Pattern pt_pattern, const size_t i, const size_t j, const unsigned int i_bits,
+                    const bool b_bayer, std::mt19937& rng)
+    {
+        const double d_max = (double)((1 << i_bits) - 1);
+        switch (pt_pattern)
+        {
+        case Pattern_Diagonal:
+            return (uint16_t)((i + j) & (size_t)d_max);
+        case Pattern_Noise:
+            return (uint16_t)(rng() & (uint32_t)d_max);
+        default:
+            break;
+        }
+        std::normal_distribution<double> noise(0, d_max / 128);
+        const double d_gain = b_bayer ? 0.6 + 0.2 * (double)((i % 2) * 2 + j % 2) : 1.0;
+        const double d_value = d_gain * d_max * (0.5 + 0.3 * sin(j * 0.01) * cos(i * 0.013)) + noise(rng);
+        return (uint16_t)std::min(d_max, std::max(0.0, floor(d_value + 0.5)));
+    }
+
+    //---------------------------------------------------------------------
+    // Fill a row-major frame of the case's pixel type
+    std::vector<uint8_t> make_frame(const BenchmarkCase& bc, const size_t i_height, const size_t i_width)
+    {
+        const unsigned int i_bits = Pylon::BitDepth(bc.ept_type);
+        const size_t i_sample_bytes = i_bits > 8 ? 2 : 1;
+        std::vector<uint8_t> frame(i_height * i_width * i_sample_bytes);
+        std::mt19937 rng(12345);
+        for (size_t i = 0; i < i_height; i++)
+        {
+            for (size_t j = 0; j < i_width; j++)
+            {
+                const uint16_t i_value = sample(bc.pt_pattern, i, j, i_bits, Pylon::IsBayer(bc.ept_type), rng);
+                if (i_sample_bytes == 1)
+                {
+                    frame[i * i_width + j] = (uint8_t)i_value;
+                }
+                else
+                {
+                    memcpy(&frame[2 * (i * i_width + j)], &i_value, 2);
+                }
+            }
+        }
+        return frame;
+    }
+
+    //---------------------------------------------------------------------
+    // Seconds since tp_start
+    double seconds_since(const std::chrono::steady_clock::time_point& tp_start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - tp_start).count();
+    }
+
+    //---------------------------------------------------------------------
+    // Encode and decode a case i_repetitions times, returns false if the
+    // decoded frame differs
+    bool benchmark_case(const BenchmarkCase& bc, const uint32_t i_width, const uint32_t i_height, const int i_repetitions)
+    {
+        BaslerHelper::CompressedStreamHeader header;
+        BaslerHelper::init_compressed_header(header, i_width, i_height, bc.ept_type);
+        BaslerHelper::FrameEncoder encoder(header, bc.ept_type);
+        const std::vector<uint8_t> frame = make_frame(bc, i_height, i_width);
+        std::vector<uint8_t> decoded(frame.size());
+
+        std::chrono::steady_clock::time_point tp_start = std::chrono::steady_clock::now();
+        for (int r = 0; r < i_repetitions; r++)
+        {
+            encoder.encode(&frame[0]);
+        }
+        const double d_encode = seconds_since(tp_start);
+        // Keep a copy, the encoder reuses its buffer
+        const std::vector<uint8_t> data = encoder.encode(&frame[0]);
+
+        tp_start = std::chrono::steady_clock::now();
+        for (int r = 0; r < i_repetitions; r++)
+        {
+            BaslerHelper::decode_frame(header, &data[0], data.size(), &decoded[0]);
+        }
+        const double d_decode = seconds_since(tp_start);
+
+        const bool b_ok = decoded == frame;
+        const double d_megabytes = (double)frame.size() * i_repetitions * 1e-6;
+        printf("%-30s ratio %5.2f, encode %7.1f MB/s, decode %7.1f MB/s, %s\n", bc.s_name,
+                (double)frame.size() / data.size(), d_megabytes / d_encode, d_megabytes / d_decode,
+                b_ok ? "round trip ok" : "ROUND TRIP FAILED");
+        return b_ok;
+    }
+}
+
+
+int main(int argc, char* argv[])
+{
+    const uint32_t i_width = argc > 1 ? (uint32_t)atol(argv[1]) : 1920;
+    const uint32_t i_height = argc > 2 ? (uint32_t)atol(argv[2]) : 1080;
+    const int i_repetitions = argc > 3 ? atoi(argv[3]) : 20;
+    if (i_width == 0 || i_height == 0 || i_repetitions < 1)
+    {
+        printf("Usage: benchmarkCompression [width height repetitions]\n");
+        return 2;
+    }
+
+    printf("%ux%u, %d repetitions, one core:\n", i_width, i_height, i_repetitions);
+    bool b_ok = true;
+    try
+    {
+        for (size_t c = 0; c < sizeof(CASES) / sizeof(CASES[0]); c++)
+        {
+            b_ok = benchmark_case(CASES[c], i_width, i_height, i_repetitions) && b_ok;
+        }
+    }
+    catch (GenICam::GenericException &e)
+    {
+        printf("Error: %s\n", e.GetDescription());
+        return 1;
+    }
+    return b_ok ? 0 : 1;
+}
@@ -0,0 +1,57 @@
+function results = benchmarkMetadata(nFrames, nRuns)
+% benchmarkMetadata.m - Cost of the metadata output of baslerGetData
+%
+%  Captures frames from synthetic sources, with one output and with the
+%  metadata as second output, nRuns (default=5) times each in
+%  alternation: nFrames (default=5000) frames of 320 x 240, which show
+%  the cost per frame, and nFrames/25 frames of 1920 x 1080, which show
+%  the cost next to the copy of the frames. Prints and returns
+%  the median frames per second of both and the overhead of the metadata
+%  in percent. The metadata must hold one successful entry per frame.
+%
+%  Usage:
+%    benchmarkMetadata();
+%    results = benchmarkMetadata(nFrames, nRuns);
+%
+
+if nargin < 1
+    nFrames = 5000;
+end
+if nargin < 2
+    nRuns = 5;
+end
+
+addpath(fileparts(fileparts(mfilename('fullpath'))));
+sizes = [320 240 nFrames; 1920 1080 max(1, round(nFrames/25))];
+
+results = struct('width', num2cell(sizes(:,1)), 'height', num2cell(sizes(:,2)), ...
+                 'framesPerSecond', NaN, 'framesPerSecondMetadata', NaN, 'overhead', NaN);
+for s = 1:size(sizes, 1)
+    src = struct('Width', sizes(s,1), 'Height', sizes(s,2), 'PixelFormat', 'Mono8');
+    baslerGetData(src, 10);     % warm up
+
+    n = sizes(s,3);
+    seconds = zeros(nRuns, 2);
+    for r = 1:nRuns
+        tStart = tic;
+        frames = baslerGetData(src, n);
+        seconds(r,1) = toc(tStart);
+        clear frames
+
+        tStart = tic;
+        [frames, metadata] = baslerGetData(src, n);
+        seconds(r,2) = toc(tStart);
+        clear frames
+        assert(numel(metadata.succeeded) == n && all(metadata.succeeded), ...
+               'The metadata does not hold one successful entry per frame');
+    end
+
+    framesPerSecond = n ./ median(seconds, 1);
+    results(s).framesPerSecond = framesPerSecond(1);
+    results(s).framesPerSecondMetadata = framesPerSecond(2);
+    results(s).overhead = 100 * (framesPerSecond(1) / framesPerSecond(2) - 1);
+    fprintf('%4dx%-4d %9.1f fps, with metadata %9.1f fps, overhead %+5.1f %%\n', ...
+            sizes(s,1), sizes(s,2), framesPerSecond(1), framesPerSecond(2), results(s).overhead);
+end
+
+end
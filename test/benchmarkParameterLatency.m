@@ -0,0 +1,52 @@
+function results = benchmarkParameterLatency(parameterNames, repetitions)
+% benchmarkParameterLatency.m - Latency of parameter accesses on an emulated camera
+%
+%  Opens an emulated camera with each read policy ('Cached', 'Polled' and
+%  'Device') and times repetitions (default=1000) accesses to each of
+%  parameterNames (default={'ExposureTime', 'Width', 'PixelFormat'})
+%  with baslerParameterLatency: reading with a lookup by name, reading
+%  through the cached node handle and writing the value back. Prints and
+%  returns the median and p99 of each in microseconds. The emulator has
+%  no transport layer, so the numbers show the overhead of the driver and
+%  of GenApi only.
+%
+%  Usage:
+%    benchmarkParameterLatency();
+%    results = benchmarkParameterLatency(parameterNames, repetitions);
+%
+
+if nargin < 1 || isempty(parameterNames)
+    parameterNames = {'ExposureTime', 'Width', 'PixelFormat'};
+end
+if nargin < 2
+    repetitions = 1000;
+end
+
+camera = emulatedCamera();
+
+policies = {'Cached', 'Polled', 'Device'};
+accesses = {'lookupGet', 'cachedGet', 'cachedSet'};
+results = struct('policy', {}, 'name', {}, 'lookupGet', {}, 'cachedGet', {}, 'cachedSet', {});
+for p = 1:numel(policies)
+    baslerCloseCamera(camera);
+    baslerOpenCamera(camera, policies{p});
+    baslerParameterLatency(camera, parameterNames, 10);     % warm up
+
+    latencies = baslerParameterLatency(camera, parameterNames, repetitions);
+    for k = 1:numel(latencies)
+        result = struct('policy', policies{p}, 'name', latencies(k).name, ...
+                        'lookupGet', NaN(1, 2), 'cachedGet', NaN(1, 2), 'cachedSet', NaN(1, 2));
+        for a = 1:numel(accesses)
+            latency = latencies(k).(accesses{a});
+            if ~isempty(latency)
+                result.(accesses{a}) = 1e6 * [latency.median, latency.p99];
+            end
+        end
+        results(end+1) = result; %#ok<AGROW>
+        fprintf('%-6s %-14s lookup get %8.2f / %8.2f us, cached get %8.2f / %8.2f us, cached set %8.2f / %8.2f us (median / p99)\n', ...
+                policies{p}, result.name, result.lookupGet, result.cachedGet, result.cachedSet);
+    end
+end
+baslerCloseCamera(camera);
+
+end
@@ -0,0 +1,58 @@
+function results = benchmarkReadTiff(nFrames, width, height)
+% benchmarkReadTiff.m - Compare baslerReadTiff with a loop over imread
+%
+%  Saves nFrames (default=200) Mono8 frames of width x height (default=
+%  1920 x 1080) from a synthetic source as .tiff files into a temporary
+%  directory, reads them back once with baslerReadTiff and once with
+%  imread in a loop, in the same order, and checks that both return the
+%  same frames. Prints and returns the time and throughput in MB/s of
+%  both. The files are read once before the timing, so both read from
+%  the file cache. The directory is removed afterwards.
+%
+%  Usage:
+%    benchmarkReadTiff();
+%    results = benchmarkReadTiff(nFrames, width, height);
+%
+
+if nargin < 1
+    nFrames = 200;
+end
+if nargin < 3
+    width = 1920;
+    height = 1080;
+end
+
+addpath(fileparts(fileparts(mfilename('fullpath'))));
+directory = tempname();
+mkdir(directory);
+cleanup = onCleanup(@() rmdir(directory, 's'));
+
+src = struct('Width', width, 'Height', height, 'PixelFormat', 'Mono8');
+baslerSaveData(src, directory, nFrames, 'Mono8');
+[~, info] = baslerReadTiff(directory);
+files = fullfile(directory, info.fileNames);
+
+names = {'baslerReadTiff', 'imread loop'};
+results = struct('name', names, 'seconds', NaN, 'megabytesPerSecond', NaN);
+
+tStart = tic;
+frames = baslerReadTiff(directory);
+results(1).seconds = toc(tStart);
+
+tStart = tic;
+reference = zeros(height, width, numel(files), 'uint8');
+for k = 1:numel(files)
+    reference(:,:,k) = imread(files{k});
+end
+results(2).seconds = toc(tStart);
+
+assert(isequal(frames, reference), 'baslerReadTiff and imread differ');
+
+megabytes = numel(reference) / 1e6;
+for k = 1:2
+    results(k).megabytesPerSecond = megabytes / results(k).seconds;
+    fprintf('%-15s %7.3f s, %8.1f MB/s\n', names{k}, results(k).seconds, ...
+            results(k).megabytesPerSecond);
+end
+
+end
@@ -0,0 +1,53 @@
+function results = benchmarkSession(nCalls)
+% benchmarkSession.m - Time of driver calls with and without open sessions
+%
+%  Calls baslerGetParameter and baslerGetData (one Mono8 frame) nCalls
+%  (default=50) times each on an emulated camera, in three ways:
+%    - open: the camera is kept open between the calls
+%    - closed: the camera is closed after each call, Pylon stays
+%      initialized
+%    - cleared: all cameras are closed and the driver is cleared after
+%      each call, so Pylon is initialized and the devices are enumerated
+%      again, as before the sessions were kept
+%  Prints and returns the median time per call in ms.
+%
+%  Usage:
+%    benchmarkSession();
+%    results = benchmarkSession(nCalls);
+%
+
+if nargin < 1
+    nCalls = 50;
+end
+
+camera = emulatedCamera();
+baslerSetParameter(camera, 'PixelFormat', 'Mono8');
+
+names = {'open', 'closed', 'cleared'};
+calls = {@() baslerGetParameter(camera, 'ExposureTime'), ...
+         @() baslerGetData(camera, 1)};
+results = struct('name', names, 'getParameter', NaN, 'getData', NaN);
+for k = 1:numel(names)
+    milliseconds = zeros(nCalls, numel(calls));
+    for c = 1:numel(calls)
+        baslerOpenCamera(camera);
+        for n = 1:nCalls
+            tStart = tic;
+            calls{c}();
+            milliseconds(n,c) = 1000 * toc(tStart);
+            switch names{k}
+                case 'closed'
+                    baslerCloseCamera(camera);
+                case 'cleared'
+                    baslerCloseCamera();
+                    clear baslerDriver
+            end
+        end
+    end
+    results(k).getParameter = median(milliseconds(:,1));
+    results(k).getData = median(milliseconds(:,2));
+    fprintf('%-8s GetParameter %8.2f ms, GetData %8.2f ms\n', names{k}, ...
+            results(k).getParameter, results(k).getData);
+end
+
+end
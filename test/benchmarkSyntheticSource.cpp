@@ -0,0 +1,215 @@
+// benchmarkSyntheticSource.cpp - Throughput of the capture without a camera
+// 17.10.2026 / agent
+//
+// Runs capture_images on a SyntheticSource for several input and output
+// formats and prints frames per second, MB/s written into the output
+// and the median time of the retrieve, convert and copy stages. The
+// source delivers frames as fast as possible, so the numbers are those of
+// the conversion and copy of the driver, not of a camera. The Bayer and
+// mono to RGB cases compare the native kernels with Pylon's converter.
+// Each case runs once with nWorkers worker threads and once in the grab
+// thread.
+// Then save_images writes the Mono8 frames of a SyntheticSource as TIFF
+// files, as a .braw raw stream and as a .bcmp compressed stream into
+// saveDirectory, with 1, 2 and 4 writers. The default directory /dev/shm
+// is a tmpfs on Linux, so these numbers leave out the disk. The files are
+// removed after each case.
+//
+// Build with "make tests" in Matlab, which links the driver's objects and
+// Matlab's libraries. Run it outside of Matlab with Matlab's and Pylon's
+// binaries on the path:
+//   benchmarkSyntheticSource [width height nFrames nWorkers saveDirectory]
+//   (default 1920 1080 300, nWorkers = one per CPU core but one,
+//   saveDirectory = /dev/shm)
+
+
+#include <pylon/PylonIncludes.h>
+#include "capture_images.h"
+#include <boost/filesystem.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+
+namespace {
+
+    //---------------------------------------------------------------------
+    // One capture of the benchmark
+    struct BenchmarkCase
+    {
+        Pylon::EPixelType ept_input_type;
+        Pylon::EPixelType ept_output_type;
+        BaslerHelper::ColorConversion cc_method;
+        const char* s_method;
+    };
+
+    const BenchmarkCase CASES[] = {
+        {Pylon::PixelType_Mono8,        Pylon::PixelType_Mono8,         BaslerHelper::ColorConversion_Bilinear, "copy"},
+        {Pylon::PixelType_Mono12,       Pylon::PixelType_Mono16,        BaslerHelper::ColorConversion_Bilinear, "copy"},
+        {Pylon::PixelType_Mono12p,      Pylon::PixelType_Mono16,        BaslerHelper::ColorConversion_Bilinear, "unpack"},
+        {Pylon::PixelType_Mono12p,      Pylon::PixelType_Mono16,        BaslerHelper::ColorConversion_Pylon,    "pylon"},
+        {Pylon::PixelType_RGB8packed,   Pylon::PixelType_RGB8packed,    BaslerHelper::ColorConversion_Bilinear, "copy"},
+        {Pylon::PixelType_BayerRG8,     Pylon::PixelType_RGB8packed,    BaslerHelper::ColorConversion_Bilinear, "bilinear"},
+        {Pylon::PixelType_BayerRG8,     Pylon::PixelType_RGB8packed,    BaslerHelper::ColorConversion_GradientCorrected, "gradient"},
+        {Pylon::PixelType_BayerRG8,     Pylon::PixelType_RGB8packed,    BaslerHelper::ColorConversion_Pylon,    "pylon"},
+        {Pylon::PixelType_BayerRG12,    Pylon::PixelType_RGB16packed,   BaslerHelper::ColorConversion_Bilinear, "bilinear"},
+        {Pylon::PixelType_BayerRG12,    Pylon::PixelType_RGB16packed,   BaslerHelper::ColorConversion_Pylon,    "pylon"},
+        {Pylon::PixelType_Mono8,        Pylon::PixelType_RGB8packed,    BaslerHelper::ColorConversion_Bilinear, "native"},
+        {Pylon::PixelType_Mono8,        Pylon::PixelType_RGB8packed,    BaslerHelper::ColorConversion_Pylon,    "pylon"},
+    };
+
+    //---------------------------------------------------------------------
+    // Capture i_num_of_frames frames of a case into p_output, returns the
+    // time in s and fills the telemetry
+    template <typename T>
+    double run_case(const BenchmarkCase& bc,
+                    const unsigned long long i_width,
+                    const unsigned long long i_height,
+                    const int i_num_of_frames,
+                    const int i_num_of_workers,
+                    std::vector<T>& output,
+                    BaslerHelper::Telemetry& telemetry)
+    {
+        BaslerHelper::SyntheticSource source(i_width, i_height, bc.ept_input_type, 0, 0);
+        const std::chrono::steady_clock::time_point tp_start = std::chrono::steady_clock::now();
+        BaslerHelper::capture_images<T>(&source, i_num_of_frames, &output[0], bc.ept_output_type, i_num_of_workers,
+                false, NULL, bc.cc_method, NULL, NULL, NULL, NULL, &telemetry);
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - tp_start).count();
+    }
+
+    //---------------------------------------------------------------------
+    // Run a case with and without workers and print a line for each
+    template <typename T>
+    void benchmark_case(const BenchmarkCase& bc,
+                        const unsigned long long i_width,
+                        const unsigned long long i_height,
+                        const int i_num_of_frames,
+                        const int i_num_of_workers)
+    {
+        const size_t i_frame_numel = (size_t)(i_width * i_height * Pylon::SamplesPerPixel(bc.ept_output_type));
+        std::vector<T> output(i_frame_numel * i_num_of_frames);
+        const double d_megabytes = (double)output.size() * sizeof(T) * 1e-6;
+
+        const int i_workers[] = {i_num_of_workers, 0};
+        for (int w = 0; w < 2; w++)
+        {
+            // Warm up: fault in the output and create the Pylon converter
+            BaslerHelper::Telemetry warm_up(false);
+            run_case<T>(bc, i_width, i_height, std::min(i_num_of_frames, 10), i_workers[w], output, warm_up);
+
+            BaslerHelper::Telemetry telemetry(false);
+            const double d_seconds = run_case<T>(bc, i_width, i_height, i_num_of_frames, i_workers[w], output, telemetry);
+            printf("%-12s -> %-12s %-9s %2d worker(s): %7.1f fps %8.1f MB/s, p50 retrieve %6.3f convert %6.3f copy %6.3f ms\n",
+                    Pylon::CPixelTypeMapper::GetNameByPixelType(bc.ept_input_type),
+                    Pylon::CPixelTypeMapper::GetNameByPixelType(bc.ept_output_type),
+                    bc.s_method, i_workers[w], i_num_of_frames / d_seconds, d_megabytes / d_seconds,
+                    1000 * telemetry.percentile(BaslerHelper::Stage_Retrieve, 50),
+                    1000 * telemetry.percentile(BaslerHelper::Stage_Convert, 50),
+                    1000 * telemetry.percentile(BaslerHelper::Stage_Copy, 50));
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // One run of save_images
+    struct SaveCase
+    {
+        BaslerHelper::SaveFormat sf_format;
+        const char* s_name;
+        const char* s_file;     // Created in the save directory
+    };
+
+    const SaveCase SAVE_CASES[] = {
+        {BaslerHelper::SaveFormat_Tiff,         "tiff", "tiff"},
+        {BaslerHelper::SaveFormat_RawStream,    "braw", "frames.braw"},
+        {BaslerHelper::SaveFormat_Compressed,   "bcmp", "frames.bcmp"},
+    };
+
+    //---------------------------------------------------------------------
+    // Save i_num_of_frames Mono8 frames of a SyntheticSource in the format
+    // of the case with 1, 2 and 4 writers and print a line for each
+    void benchmark_save(const SaveCase& sc,
+                        const unsigned long long i_width,
+                        const unsigned long long i_height,
+                        const int i_num_of_frames,
+                        const boost::filesystem::path& bfp_directory)
+    {
+        const boost::filesystem::path bfp_file = bfp_directory / sc.s_file;
+        boost::filesystem::path bfp_save_path = bfp_file;
+        if (sc.sf_format == BaslerHelper::SaveFormat_Tiff)
+        {
+            boost::filesystem::create_directory(bfp_file);
+            bfp_save_path /= "frame_%04d.tif";
+        }
+        const double d_megabytes = (double)(i_width * i_height) * i_num_of_frames * 1e-6;
+
+        const int i_writers[] = {1, 2, 4};
+        for (int w = 0; w < 3; w++)
+        {
+            BaslerHelper::SyntheticSource source(i_width, i_height, Pylon::PixelType_Mono8, 0, 0);
+            BaslerHelper::Telemetry telemetry(false);
+            const std::chrono::steady_clock::time_point tp_start = std::chrono::steady_clock::now();
+            const BaslerHelper::SaveStatistics stats = BaslerHelper::save_images(&source, bfp_save_path, i_num_of_frames,
+                    Pylon::PixelType_Mono8, i_writers[w], sc.sf_format, false, NULL, NULL, &telemetry);
+            const double d_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - tp_start).count();
+            const double d_ratio = stats.i_compressed_bytes > 0 ? (double)stats.i_raw_bytes / stats.i_compressed_bytes : 1.0;
+            printf("Mono8 save %-4s %d writer(s): %7.1f fps %8.1f MB/s, saved %d, stalls %d, queue %d, ratio %5.2f, p50 save %6.3f ms\n",
+                    sc.s_name, i_writers[w], i_num_of_frames / d_seconds, d_megabytes / d_seconds,
+                    stats.i_saved, stats.i_stalls, stats.i_max_queue_depth, d_ratio,
+                    1000 * telemetry.percentile(BaslerHelper::Stage_Save, 50));
+        }
+        boost::filesystem::remove_all(bfp_file);
+    }
+}
+
+
+int main(int argc, char* argv[])
+{
+    const unsigned long long i_width = argc > 1 ? strtoull(argv[1], NULL, 10) : 1920;
+    const unsigned long long i_height = argc > 2 ? strtoull(argv[2], NULL, 10) : 1080;
+    const int i_num_of_frames = argc > 3 ? atoi(argv[3]) : 300;
+    const int i_num_of_workers = argc > 4 ? atoi(argv[4]) :
+            std::max(1, (int)std::thread::hardware_concurrency() - 1);
+    const boost::filesystem::path bfp_directory(argc > 5 ? argv[5] : "/dev/shm");
+    if (i_width == 0 || i_height == 0 || i_num_of_frames < 1 || i_num_of_workers < 0)
+    {
+        printf("Usage: benchmarkSyntheticSource [width height nFrames nWorkers saveDirectory]\n");
+        return 2;
+    }
+
+    Pylon::PylonAutoInitTerm pylon_init;
+    try
+    {
+        printf("%llux%llu, %d frames, kernel set %s\n", i_width, i_height, i_num_of_frames,
+                BaslerHelper::transpose_kernel_name());
+        for (size_t c = 0; c < sizeof(CASES) / sizeof(CASES[0]); c++)
+        {
+            if (Pylon::BitPerPixel(CASES[c].ept_output_type) / Pylon::SamplesPerPixel(CASES[c].ept_output_type) > 8)
+            {
+                benchmark_case<uint16_t>(CASES[c], i_width, i_height, i_num_of_frames, i_num_of_workers);
+            }
+            else
+            {
+                benchmark_case<uint8_t>(CASES[c], i_width, i_height, i_num_of_frames, i_num_of_workers);
+            }
+        }
+        printf("Saving into %s\n", bfp_directory.string().c_str());
+        for (size_t c = 0; c < sizeof(SAVE_CASES) / sizeof(SAVE_CASES[0]); c++)
+        {
+            benchmark_save(SAVE_CASES[c], i_width, i_height, i_num_of_frames, bfp_directory);
+        }
+    }
+    catch (GenICam::GenericException &e)
+    {
+        printf("Error: %s\n", e.GetDescription());
+        return 1;
+    }
+    catch (boost::filesystem::filesystem_error &e)
+    {
+        printf("Error: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
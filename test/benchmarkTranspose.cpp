@@ -0,0 +1,158 @@
+// benchmarkTranspose.cpp - Check and time the transpose kernels
+// 17.10.2026 / agent
+//
+// Compares BaslerHelper::transpose_image with the per pixel loop it
+// replaced, first for correctness on all sizes up to 130x130 pixels with
+// 1 to 4 bands, then in GB/s (bytes copied per second) on frames of the
+// given size. Three copies are timed for 8 and 16 bit:
+//   - naive: one pixel at a time, one pass per band, as capture_images
+//     copied before
+//   - tiled: the tiled scalar template, used for types without a kernel
+//   - kernel: the kernel set chosen at runtime (avx2, sse2 or scalar)
+// Needs neither Matlab nor Pylon.
+//
+// Build and run, from the test directory:
+//   g++ -O2 -std=c++11 -I../basler_helper benchmarkTranspose.cpp ../basler_helper/transpose_image.cpp -o benchmarkTranspose
+//   cl /O2 /EHsc /I..\basler_helper benchmarkTranspose.cpp ..\basler_helper\transpose_image.cpp
+//   benchmarkTranspose [height width repetitions]    (default 1088 2048 50)
+
+
+#include "transpose_image.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+
+namespace {
+
+    //---------------------------------------------------------------------
+    // Per pixel copy, one pass per band
+    template <typename T>
+    void transpose_naive(const T* p_src, T* p_dst, const size_t i_height, const size_t i_width, const unsigned int i_bands)
+    {
+        for (unsigned int b = 0; b < i_bands; b++)
+        {
+            for (size_t i = 0; i < i_height; i++)
+            {
+                for (size_t j = 0; j < i_width; j++)
+                {
+                    p_dst[b*i_height*i_width + j*i_height + i] = p_src[(i*i_width + j)*i_bands + b];
+                }
+            }
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Compare the kernels with the naive copy, returns the number of
+    // sizes which differ
+    template <typename T>
+    int check_sizes()
+    {
+        int i_failed = 0;
+        for (unsigned int i_bands = 1; i_bands <= 4; i_bands++)
+        {
+            for (size_t i_height = 1; i_height <= 130; i_height++)
+            {
+                for (size_t i_width = 1; i_width <= 130; i_width++)
+                {
+                    const size_t i_numel = i_height * i_width * i_bands;
+                    std::vector<T> src(i_numel), expected(i_numel), actual(i_numel);
+                    for (size_t k = 0; k < i_numel; k++)
+                    {
+                        src[k] = (T)(k * 2654435761u >> 7);
+                    }
+                    transpose_naive(&src[0], &expected[0], i_height, i_width, i_bands);
+                    BaslerHelper::transpose_image(&src[0], &actual[0], i_height, i_width, i_bands);
+                    if (actual != expected)
+                    {
+                        printf("  %u bit, %ux%u, %u band(s): kernel differs\n", (unsigned int)(8 * sizeof(T)),
+                                (unsigned int)i_height, (unsigned int)i_width, i_bands);
+                        i_failed++;
+                    }
+                    BaslerHelper::transpose_image<T>(&src[0], &actual[0], i_height, i_width, i_bands);
+                    if (actual != expected)
+                    {
+                        printf("  %u bit, %ux%u, %u band(s): tiled differs\n", (unsigned int)(8 * sizeof(T)),
+                                (unsigned int)i_height, (unsigned int)i_width, i_bands);
+                        i_failed++;
+                    }
+                }
+            }
+        }
+        return i_failed;
+    }
+
+    //---------------------------------------------------------------------
+    // Best of i_repetitions copies, in GB/s
+    template <typename F>
+    double best_rate(F copy, const size_t i_bytes, const int i_repetitions)
+    {
+        double d_best = 0;
+        for (int r = 0; r < i_repetitions; r++)
+        {
+            const std::chrono::steady_clock::time_point tp_start = std::chrono::steady_clock::now();
+            copy();
+            const double d_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - tp_start).count();
+            const double d_rate = (double)i_bytes / d_seconds * 1e-9;
+            d_best = d_rate > d_best ? d_rate : d_best;
+        }
+        return d_best;
+    }
+
+    //---------------------------------------------------------------------
+    // Time the three copies of a frame
+    template <typename T>
+    void time_copies(const size_t i_height, const size_t i_width, const unsigned int i_bands, const int i_repetitions)
+    {
+        const size_t i_numel = i_height * i_width * i_bands;
+        std::vector<T> src(i_numel), dst(i_numel);
+        for (size_t k = 0; k < i_numel; k++)
+        {
+            src[k] = (T)k;
+        }
+        const T* p_src = &src[0];
+        T* p_dst = &dst[0];
+        const size_t i_bytes = i_numel * sizeof(T);
+
+        const double d_naive = best_rate([&]() { transpose_naive(p_src, p_dst, i_height, i_width, i_bands); },
+                i_bytes, i_repetitions);
+        const double d_tiled = best_rate([&]() { BaslerHelper::transpose_image<T>(p_src, p_dst, i_height, i_width, i_bands); },
+                i_bytes, i_repetitions);
+        const double d_kernel = best_rate([&]() { BaslerHelper::transpose_image(p_src, p_dst, i_height, i_width, i_bands); },
+                i_bytes, i_repetitions);
+        printf("%2u bit %u band(s): naive %6.2f GB/s, tiled %6.2f GB/s, kernel %6.2f GB/s\n",
+                (unsigned int)(8 * sizeof(T)), i_bands, d_naive, d_tiled, d_kernel);
+    }
+}
+
+
+int main(int argc, char* argv[])
+{
+    const size_t i_height = argc > 1 ? (size_t)atol(argv[1]) : 1088;
+    const size_t i_width = argc > 2 ? (size_t)atol(argv[2]) : 2048;
+    const int i_repetitions = argc > 3 ? atoi(argv[3]) : 50;
+    if (i_height == 0 || i_width == 0 || i_repetitions < 1)
+    {
+        printf("Usage: benchmarkTranspose [height width repetitions]\n");
+        return 2;
+    }
+
+    printf("Kernel set: %s\n", BaslerHelper::transpose_kernel_name());
+    const int i_failed = check_sizes<uint8_t>() + check_sizes<uint16_t>();
+    printf("Sizes up to 130x130 with 1 to 4 bands: %s\n", i_failed == 0 ? "ok" : "FAILED");
+
+    printf("%ux%u, best of %d:\n", (unsigned int)i_height, (unsigned int)i_width, i_repetitions);
+    // The number of bands is read at runtime, as in the driver, so that
+    // the compiler cannot specialize the copies here for it
+    volatile unsigned int i_bands[] = {1, 3, 4};
+    for (int k = 0; k < 3; k++)
+    {
+        time_copies<uint8_t>(i_height, i_width, i_bands[k], i_repetitions);
+    }
+    for (int k = 0; k < 3; k++)
+    {
+        time_copies<uint16_t>(i_height, i_width, i_bands[k], i_repetitions);
+    }
+    return i_failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,56 @@
+function results = benchmarkTransposed(nFrames)
+% benchmarkTransposed.m - Compare the direct grab with the copying one
+%
+%  Captures nFrames (default=500) Mono8 frames from an emulated camera,
+%  once through the Pylon grab buffers and once with Transposed = 1,
+%  where the camera writes into the returned array. Prints and returns
+%  the throughput of both in MB/s and the growth of the resident memory
+%  of Matlab during each capture in MB (Linux only, NaN elsewhere). The
+%  memory is read after the capture, so buffers freed before are not
+%  seen.
+%
+%  Usage:
+%    benchmarkTransposed();
+%    results = benchmarkTransposed(nFrames);
+%
+
+if nargin < 1
+    nFrames = 500;
+end
+
+camera = emulatedCamera();
+baslerSetParameter(camera, 'PixelFormat', 'Mono8');
+
+names = {'copy', 'transposed'};
+results = struct('name', names, 'megabytesPerSecond', NaN, 'residentGrowth', NaN);
+for k = 1:2
+    rssBefore = residentMegabytes();
+    tStart = tic;
+    frames = baslerGetData(camera, nFrames, 'Mono8', 0, [], 'Transposed', k == 2);
+    seconds = toc(tStart);
+    info = whos('frames');
+    results(k).megabytesPerSecond = info.bytes / 1e6 / seconds;
+    results(k).residentGrowth = residentMegabytes() - rssBefore;
+    clear frames
+    fprintf('%-10s %8.1f MB/s, resident memory +%.1f MB\n', names{k}, ...
+            results(k).megabytesPerSecond, results(k).residentGrowth);
+end
+
+end
+
+
+function megabytes = residentMegabytes()
+% Resident memory of the Matlab process, NaN if unknown
+megabytes = NaN;
+fid = fopen('/proc/self/status', 'r');
+if fid < 0
+    return;
+end
+status = fread(fid, Inf, '*char')';
+fclose(fid);
+tokens = regexp(status, 'VmRSS:\s*(\d+)\s*kB', 'tokens', 'once');
+if ~isempty(tokens)
+    megabytes = str2double(tokens{1}) / 1024;
+end
+
+end
@@ -0,0 +1,27 @@
+function camera = emulatedCamera()
+% emulatedCamera.m - Index of an emulated Basler camera for the tests
+%
+%  Enables the Pylon camera emulation (PYLON_CAMEMU) and returns the index
+%  of the first emulated camera, so the tests run without hardware. The
+%  driver is cleared first, as Pylon reads PYLON_CAMEMU only when it is
+%  initialized. The driver directory is added to the path.
+%
+%  Usage:
+%    camera = emulatedCamera();
+%
+
+addpath(fileparts(fileparts(mfilename('fullpath'))));
+
+if ~strcmp(getenv('PYLON_CAMEMU'), '1')
+    setenv('PYLON_CAMEMU', '1');
+    clear baslerDriver
+end
+
+cameras = baslerFindCameras();
+index = find(strcmp(cameras(:,2), 'Emulation'), 1);
+if isempty(index)
+    error('baslerDriver:Error:CameraError', 'No emulated camera found.');
+end
+camera = cameras{index,1};
+
+end
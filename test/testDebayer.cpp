@@ -0,0 +1,208 @@
+// testDebayer.cpp - Compare the native bilinear debayer with Pylon's converter
+// 17.10.2026 / agent
+//
+// Converts synthetic BayerRG8 and BayerRG12 frames to RGB8packed and
+// RGB16packed with convert_native (bilinear) and with Pylon's
+// CImageFormatConverter and compares the values of every pixel and color.
+// The frames are a smooth scene with sensor noise and random values, in
+// a full frame and some small odd sizes. The two outermost rows and
+// columns are reported separately, as both may treat the border of the
+// image differently. Prints the largest difference inside and on the
+// border, in units of the input's least significant bit, and the best
+// time of both of 10 conversions. Returns 1 if a value inside differs
+// by more than one unit.
+//
+// Build with "make tests" in Matlab, or from the test directory:
+//   g++ -O2 -std=c++11 -I../basler_helper $(pylon-config --cflags) testDebayer.cpp ../basler_helper/debayer_image.cpp ../basler_helper/unpack_image.cpp ../basler_helper/transpose_image.cpp $(pylon-config --libs) -o testDebayer
+//   testDebayer [width height]    (default 1920 1080)
+
+
+#include <pylon/PylonIncludes.h>
+#include "debayer_image.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+
+namespace {
+
+    // Rows and columns at each side counted as border
+    const size_t BORDER = 2;
+
+    struct DebayerFormat
+    {
+        Pylon::EPixelType ept_input_type;
+        Pylon::EPixelType ept_output_type;
+        const char* s_name;
+        unsigned int i_bits;
+    };
+
+    const DebayerFormat FORMATS[] = {
+        {Pylon::PixelType_BayerRG8,     Pylon::PixelType_RGB8packed,    "BayerRG8 -> RGB8packed",   8},
+        {Pylon::PixelType_BayerRG12,    Pylon::PixelType_RGB16packed,   "BayerRG12 -> RGB16packed", 12},
+    };
+
+    //---------------------------------------------------------------------
+    // Sample (i,j) of a frame: a slow wave with a different gain on each
+    // color and gaussian noise of about 1 % of the range, or random values
+    uint16_t sample(const bool b_random, const size_t i, const size_t j, const unsigned int i_bits, std::mt19937& rng)
+    {
+        const double d_max = (double)((1 << i_bits) - 1);
+        if (b_random)
+        {
+            return (uint16_t)(rng() & (uint32_t)d_max);
+        }
+        std::normal_distribution<double> noise(0, d_max / 128);
+        const double d_gain = 0.6 + 0.2 * (double)((i % 2) * 2 + j % 2);
+        const double d_value = d_gain * d_max * (0.5 + 0.3 * sin(j * 0.01) * cos(i * 0.013)) + noise(rng);
+        return (uint16_t)std::min(d_max, std::max(0.0, floor(d_value + 0.5)));
+    }
+
+    //---------------------------------------------------------------------
+    // Best time in s of i_runs calls of f
+    template <typename F>
+    double best_seconds(F f, const int i_runs)
+    {
+        double d_best = 1e30;
+        for (int r = 0; r < i_runs; r++)
+        {
+            const std::chrono::steady_clock::time_point tp_start = std::chrono::steady_clock::now();
+            f();
+            d_best = std::min(d_best, std::chrono::duration<double>(std::chrono::steady_clock::now() - tp_start).count());
+        }
+        return d_best;
+    }
+
+    //---------------------------------------------------------------------
+    // Convert one frame both ways and compare, returns the number of
+    // values inside which differ by more than one unit
+    template <typename T>
+    int check(const DebayerFormat& format, const size_t i_height, const size_t i_width, const bool b_random,
+              const bool b_timed, std::mt19937& rng)
+    {
+        const size_t i_numel = i_height * i_width;
+        std::vector<T> raw(i_numel);
+        for (size_t i = 0; i < i_height; i++)
+        {
+            for (size_t j = 0; j < i_width; j++)
+            {
+                raw[i * i_width + j] = (T)sample(b_random, i, j, format.i_bits, rng);
+            }
+        }
+
+        // Native: column-major planes, Pylon: row-major interleaved
+        std::vector<T> native(3 * i_numel), pylon(3 * i_numel);
+        Pylon::CImageFormatConverter py_converter;
+        py_converter.OutputPixelFormat = format.ept_output_type;
+        const auto native_convert = [&]() {
+            BaslerHelper::convert_native(&raw[0], format.ept_input_type, &native[0], format.ept_output_type,
+                    i_height, i_width, BaslerHelper::ColorConversion_Bilinear);
+        };
+        const auto pylon_convert = [&]() {
+            py_converter.Convert(&pylon[0], pylon.size() * sizeof(T), &raw[0], raw.size() * sizeof(T),
+                    format.ept_input_type, (uint32_t)i_width, (uint32_t)i_height, 0, Pylon::ImageOrientation_TopDown);
+        };
+        const int i_runs = b_timed ? 10 : 1;
+        const double d_native = best_seconds(native_convert, i_runs);
+        const double d_pylon = best_seconds(pylon_convert, i_runs);
+
+        // Differences in units of the input, outputs of more than 8 bits
+        // hold the values in the most significant bits
+        const unsigned int i_shift = 8 * sizeof(T) > format.i_bits ? 8 * sizeof(T) - format.i_bits : 0;
+        const int i_unit = 1 << i_shift;
+        int i_max_inside = 0;
+        int i_max_border = 0;
+        int i_failed = 0;
+        for (size_t i = 0; i < i_height; i++)
+        {
+            for (size_t j = 0; j < i_width; j++)
+            {
+                const bool b_border = i < BORDER || j < BORDER || i + BORDER >= i_height || j + BORDER >= i_width;
+                for (size_t c = 0; c < 3; c++)
+                {
+                    const int i_native = native[(c * i_width + j) * i_height + i];
+                    const int i_pylon = pylon[(i * i_width + j) * 3 + c];
+                    const int i_diff = (std::abs(i_native - i_pylon) + i_unit - 1) / i_unit;
+                    if (b_border)
+                    {
+                        i_max_border = std::max(i_max_border, i_diff);
+                    }
+                    else
+                    {
+                        i_max_inside = std::max(i_max_inside, i_diff);
+                        if (i_diff > 1 && i_failed++ < 3)
+                        {
+                            printf("  %s %ux%u: color %u at (%u,%u) is %d, Pylon %d\n", format.s_name,
+                                    (unsigned int)i_height, (unsigned int)i_width, (unsigned int)c,
+                                    (unsigned int)i, (unsigned int)j, i_native, i_pylon);
+                        }
+                    }
+                }
+            }
+        }
+
+        printf("%-25s %4ux%-4u %-6s inside max %3d, border max %3d", format.s_name, (unsigned int)i_width,
+                (unsigned int)i_height, b_random ? "random" : "scene", i_max_inside, i_max_border);
+        if (b_timed)
+        {
+            printf(", native %7.3f ms, Pylon %7.3f ms", 1000 * d_native, 1000 * d_pylon);
+        }
+        printf(", %s\n", i_failed == 0 ? "ok" : "FAILED");
+        return i_failed;
+    }
+}
+
+
+int main(int argc, char* argv[])
+{
+    const size_t i_width = argc > 1 ? (size_t)atol(argv[1]) : 1920;
+    const size_t i_height = argc > 2 ? (size_t)atol(argv[2]) : 1080;
+    if (i_width < 2 * BORDER + 1 || i_height < 2 * BORDER + 1)
+    {
+        printf("Usage: testDebayer [width height]\n");
+        return 2;
+    }
+
+    Pylon::PylonAutoInitTerm pylon_init;
+    std::mt19937 rng(12345);
+    const size_t i_sizes[][2] = {{i_height, i_width}, {21, 37}, {8, 16}, {5, 7}};
+    int i_failed = 0;
+    try
+    {
+        for (size_t f = 0; f < sizeof(FORMATS) / sizeof(FORMATS[0]); f++)
+        {
+            if (!BaslerHelper::can_convert_native(FORMATS[f].ept_input_type, FORMATS[f].ept_output_type))
+            {
+                printf("  %s has no native kernel\n", FORMATS[f].s_name);
+                i_failed++;
+                continue;
+            }
+            for (size_t s = 0; s < sizeof(i_sizes) / sizeof(i_sizes[0]); s++)
+            {
+                for (int r = 0; r < 2; r++)
+                {
+                    if (FORMATS[f].i_bits > 8)
+                    {
+                        i_failed += check<uint16_t>(FORMATS[f], i_sizes[s][0], i_sizes[s][1], r == 1, s == 0, rng);
+                    }
+                    else
+                    {
+                        i_failed += check<uint8_t>(FORMATS[f], i_sizes[s][0], i_sizes[s][1], r == 1, s == 0, rng);
+                    }
+                }
+            }
+        }
+    }
+    catch (GenICam::GenericException &e)
+    {
+        printf("Error: %s\n", e.GetDescription());
+        return 1;
+    }
+    printf("%d value(s) inside differ by more than one unit\n", i_failed);
+    return i_failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,211 @@
+// testFrameReduce.cpp - Check the reduce kernels against the scalar code
+// 17.10.2026 / agent
+//
+// Runs the SIMD kernels of frame_reduce (accumulate_sum, _sum_squares,
+// _max and _min for 8 and 16 bit samples) and the scalar templates on the
+// same random values and accumulators and compares. The values include
+// the extremes of each type. Covers 1 to 260 samples (the SIMD kernels
+// and their remainders), all 16 byte offsets of the source and some full
+// frame sizes. Then checks FrameAccumulator, also after a merge, against
+// a reference in double. Prints the failing cases and returns 1 if any.
+// Needs no Pylon.
+//
+// Build and run, from the test directory:
+//   g++ -O2 -std=c++11 -I../basler_helper testFrameReduce.cpp ../basler_helper/frame_reduce.cpp -o testFrameReduce
+//   cl /O2 /EHsc /I..\basler_helper testFrameReduce.cpp ..\basler_helper\frame_reduce.cpp
+//   testFrameReduce
+
+
+#include "frame_reduce.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <vector>
+
+
+namespace {
+
+    //---------------------------------------------------------------------
+    // i_numel random values, every third one an extreme of the type
+    template <typename T>
+    std::vector<T> random_values(const size_t i_numel, std::mt19937& rng)
+    {
+        const T i_max = std::numeric_limits<T>::max();
+        std::vector<T> values(i_numel);
+        for (size_t i = 0; i < i_numel; i++)
+        {
+            values[i] = (i % 3 == 0) ? ((i / 3) % 2 == 0 ? i_max : 0) : (T)(rng() & i_max);
+        }
+        return values;
+    }
+
+    //---------------------------------------------------------------------
+    // Compare the kernel and the scalar result, returns 1 if they differ
+    template <typename A>
+    int compare(const char* s_function, const unsigned int i_bits, const size_t i_numel, const size_t i_offset,
+                const std::vector<A>& kernel, const std::vector<A>& scalar)
+    {
+        for (size_t i = 0; i < i_numel; i++)
+        {
+            if (kernel[i] != scalar[i])
+            {
+                printf("  %s %u bit, %u sample(s), offset %u: %llu at %u, expected %llu\n", s_function, i_bits,
+                        (unsigned int)i_numel, (unsigned int)i_offset, (unsigned long long)kernel[i],
+                        (unsigned int)i, (unsigned long long)scalar[i]);
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+    //---------------------------------------------------------------------
+    // Check all kernels of one type on i_numel samples starting i_offset
+    // samples into the source, returns the number of failing kernels
+    template <typename T>
+    int check_kernels(const size_t i_numel, const size_t i_offset, std::mt19937& rng)
+    {
+        const unsigned int i_bits = 8 * sizeof(T);
+        const std::vector<T> src = random_values<T>(i_numel + i_offset, rng);
+        const T* p_src = &src[i_offset];
+        int i_failed = 0;
+
+        // Accumulators already hold values, as after some frames
+        std::vector<uint32_t> sum(i_numel + 1), sum_scalar;
+        std::vector<uint64_t> squares(i_numel + 1), squares_scalar;
+        for (size_t i = 0; i < i_numel; i++)
+        {
+            sum[i] = rng() >> 8;
+            squares[i] = ((uint64_t)rng() << 16) | rng();
+        }
+        sum_scalar = sum;
+        squares_scalar = squares;
+        BaslerHelper::accumulate_sum(p_src, &sum[0], i_numel);
+        BaslerHelper::accumulate_sum<T>(p_src, &sum_scalar[0], i_numel);
+        i_failed += compare("accumulate_sum", i_bits, i_numel + 1, i_offset, sum, sum_scalar);
+        BaslerHelper::accumulate_sum_squares(p_src, &squares[0], i_numel);
+        BaslerHelper::accumulate_sum_squares<T>(p_src, &squares_scalar[0], i_numel);
+        i_failed += compare("accumulate_sum_squares", i_bits, i_numel + 1, i_offset, squares, squares_scalar);
+
+        std::vector<T> extreme = random_values<T>(i_numel + 1, rng);
+        std::vector<T> extreme_scalar = extreme;
+        BaslerHelper::accumulate_max(p_src, &extreme[0], i_numel);
+        BaslerHelper::accumulate_max<T>(p_src, &extreme_scalar[0], i_numel);
+        i_failed += compare("accumulate_max", i_bits, i_numel + 1, i_offset, extreme, extreme_scalar);
+        BaslerHelper::accumulate_min(p_src, &extreme[0], i_numel);
+        BaslerHelper::accumulate_min<T>(p_src, &extreme_scalar[0], i_numel);
+        i_failed += compare("accumulate_min", i_bits, i_numel + 1, i_offset, extreme, extreme_scalar);
+        return i_failed;
+    }
+
+    //---------------------------------------------------------------------
+    // Reduce i_frames random frames, half of them in a second accumulator
+    // which is merged, and compare with a reference in double. Returns 1
+    // if a mode differs.
+    template <typename T>
+    int check_accumulator(const size_t i_height, const size_t i_width, const unsigned int i_bands,
+                          const int i_frames, std::mt19937& rng)
+    {
+        const size_t i_numel = i_height * i_width * i_bands;
+        std::vector<std::vector<T> > frames(i_frames);
+        for (int f = 0; f < i_frames; f++)
+        {
+            frames[f] = random_values<T>(i_numel, rng);
+        }
+
+        const BaslerHelper::ReduceMode rm_modes[] = {BaslerHelper::Reduce_Mean, BaslerHelper::Reduce_Var,
+                BaslerHelper::Reduce_Sum, BaslerHelper::Reduce_Max, BaslerHelper::Reduce_Min};
+        const char* s_modes[] = {"mean", "var", "sum", "max", "min"};
+        int i_failed = 0;
+        for (int m = 0; m < 5; m++)
+        {
+            BaslerHelper::FrameAccumulator<T> accumulator(rm_modes[m], i_height, i_width, i_bands);
+            BaslerHelper::FrameAccumulator<T> other(rm_modes[m], i_height, i_width, i_bands);
+            for (int f = 0; f < i_frames; f++)
+            {
+                (f % 2 == 0 ? accumulator : other).add(&frames[f][0]);
+            }
+            accumulator.merge(other);
+            std::vector<double> result(i_numel);
+            accumulator.result(&result[0]);
+
+            for (size_t i = 0; i < i_height; i++)
+            {
+                for (size_t j = 0; j < i_width; j++)
+                {
+                    for (unsigned int b = 0; b < i_bands; b++)
+                    {
+                        const size_t i_src = (i * i_width + j) * i_bands + b;
+                        double d_sum = 0, d_max = frames[0][i_src], d_min = frames[0][i_src];
+                        for (int f = 0; f < i_frames; f++)
+                        {
+                            d_sum += frames[f][i_src];
+                            d_max = std::max(d_max, (double)frames[f][i_src]);
+                            d_min = std::min(d_min, (double)frames[f][i_src]);
+                        }
+                        const double d_mean = d_sum / i_frames;
+                        double d_squares = 0;
+                        for (int f = 0; f < i_frames; f++)
+                        {
+                            d_squares += (frames[f][i_src] - d_mean) * (frames[f][i_src] - d_mean);
+                        }
+                        const double d_expected[] = {d_mean, i_frames < 2 ? 0.0 : d_squares / (i_frames - 1),
+                                d_sum, d_max, d_min};
+                        const double d_actual = result[b * i_height * i_width + j * i_height + i];
+                        if (std::fabs(d_actual - d_expected[m]) > 1e-9 * std::max(1.0, std::fabs(d_expected[m])))
+                        {
+                            printf("  FrameAccumulator %u bit %s, %ux%ux%u, %d frame(s): %g at (%u,%u,%u), expected %g\n",
+                                    (unsigned int)(8 * sizeof(T)), s_modes[m], (unsigned int)i_height,
+                                    (unsigned int)i_width, i_bands, i_frames, d_actual, (unsigned int)i,
+                                    (unsigned int)j, b, d_expected[m]);
+                            i_failed++;
+                            i = i_height;
+                            j = i_width;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+        return i_failed;
+    }
+}
+
+
+int main()
+{
+    std::mt19937 rng(12345);
+    const size_t i_frame_sizes[] = {640 * 480, 1920 * 1080 * 3};
+    int i_failed = 0;
+    int i_cases = 0;
+    for (size_t i_numel = 1; i_numel <= 260; i_numel++)
+    {
+        for (size_t i_offset = 0; i_offset < 16; i_offset++)
+        {
+            i_failed += check_kernels<uint8_t>(i_numel, i_offset, rng);
+            i_failed += check_kernels<uint16_t>(i_numel, i_offset, rng);
+            i_cases += 2;
+        }
+    }
+    for (size_t s = 0; s < sizeof(i_frame_sizes) / sizeof(i_frame_sizes[0]); s++)
+    {
+        i_failed += check_kernels<uint8_t>(i_frame_sizes[s], 1, rng);
+        i_failed += check_kernels<uint16_t>(i_frame_sizes[s], 1, rng);
+        i_cases += 2;
+    }
+    printf("Kernels: %d case(s), %s\n", i_cases, i_failed == 0 ? "ok" : "FAILED");
+
+    int i_accumulator_failed = 0;
+    const int i_frames[] = {1, 2, 7};
+    for (int f = 0; f < 3; f++)
+    {
+        i_accumulator_failed += check_accumulator<uint8_t>(5, 37, 1, i_frames[f], rng);
+        i_accumulator_failed += check_accumulator<uint8_t>(3, 11, 3, i_frames[f], rng);
+        i_accumulator_failed += check_accumulator<uint16_t>(5, 37, 1, i_frames[f], rng);
+        i_accumulator_failed += check_accumulator<uint16_t>(3, 11, 3, i_frames[f], rng);
+    }
+    printf("FrameAccumulator: %s\n", i_accumulator_failed == 0 ? "ok" : "FAILED");
+    i_failed += i_accumulator_failed;
+    return i_failed == 0 ? 0 : 1;
+}
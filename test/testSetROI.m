@@ -0,0 +1,60 @@
+function testSetROI()
+% testSetROI.m - Check the order in which the ROI is applied
+%
+%  baslerSetROI and baslerSetParameters set the size of the ROI before
+%  its offset, whatever order the caller used. Checks a change from full
+%  frame to an ROI with offsets and a batch with the offset in front of
+%  the size, against an emulated camera.
+%
+%  Usage:
+%    testSetROI();
+%
+
+camera = emulatedCamera();
+maxSize = baslerGetParameters(camera, {'WidthMax','HeightMax'});
+w = double(maxSize.WidthMax);
+h = double(maxSize.HeightMax);
+
+% Full frame to an ROI with offsets, the offsets have no room before the
+% size is set
+baslerSetROI(camera);
+checkROI(camera, [w/8, h/8, w/2, h/2]);
+
+% Offset in front of the size, the new offset only fits with the new size
+baslerSetROI(camera, [w/4, 0, 3*w/4, h/2]);
+checkBatch(camera, struct('OffsetX', w/2, 'Width', w/2), [w/2, 0, w/2, h/2]);
+
+% Offset in front of a growing size, the given offset must not be reset
+baslerSetROI(camera, [w/2, 0, w/4, h/2]);
+checkBatch(camera, struct('OffsetX', w/8, 'Width', 3*w/4), [w/8, 0, 3*w/4, h/2]);
+
+baslerSetROI(camera);
+fprintf('testSetROI passed\n');
+
+end
+
+
+function checkROI(camera, roi)
+% Set an ROI with baslerSetROI and compare it with the camera
+baslerSetROI(camera, roi);
+compareROI(camera, roi);
+end
+
+
+function checkBatch(camera, parameters, roi)
+% Set parameters in one batch, all must succeed and give the ROI
+status = baslerSetParameters(camera, parameters);
+assert(all([status.success]), 'Setting %s failed: %s', ...
+       strjoin({status(~[status.success]).name}, ', '), ...
+       strjoin({status(~[status.success]).message}, ', '));
+compareROI(camera, roi);
+end
+
+
+function compareROI(camera, roi)
+% Compare the camera's ROI with the expected one
+values = baslerGetParameters(camera, {'OffsetX','OffsetY','Width','Height'});
+actual = double([values.OffsetX, values.OffsetY, values.Width, values.Height]);
+assert(isequal(actual, roi), 'ROI is [%s] instead of [%s]', ...
+       num2str(actual), num2str(roi));
+end
@@ -0,0 +1,215 @@
+// testUnpack.cpp - Check the unpack kernels against a reference packer
+// 17.10.2026 / agent
+//
+// Packs random values with a bit-by-bit reference of each packing, unpacks
+// them with unpack_row, unpack_rows and unpack_image and compares. Covers
+// all packed mono and Bayer formats, widths of 1 to 260 pixels (the SIMD
+// kernels and their remainders) and some full frame widths, a few heights
+// and shifts of 0 and to the most significant bit. Prints the failing
+// cases and returns 1 if any. Needs the Pylon headers only.
+//
+// Build and run, from the test directory:
+//   g++ -O2 -std=c++11 -I../basler_helper -I"$PYLON_ROOT/include" testUnpack.cpp ../basler_helper/unpack_image.cpp ../basler_helper/transpose_image.cpp -o testUnpack
+//   cl /O2 /EHsc /I..\basler_helper /I"%PYLON_ROOT%\include" testUnpack.cpp ..\basler_helper\unpack_image.cpp ..\basler_helper\transpose_image.cpp
+//   testUnpack
+
+
+#include "unpack_image.h"
+#include "transpose_image.h"
+#include <cstdio>
+#include <random>
+#include <vector>
+
+
+namespace {
+
+    // Layouts of the packed formats
+    enum Packing
+    {
+        Packing_p,              // Mono10p, Mono12p: LSB first bit stream
+        Packing_packed          // Mono10packed, Mono12packed: 2 pixels in 3 bytes
+    };
+
+    struct PackedFormat
+    {
+        Pylon::EPixelType ept_type;
+        const char* s_name;
+        Packing pk_packing;
+        unsigned int i_bits;
+    };
+
+    const PackedFormat FORMATS[] = {
+        {Pylon::PixelType_Mono10p,          "Mono10p",          Packing_p,      10},
+        {Pylon::PixelType_Mono12p,          "Mono12p",          Packing_p,      12},
+        {Pylon::PixelType_Mono10packed,     "Mono10packed",     Packing_packed, 10},
+        {Pylon::PixelType_Mono12packed,     "Mono12packed",     Packing_packed, 12},
+        {Pylon::PixelType_BayerGR10p,       "BayerGR10p",       Packing_p,      10},
+        {Pylon::PixelType_BayerRG10p,       "BayerRG10p",       Packing_p,      10},
+        {Pylon::PixelType_BayerGB10p,       "BayerGB10p",       Packing_p,      10},
+        {Pylon::PixelType_BayerBG10p,       "BayerBG10p",       Packing_p,      10},
+        {Pylon::PixelType_BayerGR12p,       "BayerGR12p",       Packing_p,      12},
+        {Pylon::PixelType_BayerRG12p,       "BayerRG12p",       Packing_p,      12},
+        {Pylon::PixelType_BayerGB12p,       "BayerGB12p",       Packing_p,      12},
+        {Pylon::PixelType_BayerBG12p,       "BayerBG12p",       Packing_p,      12},
+        {Pylon::PixelType_BayerGR12Packed,  "BayerGR12Packed",  Packing_packed, 12},
+        {Pylon::PixelType_BayerRG12Packed,  "BayerRG12Packed",  Packing_packed, 12},
+        {Pylon::PixelType_BayerGB12Packed,  "BayerGB12Packed",  Packing_packed, 12},
+        {Pylon::PixelType_BayerBG12Packed,  "BayerBG12Packed",  Packing_packed, 12},
+    };
+
+    //---------------------------------------------------------------------
+    // Bytes of a packed row, rows are padded to whole bytes
+    size_t reference_row_bytes(const PackedFormat& format, const size_t i_width)
+    {
+        if (format.pk_packing == Packing_p)
+        {
+            return (i_width * format.i_bits + 7) / 8;
+        }
+        return (i_width * 3 + 1) / 2;
+    }
+
+    //---------------------------------------------------------------------
+    // Pack one row. p: bit k of pixel j is bit (j*bits + k) of the row,
+    // counted from the LSB of the first byte. packed: pixels 2n and 2n+1
+    // share 3 bytes, the upper 8 bits of each pixel in bytes 0 and 2 and
+    // the remaining low bits in the low (pixel 2n) and high (pixel 2n+1)
+    // nibble of byte 1.
+    void reference_pack_row(const PackedFormat& format, const uint16_t* p_values, const size_t i_width, uint8_t* p_row)
+    {
+        if (format.pk_packing == Packing_p)
+        {
+            for (size_t j = 0; j < i_width; j++)
+            {
+                for (unsigned int k = 0; k < format.i_bits; k++)
+                {
+                    const size_t i_bit = j * format.i_bits + k;
+                    if ((p_values[j] >> k) & 1)
+                    {
+                        p_row[i_bit / 8] |= (uint8_t)(1 << (i_bit % 8));
+                    }
+                }
+            }
+            return;
+        }
+        const unsigned int i_low_bits = format.i_bits - 8;
+        for (size_t j = 0; j < i_width; j++)
+        {
+            uint8_t* p_group = p_row + (j / 2) * 3;
+            const uint8_t i_high = (uint8_t)(p_values[j] >> i_low_bits);
+            const uint8_t i_low = (uint8_t)(p_values[j] & ((1 << i_low_bits) - 1));
+            if (j % 2 == 0)
+            {
+                p_group[0] = i_high;
+                p_group[1] |= i_low;
+            }
+            else
+            {
+                p_group[2] = i_high;
+                p_group[1] |= (uint8_t)(i_low << 4);
+            }
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Check one format and size, returns the number of wrong values
+    int check(const PackedFormat& format, const size_t i_height, const size_t i_width, std::mt19937& rng)
+    {
+        int i_failed = 0;
+        const size_t i_row_bytes = reference_row_bytes(format, i_width);
+        if (BaslerHelper::packed_row_bytes(format.ept_type, i_width) != i_row_bytes)
+        {
+            printf("  %s width %u: packed_row_bytes is %u, expected %u\n", format.s_name, (unsigned int)i_width,
+                    (unsigned int)BaslerHelper::packed_row_bytes(format.ept_type, i_width), (unsigned int)i_row_bytes);
+            return 1;
+        }
+
+        // Random values, the first row also the extremes
+        const uint16_t i_max = (uint16_t)((1 << format.i_bits) - 1);
+        std::vector<uint16_t> values(i_height * i_width);
+        for (size_t k = 0; k < values.size(); k++)
+        {
+            values[k] = (uint16_t)(rng() & i_max);
+        }
+        for (size_t j = 0; j < i_width; j++)
+        {
+            values[j] = (j % 3 == 0) ? i_max : (j % 3 == 1 ? 0 : values[j]);
+        }
+
+        // One byte of slack after the frame, the kernels must not use it
+        std::vector<uint8_t> packed(i_height * i_row_bytes + 1, 0);
+        for (size_t i = 0; i < i_height; i++)
+        {
+            reference_pack_row(format, &values[i * i_width], i_width, &packed[i * i_row_bytes]);
+        }
+        packed.back() = 0xA5;
+
+        const unsigned int i_shifts[] = {0, 16 - format.i_bits};
+        for (int s = 0; s < 2; s++)
+        {
+            const unsigned int i_shift = i_shifts[s];
+            std::vector<uint16_t> row(i_width), rows(i_height * i_width), image(i_height * i_width);
+            BaslerHelper::unpack_rows(&packed[0], format.ept_type, &rows[0], i_height, i_width, i_shift);
+            BaslerHelper::unpack_image(&packed[0], format.ept_type, &image[0], i_height, i_width, i_shift);
+            for (size_t i = 0; i < i_height; i++)
+            {
+                BaslerHelper::unpack_row(&packed[i * i_row_bytes], format.ept_type, &row[0], i_width, i_shift);
+                for (size_t j = 0; j < i_width; j++)
+                {
+                    const uint16_t i_expected = (uint16_t)(values[i * i_width + j] << i_shift);
+                    const uint16_t i_actual[] = {row[j], rows[i * i_width + j], image[j * i_height + i]};
+                    const char* s_functions[] = {"unpack_row", "unpack_rows", "unpack_image"};
+                    for (int f = 0; f < 3; f++)
+                    {
+                        if (i_actual[f] != i_expected && i_failed++ < 3)
+                        {
+                            printf("  %s %ux%u shift %u: %s gives %u at (%u,%u), expected %u\n", format.s_name,
+                                    (unsigned int)i_height, (unsigned int)i_width, i_shift, s_functions[f],
+                                    i_actual[f], (unsigned int)i, (unsigned int)j, i_expected);
+                        }
+                    }
+                }
+            }
+        }
+        return i_failed;
+    }
+}
+
+
+int main()
+{
+    printf("Kernel set: %s\n", BaslerHelper::use_avx2_kernels() ? "avx2" : "scalar");
+    std::mt19937 rng(12345);
+    const size_t i_heights[] = {1, 2, 3, 17};
+    const size_t i_frame_widths[] = {640, 1281, 1920, 2048, 4096};
+    int i_failed = 0;
+    int i_cases = 0;
+    for (size_t f = 0; f < sizeof(FORMATS) / sizeof(FORMATS[0]); f++)
+    {
+        Pylon::EPixelType ept_unpacked;
+        if (!BaslerHelper::unpacked_format(FORMATS[f].ept_type, ept_unpacked)
+                || BaslerHelper::packed_bit_depth(FORMATS[f].ept_type) != FORMATS[f].i_bits)
+        {
+            printf("  %s is not recognized as a %u bit packed format\n", FORMATS[f].s_name, FORMATS[f].i_bits);
+            i_failed++;
+            continue;
+        }
+        int i_format_failed = 0;
+        for (size_t h = 0; h < sizeof(i_heights) / sizeof(i_heights[0]); h++)
+        {
+            for (size_t i_width = 1; i_width <= 260; i_width++)
+            {
+                i_format_failed += check(FORMATS[f], i_heights[h], i_width, rng);
+                i_cases++;
+            }
+        }
+        for (size_t w = 0; w < sizeof(i_frame_widths) / sizeof(i_frame_widths[0]); w++)
+        {
+            i_format_failed += check(FORMATS[f], 9, i_frame_widths[w], rng);
+            i_cases++;
+        }
+        printf("%-16s %s\n", FORMATS[f].s_name, i_format_failed == 0 ? "ok" : "FAILED");
+        i_failed += i_format_failed;
+    }
+    printf("%d case(s), %d wrong value(s)\n", i_cases, i_failed);
+    return i_failed == 0 ? 0 : 1;
+}